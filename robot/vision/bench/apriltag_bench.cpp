@@ -0,0 +1,79 @@
+#include "apriltag_detector.hpp"
+#include "bench_corpus.hpp"
+
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <chrono>
+
+using navign::robot::vision::AprilTagDetector;
+using navign::robot::vision::bench::BenchCorpus;
+using navign::robot::vision::bench::benchTagSize;
+
+namespace {
+
+double toMs(std::chrono::nanoseconds duration) {
+    return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+// detect() with pose over the corpus; range(0) = quad decimate, range(1) = threads
+void BM_AprilTagDetect(benchmark::State& state) {
+    const auto& corpus = BenchCorpus::get();
+    AprilTagDetector detector;
+    detector.setQuadDecimate(static_cast<float>(state.range(0)));
+    detector.setNumThreads(static_cast<int>(state.range(1)));
+
+    double decode_ms = 0.0, pose_ms = 0.0;
+    size_t tags = 0;
+    size_t i = 0;
+    for (auto _ : state) {
+        auto results = detector.detect(corpus.grayFrame(i++), corpus.camera_matrix,
+                                       corpus.dist_coeffs, benchTagSize());
+        benchmark::DoNotOptimize(results);
+
+        const auto& timings = detector.getLastTimings();
+        decode_ms += toMs(timings.decode);
+        pose_ms += toMs(timings.pose);
+        tags += results.size();
+    }
+
+    state.SetItemsProcessed(state.iterations());
+    state.counters["decode_ms"] = benchmark::Counter(decode_ms, benchmark::Counter::kAvgIterations);
+    state.counters["pose_ms"] = benchmark::Counter(pose_ms, benchmark::Counter::kAvgIterations);
+    // Fewer tags at higher decimation is a recall regression, not a speedup
+    state.counters["tags"] = benchmark::Counter(static_cast<double>(tags), benchmark::Counter::kAvgIterations);
+}
+
+// ROI tracking between full scans; range(0) = rescan interval
+void BM_AprilTagDetectTracking(benchmark::State& state) {
+    const auto& corpus = BenchCorpus::get();
+    AprilTagDetector detector;
+    detector.setTrackingMode(true, static_cast<int>(state.range(0)));
+
+    size_t tags = 0;
+    size_t i = 0;
+    for (auto _ : state) {
+        auto results = detector.detect(corpus.grayFrame(i++), corpus.camera_matrix,
+                                       corpus.dist_coeffs, benchTagSize());
+        benchmark::DoNotOptimize(results);
+        tags += results.size();
+    }
+
+    state.SetItemsProcessed(state.iterations());
+    state.counters["tags"] = benchmark::Counter(static_cast<double>(tags), benchmark::Counter::kAvgIterations);
+    state.counters["roi_scan_ratio"] = static_cast<double>(detector.getRoiScanCount()) /
+        static_cast<double>(std::max<uint64_t>(1, detector.getRoiScanCount() + detector.getFullScanCount()));
+}
+
+} // namespace
+
+BENCHMARK(BM_AprilTagDetect)
+    ->ArgsProduct({{1, 2, 3, 4}, {1, 4}})
+    ->ArgNames({"decimate", "threads"})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+BENCHMARK(BM_AprilTagDetectTracking)
+    ->Arg(10)->Arg(30)
+    ->ArgName("rescan")
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
@@ -0,0 +1,173 @@
+#include "bench_corpus.hpp"
+#include "camera_calibration.hpp"
+#include "undistortion_lut.hpp"
+
+#include <apriltag/apriltag.h>
+#include <apriltag/tag36h11.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+
+namespace navign::robot::vision::bench {
+
+namespace {
+
+constexpr size_t kDefaultFrameLimit = 300;
+constexpr double kDefaultTagSize = 0.16;
+
+size_t frameLimit() {
+    const char* limit = std::getenv("NAVIGN_BENCH_FRAMES");
+    const long value = limit ? std::atol(limit) : 0;
+    return value > 0 ? static_cast<size_t>(value) : kDefaultFrameLimit;
+}
+
+void loadDirectory(const std::filesystem::path& directory, size_t limit, std::vector<cv::Mat>& frames) {
+    std::vector<std::filesystem::path> paths;
+    for (const auto& entry : std::filesystem::directory_iterator(directory)) {
+        std::string extension = entry.path().extension().string();
+        std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+        if (extension == ".png" || extension == ".jpg" || extension == ".jpeg" || extension == ".bmp") {
+            paths.push_back(entry.path());
+        }
+    }
+    std::sort(paths.begin(), paths.end());
+
+    for (const auto& path : paths) {
+        if (frames.size() >= limit) {
+            break;
+        }
+        cv::Mat image = cv::imread(path.string(), cv::IMREAD_COLOR);
+        if (!image.empty()) {
+            frames.push_back(std::move(image));
+        }
+    }
+}
+
+void loadVideo(const std::string& path, size_t limit, std::vector<cv::Mat>& frames) {
+    cv::VideoCapture video(path);
+    cv::Mat image;
+    while (frames.size() < limit && video.read(image)) {
+        frames.push_back(image.clone());
+    }
+}
+
+/**
+ * @brief Noise background with tag36h11 tags at several scales
+ */
+cv::Mat syntheticFrame() {
+    cv::Mat gray(480, 640, CV_8UC1);
+    cv::RNG rng(42);
+    rng.fill(gray, cv::RNG::UNIFORM, 64, 192);
+
+    apriltag_family_t* family = tag36h11_create();
+    const struct { int id; int x; int y; int size; } placements[] = {
+        {0, 40, 40, 160}, {1, 260, 60, 100}, {2, 420, 220, 60}, {3, 120, 300, 120},
+    };
+    for (const auto& placement : placements) {
+        image_u8_t* tag = apriltag_to_image(family, placement.id);
+        const cv::Mat tag_image(tag->height, tag->width, CV_8UC1, tag->buf, tag->stride);
+        cv::Mat roi = gray(cv::Rect(placement.x, placement.y, placement.size, placement.size));
+        cv::resize(tag_image, roi, roi.size(), 0, 0, cv::INTER_NEAREST);
+        image_u8_destroy(tag);
+    }
+    tag36h11_destroy(family);
+
+    cv::Mat frame;
+    cv::cvtColor(gray, frame, cv::COLOR_GRAY2BGR);
+    return frame;
+}
+
+BenchCorpus loadCorpus() {
+    BenchCorpus corpus;
+    const size_t limit = frameLimit();
+
+    if (const char* path = std::getenv("NAVIGN_BENCH_CORPUS")) {
+        corpus.source = path;
+        if (std::filesystem::is_directory(path)) {
+            loadDirectory(path, limit, corpus.frames);
+        } else {
+            loadVideo(path, limit, corpus.frames);
+        }
+        if (corpus.frames.empty()) {
+            std::cerr << "No frames in corpus " << path << ", using the synthetic frame" << std::endl;
+        }
+    } else if (const char* image_path = std::getenv("NAVIGN_BENCH_IMAGE")) {
+        corpus.source = image_path;
+        cv::Mat image = cv::imread(image_path, cv::IMREAD_COLOR);
+        if (!image.empty()) {
+            corpus.frames.push_back(std::move(image));
+        }
+    }
+
+    if (corpus.frames.empty()) {
+        corpus.source = "synthetic";
+        corpus.frames.push_back(syntheticFrame());
+    }
+
+    corpus.gray.resize(corpus.frames.size());
+    for (size_t i = 0; i < corpus.frames.size(); i++) {
+        cv::cvtColor(corpus.frames[i], corpus.gray[i], cv::COLOR_BGR2GRAY);
+    }
+
+    CameraCalibration calibration;
+    const char* calibration_file = std::getenv("NAVIGN_BENCH_CALIBRATION");
+    if (calibration_file && calibration.load(calibration_file)) {
+        corpus.camera_matrix = calibration.getCalibration().camera_matrix.clone();
+        corpus.dist_coeffs = calibration.getCalibration().dist_coeffs.clone();
+        corpus.calibrated = true;
+    } else {
+        // Nominal ~60 degree horizontal field of view, no distortion
+        const cv::Size size = corpus.frames.front().size();
+        const double focal = 0.87 * size.width;
+        corpus.camera_matrix = (cv::Mat_<double>(3, 3) <<
+            focal, 0, size.width / 2.0,
+            0, focal, size.height / 2.0,
+            0, 0, 1);
+        corpus.dist_coeffs = cv::Mat::zeros(1, 5, CV_64F);
+    }
+
+    return corpus;
+}
+
+} // namespace
+
+const BenchCorpus& BenchCorpus::get() {
+    static const BenchCorpus corpus = loadCorpus();
+    return corpus;
+}
+
+std::string benchModelPath() {
+    const char* path = std::getenv("NAVIGN_BENCH_MODEL");
+    return path ? path : "yolov8n.onnx";
+}
+
+double benchTagSize() {
+    const char* size = std::getenv("NAVIGN_BENCH_TAG_SIZE");
+    const double value = size ? std::atof(size) : 0.0;
+    return value > 0.0 ? value : kDefaultTagSize;
+}
+
+CoordinateTransform benchTransform(bool use_lut) {
+    const auto& corpus = BenchCorpus::get();
+    CoordinateTransform transform;
+    transform.setCalibration(corpus.camera_matrix, corpus.dist_coeffs);
+    if (use_lut) {
+        transform.setUndistortionLut(
+            UndistortionLut::build(corpus.camera_matrix, corpus.dist_coeffs, corpus.frameSize()));
+    }
+
+    // Columns are the camera axes in the world (z up): x right, y down, z forward
+    const double pitch = 30.0 * CV_PI / 180.0;
+    const cv::Matx33d rotation(
+        1, 0, 0,
+        0, -std::sin(pitch), std::cos(pitch),
+        0, -std::cos(pitch), -std::sin(pitch));
+    transform.setCameraPose(cv::Mat(rotation), cv::Mat(cv::Vec3d(0.0, 0.0, 1.2)));
+    return transform;
+}
+
+} // namespace navign::robot::vision::bench
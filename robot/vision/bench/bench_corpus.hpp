@@ -0,0 +1,56 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <opencv2/opencv.hpp>
+
+#include "coordinate_transform.hpp"
+
+namespace navign::robot::vision::bench {
+
+/**
+ * @brief Frames and calibration shared by every benchmark
+ *
+ * Loaded once from the environment so the same binary runs against recorded
+ * camera data:
+ *
+ *   NAVIGN_BENCH_CORPUS       Directory of frames (PNG/JPG, sorted by name) or a video file
+ *   NAVIGN_BENCH_IMAGE        Single frame, used when no corpus is given
+ *   NAVIGN_BENCH_FRAMES       Frames kept in memory (default: 300)
+ *   NAVIGN_BENCH_CALIBRATION  Calibration file of the recording camera
+ *   NAVIGN_BENCH_MODEL        YOLO model (default: yolov8n.onnx)
+ *   NAVIGN_BENCH_TAG_SIZE     AprilTag edge length in meters (default: 0.16)
+ *
+ * Without a corpus a deterministic 640x480 frame with rendered tag36h11
+ * tags over noise is used, so AprilTag benchmarks still decode tags.
+ */
+struct BenchCorpus {
+    std::string source;           // Corpus path or "synthetic"
+    std::vector<cv::Mat> frames;  // BGR, all decoded up front
+    std::vector<cv::Mat> gray;
+
+    // Intrinsics of the recording camera (a nominal pinhole if not given)
+    cv::Mat camera_matrix;
+    cv::Mat dist_coeffs;
+    bool calibrated = false;
+
+    /**
+     * @brief The process-wide corpus, loaded on first use
+     */
+    static const BenchCorpus& get();
+
+    // Frames cycle so benchmarks can iterate past the end of the corpus
+    const cv::Mat& frame(size_t i) const { return frames[i % frames.size()]; }
+    const cv::Mat& grayFrame(size_t i) const { return gray[i % gray.size()]; }
+    cv::Size frameSize() const { return frames.front().size(); }
+};
+
+std::string benchModelPath();
+double benchTagSize();
+
+/**
+ * @brief Corpus intrinsics, camera 1.2 m above the floor (z = 0) pitched 30 degrees down
+ */
+CoordinateTransform benchTransform(bool use_lut);
+
+} // namespace navign::robot::vision::bench
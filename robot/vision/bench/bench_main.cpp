@@ -0,0 +1,31 @@
+#include "bench_corpus.hpp"
+
+#include <benchmark/benchmark.h>
+#include <string>
+
+using navign::robot::vision::bench::BenchCorpus;
+using navign::robot::vision::bench::benchModelPath;
+
+// BENCHMARK_MAIN plus the corpus and build in the report context, so JSON
+// results (--benchmark_out=run.json --benchmark_out_format=json) can be
+// compared across releases knowing what they were measured on
+int main(int argc, char** argv) {
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+        return 1;
+    }
+
+    const auto& corpus = BenchCorpus::get();
+    const cv::Size size = corpus.frameSize();
+    benchmark::AddCustomContext("navign_version", NAVIGN_VISION_VERSION);
+    benchmark::AddCustomContext("corpus", corpus.source);
+    benchmark::AddCustomContext("corpus_frames", std::to_string(corpus.frames.size()));
+    benchmark::AddCustomContext("frame_size", std::to_string(size.width) + "x" + std::to_string(size.height));
+    benchmark::AddCustomContext("calibrated", corpus.calibrated ? "true" : "false");
+    benchmark::AddCustomContext("model", benchModelPath());
+    benchmark::AddCustomContext("opencv", CV_VERSION);
+
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
@@ -0,0 +1,58 @@
+#include "bench_corpus.hpp"
+#include "coordinate_transform.hpp"
+
+#include <benchmark/benchmark.h>
+#include <vector>
+
+using navign::robot::vision::CoordinateTransform;
+using navign::robot::vision::bench::BenchCorpus;
+using navign::robot::vision::bench::benchTransform;
+
+namespace {
+
+// Lower half of the image, where foot points of floor objects land
+std::vector<cv::Point2f> imagePoints(size_t count) {
+    const cv::Size size = BenchCorpus::get().frameSize();
+    std::vector<cv::Point2f> points(count);
+    cv::RNG rng(3);
+    for (auto& point : points) {
+        point = cv::Point2f(rng.uniform(0.0f, static_cast<float>(size.width - 1)),
+                            rng.uniform(size.height * 0.55f, static_cast<float>(size.height - 1)));
+    }
+    return points;
+}
+
+// Batched unprojection onto z = 0; range(0) = points per call
+void BM_ImageToWorldBatch(benchmark::State& state, bool use_lut) {
+    const CoordinateTransform transform = benchTransform(use_lut);
+    const auto image_points = imagePoints(static_cast<size_t>(state.range(0)));
+    std::vector<cv::Point3d> world_points(image_points.size());
+
+    for (auto _ : state) {
+        const size_t valid = transform.imageToWorld(image_points, world_points, 0.0);
+        benchmark::DoNotOptimize(valid);
+        benchmark::DoNotOptimize(world_points.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+// Batched projection of floor points back into the image
+void BM_WorldToImageBatch(benchmark::State& state) {
+    const CoordinateTransform transform = benchTransform(false);
+    const auto image_points = imagePoints(static_cast<size_t>(state.range(0)));
+    std::vector<cv::Point3d> world_points(image_points.size());
+    transform.imageToWorld(image_points, world_points, 0.0);
+    std::vector<cv::Point2f> projected(world_points.size());
+
+    for (auto _ : state) {
+        transform.worldToImage(world_points, projected);
+        benchmark::DoNotOptimize(projected.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+} // namespace
+
+BENCHMARK_CAPTURE(BM_ImageToWorldBatch, iterative, false)->Arg(16)->Arg(256)->Arg(4096);
+BENCHMARK_CAPTURE(BM_ImageToWorldBatch, lut, true)->Arg(16)->Arg(256)->Arg(4096);
+BENCHMARK(BM_WorldToImageBatch)->Arg(16)->Arg(256)->Arg(4096);
@@ -0,0 +1,236 @@
+#include "bench_corpus.hpp"
+#include "letterbox.hpp"
+#include "object_detector.hpp"
+#include "yolo_postprocess.hpp"
+
+#include <benchmark/benchmark.h>
+#include <chrono>
+#include <vector>
+
+using navign::robot::vision::DnnTarget;
+using navign::robot::vision::InferenceBackend;
+using navign::robot::vision::LetterboxPreprocessor;
+using navign::robot::vision::NmsMode;
+using navign::robot::vision::ObjectDetector;
+using navign::robot::vision::YoloPostprocessor;
+using navign::robot::vision::bench::BenchCorpus;
+using navign::robot::vision::bench::benchModelPath;
+
+namespace {
+
+double toMs(std::chrono::nanoseconds duration) {
+    return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+// Per-frame detect() over the corpus; stage split reported as counters
+void BM_ObjectDetectorDetect(benchmark::State& state, InferenceBackend backend, DnnTarget target) {
+    const auto& corpus = BenchCorpus::get();
+    ObjectDetector detector;
+    detector.setBackend(backend);
+    detector.setDnnTarget(target);
+    if (!detector.loadModel(benchModelPath())) {
+        state.SkipWithError("model not available for this backend");
+        return;
+    }
+    if (target == DnnTarget::OpenCL && !detector.usesDeviceInput()) {
+        state.SkipWithError("no OpenCL device");
+        return;
+    }
+
+    // Warm up lazy allocations and kernel selection
+    detector.detect(corpus.frame(0));
+
+    double preprocess_ms = 0.0, inference_ms = 0.0, postprocess_ms = 0.0;
+    size_t objects_found = 0;
+    size_t i = 0;
+    for (auto _ : state) {
+        auto objects = detector.detect(corpus.frame(i++));
+        benchmark::DoNotOptimize(objects);
+
+        const auto& timings = detector.getLastTimings();
+        preprocess_ms += toMs(timings.preprocess);
+        inference_ms += toMs(timings.inference);
+        postprocess_ms += toMs(timings.postprocess);
+        objects_found += objects.size();
+    }
+
+    state.SetItemsProcessed(state.iterations());
+    state.counters["preprocess_ms"] = benchmark::Counter(preprocess_ms, benchmark::Counter::kAvgIterations);
+    state.counters["inference_ms"] = benchmark::Counter(inference_ms, benchmark::Counter::kAvgIterations);
+    state.counters["postprocess_ms"] = benchmark::Counter(postprocess_ms, benchmark::Counter::kAvgIterations);
+    state.counters["objects"] = benchmark::Counter(static_cast<double>(objects_found),
+                                                   benchmark::Counter::kAvgIterations);
+}
+
+// One detectBatch() pass over state.range(0) frames; items are frames
+void BM_ObjectDetectorDetectBatch(benchmark::State& state, InferenceBackend backend) {
+    const auto& corpus = BenchCorpus::get();
+    ObjectDetector detector;
+    detector.setBackend(backend);
+    if (!detector.loadModel(benchModelPath())) {
+        state.SkipWithError("model not available for this backend");
+        return;
+    }
+
+    std::vector<cv::Mat> frames;
+    for (int64_t b = 0; b < state.range(0); b++) {
+        frames.push_back(corpus.frame(static_cast<size_t>(b)));
+    }
+    detector.detectBatch(frames);
+
+    for (auto _ : state) {
+        auto objects = detector.detectBatch(frames);
+        benchmark::DoNotOptimize(objects);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+/**
+ * @brief Capture-side gray conversion plus detect(), as the service runs them
+ *
+ * The CPU path converts gray on the host and letterboxes on the host. The
+ * OpenCL path uploads the frame once, converts gray on the device and reads
+ * it back for AprilTag, and hands the device copy to detect(). The
+ * difference between the two is what the transfers cost or save on this
+ * machine. gray_ms covers the upload and read-back on the OpenCL path.
+ */
+void BM_FrameToObjects(benchmark::State& state, DnnTarget target) {
+    const auto& corpus = BenchCorpus::get();
+    ObjectDetector detector;
+    detector.setBackend(InferenceBackend::OpenCvDnn);
+    detector.setDnnTarget(target);
+    if (!detector.loadModel(benchModelPath())) {
+        state.SkipWithError("model not available");
+        return;
+    }
+    const bool device = detector.usesDeviceInput();
+    if (target == DnnTarget::OpenCL && !device) {
+        state.SkipWithError("no OpenCL device");
+        return;
+    }
+
+    cv::Mat gray;
+    cv::UMat device_image, device_gray;
+    detector.detect(corpus.frame(0));
+
+    double gray_ms = 0.0;
+    size_t i = 0;
+    for (auto _ : state) {
+        const cv::Mat& frame = corpus.frame(i++);
+        const auto gray_start = std::chrono::steady_clock::now();
+        if (device) {
+            frame.copyTo(device_image);
+            cv::cvtColor(device_image, device_gray, cv::COLOR_BGR2GRAY);
+            device_gray.copyTo(gray);
+        } else {
+            cv::cvtColor(frame, gray, cv::COLOR_BGR2GRAY);
+        }
+        gray_ms += toMs(std::chrono::steady_clock::now() - gray_start);
+        benchmark::DoNotOptimize(gray.data);
+
+        auto objects = detector.detect(frame, 0.5f, 0.4f, device_image);
+        benchmark::DoNotOptimize(objects);
+    }
+
+    state.SetItemsProcessed(state.iterations());
+    state.counters["gray_ms"] = benchmark::Counter(gray_ms, benchmark::Counter::kAvgIterations);
+}
+
+// Letterbox + BGR->RGB CHW float conversion alone, into a 640x640 input
+void BM_LetterboxPreprocess(benchmark::State& state) {
+    const auto& corpus = BenchCorpus::get();
+    const cv::Size input(640, 640);
+    std::vector<float> tensor(3 * input.area());
+    LetterboxPreprocessor preprocessor;
+
+    size_t i = 0;
+    for (auto _ : state) {
+        auto transform = preprocessor.apply(corpus.frame(i++), input, tensor.data());
+        benchmark::DoNotOptimize(transform);
+        benchmark::DoNotOptimize(tensor.data());
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(corpus.frame(0).total() * 3));
+}
+
+/**
+ * @brief Synthetic YOLOv8 head [1, 84, 8400]: low scores with a few hot anchors
+ */
+cv::Mat syntheticHead(int hot_anchors) {
+    constexpr int kChannels = 84;
+    constexpr int kAnchors = 8400;
+    const int sizes[] = {1, kChannels, kAnchors};
+    cv::Mat head(3, sizes, CV_32F);
+    cv::Mat rows(kChannels, kAnchors, CV_32F, head.ptr<float>());
+
+    cv::RNG rng(7);
+    rng.fill(rows.rowRange(0, 2), cv::RNG::UNIFORM, 0.0f, 640.0f);
+    rng.fill(rows.rowRange(2, 4), cv::RNG::UNIFORM, 10.0f, 120.0f);
+    rng.fill(rows.rowRange(4, kChannels), cv::RNG::UNIFORM, 0.0f, 0.05f);
+
+    // A few confident candidates among thousands of background anchors
+    for (int k = 0; k < hot_anchors; k++) {
+        const int anchor = rng.uniform(0, kAnchors);
+        const int cls = 4 + rng.uniform(0, kChannels - 4);
+        rows.at<float>(cls, anchor) = rng.uniform(0.5f, 0.95f);
+    }
+    return head;
+}
+
+// decode() + suppress(); range(0) = candidates above threshold
+void BM_YoloPostprocess(benchmark::State& state, NmsMode mode) {
+    const cv::Mat head = syntheticHead(static_cast<int>(state.range(0)));
+    YoloPostprocessor postprocessor;
+
+    for (auto _ : state) {
+        postprocessor.decode(head, 0.25f);
+        const auto& keep = postprocessor.suppress(0.25f, 0.45f, mode);
+        benchmark::DoNotOptimize(keep.data());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+} // namespace
+
+BENCHMARK_CAPTURE(BM_ObjectDetectorDetect, opencv_dnn, InferenceBackend::OpenCvDnn, DnnTarget::CPU)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+BENCHMARK_CAPTURE(BM_ObjectDetectorDetect, opencv_dnn_opencl, InferenceBackend::OpenCvDnn, DnnTarget::OpenCL)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+BENCHMARK_CAPTURE(BM_ObjectDetectorDetectBatch, opencv_dnn, InferenceBackend::OpenCvDnn)
+    ->Arg(1)->Arg(2)->Arg(4)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+#ifdef USE_ONNXRUNTIME
+BENCHMARK_CAPTURE(BM_ObjectDetectorDetect, onnxruntime, InferenceBackend::OnnxRuntime, DnnTarget::CPU)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+BENCHMARK_CAPTURE(BM_ObjectDetectorDetectBatch, onnxruntime, InferenceBackend::OnnxRuntime)
+    ->Arg(1)->Arg(2)->Arg(4)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+#endif
+
+BENCHMARK_CAPTURE(BM_FrameToObjects, cpu, DnnTarget::CPU)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+BENCHMARK_CAPTURE(BM_FrameToObjects, opencl, DnnTarget::OpenCL)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+BENCHMARK(BM_LetterboxPreprocess)->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_CAPTURE(BM_YoloPostprocess, agnostic, NmsMode::Agnostic)
+    ->Arg(10)->Arg(200)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_YoloPostprocess, class_aware, NmsMode::ClassAware)
+    ->Arg(10)->Arg(200)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_YoloPostprocess, batched, NmsMode::Batched)
+    ->Arg(10)->Arg(200)
+    ->Unit(benchmark::kMicrosecond);
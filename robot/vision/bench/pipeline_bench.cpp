@@ -0,0 +1,98 @@
+#include "apriltag_detector.hpp"
+#include "bench_corpus.hpp"
+#include "coordinate_transform.hpp"
+#include "object_detector.hpp"
+#include "object_tracker.hpp"
+
+#include <benchmark/benchmark.h>
+#include <chrono>
+#include <cmath>
+#include <vector>
+
+using navign::robot::vision::AprilTagDetector;
+using navign::robot::vision::CoordinateTransform;
+using navign::robot::vision::ObjectDetector;
+using navign::robot::vision::ObjectTracker;
+using navign::robot::vision::bench::BenchCorpus;
+using navign::robot::vision::bench::benchModelPath;
+using navign::robot::vision::bench::benchTagSize;
+using navign::robot::vision::bench::benchTransform;
+
+namespace {
+
+/**
+ * @brief Every per-frame stage of the service on one thread
+ *
+ * Grayscale, AprilTag detection with pose, YOLO, ground projection of the
+ * box foot points and tracking, in pipeline order. Each benchmark thread
+ * owns its components like a service worker does, so ->Threads(n) shows
+ * how throughput scales with workers. Without a model only the AprilTag
+ * half runs (labelled "tags only").
+ */
+void BM_PipelineFrame(benchmark::State& state) {
+    const auto& corpus = BenchCorpus::get();
+
+    AprilTagDetector tag_detector;
+    tag_detector.setNumThreads(1);
+#ifdef USE_OBJECT_DETECTION
+    ObjectDetector object_detector;
+    const bool with_objects = object_detector.loadModel(benchModelPath());
+#else
+    constexpr bool with_objects = false;
+#endif
+    if (!with_objects) {
+        state.SetLabel("tags only");
+    }
+
+    const CoordinateTransform transform = benchTransform(true);
+    ObjectTracker tracker;
+
+    cv::Mat gray;
+    std::vector<cv::Point2f> foot_points;
+    std::vector<cv::Point3d> world_points;
+    auto timestamp = ObjectTracker::Clock::now();
+    const auto frame_interval = std::chrono::milliseconds(33);
+
+    // Threads start at different frames of the corpus
+    size_t i = static_cast<size_t>(state.thread_index()) * 17;
+    for (auto _ : state) {
+        const cv::Mat& frame = corpus.frame(i++);
+        cv::cvtColor(frame, gray, cv::COLOR_BGR2GRAY);
+
+        auto tags = tag_detector.detect(gray, corpus.camera_matrix, corpus.dist_coeffs, benchTagSize());
+        benchmark::DoNotOptimize(tags);
+
+#ifdef USE_OBJECT_DETECTION
+        if (with_objects) {
+            auto objects = object_detector.detect(frame, 0.1f, 0.4f);
+
+            foot_points.resize(objects.size());
+            world_points.resize(objects.size());
+            for (size_t k = 0; k < objects.size(); k++) {
+                const cv::Rect& box = objects[k].bbox;
+                foot_points[k] = cv::Point2f(box.x + box.width * 0.5f, static_cast<float>(box.y + box.height));
+            }
+            transform.imageToWorld(foot_points, world_points, 0.0);
+            for (size_t k = 0; k < objects.size(); k++) {
+                if (!std::isnan(world_points[k].x)) {
+                    objects[k].has_3d = true;
+                    objects[k].world_position = world_points[k];
+                }
+            }
+
+            timestamp += frame_interval;
+            tracker.update(objects, timestamp);
+            benchmark::DoNotOptimize(objects);
+        }
+#endif
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+
+} // namespace
+
+BENCHMARK(BM_PipelineFrame)
+    ->Threads(1)->Threads(2)->Threads(4)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstdint>
+
+namespace navign::robot::vision {
+
+/**
+ * @brief AprilTag detector parameters chosen by the controller
+ */
+struct AprilTagTuning {
+    float quad_decimate = 2.0f;
+    int nthreads = 4;
+    bool refine_edges = true;
+};
+
+/**
+ * @brief Snapshot of controller decisions and inputs, for metrics
+ */
+struct AprilTagControllerState {
+    AprilTagTuning tuning;
+    double latency_ms = 0.0;       // Smoothed full-frame detection latency
+    double budget_ms = 0.0;        // Per-frame deadline derived from target FPS
+    double smallest_tag_px = 0.0;  // Smallest recent tag side, 0 if none seen
+    float max_decimate = 0.0f;     // Decimation ceiling imposed by tag size
+    uint64_t deadline_misses = 0;
+    uint64_t adjustments = 0;
+};
+
+/**
+ * @brief Closed-loop controller for quad_decimate, nthreads and refine_edges
+ *
+ * Each frame it is fed the measured detection latency and the smallest
+ * apparent tag size. When tags get small (far away) decimation is lowered
+ * so they stay detectable; when the frame deadline is missed it first adds
+ * threads, then raises decimation, then drops edge refinement. With ample
+ * headroom it steps back towards the most accurate settings. Changes are
+ * rate-limited so the detector does not oscillate.
+ */
+class AprilTagController {
+public:
+    AprilTagController();
+
+    /**
+     * @brief Configure the frame deadline and thread ceiling
+     * @param target_fps Target frame rate (from VisionService::setFrameRate)
+     * @param max_threads Upper bound for nthreads (0 = hardware concurrency)
+     */
+    void configure(double target_fps, int max_threads = 0);
+
+    /**
+     * @brief Feed one frame's measurements
+     * @param latency_ms Full-frame detection latency
+     * @param smallest_tag_px Smallest tag side in pixels this frame (0 if none)
+     * @return Tuning to apply for the next frame
+     */
+    const AprilTagTuning& update(double latency_ms, double smallest_tag_px);
+
+    const AprilTagControllerState& state() const { return state_; }
+
+    void reset(const AprilTagTuning& tuning);
+
+private:
+    AprilTagControllerState state_;
+    int max_threads_ = 4;
+    int decimate_index_ = 0;
+    int cooldown_frames_ = 0;
+    int frames_since_tag_ = 0;
+
+    // Raise decimation when over budget, subject to the tag-size ceiling
+    bool stepFaster();
+    // Move towards the most accurate settings when there is headroom
+    bool stepMoreAccurate();
+};
+
+} // namespace navign::robot::vision
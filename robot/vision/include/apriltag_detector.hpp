@@ -1,28 +1,86 @@
 #pragma once
 
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <unordered_map>
 #include <vector>
 #include <opencv2/opencv.hpp>
 #include <apriltag/apriltag.h>
-#include <apriltag/tag36h11.h>
 #include <apriltag/apriltag_pose.h>
 
+#include "apriltag_controller.hpp"
+#include "apriltag_filter.hpp"
+#include "apriltag_pose_method.hpp"
+
 namespace navign::robot::vision {
 
 /**
  * @brief Result of AprilTag detection
+ *
+ * Fixed-size members only, so results can be produced without touching
+ * the heap.
  */
 struct AprilTagResult {
     uint32_t tag_id;
     cv::Point2d center;
-    std::vector<cv::Point2d> corners;  // 4 corners
+    std::array<cv::Point2d, 4> corners;
     double decision_margin;
     int hamming_distance;
 
-    // Pose estimation (if calibration available)
+    // Pose estimation (if calibration available), tag to camera frame
     bool pose_valid = false;
-    cv::Mat rotation;     // 3x3 rotation matrix
-    cv::Mat translation;  // 3x1 translation vector
-    cv::Point3d position; // Tag position in world coordinates
+    cv::Matx33d rotation = cv::Matx33d::eye();
+    cv::Vec3d translation{0.0, 0.0, 0.0};
+    cv::Point3d position;     // Tag position in camera coordinates
+    double pose_error = 0.0;  // Object-space error (orthogonal iteration only)
+};
+
+
+/**
+ * @brief ROI tracking state of one image stream
+ *
+ * Owned by whoever owns the stream, so every detector that sees the
+ * stream's frames shares it. Frames may be detected by several detectors
+ * at once and finish in any order: the scan kind (full or ROI) is claimed
+ * per frame when detection starts, so rescans are counted once per stream,
+ * and results only update the tracks when they come from a newer frame
+ * than the last applied one. Velocities are per frame of the stream, so
+ * predictions scale with the actual frame gap. Thread-safe.
+ */
+class AprilTagTrackState {
+public:
+    /**
+     * @brief Forget all tracks; the next frame gets a full scan
+     */
+    void reset();
+
+private:
+    friend class AprilTagDetector;
+
+    // Tag seen in an earlier frame, used to predict the next search region
+    struct TagTrack {
+        uint32_t tag_id;
+        cv::Rect2d bounds;
+        cv::Point2d velocity;  // Pixels per stream frame
+    };
+
+    std::mutex mutex_;
+    std::vector<TagTrack> tracks_;
+    uint64_t last_frame_ = 0;  // Frame the tracks were updated from
+    bool has_frame_ = false;
+    int frames_since_rescan_ = 0;
+    bool track_lost_ = false;
+};
+
+/**
+ * @brief Stage durations of the most recent detect() call
+ */
+struct AprilTagTimings {
+    std::chrono::nanoseconds decode{0};  // Quad detection and decoding
+    std::chrono::nanoseconds pose{0};    // Pose estimation over all tags
 };
 
 /**
@@ -35,16 +93,54 @@ public:
 
     /**
      * @brief Detect AprilTags in an image
-     * @param image Input image (grayscale or BGR)
+     * @param image Input image (grayscale or BGR). Grayscale input is used in
+     *              place without copying; it must be 8-bit single channel.
      * @param camera_matrix Camera intrinsic matrix (3x3) for pose estimation
      * @param dist_coeffs Distortion coefficients (optional)
      * @param tag_size Physical tag size in meters (for pose estimation)
+     * @param stream_id Image stream (camera) the frame belongs to; tracking
+     *                  state is kept separately per stream
      * @return Vector of detected tags
      */
     std::vector<AprilTagResult> detect(
         const cv::Mat& image,
         const cv::Mat& camera_matrix = cv::Mat(),
         const cv::Mat& dist_coeffs = cv::Mat(),
+        double tag_size = 0.015,
+        uint32_t stream_id = 0
+    );
+
+    /**
+     * @brief Detect AprilTags into a caller-owned vector
+     *
+     * results is cleared first and keeps its capacity, so a reused vector
+     * makes steady-state detection allocation-free.
+     */
+    void detect(
+        const cv::Mat& image,
+        std::vector<AprilTagResult>& results,
+        const cv::Mat& camera_matrix = cv::Mat(),
+        const cv::Mat& dist_coeffs = cv::Mat(),
+        double tag_size = 0.015,
+        uint32_t stream_id = 0
+    );
+
+    /**
+     * @brief Detect AprilTags in one frame of a stream with shared tracking state
+     *
+     * Use this whenever several detectors handle frames of the same stream;
+     * the stream_id overloads keep state inside this detector instead.
+     *
+     * @param tracks Tracking state of the frame's stream
+     * @param frame_id Sequence number of the frame within its stream
+     */
+    void detect(
+        const cv::Mat& image,
+        std::vector<AprilTagResult>& results,
+        AprilTagTrackState& tracks,
+        uint64_t frame_id,
+        const cv::Mat& camera_matrix = cv::Mat(),
+        const cv::Mat& dist_coeffs = cv::Mat(),
         double tag_size = 0.015
     );
 
@@ -57,18 +153,156 @@ public:
     void setRefineEdges(bool refine);
     void setDecodeSharpening(double sharpening);
 
+    /**
+     * @brief Select the pose estimation method (default: orthogonal iteration)
+     *
+     * Poses of one frame are estimated in parallel on the detector's
+     * worker pool (nthreads).
+     */
+    void setPoseMethod(AprilTagPoseMethod method) { pose_method_ = method; }
+
+    /**
+     * @brief Select the tag family by name (default: tag36h11)
+     * @return false if the family is unknown; the current family is kept
+     */
+    bool setTagFamily(const std::string& name);
+    const std::string& getTagFamily() const { return family_name_; }
+
+    /**
+     * @brief Reject candidates before they reach pose estimation
+     *
+     * max_hamming also sizes the decoder's lookup table, so lower values
+     * decode faster and use less memory. With prune_family, the family is
+     * reduced to the whitelisted codes: other codes are never matched, and
+     * the lookup table shrinks with the deployment.
+     */
+    void setFilter(const AprilTagFilter& filter, bool prune_family = false);
+
+    /**
+     * @brief Candidates rejected by the filter (safe to read from other threads)
+     */
+    uint64_t getRejectedCount() const { return rejected_; }
+
+    /**
+     * @brief Enable region-of-interest tracking between frames
+     *
+     * When enabled, tags found in the previous frame are searched for only
+     * inside a crop predicted from their last corners, decoded at full
+     * resolution. A full-frame scan still runs every rescan_interval frames
+     * and whenever a tracked tag is lost, so new tags are picked up.
+     *
+     * @param enabled Enable tracking mode
+     * @param rescan_interval Frames between forced full-frame scans
+     */
+    void setTrackingMode(bool enabled, int rescan_interval = 10);
+
+    /**
+     * @brief Enable closed-loop tuning of quad_decimate, nthreads and refine_edges
+     *
+     * Full-frame scans feed their latency and smallest tag size into an
+     * AprilTagController, whose decisions apply from the next frame.
+     * Manual setters still work but are overridden while enabled.
+     *
+     * @param enabled Enable adaptive control
+     * @param target_fps Frame rate whose period is the detection deadline
+     */
+    void setAdaptiveControl(bool enabled, double target_fps = 30.0);
+
+    /**
+     * @brief Latest controller decisions (safe to read from other threads)
+     */
+    AprilTagControllerState getControllerState() const;
+
+    /**
+     * @brief Tracking statistics (safe to read from other threads)
+     */
+    uint64_t getFullScanCount() const { return full_scans_; }
+    uint64_t getRoiScanCount() const { return roi_scans_; }
+
+    /**
+     * @brief Stage durations of the last detect() (read on the detecting thread)
+     */
+    const AprilTagTimings& getLastTimings() const { return last_timings_; }
+
 private:
     apriltag_detector_t* detector_ = nullptr;
     apriltag_family_t* tag_family_ = nullptr;
+    void (*family_destroy_)(apriltag_family_t*) = nullptr;
+    std::string family_name_;
 
-    // Estimate pose for a single tag
-    bool estimatePose(
-        zarray_t* detections,
-        int idx,
-        const cv::Mat& camera_matrix,
-        double tag_size,
-        AprilTagResult& result
-    );
+    // Candidate filtering
+    AprilTagFilter filter_;
+    bool prune_family_ = false;
+    std::vector<bool> allowed_ids_;  // Indexed by tag ID; empty accepts all
+    std::atomic<uint64_t> rejected_{0};
+
+    // Family reduced to the whitelisted codes; its IDs index subset_ids_
+    apriltag_family_t subset_family_{};
+    std::vector<uint64_t> subset_codes_;
+    std::vector<uint32_t> subset_ids_;
+
+    // Register the (possibly pruned) family with the current filter
+    void rebuildFamily();
+
+    // Map a pruned-family ID back and apply the filter
+    bool acceptDetection(apriltag_detection_t* det);
+
+    // Reused conversion buffer for BGR input
+    cv::Mat gray_buffer_;
+
+    AprilTagTimings last_timings_;
+
+    // apriltag_detector_detect(), accumulating into last_timings_.decode
+    zarray_t* detectTimed(image_u8_t* im);
+
+    // State of the streams detected through the stream_id overloads
+    struct StreamTracks {
+        AprilTagTrackState state;
+        uint64_t frames = 0;
+    };
+
+    bool tracking_enabled_ = false;
+    int rescan_interval_ = 10;
+    std::unordered_map<uint32_t, StreamTracks> stream_tracks_;
+    std::vector<AprilTagTrackState::TagTrack> claimed_tracks_;  // Copied out for this frame's ROIs
+    std::vector<AprilTagTrackState::TagTrack> updated_tracks_;
+    std::vector<cv::Rect> rois_;
+    std::atomic<uint64_t> full_scans_{0};
+    std::atomic<uint64_t> roi_scans_{0};
+
+    // Adaptive parameter control
+    bool adaptive_enabled_ = false;
+    AprilTagController controller_;
+    mutable std::mutex controller_mutex_;
+    AprilTagControllerState controller_snapshot_;
+
+    void applyTuning(const AprilTagTuning& tuning);
+
+    // Pose estimation, spread across the detector's worker pool
+    struct PoseTask {
+        apriltag_detection_info_t info;
+        AprilTagResult* result;
+        AprilTagPoseMethod method;
+    };
+
+    AprilTagPoseMethod pose_method_ = AprilTagPoseMethod::OrthogonalIteration;
+    std::vector<apriltag_detection_t*> pose_detections_;  // Parallel to the frame's results
+    std::vector<PoseTask> pose_tasks_;
+    std::vector<zarray_t*> roi_detections_;
+
+    // Convert one detection into a result (pose is filled in by estimatePoses)
+    AprilTagResult makeResult(apriltag_detection_t* det);
+
+    // Estimate the pose of every result from its detection in pose_detections_
+    void estimatePoses(std::vector<AprilTagResult>& results, const cv::Mat& camera_matrix, double tag_size);
+
+    static void runPoseTask(void* task);
+
+    // Predict search regions from claimed_tracks_, frames_ahead stream frames on
+    void predictRois(double frames_ahead, cv::Size image_size);
+
+    // Update a stream's tracks from a frame's results (state mutex held)
+    void updateTracks(AprilTagTrackState& state, uint64_t frame_id, const std::vector<AprilTagResult>& results);
 };
 
 } // namespace navign::robot::vision
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace navign::robot::vision {
+
+/**
+ * @brief AprilTag candidate filters applied after decoding and before pose estimation
+ */
+struct AprilTagFilter {
+    std::vector<uint32_t> id_whitelist;  // Deployed tag IDs; empty accepts every ID
+    int max_hamming = 2;                 // Bit errors corrected while decoding (0-3)
+    double min_decision_margin = 0.0;    // Reject weak decodes below this margin
+};
+
+} // namespace navign::robot::vision
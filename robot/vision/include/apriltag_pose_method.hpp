@@ -0,0 +1,13 @@
+#pragma once
+
+namespace navign::robot::vision {
+
+/**
+ * @brief Tag pose estimation method
+ */
+enum class AprilTagPoseMethod {
+    OrthogonalIteration,  // estimate_tag_pose: homography seed refined, ambiguity resolved
+    Homography,           // estimate_pose_for_tag_homography: decomposition only, faster
+};
+
+} // namespace navign::robot::vision
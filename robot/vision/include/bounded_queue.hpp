@@ -0,0 +1,112 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <optional>
+
+namespace navign::robot::vision {
+
+/**
+ * @brief Bounded queue connecting pipeline stages
+ *
+ * When the queue is full, pushing evicts the oldest item instead of blocking,
+ * so a slow consumer always works on the most recent frame rather than on a
+ * growing backlog of stale ones.
+ */
+template <typename T>
+class BoundedQueue {
+public:
+    explicit BoundedQueue(size_t capacity) : capacity_(capacity == 0 ? 1 : capacity) {}
+
+    BoundedQueue(const BoundedQueue&) = delete;
+    BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+    /**
+     * @brief Push an item, dropping the oldest queued item if full
+     * @return false if the queue has been closed
+     */
+    bool push(T item) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (closed_) {
+                return false;
+            }
+            if (items_.size() >= capacity_) {
+                items_.pop_front();
+                dropped_.fetch_add(1, std::memory_order_relaxed);
+            }
+            items_.push_back(std::move(item));
+            size_.store(items_.size(), std::memory_order_relaxed);
+        }
+        not_empty_.notify_one();
+        return true;
+    }
+
+    /**
+     * @brief Pop the oldest item, waiting up to timeout
+     * @return The item, or std::nullopt on timeout or when closed and drained
+     */
+    std::optional<T> pop(std::chrono::milliseconds timeout) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (!not_empty_.wait_for(lock, timeout, [this] { return closed_ || !items_.empty(); })) {
+            return std::nullopt;
+        }
+        if (items_.empty()) {
+            return std::nullopt;
+        }
+        T item = std::move(items_.front());
+        items_.pop_front();
+        size_.store(items_.size(), std::memory_order_relaxed);
+        return item;
+    }
+
+    /**
+     * @brief Close the queue and wake all waiting consumers
+     */
+    void close() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            closed_ = true;
+        }
+        not_empty_.notify_all();
+    }
+
+    /**
+     * @brief Discard queued items and reopen the queue
+     */
+    void reset() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        items_.clear();
+        closed_ = false;
+        size_.store(0, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Current queue depth (lock-free, for metrics)
+     */
+    size_t size() const { return size_.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Number of items evicted because the queue was full
+     */
+    uint64_t droppedCount() const { return dropped_.load(std::memory_order_relaxed); }
+
+    size_t capacity() const { return capacity_; }
+
+private:
+    const size_t capacity_;
+    mutable std::mutex mutex_;
+    std::condition_variable not_empty_;
+    std::deque<T> items_;
+    bool closed_ = false;
+
+    std::atomic<size_t> size_{0};
+    std::atomic<uint64_t> dropped_{0};
+};
+
+} // namespace navign::robot::vision
@@ -1,9 +1,12 @@
 #pragma once
 
+#include <memory>
 #include <vector>
 #include <string>
 #include <opencv2/opencv.hpp>
 
+#include "undistortion_lut.hpp"
+
 namespace navign::robot::vision {
 
 /**
@@ -22,6 +25,83 @@ struct CalibrationData {
     double reprojection_error = 0.0;
 };
 
+/**
+ * @brief When an incremental calibration has seen enough views
+ */
+struct CalibrationConvergence {
+    int min_views = 8;              // Never stop before this many views
+    int max_views = 40;             // Stop here even if not converged
+    double rms_tolerance = 0.02;    // Max relative RMS change between views
+    int stable_views = 3;           // Consecutive views within tolerance
+    double min_coverage = 0.6;      // Fraction of the coverage grid seen
+};
+
+/**
+ * @brief Live state of an incremental calibration
+ */
+struct CalibrationProgress {
+    size_t views = 0;
+    double rms_error = 0.0;           // Of the current estimate, 0 before the first
+    std::vector<double> view_errors;  // RMS reprojection error of each view
+    std::vector<double> view_coverage;  // Image fraction covered by each view's board
+    double coverage = 0.0;            // Fraction of coverage grid cells seen by any view
+    bool converged = false;
+};
+
+/**
+ * @brief Calibration refined one view at a time
+ *
+ * Keeps only the corner sets of accepted views, not their images. Once
+ * min_views are in, every new view re-runs cv::calibrateCamera seeded with
+ * the previous estimate, which converges in a few iterations. The estimate
+ * has converged when its RMS error stays within rms_tolerance for
+ * stable_views consecutive views and the boards have covered enough of the
+ * image; coverage matters because a board held only in the center leaves
+ * the distortion at the edges unconstrained.
+ */
+class IncrementalCalibration {
+public:
+    // Coverage grid over the image
+    static constexpr int kCoverageCols = 8;
+    static constexpr int kCoverageRows = 6;
+
+    IncrementalCalibration(cv::Size image_size, cv::Size pattern_size, double square_size,
+                           const CalibrationConvergence& convergence = {});
+
+    /**
+     * @brief Add the corners of one view and update the estimate
+     * @return false if the corner set does not match the pattern
+     */
+    bool addView(const std::vector<cv::Point2f>& corners);
+
+    const CalibrationProgress& progress() const { return progress_; }
+    bool converged() const { return progress_.converged; }
+
+    /**
+     * @brief True when no more views are needed (converged or max_views)
+     */
+    bool done() const;
+
+    /**
+     * @brief Current estimate (is_valid once min_views are in)
+     */
+    const CalibrationData& result() const { return calibration_; }
+
+private:
+    cv::Size image_size_;
+    cv::Size pattern_size_;
+    CalibrationConvergence convergence_;
+    std::vector<cv::Point3f> board_points_;
+
+    std::vector<std::vector<cv::Point2f>> image_points_;
+    std::vector<bool> covered_cells_;
+    CalibrationData calibration_;
+    CalibrationProgress progress_;
+    int stable_count_ = 0;
+
+    void recalibrate();
+};
+
 /**
  * @brief Camera calibration using chessboard pattern
  */
@@ -32,6 +112,9 @@ public:
 
     /**
      * @brief Calibrate camera using chessboard pattern
+     *
+     * Corners are found in all images in parallel on OpenCV's thread pool.
+     *
      * @param images Vector of calibration images
      * @param pattern_size Chessboard pattern size (cols, rows) - internal corners
      * @param square_size Physical size of chessboard square in meters
@@ -43,19 +126,46 @@ public:
         double square_size
     );
 
+    /**
+     * @brief Calibrate from corner sets found earlier (see findChessboards)
+     * @param corner_sets Corners of each view, one set per image
+     * @param image_size Size of the images the corners were found in
+     */
+    bool calibrateFromCorners(
+        const std::vector<std::vector<cv::Point2f>>& corner_sets,
+        cv::Size image_size,
+        cv::Size pattern_size,
+        double square_size
+    );
+
     /**
      * @brief Calibrate from live camera feed
+     *
+     * Only the corners of captured frames are kept. Each capture refines an
+     * IncrementalCalibration whose RMS error and coverage are shown live;
+     * collection stops once the estimate converges, or after num_frames.
+     *
      * @param camera_index Camera device index
      * @param pattern_size Chessboard pattern size
      * @param square_size Physical square size in meters
-     * @param num_frames Number of calibration frames to collect
+     * @param num_frames Maximum number of calibration frames to collect
      * @return true if calibration successful
      */
     bool calibrateFromCamera(
         int camera_index,
         cv::Size pattern_size,
         double square_size,
-        int num_frames = 20
+        int num_frames = 20,
+        const CalibrationConvergence& convergence = {}
+    );
+
+    /**
+     * @brief Find chessboard corners in every image in parallel
+     * @return One corner set per image, empty where no board was found
+     */
+    static std::vector<std::vector<cv::Point2f>> findChessboards(
+        const std::vector<cv::Mat>& images,
+        cv::Size pattern_size
     );
 
     /**
@@ -66,10 +176,20 @@ public:
 
     /**
      * @brief Load calibration from file
+     *
+     * Also builds the undistortion tables. When persistence is enabled they
+     * are read from (or written to) "<filename>.lut" next to the YAML, so
+     * only the first start after a calibration change pays for building them.
+     *
      * @param filename Path to load
      */
     bool load(const std::string& filename);
 
+    /**
+     * @brief Enable persisting undistortion tables next to the calibration file
+     */
+    void setPersistUndistortion(bool persist) { persist_undistortion_ = persist; }
+
     /**
      * @brief Get calibration data
      */
@@ -82,9 +202,33 @@ public:
 
     /**
      * @brief Undistort an image
+     *
+     * Uses the cached remap tables for images of the calibrated size,
+     * falling back to cv::undistort otherwise.
      */
     cv::Mat undistort(const cv::Mat& image) const;
 
+    /**
+     * @brief Undistort into a caller-owned buffer (reused if already allocated)
+     */
+    void undistort(const cv::Mat& image, cv::Mat& undistorted) const;
+
+    /**
+     * @brief Undistort an image held on the OpenCL device, without leaving it
+     *
+     * Only the remap tables take the device path; other sizes fall back to
+     * cv::undistort, which runs on the CPU.
+     */
+    void undistort(const cv::UMat& image, cv::UMat& undistorted) const;
+
+    /**
+     * @brief Precomputed undistortion tables, or nullptr if not calibrated
+     *
+     * Rebuilt whenever the calibration changes; holders of the old tables
+     * keep a consistent snapshot.
+     */
+    std::shared_ptr<const UndistortionLut> getUndistortionLut() const { return undistortion_lut_; }
+
     /**
      * @brief Get optimal new camera matrix
      */
@@ -92,13 +236,22 @@ public:
 
 private:
     CalibrationData calibration_;
+    std::shared_ptr<const UndistortionLut> undistortion_lut_;
+    bool persist_undistortion_ = true;
+
+    // Rebuild (or load) undistortion tables for the current calibration
+    void updateUndistortionLut(const std::string& cache_file = "");
 
-    // Helper: detect chessboard corners
-    bool detectChessboard(
+    // Helper: detect chessboard corners; fast_check rejects frames without
+    // a board quickly (live preview)
+    static bool detectChessboard(
         const cv::Mat& image,
         cv::Size pattern_size,
-        std::vector<cv::Point2f>& corners
+        std::vector<cv::Point2f>& corners,
+        bool fast_check = false
     );
+
+    void applyCalibration(const CalibrationData& calibration);
 };
 
 } // namespace navign::robot::vision
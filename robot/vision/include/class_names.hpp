@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace navign::robot::vision {
+
+/**
+ * @brief Process-wide table of interned object class names
+ *
+ * Detections carry a 16-bit class id instead of their own copy of the
+ * name; the name is looked up only when a message is built. Names are
+ * never removed, so returned references stay valid for the life of the
+ * process and lookups take no lock. Detectors loading the same names file
+ * share the same ids.
+ */
+class ClassNames {
+public:
+    static constexpr size_t kCapacity = 2048;
+    static constexpr uint16_t kUnknown = 0;  // "Unknown"
+
+    /**
+     * @brief Id of a name, adding it on first use
+     * @return kUnknown once the table is full
+     */
+    static uint16_t intern(std::string_view name);
+
+    /**
+     * @brief Name of an id ("Unknown" for ids never handed out)
+     */
+    static const std::string& name(uint16_t id);
+
+    /**
+     * @brief Number of ids handed out, including kUnknown
+     */
+    static size_t size();
+};
+
+} // namespace navign::robot::vision
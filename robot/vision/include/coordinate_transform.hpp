@@ -1,12 +1,25 @@
 #pragma once
 
+#include <array>
+#include <memory>
+#include <optional>
+#include <span>
 #include <vector>
 #include <opencv2/opencv.hpp>
 
+#include "undistortion_lut.hpp"
+
 namespace navign::robot::vision {
 
 /**
  * @brief 2D-3D coordinate transformation utilities
+ *
+ * Pose convention: the camera pose maps camera coordinates to world
+ * coordinates, X_world = rotation * X_camera + translation, so translation
+ * is the camera position in the world frame.
+ *
+ * Intrinsics and pose are cached as fixed-size matrices when set, so the
+ * batched APIs allocate nothing per call.
  */
 class CoordinateTransform {
 public:
@@ -18,6 +31,15 @@ public:
      */
     void setCalibration(const cv::Mat& camera_matrix, const cv::Mat& dist_coeffs);
 
+    /**
+     * @brief Use precomputed undistortion tables for point unprojection
+     *
+     * Points inside the table are unprojected by bilinear lookup instead
+     * of iterative undistortion. Pass nullptr to go back to the iterative
+     * path.
+     */
+    void setUndistortionLut(std::shared_ptr<const UndistortionLut> lut) { undistortion_lut_ = std::move(lut); }
+
     /**
      * @brief Set camera pose (extrinsics)
      * @param rotation 3x3 rotation matrix (camera to world)
@@ -33,6 +55,23 @@ public:
      */
     cv::Point3d imageToWorld(const cv::Point2f& image_point, double z_plane = 0.0) const;
 
+    /**
+     * @brief Project a batch of image points onto the plane z = z_plane
+     *
+     * Points whose ray is parallel to the plane or hits it behind the camera
+     * are written as NaN.
+     *
+     * @param image_points 2D points in image (u, v)
+     * @param world_points Output, same size as image_points
+     * @param z_plane Z coordinate of ground plane in world coords
+     * @return Number of points with a valid intersection
+     */
+    size_t imageToWorld(
+        std::span<const cv::Point2f> image_points,
+        std::span<cv::Point3d> world_points,
+        double z_plane = 0.0
+    ) const;
+
     /**
      * @brief Project 3D world point to 2D image coordinates
      * @param world_point 3D point in world coordinates
@@ -40,6 +79,16 @@ public:
      */
     cv::Point2f worldToImage(const cv::Point3d& world_point) const;
 
+    /**
+     * @brief Project a batch of world points into the (distorted) image
+     * @param world_points 3D points in world coordinates
+     * @param image_points Output, same size as world_points
+     */
+    void worldToImage(
+        std::span<const cv::Point3d> world_points,
+        std::span<cv::Point2f> image_points
+    ) const;
+
     /**
      * @brief Compute ray direction from camera through image point
      * @param image_point 2D point in image
@@ -47,6 +96,16 @@ public:
      */
     cv::Point3d getRayDirection(const cv::Point2f& image_point) const;
 
+    /**
+     * @brief Compute normalized world-frame ray directions for a batch of image points
+     * @param image_points 2D points in image
+     * @param directions Output, same size as image_points
+     */
+    void getRayDirections(
+        std::span<const cv::Point2f> image_points,
+        std::span<cv::Point3d> directions
+    ) const;
+
     /**
      * @brief Intersect ray with plane
      * @param ray_origin Camera position in world coords
@@ -67,6 +126,19 @@ public:
      */
     cv::Point3d getCameraPosition() const;
 
+    /**
+     * @brief Camera to world rotation (identity without a pose)
+     */
+    const cv::Matx33d& getRotation() const { return rotation_; }
+
+    /**
+     * @brief Map a 3D point between the camera frame and the world frame
+     *
+     * Without a pose both frames coincide.
+     */
+    cv::Point3d cameraToWorld(const cv::Point3d& camera_point) const;
+    cv::Point3d worldToCamera(const cv::Point3d& world_point) const;
+
     /**
      * @brief Check if calibration is set
      */
@@ -78,13 +150,29 @@ public:
     bool hasPose() const { return has_pose_; }
 
 private:
+    // Original calibration, used only for distortion models beyond k1..k3
     cv::Mat camera_matrix_;
     cv::Mat dist_coeffs_;
-    cv::Mat rotation_;      // Camera to world
-    cv::Mat translation_;   // Camera to world
+
+    // Cached intrinsics
+    double fx_ = 1.0, fy_ = 1.0, cx_ = 0.0, cy_ = 0.0;
+    std::array<double, 5> dist_{};  // k1, k2, p1, p2, k3
+    bool extended_distortion_ = false;
+    std::shared_ptr<const UndistortionLut> undistortion_lut_;
+
+    // Cached pose
+    cv::Matx33d rotation_ = cv::Matx33d::eye();       // Camera to world
+    cv::Matx33d rotation_inv_ = cv::Matx33d::eye();   // World to camera
+    cv::Vec3d camera_position_{0.0, 0.0, 0.0};        // Camera origin in world
 
     bool has_calibration_ = false;
     bool has_pose_ = false;
+
+    // Undistort one pixel to normalized camera coordinates (z = 1)
+    cv::Point2d normalize(const cv::Point2f& image_point) const;
+
+    // Apply distortion and intrinsics to a normalized camera point
+    cv::Point2f project(double x, double y) const;
 };
 
 } // namespace navign::robot::vision
@@ -0,0 +1,185 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+namespace navign::robot::vision {
+
+/**
+ * @brief Multi-producer queue with one bounded lane per producer
+ *
+ * Each lane behaves like a BoundedQueue: pushing to a full lane evicts that
+ * lane's oldest item. Consumers take items from the lanes in round-robin
+ * order, so a producer running at a higher rate can neither starve nor evict
+ * the items of another one. Lossless producers (e.g. fast replay) can use
+ * pushWait() to block on a full lane instead.
+ */
+template <typename T>
+class FairQueue {
+public:
+    explicit FairQueue(size_t lane_capacity, size_t lanes = 1)
+        : lane_capacity_(lane_capacity == 0 ? 1 : lane_capacity), lanes_(lanes == 0 ? 1 : lanes) {}
+
+    FairQueue(const FairQueue&) = delete;
+    FairQueue& operator=(const FairQueue&) = delete;
+
+    /**
+     * @brief Push an item into a lane, dropping that lane's oldest item if full
+     * @return false if the queue has been closed or the lane does not exist
+     */
+    bool push(size_t lane, T item) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (closed_ || lane >= lanes_.size()) {
+                return false;
+            }
+            Lane& target = lanes_[lane];
+            if (target.items.size() >= lane_capacity_) {
+                target.items.pop_front();
+                target.dropped++;
+            } else {
+                size_++;
+            }
+            target.items.push_back(std::move(item));
+        }
+        not_empty_.notify_one();
+        return true;
+    }
+
+    /**
+     * @brief Push an item, waiting for room in the lane instead of evicting
+     * @return false on timeout, if the queue has been closed or the lane does not exist
+     */
+    bool pushWait(size_t lane, T item, std::chrono::milliseconds timeout) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            if (lane >= lanes_.size()) {
+                return false;
+            }
+            if (!not_full_.wait_for(lock, timeout, [&] {
+                    return closed_ || lanes_[lane].items.size() < lane_capacity_; })) {
+                return false;
+            }
+            if (closed_) {
+                return false;
+            }
+            lanes_[lane].items.push_back(std::move(item));
+            size_++;
+        }
+        not_empty_.notify_one();
+        return true;
+    }
+
+    /**
+     * @brief Pop the oldest item of the next non-empty lane, waiting up to timeout
+     * @return The item, or std::nullopt on timeout or when closed and drained
+     */
+    std::optional<T> pop(std::chrono::milliseconds timeout) {
+        return popUntil(std::chrono::steady_clock::now() + timeout);
+    }
+
+    /**
+     * @brief Pop like pop(), waiting until an absolute deadline
+     */
+    std::optional<T> popUntil(std::chrono::steady_clock::time_point deadline) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (!not_empty_.wait_until(lock, deadline, [this] { return closed_ || size_ > 0; })) {
+            return std::nullopt;
+        }
+        if (size_ == 0) {
+            return std::nullopt;
+        }
+
+        for (size_t i = 0; i < lanes_.size(); i++) {
+            Lane& lane = lanes_[(next_lane_ + i) % lanes_.size()];
+            if (lane.items.empty()) {
+                continue;
+            }
+            next_lane_ = (next_lane_ + i + 1) % lanes_.size();
+            T item = std::move(lane.items.front());
+            lane.items.pop_front();
+            size_--;
+            // Producers blocked in pushWait() may be waiting on any lane
+            lock.unlock();
+            not_full_.notify_all();
+            return item;
+        }
+        return std::nullopt;
+    }
+
+    /**
+     * @brief Close the queue and wake all waiting consumers
+     */
+    void close() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            closed_ = true;
+        }
+        not_empty_.notify_all();
+        not_full_.notify_all();
+    }
+
+    /**
+     * @brief Discard queued items and reopen the queue with the given lane count
+     */
+    void reset(size_t lanes) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        lanes_.assign(lanes == 0 ? 1 : lanes, Lane{});
+        next_lane_ = 0;
+        size_ = 0;
+        closed_ = false;
+    }
+
+    /**
+     * @brief Items queued across all lanes
+     */
+    size_t size() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return size_;
+    }
+
+    /**
+     * @brief Items evicted from one lane because it was full
+     */
+    uint64_t droppedCount(size_t lane) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return lane < lanes_.size() ? lanes_[lane].dropped : 0;
+    }
+
+    /**
+     * @brief Items evicted from all lanes
+     */
+    uint64_t droppedCount() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        uint64_t total = 0;
+        for (const auto& lane : lanes_) {
+            total += lane.dropped;
+        }
+        return total;
+    }
+
+    size_t laneCapacity() const { return lane_capacity_; }
+
+private:
+    struct Lane {
+        std::deque<T> items;
+        uint64_t dropped = 0;
+    };
+
+    const size_t lane_capacity_;
+    mutable std::mutex mutex_;
+    std::condition_variable not_empty_;
+    std::condition_variable not_full_;
+    std::vector<Lane> lanes_;
+    size_t next_lane_ = 0;
+    size_t size_ = 0;
+    bool closed_ = false;
+};
+
+} // namespace navign::robot::vision
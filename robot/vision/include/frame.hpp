@@ -0,0 +1,37 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <opencv2/opencv.hpp>
+
+namespace navign::robot::vision {
+
+/**
+ * @brief A captured camera frame shared between pipeline stages
+ *
+ * Frames are immutable once published by the capture stage, so detector
+ * workers can read the same image concurrently without copying it. The
+ * grayscale plane is computed once at capture and shared by every consumer
+ * that needs it.
+ *
+ * When YOLO runs on an OpenCL device, the capture stage also uploads the
+ * BGR image once into device_image (and derives gray from it there), so
+ * the object workers letterbox it without a second upload. The upload has
+ * completed by the time the frame is published.
+ */
+struct Frame {
+    uint64_t frame_id = 0;      // Per-camera sequence number
+    uint32_t camera_index = 0;  // Position of the source camera in the service
+    std::chrono::steady_clock::time_point capture_time;
+    // Where end-to-end latency and deadlines are measured from: capture_time,
+    // except in fast replays, whose capture_time follows the recording
+    std::chrono::steady_clock::time_point received_time;
+    cv::Mat image;  // BGR
+    cv::Mat gray;   // 8-bit single channel, same size as image
+    cv::UMat device_image;  // BGR on the OpenCL device, empty unless uploaded for this frame
+};
+
+using FramePtr = std::shared_ptr<const Frame>;
+
+} // namespace navign::robot::vision
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <opencv2/opencv.hpp>
+
+#include "frame.hpp"
+
+namespace navign::robot::vision {
+
+/**
+ * @brief Fixed-size pool of preallocated frames
+ *
+ * acquire() hands out a ref-counted frame whose image and gray buffers were
+ * allocated up front. When the last reference is released the frame returns
+ * to the pool instead of being freed, so steady-state capture performs no
+ * heap allocation. Outstanding frames keep the pool storage alive, so the
+ * pool may be destroyed before the frames it handed out.
+ */
+class FramePool {
+public:
+    /**
+     * @param capacity Number of frames to preallocate
+     * @param frame_size Size of the BGR and gray buffers
+     */
+    FramePool(size_t capacity, cv::Size frame_size);
+    ~FramePool() = default;
+
+    FramePool(const FramePool&) = delete;
+    FramePool& operator=(const FramePool&) = delete;
+
+    /**
+     * @brief Take a free frame from the pool
+     * @return Frame with preallocated buffers, or nullptr if all are in use
+     */
+    std::shared_ptr<Frame> acquire();
+
+    size_t capacity() const;
+    size_t available() const;
+
+    /**
+     * @brief Pixel memory preallocated for all frames
+     */
+    size_t bytes() const;
+
+private:
+    struct Storage {
+        std::mutex mutex;
+        std::vector<std::unique_ptr<Frame>> frames;
+        std::vector<Frame*> free_list;
+        size_t frame_bytes = 0;
+    };
+
+    std::shared_ptr<Storage> storage_;
+};
+
+} // namespace navign::robot::vision
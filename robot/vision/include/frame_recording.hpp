@@ -0,0 +1,167 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+#include <opencv2/opencv.hpp>
+
+#include "bounded_queue.hpp"
+#include "frame.hpp"
+#include "frame_source.hpp"
+
+namespace navign::robot::vision {
+
+/**
+ * @brief Payload encoding of a frame recording
+ */
+enum class RecordingCodec : uint32_t {
+    RawBgr = 0,  // Packed BGR8, replayed with a single copy
+    Mjpeg = 1,   // One JPEG per frame, ~10x smaller
+};
+
+/**
+ * @brief How a ReplaySource paces its frames
+ */
+enum class ReplayPacing {
+    Realtime,  // Original inter-frame timing
+    Fast,      // As fast as the pipeline consumes them, without drops
+};
+
+/**
+ * @brief Writes captured frames into a memory-mappable recording
+ *
+ * Container (native little-endian, 8-byte aligned records):
+ *
+ *   header   "NAVFRM01", version, codec, width, height
+ *   records  { timestamp_ns since first frame, payload size } + payload
+ *   index    offset of every record
+ *   footer   index offset, frame count, "NAVIDX01"
+ *
+ * Frames are queued and written by a background thread, so record() never
+ * blocks the capture thread; if the disk falls behind, the oldest queued
+ * frames are dropped and counted. A recording cut short (no footer) is
+ * still replayable, records are then found by scanning.
+ */
+class FrameRecorder {
+public:
+    // Queued frames are pooled buffers; the capture pool must cover them
+    static constexpr size_t kQueueCapacity = 4;
+
+    FrameRecorder() = default;
+    ~FrameRecorder();
+
+    FrameRecorder(const FrameRecorder&) = delete;
+    FrameRecorder& operator=(const FrameRecorder&) = delete;
+
+    /**
+     * @brief Create the file and start the writer thread
+     * @param jpeg_quality Used with RecordingCodec::Mjpeg
+     */
+    bool start(const std::string& path, cv::Size frame_size, RecordingCodec codec, int jpeg_quality = 90);
+
+    /**
+     * @brief Queue a frame for writing (non-blocking)
+     */
+    void record(FramePtr frame);
+
+    /**
+     * @brief Write the queued frames and the index, then close the file
+     */
+    void stop();
+
+    bool isRecording() const { return file_ != nullptr; }
+    uint64_t framesWritten() const { return frames_written_.load(); }
+    uint64_t framesDropped() const { return queue_.droppedCount(); }
+
+private:
+    std::FILE* file_ = nullptr;
+    std::string path_;
+    cv::Size frame_size_;
+    RecordingCodec codec_ = RecordingCodec::RawBgr;
+    int jpeg_quality_ = 90;
+
+    BoundedQueue<FramePtr> queue_{kQueueCapacity};
+    std::thread writer_;
+    std::atomic<bool> running_{false};
+
+    // Writer thread only
+    std::vector<uint64_t> offsets_;
+    std::vector<uint8_t> encoded_;
+    uint64_t position_ = 0;
+    bool has_first_timestamp_ = false;
+    std::chrono::steady_clock::time_point first_timestamp_;
+    std::atomic<uint64_t> frames_written_{0};
+
+    void writerLoop();
+    bool writeFrame(const Frame& frame);
+    bool writeBytes(const void* data, size_t size);
+};
+
+/**
+ * @brief Replays a FrameRecorder file through the pipeline
+ *
+ * The file is memory-mapped, so frames are read straight from the page
+ * cache: raw frames cost a single copy into the pooled buffer and MJPEG
+ * frames one decode, with no read() calls on the capture thread.
+ * Replaying the same file with the same settings feeds the detectors the
+ * same frames in the same order; with ReplayPacing::Fast the pipeline
+ * applies backpressure instead of dropping frames, so runs are directly
+ * comparable.
+ */
+class ReplaySource : public FrameSource {
+public:
+    ReplaySource() = default;
+    ~ReplaySource() override;
+
+    ReplaySource(const ReplaySource&) = delete;
+    ReplaySource& operator=(const ReplaySource&) = delete;
+
+    /**
+     * @brief Map a recording
+     * @param loop Start over after the last frame instead of finishing
+     */
+    bool open(const std::string& path, ReplayPacing pacing, bool loop = false);
+
+    bool isOpened() const override { return data_ != nullptr; }
+    cv::Size frameSize() const override { return frame_size_; }
+    bool read(Frame& frame) override;
+    void skip() override;
+    void release() override;
+    bool finished() const override { return finished_; }
+    bool paced() const override { return true; }
+    bool lossless() const override { return pacing_ == ReplayPacing::Fast; }
+    std::string describe() const override { return "recording " + path_; }
+
+    size_t frameCount() const { return records_.size(); }
+    RecordingCodec codec() const { return codec_; }
+
+private:
+    struct Record {
+        uint64_t timestamp_ns;
+        const uint8_t* payload;
+        uint32_t size;
+    };
+
+    std::string path_;
+    const uint8_t* data_ = nullptr;
+    size_t size_ = 0;
+    std::vector<Record> records_;
+
+    cv::Size frame_size_;
+    RecordingCodec codec_ = RecordingCodec::RawBgr;
+    ReplayPacing pacing_ = ReplayPacing::Realtime;
+    bool loop_ = false;
+
+    size_t next_ = 0;
+    bool finished_ = false;
+    bool started_ = false;
+    std::chrono::steady_clock::time_point start_time_;  // Capture time of the first frame of this pass
+
+    bool indexRecords();
+};
+
+} // namespace navign::robot::vision
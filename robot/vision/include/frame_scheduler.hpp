@@ -0,0 +1,149 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace navign::robot::vision {
+
+/**
+ * @brief What a camera gives up when its frames fall behind their deadline
+ */
+enum class LoadShedding {
+    Off,      // Every frame goes to every detector; full lanes evict their oldest frame
+    Objects,  // YOLO skips frames first, AprilTag still sees every frame
+    Frames,   // Whole frames are skipped
+};
+
+/**
+ * @brief Per-camera scheduling settings
+ */
+struct SchedulerConfig {
+    int fps = 30;                         // Capture grid of unpaced sources
+    int object_fps = 0;                   // YOLO rate, 0 = every frame
+    LoadShedding shedding = LoadShedding::Objects;
+    std::chrono::nanoseconds deadline{0};  // Capture to publish, 0 = one frame period
+};
+
+/**
+ * @brief Real-time priority and CPU placement of the pipeline threads
+ *
+ * Priorities are SCHED_FIFO levels (1-99, 0 leaves the thread on the
+ * default scheduler) and need CAP_SYS_NICE or a matching RLIMIT_RTPRIO.
+ * Threads are pinned to the whole CPU set, not one CPU each; empty sets
+ * leave placement to the kernel. Failures are logged, never fatal.
+ */
+struct ThreadTuning {
+    int capture_priority = 0;
+    int detection_priority = 0;
+    std::vector<int> capture_cpus;
+    std::vector<int> detection_cpus;
+};
+
+/**
+ * @brief Apply a priority and CPU set to the calling thread
+ * @param name Thread description used in warnings
+ */
+bool tuneCurrentThread(int priority, const std::vector<int>& cpus, const std::string& name);
+
+/**
+ * @brief Paces one camera and decides, per frame, which detectors run
+ *
+ * Unpaced sources are paced on an absolute grid of the frame period
+ * (sleep_until the next slot), so rounding and overruns do not accumulate
+ * into drift; a source more than a period behind restarts the grid instead
+ * of bursting to catch up.
+ *
+ * A frame is behind when it was captured more than a period ago (it sat in
+ * the driver's queue) or when the camera's last result of the shed kind
+ * missed its deadline. Behind frames are shed by policy, but never more
+ * than kMaxConsecutiveSheds in a row so the shed work still makes progress
+ * under sustained overload. A busy detector alone is not a reason to shed:
+ * its lane evicts the older frame, so it picks up the freshest one next.
+ * YOLO frames are picked on a grid of capture timestamps at object_fps.
+ *
+ * plan() runs on the camera's capture thread; recordResult() on the publish
+ * thread. The counters may be read from anywhere.
+ */
+class FrameScheduler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr int kMaxConsecutiveSheds = 4;
+
+    struct Work {
+        bool apriltags = false;
+        bool objects = false;
+    };
+
+    enum class ResultKind { AprilTags = 0, Objects = 1 };
+
+    /**
+     * @brief Deadline hits and misses of one result kind
+     */
+    struct DeadlineStats {
+        uint64_t met = 0;
+        uint64_t missed = 0;
+
+        double missRate() const {
+            const uint64_t total = met + missed;
+            return total > 0 ? static_cast<double>(missed) / total : 0.0;
+        }
+    };
+
+    void configure(const SchedulerConfig& config);
+    const SchedulerConfig& config() const { return config_; }
+
+    /**
+     * @brief Sleep until the next slot of the frame grid (unpaced sources)
+     */
+    void waitForSlot();
+
+    /**
+     * @brief Decide which detectors a captured frame goes to
+     */
+    Work plan(Clock::time_point capture_time);
+
+    /**
+     * @brief Account a published result against its frame's deadline
+     */
+    void recordResult(ResultKind kind, Clock::time_point capture_time, Clock::time_point published);
+
+    DeadlineStats deadlineStats(ResultKind kind) const;
+    uint64_t framesShed() const { return frames_shed_.load(std::memory_order_relaxed); }
+    uint64_t objectFramesShed() const { return object_frames_shed_.load(std::memory_order_relaxed); }
+    std::chrono::nanoseconds period() const { return period_; }
+
+private:
+    struct Deadline {
+        std::atomic<uint64_t> met{0};
+        std::atomic<uint64_t> missed{0};
+        std::atomic<bool> last_missed{false};
+    };
+
+    SchedulerConfig config_;
+    std::chrono::nanoseconds period_{0};
+    std::chrono::nanoseconds object_period_{0};
+    std::chrono::nanoseconds apriltag_deadline_{0};
+    std::chrono::nanoseconds object_deadline_{0};
+
+    // Capture thread only
+    Clock::time_point next_slot_;
+    Clock::time_point next_object_due_;
+    int consecutive_frame_sheds_ = 0;
+    int consecutive_object_sheds_ = 0;
+
+    Deadline deadlines_[2];
+    std::atomic<uint64_t> frames_shed_{0};
+    std::atomic<uint64_t> object_frames_shed_{0};
+
+    bool lastMissed(ResultKind kind) const {
+        return deadlines_[static_cast<size_t>(kind)].last_missed.load(std::memory_order_relaxed);
+    }
+};
+
+const char* loadSheddingName(LoadShedding shedding);
+
+} // namespace navign::robot::vision
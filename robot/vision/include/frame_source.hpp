@@ -0,0 +1,163 @@
+#pragma once
+
+#include <string>
+#include <opencv2/opencv.hpp>
+
+#include "frame.hpp"
+
+namespace navign::robot::vision {
+
+/**
+ * @brief How live cameras are opened
+ */
+enum class CaptureBackend {
+    OpenCV,     // cv::VideoCapture with the default backend, BGR frames
+    V4L2,       // Native V4L2 mmap streaming; gray straight from the Y plane
+    GStreamer,  // v4l2src pipeline into an NV12 appsink, optional hardware JPEG decode
+};
+
+/**
+ * @brief Pixel format requested from the camera by the V4L2 and GStreamer backends
+ */
+enum class CapturePixelFormat {
+    Auto,   // First of YUYV, NV12, MJPEG the device supports at the requested size
+    Yuyv,
+    Nv12,
+    Mjpeg,
+};
+
+/**
+ * @brief Where a camera's frames come from
+ *
+ * The capture thread owns its source and calls read() into pooled frames,
+ * so implementations are used from one thread only.
+ */
+class FrameSource {
+public:
+    virtual ~FrameSource() = default;
+
+    virtual bool isOpened() const = 0;
+
+    /**
+     * @brief Size of the frames read() delivers
+     */
+    virtual cv::Size frameSize() const = 0;
+
+    /**
+     * @brief Read the next frame
+     *
+     * Decodes into frame.image, reusing its buffer when size and type match,
+     * and sets frame.capture_time. Sources that providesGray() also fill
+     * frame.gray. Other fields are left to the caller.
+     *
+     * @return false on a read error or past the end of a finite source
+     */
+    virtual bool read(Frame& frame) = 0;
+
+    /**
+     * @brief Discard the next frame, so the source does not fall behind
+     */
+    virtual void skip() = 0;
+
+    virtual void release() = 0;
+
+    /**
+     * @brief True once a finite source has delivered its last frame
+     */
+    virtual bool finished() const { return false; }
+
+    /**
+     * @brief True if read() keeps its own pace instead of the target frame rate
+     */
+    virtual bool paced() const { return false; }
+
+    /**
+     * @brief True if no frame may be dropped; the pipeline blocks on full queues instead
+     */
+    virtual bool lossless() const { return false; }
+
+    /**
+     * @brief True if read() fills frame.gray itself, so no BGR to gray conversion is needed
+     */
+    virtual bool providesGray() const { return false; }
+
+    /**
+     * @brief Whether read() must fill frame.image
+     *
+     * Gray-providing sources can skip the BGR conversion when nothing but
+     * the AprilTag path consumes the frame. Other sources ignore this.
+     */
+    virtual void setColorOutput(bool /*enabled*/) {}
+
+    /**
+     * @brief Human-readable name for logs and errors
+     */
+    virtual std::string describe() const = 0;
+};
+
+/**
+ * @brief Live camera through cv::VideoCapture
+ */
+class VideoCaptureSource : public FrameSource {
+public:
+    /**
+     * @brief Open a camera device and request a resolution and frame rate
+     *
+     * frameSize() reports what the driver actually delivers.
+     */
+    bool open(int device, cv::Size size, int fps);
+
+    bool isOpened() const override { return capture_.isOpened(); }
+    cv::Size frameSize() const override { return frame_size_; }
+    bool read(Frame& frame) override;
+    void skip() override { capture_.grab(); }
+    void release() override { capture_.release(); }
+    std::string describe() const override { return "camera " + std::to_string(device_); }
+
+private:
+    cv::VideoCapture capture_;
+    int device_ = -1;
+    cv::Size frame_size_;
+};
+
+/**
+ * @brief Live camera through a GStreamer v4l2src pipeline
+ *
+ * The pipeline ends in an NV12 appsink, so the Y plane is copied into
+ * frame.gray and BGR is only produced when color output is enabled. With
+ * MJPEG cameras the JPEG decoder element is configurable, which is how the
+ * hardware decoders are used (nvjpegdec on Jetson, mppjpegdec on Rockchip,
+ * v4l2jpegdec on V4L2 M2M codecs). Requires OpenCV built with GStreamer.
+ */
+class GStreamerSource : public FrameSource {
+public:
+    /**
+     * @param jpeg_decoder GStreamer element decoding MJPEG (default: jpegdec)
+     */
+    bool open(int device, cv::Size size, int fps, CapturePixelFormat format,
+              const std::string& jpeg_decoder = "jpegdec");
+
+    bool isOpened() const override { return capture_.isOpened(); }
+    cv::Size frameSize() const override { return frame_size_; }
+    bool read(Frame& frame) override;
+    void skip() override { capture_.grab(); }
+    void release() override { capture_.release(); }
+    bool providesGray() const override { return true; }
+    void setColorOutput(bool enabled) override { color_output_ = enabled; }
+    std::string describe() const override { return "camera " + std::to_string(device_) + " (GStreamer)"; }
+
+    /**
+     * @brief The pipeline open() would launch
+     */
+    static std::string pipeline(int device, cv::Size size, int fps, CapturePixelFormat format,
+                                const std::string& jpeg_decoder);
+
+private:
+    cv::VideoCapture capture_;
+    int device_ = -1;
+    cv::Size frame_size_;
+    bool color_output_ = true;
+    cv::Mat nv12_;
+};
+
+} // namespace navign::robot::vision
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <optional>
+#include <string>
+
+namespace navign::robot::vision {
+
+/**
+ * @brief Whether YOLO object detection is compiled in (CMake USE_OBJECT_DETECTION)
+ *
+ * AprilTag-only builds leave out the detector, its backends and the object
+ * worker stage; checks against this constant fold away at compile time.
+ */
+#ifdef USE_OBJECT_DETECTION
+inline constexpr bool kObjectDetectionBuilt = true;
+#else
+inline constexpr bool kObjectDetectionBuilt = false;
+#endif
+
+/**
+ * @brief Inference backend used by ObjectDetector
+ */
+enum class InferenceBackend {
+    Auto,         // ONNX Runtime when built with it, otherwise OpenCV DNN
+    OpenCvDnn,
+    OnnxRuntime,
+};
+
+/**
+ * @brief ONNX Runtime execution provider
+ *
+ * Providers that are not compiled into the ONNX Runtime build fall back
+ * to CPU at load time with a warning.
+ */
+enum class ExecutionProvider {
+    CPU,
+    CUDA,
+    TensorRT,
+    OpenVINO,
+    CoreML,
+};
+
+/**
+ * @brief Device OpenCV DNN runs the model on (the OpenCV DNN backend only)
+ *
+ * OpenCL also moves letterboxing and blob creation onto the device through
+ * OpenCV's transparent API (cv::UMat). Unavailable devices fall back to the
+ * CPU at load time with a warning.
+ */
+enum class DnnTarget {
+    CPU,
+    OpenCL,  // Mali / Adreno / Intel GPUs; FP16 with --precision fp16 or auto
+    CUDA,    // Needs OpenCV built with CUDA DNN support
+};
+
+/**
+ * @brief Numeric precision of the YOLO model
+ *
+ * Reduced-precision models are separate files next to the FP32 model,
+ * named by suffix: yolov8n.onnx -> yolov8n.fp16.onnx, yolov8n.int8.onnx
+ * (see scripts/quantize_model.py). Both keep FP32 inputs and outputs.
+ */
+enum class ModelPrecision {
+    Auto,  // Best variant available for the backend and hardware
+    FP32,
+    FP16,
+    INT8,  // Static QDQ quantization, calibrated on recorded frames
+};
+
+/**
+ * @brief Parse an execution provider name ("cpu", "cuda", "tensorrt", "openvino", "coreml")
+ */
+std::optional<ExecutionProvider> parseExecutionProvider(const std::string& name);
+
+const char* executionProviderName(ExecutionProvider provider);
+
+/**
+ * @brief Parse a DNN target name ("cpu", "opencl", "cuda")
+ */
+std::optional<DnnTarget> parseDnnTarget(const std::string& name);
+
+const char* dnnTargetName(DnnTarget target);
+
+/**
+ * @brief Parse a model precision name ("auto", "fp32", "fp16", "int8")
+ */
+std::optional<ModelPrecision> parseModelPrecision(const std::string& name);
+
+const char* modelPrecisionName(ModelPrecision precision);
+
+} // namespace navign::robot::vision
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <vector>
+#include <opencv2/opencv.hpp>
+
+#include "fair_queue.hpp"
+#include "frame.hpp"
+#include "object_detector.hpp"
+
+namespace navign::robot::vision {
+
+/**
+ * @brief Groups queued frames into batched ObjectDetector passes
+ *
+ * collect() blocks for a first frame, then keeps taking frames from the
+ * queue until the batch is full or the latency budget, counted from the
+ * first frame, has run out. The queue serves cameras round-robin, so a batch
+ * mixes cameras before it takes consecutive frames of one camera. run()
+ * executes the batch in a single forward pass and returns one result per
+ * frame. One scheduler per worker; an instance is not thread-safe.
+ */
+class InferenceScheduler {
+public:
+    struct Result {
+        FramePtr frame;
+        std::vector<ObjectResult> objects;
+    };
+
+    /**
+     * @param detector Detector owned by the calling worker
+     * @param max_batch Frames per forward pass, capped by the model's batch limit
+     * @param latency_budget Longest time the first frame waits for the batch to fill
+     */
+    InferenceScheduler(ObjectDetector& detector, size_t max_batch, std::chrono::microseconds latency_budget);
+
+    /**
+     * @brief Collect the next batch
+     * @param idle_timeout How long to wait for the first frame
+     * @return false if no frame arrived
+     */
+    bool collect(FairQueue<FramePtr>& queue, std::chrono::milliseconds idle_timeout);
+
+    /**
+     * @brief Run the collected batch; results stay valid until the next collect()
+     */
+    std::vector<Result>& run(float confidence_threshold, float nms_threshold);
+
+    size_t maxBatch() const { return max_batch_; }
+
+private:
+    ObjectDetector& detector_;
+    size_t max_batch_;
+    std::chrono::microseconds latency_budget_;
+
+    std::vector<FramePtr> pending_;
+    std::vector<cv::Mat> images_;
+    std::vector<cv::UMat> device_images_;  // Frame::device_image, empty when not uploaded
+    std::vector<Result> results_;
+};
+
+} // namespace navign::robot::vision
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace navign::robot::vision {
+
+/**
+ * @brief Pipeline stages with latency instrumentation
+ */
+enum class PipelineStage : uint8_t {
+    Capture,
+    Grayscale,
+    AprilTagDecode,
+    PoseEstimation,
+    Localization,  // Multi-tag camera pose solve
+    YoloPreprocess,
+    YoloInference,
+    YoloPostprocess,
+    GroundProjection,  // Box foot points onto the floor plane
+    Tracking,  // Object tracker update or prediction
+    Publish,
+    EndToEnd,  // Capture timestamp to publish
+    Count,
+};
+
+inline constexpr size_t kPipelineStageCount = static_cast<size_t>(PipelineStage::Count);
+
+/**
+ * @brief Stable snake_case stage name (used as metric label)
+ */
+const char* pipelineStageName(PipelineStage stage);
+
+/**
+ * @brief Merged view of one or more latency histograms
+ */
+struct LatencySnapshot {
+    std::vector<uint64_t> counts;
+    uint64_t count = 0;
+    uint64_t sum_us = 0;
+
+    double percentileMs(double quantile) const;
+    double meanMs() const;
+};
+
+/**
+ * @brief HDR-style latency histogram with microsecond resolution
+ *
+ * Values below 16 us are counted exactly; above that every power of two is
+ * split into 16 linear sub-buckets, bounding the relative error to ~6% up to
+ * about 35 minutes. Recording is a single relaxed atomic increment, so it is
+ * lock-free and safe to read concurrently.
+ */
+class LatencyHistogram {
+public:
+    static constexpr size_t kSubBuckets = 16;
+    static constexpr size_t kMaxExponent = 31;
+    static constexpr size_t kBucketCount = kSubBuckets + (kMaxExponent - 3) * kSubBuckets;
+
+    void record(std::chrono::nanoseconds duration);
+
+    /**
+     * @brief Accumulate this histogram into a snapshot
+     */
+    void addTo(LatencySnapshot& snapshot) const;
+
+    static size_t bucketIndex(uint64_t micros);
+    static double bucketMidpointUs(size_t index);
+
+private:
+    std::array<std::atomic<uint64_t>, kBucketCount> counts_{};
+    std::atomic<uint64_t> sum_us_{0};
+};
+
+/**
+ * @brief Per-thread latency histograms for every pipeline stage
+ *
+ * Each pipeline thread registers once and records into its own histograms,
+ * so the hot path never contends with other threads. Readers merge the
+ * histograms of all threads on demand.
+ */
+class LatencyMetrics {
+public:
+    class ThreadRecorder {
+    public:
+        void record(PipelineStage stage, std::chrono::nanoseconds duration) {
+            histograms_[static_cast<size_t>(stage)].record(duration);
+        }
+
+    private:
+        friend class LatencyMetrics;
+        std::array<LatencyHistogram, kPipelineStageCount> histograms_;
+    };
+
+    /**
+     * @brief Create the calling thread's recorder (call once, outside the hot loop)
+     *
+     * The recorder stays valid for the lifetime of this object.
+     */
+    ThreadRecorder& registerThread();
+
+    /**
+     * @brief Merge all threads' histograms for one stage
+     */
+    LatencySnapshot snapshot(PipelineStage stage) const;
+
+private:
+    mutable std::mutex mutex_;
+    std::vector<std::unique_ptr<ThreadRecorder>> recorders_;
+};
+
+} // namespace navign::robot::vision
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+
+namespace navign::robot::vision {
+
+/**
+ * @brief Mapping between an image and its letterboxed model input
+ *
+ * The image is scaled uniformly to fit the input and centered, with the
+ * remaining border filled with gray (114, as in YOLOv8 training).
+ */
+struct LetterboxTransform {
+    double scale = 1.0;
+    int pad_x = 0;          // Left border in input pixels
+    int pad_y = 0;          // Top border in input pixels
+    cv::Size content;       // Size of the scaled image inside the input
+
+    /**
+     * @brief Fit an image into a model input of the given size
+     */
+    static LetterboxTransform fit(cv::Size image, cv::Size input);
+
+    /**
+     * @brief Map a box from model input coordinates back to the image
+     */
+    cv::Rect2d toImage(const cv::Rect2d& box) const {
+        return cv::Rect2d((box.x - pad_x) / scale, (box.y - pad_y) / scale,
+                          box.width / scale, box.height / scale);
+    }
+};
+
+/**
+ * @brief Letterbox preprocessing that writes straight into a CHW input tensor
+ *
+ * Converts a BGR 8-bit image into one planar RGB float item ([3, H, W],
+ * scaled to [0, 1]) in a single pass: channel swap, normalization, HWC to
+ * CHW and border fill happen together, vectorized with AVX2 / NEON where
+ * available. Images that need resizing are first scaled to the content
+ * size with cv::resize into a reused 8-bit buffer; a 640x480 camera into a
+ * 640x640 input needs no resize at all. Not thread-safe.
+ */
+class LetterboxPreprocessor {
+public:
+    /**
+     * @brief Fill one input item
+     * @param image BGR 8-bit image
+     * @param input Model input size (W x H)
+     * @param dst First float of the item, 3 * H * W values
+     * @return The transform needed to map results back to the image
+     */
+    LetterboxTransform apply(const cv::Mat& image, cv::Size input, float* dst);
+
+private:
+    cv::Mat resized_;
+};
+
+} // namespace navign::robot::vision
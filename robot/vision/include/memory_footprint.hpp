@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+
+namespace navign::robot::vision {
+
+/**
+ * @brief Memory use of the process, as the kernel and the allocator see it
+ *
+ * Heap figures come from glibc's mallinfo2() and stay 0 elsewhere. The
+ * difference between the resident set and the heap is mostly mapped code,
+ * model weights held by the inference runtime and driver buffers.
+ */
+struct MemoryFootprint {
+    size_t rss_bytes = 0;        // Resident set (VmRSS)
+    size_t peak_rss_bytes = 0;   // High-water mark of the resident set (VmHWM)
+    size_t heap_used_bytes = 0;  // Allocated and not yet freed
+    size_t heap_free_bytes = 0;  // Freed but still held by the allocator
+
+    /**
+     * @brief Sample the current footprint; fields that cannot be read stay 0
+     */
+    static MemoryFootprint sample();
+};
+
+/**
+ * @brief Limit the number of glibc malloc arenas
+ *
+ * glibc gives threads that contend on malloc arenas of their own, and
+ * memory freed by another thread (the publish thread dropping a worker's
+ * results) goes back to the arena that allocated it, where it stays. On a
+ * many-core board the arenas alone can hold tens of megabytes. Call before
+ * starting threads; a no-op without glibc.
+ */
+void limitHeapArenas(int max_arenas);
+
+/**
+ * @brief Return freed heap pages to the kernel
+ * @return true if any memory was released (always false without glibc)
+ */
+bool releaseFreeHeap();
+
+} // namespace navign::robot::vision
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <string>
+#include <thread>
+
+namespace navign::robot::vision {
+
+/**
+ * @brief Minimal HTTP endpoint serving Prometheus text exposition
+ *
+ * Every request is answered with the output of the render callback, so
+ * any path works as the scrape target. Requests are served one at a time
+ * on a dedicated thread, which is plenty for a scraper polling every few
+ * seconds.
+ */
+class MetricsServer {
+public:
+    using RenderFn = std::function<std::string()>;
+
+    explicit MetricsServer(RenderFn render);
+    ~MetricsServer();
+
+    MetricsServer(const MetricsServer&) = delete;
+    MetricsServer& operator=(const MetricsServer&) = delete;
+
+    /**
+     * @brief Listen on the given TCP port (all interfaces)
+     * @return false if the socket could not be bound
+     */
+    bool start(int port);
+    void stop();
+
+    bool isRunning() const { return running_.load(); }
+
+private:
+    RenderFn render_;
+    int listen_fd_ = -1;
+    std::atomic<bool> running_{false};
+    std::thread thread_;
+
+    void serveLoop();
+    void handleClient(int client_fd);
+};
+
+} // namespace navign::robot::vision
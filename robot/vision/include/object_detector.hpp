@@ -1,10 +1,18 @@
 #pragma once
 
+#include <chrono>
+#include <memory>
+#include <span>
 #include <vector>
 #include <string>
 #include <opencv2/opencv.hpp>
 #include <opencv2/dnn.hpp>
 
+#include "class_names.hpp"
+#include "inference_backend.hpp"
+#include "letterbox.hpp"
+#include "yolo_postprocess.hpp"
+
 #ifdef USE_ONNXRUNTIME
 #include <onnxruntime_cxx_api.h>
 #endif
@@ -13,10 +21,14 @@ namespace navign::robot::vision {
 
 /**
  * @brief Detected object result
+ *
+ * Not called DetectedObject to avoid clashing with the generated protobuf
+ * message of that name in the same namespace. The class is an interned id
+ * (see ClassNames), so a result holds no heap memory of its own.
  */
-struct DetectedObject {
+struct ObjectResult {
     uint32_t object_id;
-    std::string class_name;
+    uint16_t class_id = ClassNames::kUnknown;
     float confidence;
     cv::Rect bbox;
     cv::Point2f center;
@@ -25,6 +37,22 @@ struct DetectedObject {
     bool has_3d = false;
     cv::Point3d world_position;
     double distance_meters = 0.0;
+
+    // Motion from the tracker (if enabled)
+    cv::Point2f image_velocity;  // Pixels per second
+    bool has_velocity = false;
+    cv::Point3d velocity;        // m/s in world coordinates
+
+    const std::string& className() const { return ClassNames::name(class_id); }
+};
+
+/**
+ * @brief Stage durations of the most recent detect() call
+ */
+struct DetectionTimings {
+    std::chrono::nanoseconds preprocess{0};
+    std::chrono::nanoseconds inference{0};
+    std::chrono::nanoseconds postprocess{0};
 };
 
 /**
@@ -35,9 +63,98 @@ public:
     ObjectDetector();
     ~ObjectDetector();
 
+    /**
+     * @brief Select inference backend and execution provider
+     *
+     * Must be called before loadModel().
+     */
+    void setBackend(InferenceBackend backend) { backend_ = backend; }
+    void setExecutionProvider(ExecutionProvider provider) { provider_ = provider; }
+
+    /**
+     * @brief Select the OpenCV DNN device (default: CPU)
+     *
+     * Must be called before loadModel(); ONNX Runtime ignores it. With
+     * OpenCL, letterboxing and blob creation run on the device as well, so
+     * each image crosses to the device once and only the network output
+     * comes back.
+     */
+    void setDnnTarget(DnnTarget target) { dnn_target_ = target; }
+
+    /**
+     * @brief Whether detect() preprocesses on an OpenCL device
+     *
+     * Callers holding a device copy of the image (see Frame::device_image)
+     * can pass it to detect() / detectBatch() to skip the upload.
+     */
+    bool usesDeviceInput() const { return device_input_; }
+
+    /**
+     * @brief Select model precision (default: best variant for the hardware)
+     *
+     * Must be called before loadModel(). Missing variants fall back to the
+     * FP32 model.
+     */
+    void setPrecision(ModelPrecision precision) { precision_ = precision; }
+
+    /**
+     * @brief Reuse ONNX Runtime's compiled model across restarts (default: on)
+     *
+     * The first load saves the graph optimized by ORT_ENABLE_ALL next to the
+     * model as <model>.<provider>.opt.onnx; later loads read it back with
+     * graph optimization off. A cache older than its model, or one ORT
+     * rejects, is rebuilt. TensorRT and OpenVINO cache their compiled
+     * engines in the same directory instead. Must be called before loadModel().
+     *
+     * @param dir Cache directory, empty for the model's own directory
+     */
+    void setModelCache(bool enabled, const std::string& dir = "") {
+        model_cache_ = enabled;
+        model_cache_dir_ = dir;
+    }
+
+    /**
+     * @brief Bound ONNX Runtime's memory (default: ORT's own arena policy)
+     *
+     * ORT grows its arenas by doubling and plans a memory pattern for the
+     * largest run, both sized for throughput. A compact arena grows by what
+     * is requested and skips the memory pattern; max_bytes also caps the
+     * CPU arena, and the CUDA arena on CUDA and TensorRT (0 = no cap). Runs
+     * that would exceed the cap fail. The CPU arena is registered once per
+     * process and shared by every detector's session, so the first detector
+     * to load decides its bounds. Must be called before loadModel().
+     */
+    void setOnnxArena(bool compact, size_t max_bytes = 0) {
+        onnx_arena_compact_ = compact;
+        onnx_arena_max_bytes_ = max_bytes;
+    }
+
+    /**
+     * @brief Precision of the loaded model
+     */
+    ModelPrecision getLoadedPrecision() const { return loaded_precision_; }
+
+    /**
+     * @brief Select NMS strategy (default: class-agnostic)
+     */
+    void setNmsMode(NmsMode mode) { nms_mode_ = mode; }
+
+    /**
+     * @brief Model input size (default 640x640)
+     *
+     * Must be called before loadModel(); ONNX Runtime models with a static
+     * input shape use that shape instead.
+     */
+    void setInputSize(cv::Size size) { input_size_ = size; }
+    cv::Size getInputSize() const { return input_size_; }
+
     /**
      * @brief Load YOLO model
-     * @param model_path Path to ONNX model file (e.g., yolov8n.onnx)
+     *
+     * Looks for reduced-precision variants next to the model
+     * (yolov8n.fp16.onnx, yolov8n.int8.onnx) according to setPrecision().
+     *
+     * @param model_path Path to the FP32 ONNX model file (e.g., yolov8n.onnx)
      * @param config_path Path to model config (optional)
      * @return true if loaded successfully
      */
@@ -45,46 +162,167 @@ public:
 
     /**
      * @brief Detect objects in an image
+     *
+     * Reuses internal input/output buffers across calls, so a single
+     * detector must not be used from several threads at once.
+     *
      * @param image Input image (BGR)
      * @param confidence_threshold Minimum confidence (0.0-1.0)
      * @param nms_threshold Non-maximum suppression threshold
+     * @param device_image Device copy of image for the OpenCL path (optional)
      * @return Vector of detected objects
      */
-    std::vector<DetectedObject> detect(
+    std::vector<ObjectResult> detect(
         const cv::Mat& image,
         float confidence_threshold = 0.5f,
-        float nms_threshold = 0.4f
+        float nms_threshold = 0.4f,
+        const cv::UMat& device_image = cv::UMat()
     );
 
+    /**
+     * @brief Detect objects in several images with batched forward passes
+     *
+     * Images are letterboxed into one N x 3 x H x W tensor per pass, and
+     * each result is mapped back through its own image's letterbox. Models without a
+     * dynamic batch dimension are run in chunks of their fixed batch, or
+     * frame by frame for batch 1.
+     *
+     * @param images Input images (BGR), any sizes
+     * @param device_images Device copies of images (optional, empty entries are uploaded)
+     * @return One result vector per image, in input order
+     */
+    std::vector<std::vector<ObjectResult>> detectBatch(
+        std::span<const cv::Mat> images,
+        float confidence_threshold = 0.5f,
+        float nms_threshold = 0.4f,
+        std::span<const cv::UMat> device_images = {}
+    );
+
+    /**
+     * @brief Largest batch one forward pass accepts (0 = no limit)
+     */
+    int maxBatchSize() const;
+
+    /**
+     * @brief Check if a model is loaded (the backend is bound at load time)
+     */
+    bool isLoaded() const;
+
+    /**
+     * @brief Check if inference runs on ONNX Runtime
+     */
+    bool usesOnnxRuntime() const { return use_onnx_; }
+
     /**
      * @brief Load COCO class names
      */
     bool loadClassNames(const std::string& names_file);
 
     /**
-     * @brief Get class name by index
+     * @brief Interned id of a model class index
+     */
+    uint16_t getClassId(int class_index) const;
+
+    /**
+     * @brief Get class name by model class index
      */
-    std::string getClassName(int class_id) const;
+    const std::string& getClassName(int class_index) const { return ClassNames::name(getClassId(class_index)); }
+
+    /**
+     * @brief Stage durations of the last detect() (read on the detecting thread)
+     */
+    const DetectionTimings& getLastTimings() const { return last_timings_; }
 
 private:
     // OpenCV DNN backend
     cv::dnn::Net net_;
-    std::vector<std::string> class_names_;
+    std::vector<uint16_t> class_ids_;  // Model class index -> interned id
     cv::Size input_size_{640, 640};
 
+    // Per-frame buffers, reused to avoid reallocating every detect() call
+    cv::Mat blob_;
+    std::vector<cv::Mat> outputs_;
+    std::vector<std::string> output_names_;
+    LetterboxPreprocessor letterbox_;
+    std::vector<LetterboxTransform> letterboxes_;  // One per blob_ item
+
+    // OpenCL path: the same steps on cv::UMat, blob_ replaced by device_blob_
+    cv::UMat device_blob_;
+    std::vector<cv::UMat> device_uploads_;
+    std::vector<cv::UMat> device_resized_;
+    std::vector<cv::UMat> device_items_;
+    DetectionTimings last_timings_;
+
+    // Input batch dimension: fixed size, or <= 0 when dynamic
+    int model_batch_ = 0;
+    bool batch_supported_ = true;  // Cleared when OpenCV DNN rejects a batch
+
+    InferenceBackend backend_ = InferenceBackend::Auto;
+    ExecutionProvider provider_ = ExecutionProvider::CPU;
+    DnnTarget dnn_target_ = DnnTarget::CPU;
+    bool device_input_ = false;  // OpenCL target loaded
+    ModelPrecision precision_ = ModelPrecision::Auto;
+    ModelPrecision loaded_precision_ = ModelPrecision::FP32;
+    bool model_cache_ = true;
+    std::string model_cache_dir_;
+    bool onnx_arena_compact_ = false;
+    size_t onnx_arena_max_bytes_ = 0;
+
+    // Precisions to try in order, ending with FP32
+    std::vector<ModelPrecision> candidatePrecisions(bool onnx) const;
+
 #ifdef USE_ONNXRUNTIME
-    // ONNX Runtime backend (faster inference)
-    std::unique_ptr<Ort::Env> onnx_env_;
+    // ONNX Runtime backend (faster inference); the environment is process-wide
     std::unique_ptr<Ort::Session> onnx_session_;
     std::unique_ptr<Ort::SessionOptions> session_options_;
+
+    // Input and output tensors are bound once and wrap blob_ / onnx_output_,
+    // so Run() writes results in place without allocating
+    std::unique_ptr<Ort::IoBinding> io_binding_;
+    std::unique_ptr<Ort::Value> input_tensor_;
+    std::unique_ptr<Ort::Value> output_tensor_;
+    cv::Mat onnx_output_;
+    bool dynamic_output_ = false;  // Output shape unknown until Run()
+    std::string input_name_;
+    std::string output_name_;
+    const uchar* bound_input_data_ = nullptr;
+    int bound_batch_ = 0;
+
+    bool loadOnnxModel(const std::string& model_path);
+    std::unique_ptr<Ort::Session> createOnnxSession(const std::string& model_path);
+    std::unique_ptr<Ort::SessionOptions> makeSessionOptions(GraphOptimizationLevel level,
+                                                            const std::string& optimized_path,
+                                                            const std::string& engine_cache_dir) const;
+    void appendExecutionProvider(Ort::SessionOptions& options, const std::string& engine_cache_dir) const;
+    void bindOnnxInput();
+    void runOnnx();
 #endif
 
     bool use_onnx_ = false;
 
     // Post-processing
-    std::vector<DetectedObject> postprocess(
-        const std::vector<cv::Mat>& outputs,
-        const cv::Mat& image,
+    YoloPostprocessor postprocessor_;
+    NmsMode nms_mode_ = NmsMode::Agnostic;
+
+    // Letterbox images into a blob_ of `batch` items (padding repeats the last image)
+    void preprocess(std::span<const cv::Mat> images, int batch, std::span<const cv::UMat> device_images);
+    void preprocessDevice(std::span<const cv::Mat> images, int batch, std::span<const cv::UMat> device_images);
+
+    // Run the network on blob_ into outputs_. Bound to the loaded backend by
+    // loadModel(), so the per-frame path never branches on the backend.
+    bool (ObjectDetector::*forward_)() = nullptr;
+    bool forward() { return (this->*forward_)(); }
+    bool forwardDnn();
+    bool forwardDnnDevice();
+#ifdef USE_ONNXRUNTIME
+    bool forwardOnnx();
+#endif
+
+    // Decode one image's head output and map boxes back to the image
+    std::vector<ObjectResult> postprocess(
+        const cv::Mat& output,
+        const LetterboxTransform& letterbox,
+        cv::Size image_size,
         float conf_threshold,
         float nms_threshold
     );
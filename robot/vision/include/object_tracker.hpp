@@ -0,0 +1,140 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <opencv2/opencv.hpp>
+
+#include "object_detector.hpp"
+
+namespace navign::robot::vision {
+
+/**
+ * @brief Association and lifetime parameters of ObjectTracker
+ */
+struct TrackerConfig {
+    float high_threshold = 0.5f;   // Detections that may start a track
+    float low_threshold = 0.1f;    // Recovers occluded tracks in the second pass
+    double match_iou = 0.3;        // Minimum IoU between prediction and detection
+    int min_hits = 3;              // Matched detections before a track is reported
+    std::chrono::milliseconds max_age{1000};            // Coasting time before a track is dropped
+    std::chrono::milliseconds confidence_half_life{500};  // Decay of predicted confidence
+};
+
+/**
+ * @brief SORT / ByteTrack-style multi-object tracker for YOLO detections
+ *
+ * Every track runs an alpha-beta (constant velocity) filter on its box
+ * center and a smoothed box size. Detections are associated in two passes:
+ * confident detections against all tracks, then low-score detections
+ * against the tracks left unmatched, which keeps partially occluded
+ * objects alive without letting weak detections start new tracks. Boxes
+ * are only matched within the same class.
+ *
+ * Between detections, predict() extrapolates the tracks to any timestamp
+ * without changing their state, so predicted frames may be produced while
+ * a detection for an earlier frame is still in flight; update() ignores
+ * detections older than the last one applied.
+ *
+ * One instance per camera; not thread-safe.
+ */
+class ObjectTracker {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit ObjectTracker(const TrackerConfig& config = {}) : config_(config) {}
+
+    void setConfig(const TrackerConfig& config) { config_ = config; }
+    const TrackerConfig& getConfig() const { return config_; }
+
+    /**
+     * @brief Associate one frame's detections with the tracks
+     *
+     * On return objects holds the confirmed tracks matched in this frame,
+     * with stable object_id, smoothed confidence and velocity. World
+     * velocity is estimated when the detections carry world positions.
+     *
+     * @param objects Detections of the frame; replaced by the tracked objects
+     * @param timestamp Capture time of the frame
+     * @return false if the frame is older than the last update and was ignored
+     */
+    bool update(std::vector<ObjectResult>& objects, Clock::time_point timestamp);
+
+    /**
+     * @brief Extrapolate the confirmed tracks to a frame without detections
+     * @param timestamp Capture time of the frame
+     * @param objects Output, one entry per live confirmed track
+     */
+    void predict(Clock::time_point timestamp, std::vector<ObjectResult>& objects) const;
+
+    /**
+     * @brief Lowest predicted confidence over the confirmed tracks
+     *
+     * Decays with the time since each track was last matched; 1 when there
+     * are no tracks.
+     */
+    float predictionConfidence(Clock::time_point timestamp) const;
+
+    /**
+     * @brief True when prediction alone is not trustworthy
+     *
+     * Set before the first update, when the last update lost a confirmed
+     * track, while a new track still awaits confirmation, or when the
+     * predicted confidence fell below min_confidence.
+     */
+    bool needsDetection(Clock::time_point timestamp, float min_confidence) const;
+
+    void reset();
+
+    size_t trackCount() const { return tracks_.size(); }
+
+private:
+    struct Track {
+        uint32_t id = 0;
+        uint16_t class_id = ClassNames::kUnknown;
+
+        // Alpha-beta state in pixels and pixels per second
+        cv::Point2d center;
+        cv::Point2d velocity;
+        cv::Size2d size;
+
+        float score = 0.0f;
+        int hits = 0;
+        bool matched = false;  // Matched in the last update
+        Clock::time_point last_update;
+
+        // World-frame motion, from consecutive world positions
+        bool has_world = false;
+        bool has_world_velocity = false;
+        cv::Point3d world_position;
+        cv::Point3d world_velocity;
+        double distance_meters = 0.0;
+    };
+
+    TrackerConfig config_;
+    std::vector<Track> tracks_;
+    uint32_t next_id_ = 1;
+    bool initialized_ = false;
+    bool lost_confirmed_ = false;  // Last update coasted a confirmed track
+    Clock::time_point last_timestamp_;
+
+    // Reused association scratch
+    struct Candidate {
+        double iou;
+        int track;
+        int detection;
+    };
+    std::vector<Candidate> candidates_;
+    std::vector<int> detection_track_;
+    std::vector<cv::Rect2d> predicted_;
+    std::vector<ObjectResult> output_;
+
+    void associate(const std::vector<ObjectResult>& objects, bool high_pass);
+    void correct(Track& track, const ObjectResult& detection, Clock::time_point timestamp);
+    ObjectResult makeResult(const Track& track, double dt, float confidence) const;
+    float decayedScore(const Track& track, Clock::time_point timestamp) const;
+    bool confirmed(const Track& track) const { return track.hits >= config_.min_hits; }
+};
+
+} // namespace navign::robot::vision
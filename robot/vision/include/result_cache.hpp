@@ -0,0 +1,121 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace navign::robot::vision {
+
+/**
+ * @brief One published result, serialized once and shared by every reader
+ *
+ * Snapshots are immutable once published. The same bytes go out on the
+ * Zenoh topic and answer every request for the result, so a result is
+ * encoded once however many consumers read it.
+ */
+struct ResultSnapshot {
+    // Derived encodings kept per snapshot; further keys are computed uncached
+    static constexpr size_t kMaxDerived = 8;
+
+    uint64_t sequence = 0;   // Publish count of the stream, starting at 1
+    uint64_t frame_id = 0;   // Camera frame the result belongs to
+    uint32_t camera_id = 0;  // CameraSource
+    std::string bytes;       // Serialized response
+
+    /**
+     * @brief An encoding derived from this result (e.g. a filtered copy), built once per key
+     *
+     * Concurrent callers asking for the same key of the same frame wait for
+     * the first caller's result instead of computing it again.
+     *
+     * @param make Called as make(std::string& out) to build the encoding
+     * @param coalesced Set to true when an existing encoding was reused
+     */
+    template <typename Make>
+    std::shared_ptr<const std::string> derived(const std::string& key, Make&& make, bool* coalesced = nullptr) const {
+        std::lock_guard<std::mutex> lock(derived_mutex_);
+        for (const auto& [derived_key, encoding] : derived_) {
+            if (derived_key == key) {
+                if (coalesced) {
+                    *coalesced = true;
+                }
+                return encoding;
+            }
+        }
+
+        auto encoding = std::make_shared<std::string>();
+        make(*encoding);
+        if (derived_.size() < kMaxDerived) {
+            derived_.emplace_back(key, encoding);
+        }
+        if (coalesced) {
+            *coalesced = false;
+        }
+        return encoding;
+    }
+
+private:
+    mutable std::mutex derived_mutex_;
+    mutable std::vector<std::pair<std::string, std::shared_ptr<const std::string>>> derived_;
+};
+
+using ResultSnapshotPtr = std::shared_ptr<const ResultSnapshot>;
+
+/**
+ * @brief Latest snapshot of one result stream, with RCU-style reads
+ *
+ * A single writer (the publish thread) builds a new snapshot and swaps it
+ * in; readers take a reference to whichever snapshot is current and keep it
+ * alive for as long as they use it. The old snapshot is freed when its last
+ * reader lets go.
+ *
+ * The swap goes through std::atomic<std::shared_ptr>, which is not
+ * lock-free: libstdc++ guards the pointer with a spin lock held only while
+ * the reference count is bumped. Readers therefore never wait for a
+ * snapshot to be built or serialized, only for another thread's pointer
+ * copy, and never block on the publish thread's other work.
+ */
+class LatestResult {
+public:
+    /**
+     * @brief Publish a new snapshot (single writer)
+     */
+    ResultSnapshotPtr publish(uint64_t frame_id, uint32_t camera_id, std::string bytes) {
+        auto snapshot = std::make_shared<ResultSnapshot>();
+        snapshot->sequence = ++published_;
+        snapshot->frame_id = frame_id;
+        snapshot->camera_id = camera_id;
+        snapshot->bytes = std::move(bytes);
+
+        ResultSnapshotPtr published = std::move(snapshot);
+        current_.store(published, std::memory_order_release);
+        return published;
+    }
+
+    /**
+     * @brief Current snapshot, or nullptr before the first publish
+     */
+    ResultSnapshotPtr load() const { return current_.load(std::memory_order_acquire); }
+
+    /**
+     * @brief Sequence of the current snapshot (0 before the first publish)
+     *
+     * Read from the snapshot itself, so it always matches what load()
+     * returns at that moment.
+     */
+    uint64_t sequence() const {
+        const auto snapshot = load();
+        return snapshot ? snapshot->sequence : 0;
+    }
+
+private:
+    std::atomic<ResultSnapshotPtr> current_;
+    uint64_t published_ = 0;  // Only touched by the writer
+};
+
+} // namespace navign::robot::vision
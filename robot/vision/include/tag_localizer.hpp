@@ -0,0 +1,100 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <opencv2/opencv.hpp>
+
+#include "apriltag_detector.hpp"
+
+namespace navign::robot::vision {
+
+/**
+ * @brief Camera pose in the world frame estimated from mapped tags
+ *
+ * Same convention as CoordinateTransform::setCameraPose():
+ * X_world = rotation * X_camera + position.
+ */
+struct CameraPoseEstimate {
+    bool valid = false;
+    cv::Matx33d rotation = cv::Matx33d::eye();  // Camera to world
+    cv::Vec3d position{0.0, 0.0, 0.0};          // Camera origin in world
+    int tags_used = 0;
+    double reprojection_error_px = 0.0;         // RMS over all corners
+};
+
+/**
+ * @brief Localizes a camera against a map of surveyed tag poses
+ *
+ * The corners of every visible mapped tag go into one joint PnP solve.
+ * When the previous frame was localized, its pose seeds an iterative
+ * refinement, which is far cheaper and more stable than solving from
+ * scratch; a fresh solve is used when there is no recent pose or the
+ * refinement does not fit the corners.
+ *
+ * Map file (YAML / JSON, cv::FileStorage):
+ *
+ *   tag_size: 0.16            # Default edge length in meters
+ *   tags:
+ *     - { id: 0, position: [x, y, z], quaternion: [w, x, y, z] }
+ *     - { id: 7, position: [x, y, z], rotation: [r00, r01, ..., r22], size: 0.2 }
+ *
+ * A tag pose maps tag coordinates (apriltag convention: x right, y down,
+ * z into the tag) to world coordinates. One instance per camera; not
+ * thread-safe.
+ */
+class TagLocalizer {
+public:
+    /**
+     * @brief Load surveyed tag poses
+     * @return true if at least one tag was loaded
+     */
+    bool loadMap(const std::string& filename);
+
+    /**
+     * @brief Camera intrinsics used for the PnP solve
+     */
+    void setCalibration(const cv::Mat& camera_matrix, const cv::Mat& dist_coeffs);
+
+    /**
+     * @brief Estimate the camera pose from this frame's tags
+     * @return Estimate; invalid when no mapped tag is visible or the solve fails
+     */
+    const CameraPoseEstimate& localize(std::span<const AprilTagResult> tags);
+
+    /**
+     * @brief Forget the previous pose, so the next solve starts from scratch
+     */
+    void reset();
+
+    bool hasMap() const { return !map_.empty(); }
+    size_t mapSize() const { return map_.size(); }
+    const CameraPoseEstimate& lastEstimate() const { return estimate_; }
+
+private:
+    // Tag corners in world coordinates, in apriltag corner order
+    std::unordered_map<uint32_t, std::array<cv::Point3d, 4>> map_;
+
+    cv::Mat camera_matrix_;
+    cv::Mat dist_coeffs_;
+
+    // Reused solve inputs
+    std::vector<cv::Point3d> object_points_;
+    std::vector<cv::Point2d> image_points_;
+    std::vector<cv::Point2d> projected_;
+
+    // World to camera from the last successful solve
+    cv::Mat rvec_;
+    cv::Mat tvec_;
+    int frames_since_solve_ = -1;  // -1: no previous pose
+
+    CameraPoseEstimate estimate_;
+
+    bool solve(bool warm_start);
+    double reprojectionError();
+};
+
+} // namespace navign::robot::vision
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <opencv2/opencv.hpp>
+
+namespace navign::robot::vision {
+
+/**
+ * @brief Precomputed undistortion tables for one calibration
+ *
+ * Holds the fixed-point (CV_16SC2 + CV_16UC1) remap tables produced by
+ * cv::initUndistortRectifyMap for image undistortion, and a per-pixel table
+ * of undistorted normalized camera coordinates (CV_32FC2) for point
+ * unprojection. Both turn per-call distortion math into table lookups.
+ *
+ * Immutable once built, so one instance can be shared between threads.
+ */
+class UndistortionLut {
+public:
+    /**
+     * @brief Build tables for a calibration
+     * @param camera_matrix 3x3 intrinsic matrix
+     * @param dist_coeffs Distortion coefficients
+     * @param image_size Image size the tables cover
+     */
+    static std::shared_ptr<UndistortionLut> build(
+        const cv::Mat& camera_matrix,
+        const cv::Mat& dist_coeffs,
+        cv::Size image_size
+    );
+
+    /**
+     * @brief Load tables persisted by save()
+     * @return Tables, or nullptr if the file is missing or was built for a
+     *         different calibration
+     */
+    static std::shared_ptr<UndistortionLut> load(
+        const std::string& filename,
+        const cv::Mat& camera_matrix,
+        const cv::Mat& dist_coeffs,
+        cv::Size image_size
+    );
+
+    /**
+     * @brief Persist tables (raw binary, keyed by the calibration)
+     */
+    bool save(const std::string& filename) const;
+
+    /**
+     * @brief Undistort an image with the cached remap tables
+     * @param image Input image, must match imageSize()
+     * @param undistorted Output (reused if already allocated)
+     */
+    void undistort(const cv::Mat& image, cv::Mat& undistorted) const;
+
+    /**
+     * @brief Undistort on the OpenCL device
+     *
+     * The remap tables are uploaded on the first call and stay on the device.
+     */
+    void undistort(const cv::UMat& image, cv::UMat& undistorted) const;
+
+    /**
+     * @brief Look up the undistorted normalized coordinates of a pixel
+     *
+     * Bilinearly interpolates the ray table at sub-pixel positions.
+     *
+     * @param image_point Distorted pixel coordinates
+     * @param normalized Output (x, y) on the z = 1 plane
+     * @return false if the point lies outside the table
+     */
+    bool lookup(const cv::Point2f& image_point, cv::Point2d& normalized) const;
+
+    cv::Size imageSize() const { return image_size_; }
+
+    /**
+     * @brief Host memory held by the tables
+     */
+    size_t bytes() const {
+        return map1_.total() * map1_.elemSize() + map2_.total() * map2_.elemSize() +
+               ray_lut_.total() * ray_lut_.elemSize();
+    }
+
+private:
+    cv::Size image_size_;
+    cv::Mat camera_matrix_;  // CV_64F copies identifying the calibration
+    cv::Mat dist_coeffs_;
+
+    cv::Mat map1_;     // CV_16SC2 integer coordinates
+    cv::Mat map2_;     // CV_16UC1 interpolation weights
+    cv::Mat ray_lut_;  // CV_32FC2 normalized (x, y) per pixel
+
+    // Device copies of map1_ / map2_, uploaded once on first use
+    mutable std::once_flag device_maps_once_;
+    mutable cv::UMat device_map1_;
+    mutable cv::UMat device_map2_;
+
+    bool matches(const cv::Mat& camera_matrix, const cv::Mat& dist_coeffs, cv::Size image_size) const;
+};
+
+} // namespace navign::robot::vision
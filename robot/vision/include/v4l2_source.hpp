@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <opencv2/opencv.hpp>
+
+#include "frame_source.hpp"
+
+namespace navign::robot::vision {
+
+/**
+ * @brief Live camera through native V4L2 mmap streaming
+ *
+ * Frames are dequeued from driver-allocated buffers mapped into the
+ * process, so nothing is copied before conversion. With YUYV and NV12
+ * the luma plane is the gray image: it is copied into frame.gray as is,
+ * and the BGR conversion runs only when color output is enabled (YOLO,
+ * recording or frame publishing). MJPEG frames are decoded in software;
+ * decoding straight to gray skips chroma entirely. For hardware JPEG
+ * decode use GStreamerSource.
+ *
+ * capture_time is the driver's monotonic buffer timestamp, taken when the
+ * frame was captured rather than when the capture thread got to it.
+ * Only single-planar capture devices are supported.
+ */
+class V4L2Source : public FrameSource {
+public:
+    static constexpr unsigned kBufferCount = 4;
+
+    V4L2Source() = default;
+    ~V4L2Source() override;
+
+    V4L2Source(const V4L2Source&) = delete;
+    V4L2Source& operator=(const V4L2Source&) = delete;
+
+    /**
+     * @brief Open /dev/video<device>, negotiate a format and start streaming
+     *
+     * frameSize() reports what the driver actually delivers.
+     */
+    bool open(int device, cv::Size size, int fps, CapturePixelFormat format = CapturePixelFormat::Auto);
+
+    bool isOpened() const override { return fd_ >= 0; }
+    cv::Size frameSize() const override { return frame_size_; }
+    bool read(Frame& frame) override;
+    void skip() override;
+    void release() override;
+    bool providesGray() const override { return true; }
+    void setColorOutput(bool enabled) override { color_output_ = enabled; }
+    std::string describe() const override;
+
+    /**
+     * @brief Negotiated format (never Auto once open)
+     */
+    CapturePixelFormat pixelFormat() const { return format_; }
+
+private:
+    struct Buffer {
+        void* start = nullptr;
+        size_t length = 0;
+    };
+
+    int fd_ = -1;
+    int device_ = -1;
+    std::vector<Buffer> buffers_;
+    bool streaming_ = false;
+
+    cv::Size frame_size_;
+    CapturePixelFormat format_ = CapturePixelFormat::Auto;
+    uint32_t bytes_per_line_ = 0;
+    bool color_output_ = true;
+
+    bool setFormat(CapturePixelFormat format, cv::Size size);
+    bool startStreaming();
+    bool convert(const uint8_t* data, size_t size, Frame& frame);
+};
+
+} // namespace navign::robot::vision
@@ -1,29 +1,73 @@
 #pragma once
 
+#include <algorithm>
 #include <atomic>
+#include <chrono>
 #include <memory>
+#include <mutex>
+#include <string>
 #include <thread>
+#include <vector>
 #include <opencv2/opencv.hpp>
 
+#include "apriltag_filter.hpp"
+#include "apriltag_pose_method.hpp"
+#include "bounded_queue.hpp"
+#include "fair_queue.hpp"
+#include "frame.hpp"
+#include "frame_recording.hpp"
+#include "frame_scheduler.hpp"
+#include "inference_backend.hpp"
+#include "latency_histogram.hpp"
+#include "object_tracker.hpp"
+#include "result_cache.hpp"
+
 // Forward declarations
 namespace navign::robot::vision {
     class AprilTagDetector;
     class ObjectDetector;
     class CameraCalibration;
     class CoordinateTransform;
+    class FramePool;
+    class InferenceScheduler;
+    class MetricsServer;
+    class ZenohPublisher;
+    class ZenohQuery;
+    struct CameraContext;
+    struct DetectionBatch;
+    class DetectionBatchPool;
+    struct PublishMessages;
+    struct RequestWorker;
+    struct RpcRequest;
+    struct StreamRates;
+    enum class VisionRpc;
 }
 
 namespace navign::robot::vision {
 
+/**
+ * @brief One camera handled by the vision service
+ */
+struct CameraConfig {
+    int device_index = 0;
+    uint32_t camera_id = 1;  // CameraSource: 1 = primary, 2 = secondary, 3 = depth
+    std::string calibration_file = "calibration.yml";
+    double floor_z = 0.0;  // Height of the floor plane in the world frame (meters)
+    std::string replay_file;  // Replay this recording instead of opening the device
+    std::string record_file;  // Record captured frames here (FrameRecorder format)
+};
+
 /**
  * @brief Main vision service for robot perception
  *
  * Provides:
+ * - Capture from one or more cameras, each with its own calibration
  * - AprilTag detection and pose estimation
  * - YOLO-based object detection
  * - MediaPipe hand tracking (optional)
  * - Camera calibration
  * - 2D-3D coordinate transformation
+ * - The proto's request/response RPCs as Zenoh queryables (robot/vision/rpc/...)
  */
 class VisionService {
 public:
@@ -36,47 +80,357 @@ public:
     bool isRunning() const { return running_.load(); }
 
     // Configuration
-    void setCameraIndex(int index) { camera_index_ = index; }
+    void setCameraIndex(int index) { camera_index_ = index; }  // Used when no camera is added
+    void setFloorHeight(double z) { floor_z_ = z; }           // Used when no camera is added
+    void setReplayFile(const std::string& file) { replay_file_ = file; }  // Used when no camera is added
+    void setRecordFile(const std::string& file) { record_file_ = file; }  // Used when no camera is added
+
+    /**
+     * @brief How recordings given in CameraConfig::replay_file are played back
+     * @param loop Start over at the end instead of finishing the capture
+     */
+    void setReplayOptions(ReplayPacing pacing, bool loop = false) {
+        replay_pacing_ = pacing;
+        replay_loop_ = loop;
+    }
+    void setRecordingCodec(RecordingCodec codec, int jpeg_quality = 90) {
+        recording_codec_ = codec;
+        recording_jpeg_quality_ = jpeg_quality;
+    }
+
+    /**
+     * @brief How live cameras are opened
+     * @param jpeg_decoder GStreamer element decoding MJPEG, e.g. nvjpegdec
+     */
+    void setCaptureBackend(CaptureBackend backend, CapturePixelFormat format = CapturePixelFormat::Auto,
+                           const std::string& jpeg_decoder = "jpegdec") {
+        capture_backend_ = backend;
+        capture_format_ = format;
+        capture_jpeg_decoder_ = jpeg_decoder;
+    }
+
+    /**
+     * @brief True once every camera's source has ended (finite replays)
+     */
+    bool isCaptureFinished() const;
+
+    /**
+     * @brief Add a camera source with its own capture thread and calibration
+     *
+     * Frames from all cameras share the detector workers, which serve the
+     * cameras round-robin.
+     */
+    void addCamera(const CameraConfig& config) { camera_configs_.push_back(config); }
+
+    /**
+     * @brief Number of detector worker threads, each with its own detector
+     */
+    void setWorkerCounts(int apriltag_workers, int object_workers);
+
     void setFrameRate(int fps) { target_fps_ = fps; }
     void setAprilTagSize(double size_meters) { apriltag_size_ = size_meters; }
+    void setExecutionProvider(ExecutionProvider provider) { execution_provider_ = provider; }
+    void setModelPrecision(ModelPrecision precision) { model_precision_ = precision; }
+
+    /**
+     * @brief Run YOLO on OpenCV DNN on this device (default: CPU, ONNX Runtime when built)
+     *
+     * Any target but CPU selects the OpenCV DNN backend. With OpenCL, sources
+     * without a native gray plane upload each frame once at capture and
+     * convert it to gray on the device, and YOLO reuses the upload.
+     */
+    void setDnnTarget(DnnTarget target) { dnn_target_ = target; }
+
+    /**
+     * @brief Reuse the optimized YOLO model across restarts (see ObjectDetector::setModelCache)
+     */
+    void setModelCache(bool enabled, const std::string& dir = "") {
+        model_cache_ = enabled;
+        model_cache_dir_ = dir;
+    }
+
+    /**
+     * @brief Run within a memory budget on small robots (0 = no budget)
+     *
+     * Low-memory mode pools fewer frames per camera, limits malloc to two
+     * arenas, runs ONNX Runtime with compact arenas, drops OpenCL's reserved
+     * buffer pool and hands freed heap back to the kernel after every status
+     * report. The status report warns when the resident set exceeds the budget.
+     */
+    void setMemoryBudget(size_t bytes) { memory_budget_ = bytes; }
+
+    /**
+     * @brief Cap ONNX Runtime's arena (0 = no cap, see ObjectDetector::setOnnxArena)
+     */
+    void setOnnxArenaLimit(size_t bytes) { onnx_arena_limit_ = bytes; }
+
+    void setAprilTagTracking(bool enabled, int rescan_interval = 10) {
+        apriltag_tracking_ = enabled;
+        apriltag_rescan_interval_ = rescan_interval;
+    }
+    void setAprilTagAdaptive(bool enabled) { apriltag_adaptive_ = enabled; }
+    void setAprilTagFamily(const std::string& family) { apriltag_family_ = family; }
+    void setAprilTagPoseMethod(AprilTagPoseMethod method) { apriltag_pose_method_ = method; }
+
+    /**
+     * @brief Restrict AprilTag candidates to the deployed tags
+     * @param prune_family Decode only the whitelisted codes
+     */
+    void setAprilTagFilter(const AprilTagFilter& filter, bool prune_family = false) {
+        apriltag_filter_ = filter;
+        apriltag_prune_family_ = prune_family;
+    }
+
+    /**
+     * @brief Batch YOLO inference across frames and cameras
+     * @param max_batch Frames per forward pass (1 disables batching)
+     * @param latency_budget Longest a frame waits for its batch to fill
+     */
+    void setObjectBatching(int max_batch, std::chrono::microseconds latency_budget) {
+        object_max_batch_ = static_cast<size_t>(std::max(1, max_batch));
+        object_batch_budget_ = latency_budget;
+    }
+
+    /**
+     * @brief Track objects across frames, optionally running YOLO only every few frames
+     *
+     * Tracked objects keep their object_id across frames and carry a
+     * velocity. With detect_interval K > 1 YOLO runs on every K-th frame of
+     * a camera, or sooner when the tracker loses an object or its predicted
+     * confidence drops below min_confidence; the frames in between are
+     * published from the tracker's motion prediction.
+     */
+    void setObjectTracking(bool enabled, int detect_interval = 1, float min_confidence = 0.3f) {
+        object_tracking_ = enabled;
+        object_detect_interval_ = std::max(1, detect_interval);
+        object_track_min_confidence_ = min_confidence;
+    }
 
-    // Component access (for testing)
-    AprilTagDetector* getAprilTagDetector() { return apriltag_detector_.get(); }
-    ObjectDetector* getObjectDetector() { return object_detector_.get(); }
-    CameraCalibration* getCameraCalibration() { return camera_calibration_.get(); }
+    /**
+     * @brief How each camera sheds work when its frames fall behind
+     *
+     * Unpaced sources are paced on the set frame rate's grid. object_fps
+     * runs YOLO on a lower-rate grid of capture timestamps (0 = every
+     * frame), on top of any tracking detect interval. A result misses its
+     * deadline when it is published more than deadline after capture (0 =
+     * one frame period; YOLO gets at least its own period). Lossless
+     * replays never shed.
+     */
+    void setLoadShedding(LoadShedding shedding, int object_fps = 0,
+                         std::chrono::milliseconds deadline = std::chrono::milliseconds(0)) {
+        load_shedding_ = shedding;
+        object_fps_ = std::max(0, object_fps);
+        frame_deadline_ = deadline;
+    }
+
+    /**
+     * @brief Real-time priority and CPU sets of the capture and detector threads
+     */
+    void setThreadTuning(const ThreadTuning& tuning) { thread_tuning_ = tuning; }
+
+    void setMetricsPort(int port) { metrics_port_ = port; }  // 0 disables the endpoint
+    void setZenohConfig(const std::string& config_file) { zenoh_config_ = config_file; }
+    void setZenohSharedMemory(bool enabled) { zenoh_shared_memory_ = enabled; }
+    void setPublishFrames(bool enabled) { publish_frames_ = enabled; }  // Raw BGR on robot/vision/frames
+
+    /**
+     * @brief Threads decoding and detecting request images (0 disables the RPC queryables)
+     *
+     * Requests carrying image_data run on these workers, each with its own
+     * detectors, never on the live pipeline's. Requests without an image
+     * are answered from the latest live result on the Zenoh thread.
+     */
+    void setRequestWorkers(int workers) { request_worker_count_ = static_cast<size_t>(std::max(0, workers)); }
+
+    /**
+     * @brief Localize every camera against a map of surveyed tag poses
+     *
+     * Each frame's tags feed a joint PnP solve whose result becomes the
+     * camera pose of that camera's CoordinateTransform, and is published
+     * on robot/vision/camera_pose.
+     */
+    void setTagMap(const std::string& map_file) { tag_map_file_ = map_file; }
+
+    /**
+     * @brief Render counters and per-stage latency in Prometheus text format
+     */
+    std::string renderPrometheusMetrics() const;
+
+    /**
+     * @brief Per-stage latency histograms (merged across pipeline threads)
+     */
+    const LatencyMetrics& getLatencyMetrics() const { return latency_metrics_; }
+
+    /**
+     * @brief Latest published result of a camera, as a serialized response
+     *
+     * The snapshot stays valid for as long as it is held, however many
+     * frames are published meanwhile. nullptr for an unknown camera or
+     * before its first result; results are cached while Zenoh is open.
+     */
+    ResultSnapshotPtr getLatestAprilTags(uint32_t camera_id) const;
+    ResultSnapshotPtr getLatestObjects(uint32_t camera_id) const;
+
+    // Component access (for testing); nullptr when out of range or not built
+    AprilTagDetector* getAprilTagDetector(size_t worker = 0);
+    ObjectDetector* getObjectDetector(size_t worker = 0);
+    CameraCalibration* getCameraCalibration(size_t camera = 0);
 
 private:
-    // Processing loop
-    void processingLoop();
+    // Pipeline stages, each running on its own thread(s):
+    // capture (one per camera) -> (AprilTag workers, YOLO workers) -> publish
+    void captureLoop(CameraContext& camera);
+    void aprilTagLoop(size_t worker);
+#ifdef USE_OBJECT_DETECTION
+    void objectLoop(size_t worker);
+#endif
+    void publishLoop();
+
+    // Constant false in AprilTag-only builds, so the object paths fold away
+    bool objectDetectionEnabled() const {
+        return kObjectDetectionBuilt && object_detection_enabled_.load(std::memory_order_acquire);
+    }
+    bool wantsColorOutput(const CameraContext& camera) const;
+
+#ifdef USE_OBJECT_DETECTION
+    // Runs on model_thread_ during start(), in parallel with camera open;
+    // object workers start when it finishes, so AprilTag never waits for it
+    void loadObjectModels(std::chrono::steady_clock::time_point start_time);
+    void startObjectWorkers();  // Under object_start_mutex_
+    void configureObjectDetector(ObjectDetector& detector) const;
+#endif
+    void waitForObjectModels();
+
+    // Serve a frame from the camera's tracker instead of YOLO, if due
+    bool predictObjects(CameraContext& camera, const FramePtr& frame, LatencyMetrics::ThreadRecorder& latency);
+
+    bool openCamera(CameraContext& camera);
 
     // Zenoh messaging
     bool initializeZenoh();
-    void publishAprilTags();
-    void publishObjects();
+    void publishAprilTags(const DetectionBatch& batch);
+    void publishObjects(const DetectionBatch& batch);
+    void publishFrame(const Frame& frame);
+    void publishCameraPose(const DetectionBatch& batch);
     void publishStatus();
+    void forwardToStreams(const DetectionBatch& batch, const std::shared_ptr<const std::string>& update);
+
+    // Request/response queries: cheap ones are answered on the Zenoh thread,
+    // requests with an image are queued to the request workers
+    void declareQueryables();
+    void requestLoop(size_t worker);
+    void handleQuery(VisionRpc rpc, std::unique_ptr<ZenohQuery> query);
+    void detectAprilTags(RpcRequest& request, RequestWorker& worker);
+    void detectObjects(RpcRequest& request, RequestWorker& worker);
+    CameraContext* findCamera(uint32_t camera_id) const;
+
+    // Zenoh session and per-topic messages reused for every publish
+    std::unique_ptr<ZenohPublisher> zenoh_;
+    std::unique_ptr<PublishMessages> messages_;
+    std::string zenoh_config_;
+    bool zenoh_shared_memory_ = false;
+    bool publish_frames_ = false;
+    std::string tag_map_file_;
+
+    // Request workers and their queue (drop oldest; dropped queries get an error reply)
+    size_t request_worker_count_ = 1;
+    std::vector<std::unique_ptr<RequestWorker>> request_workers_;
+    std::vector<std::thread> request_threads_;
+    BoundedQueue<std::shared_ptr<RpcRequest>> request_queue_;
+    std::unique_ptr<StreamRates> stream_rates_;
 
-    // Camera
-    cv::VideoCapture camera_;
+    // Latest serialized StatusResponse for GetComponentStatus
+    LatestResult latest_status_;
+    std::atomic<uint64_t> result_cache_hits_{0};       // Requests answered from a cached result
+    std::atomic<uint64_t> result_cache_coalesced_{0};  // Filtered requests that reused a copy
+
+    // Cameras
+    std::vector<CameraConfig> camera_configs_;
+    std::vector<std::unique_ptr<CameraContext>> cameras_;
     int camera_index_ = 0;
+    double floor_z_ = 0.0;
+    std::string replay_file_;
+    std::string record_file_;
+    ReplayPacing replay_pacing_ = ReplayPacing::Realtime;
+    bool replay_loop_ = false;
+    RecordingCodec recording_codec_ = RecordingCodec::Mjpeg;
+    int recording_jpeg_quality_ = 90;
+    CaptureBackend capture_backend_ = CaptureBackend::OpenCV;
+    CapturePixelFormat capture_format_ = CapturePixelFormat::Auto;
+    std::string capture_jpeg_decoder_ = "jpegdec";
     int target_fps_ = 30;
+    LoadShedding load_shedding_ = LoadShedding::Objects;
+    int object_fps_ = 0;
+    std::chrono::milliseconds frame_deadline_{0};
+    ThreadTuning thread_tuning_;
+    ExecutionProvider execution_provider_ = ExecutionProvider::CPU;
+    ModelPrecision model_precision_ = ModelPrecision::Auto;
+    DnnTarget dnn_target_ = DnnTarget::CPU;
 
-    // Components
-    std::unique_ptr<AprilTagDetector> apriltag_detector_;
-    std::unique_ptr<ObjectDetector> object_detector_;
-    std::unique_ptr<CameraCalibration> camera_calibration_;
-    std::unique_ptr<CoordinateTransform> coordinate_transform_;
+    // Components, one detector per worker (apriltag_detector_t is not reentrant)
+    size_t apriltag_worker_count_ = 1;
+    size_t object_worker_count_ = 1;
+    std::vector<std::unique_ptr<AprilTagDetector>> apriltag_detectors_;
+#ifdef USE_OBJECT_DETECTION
+    std::vector<std::unique_ptr<ObjectDetector>> object_detectors_;
+    std::vector<std::unique_ptr<InferenceScheduler>> inference_schedulers_;  // One per object worker
+#endif
+    size_t object_max_batch_ = 1;
+    std::chrono::microseconds object_batch_budget_{0};
+    std::atomic<bool> object_detection_enabled_{false};  // Object workers running
+    std::atomic<bool> object_models_loading_{false};
+    std::atomic<bool> device_frames_{false};  // Capture uploads frames for YOLO on OpenCL
+#ifdef USE_OBJECT_DETECTION
+    std::thread model_thread_;
+    std::mutex object_start_mutex_;
+    bool object_models_loaded_ = false;
+#endif
+    bool model_cache_ = true;
+    std::string model_cache_dir_;
+    size_t memory_budget_ = 0;
+    size_t onnx_arena_limit_ = 0;
+    bool object_tracking_ = false;
+    int object_detect_interval_ = 1;
+    float object_track_min_confidence_ = 0.3f;
+    TrackerConfig object_tracker_config_;
     // TODO: Add hand_tracker_ when MediaPipe C++ is implemented
 
+    // Stage queues (drop oldest when full); detector queues hold one lane per camera
+    FairQueue<FramePtr> apriltag_queue_;
+    FairQueue<FramePtr> object_queue_;
+    BoundedQueue<std::shared_ptr<DetectionBatch>> publish_queue_;
+    std::unique_ptr<DetectionBatchPool> batch_pool_;  // Per-frame results, recycled after publish
+
     // State
     std::atomic<bool> running_{false};
-    std::thread processing_thread_;
-    uint32_t frame_count_ = 0;
+    std::vector<std::thread> apriltag_threads_;
+    std::vector<std::thread> object_threads_;
+    std::thread publish_thread_;
     double apriltag_size_ = 0.015;  // 15mm default
+    bool apriltag_tracking_ = false;
+    int apriltag_rescan_interval_ = 10;
+    bool apriltag_adaptive_ = false;
+    std::string apriltag_family_ = "tag36h11";
+    AprilTagFilter apriltag_filter_;
+    bool apriltag_prune_family_ = false;
+    AprilTagPoseMethod apriltag_pose_method_ = AprilTagPoseMethod::OrthogonalIteration;
 
     // Metrics
-    uint32_t total_frames_processed_ = 0;
-    uint32_t total_tags_detected_ = 0;
-    uint32_t total_objects_detected_ = 0;
+    std::atomic<uint32_t> total_frames_processed_{0};
+    std::atomic<uint32_t> total_tags_detected_{0};
+    std::atomic<uint32_t> total_objects_detected_{0};
+    std::atomic<uint64_t> object_batches_run_{0};
+    std::atomic<uint64_t> object_frames_batched_{0};
+    std::atomic<uint64_t> object_frames_predicted_{0};
+
+    // Per-stage latency, one recorder per pipeline thread
+    LatencyMetrics latency_metrics_;
+    int metrics_port_ = 0;
+    std::unique_ptr<MetricsServer> metrics_server_;
+
+    // Frame rate over the last status interval (publish thread only)
+    std::chrono::steady_clock::time_point last_status_time_;
+    uint32_t last_status_frames_ = 0;
 };
 
 } // namespace navign::robot::vision
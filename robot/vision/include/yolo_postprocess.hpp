@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <opencv2/opencv.hpp>
+
+namespace navign::robot::vision {
+
+/**
+ * @brief Non-maximum suppression strategy
+ */
+enum class NmsMode {
+    Agnostic,    // One pass over all classes (cv::dnn::NMSBoxes)
+    ClassAware,  // Greedy NMS that only suppresses boxes of the same class
+    Batched,     // Class-aware via per-class coordinate offsets, single NMS pass
+};
+
+/**
+ * @brief Decoder and NMS for YOLOv8 detection heads
+ *
+ * Accepts both the native export layout [1, 4 + C, N] (e.g. [1, 84, 8400])
+ * and the transposed [1, N, 4 + C]. Class scores are processed as a
+ * structure of arrays, one contiguous row per class, so the per-anchor
+ * argmax and threshold run as SIMD passes (AVX2 / NEON, scalar fallback).
+ * All scratch buffers are kept between calls; a single instance must not be
+ * used from several threads at once.
+ */
+class YoloPostprocessor {
+public:
+    /**
+     * @brief Decode candidates above the confidence threshold
+     * @param output Raw head output (2D or 3D float tensor)
+     * @param conf_threshold Minimum class score
+     * @return Number of candidates kept
+     */
+    size_t decode(const cv::Mat& output, float conf_threshold);
+
+    /**
+     * @brief Run NMS over the decoded candidates
+     * @return Indices into boxes()/scores()/classIds() of the kept candidates
+     */
+    const std::vector<int>& suppress(float conf_threshold, float nms_threshold, NmsMode mode);
+
+    // Candidates in model input coordinates
+    const std::vector<cv::Rect2d>& boxes() const { return boxes_; }
+    const std::vector<float>& scores() const { return scores_; }
+    const std::vector<int>& classIds() const { return class_ids_; }
+
+private:
+    // SoA view of the head output: row r holds channel r for every anchor
+    cv::Mat transposed_;
+
+    // Per-anchor scratch
+    std::vector<float> best_score_;
+    std::vector<int32_t> best_class_;
+
+    // Candidates
+    std::vector<cv::Rect2d> boxes_;
+    std::vector<float> scores_;
+    std::vector<int> class_ids_;
+
+    // NMS scratch
+    std::vector<int> order_;
+    std::vector<int> keep_;
+    std::vector<cv::Rect2d> offset_boxes_;
+
+    void greedyClassAware(float nms_threshold);
+};
+
+} // namespace navign::robot::vision
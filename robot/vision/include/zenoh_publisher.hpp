@@ -0,0 +1,205 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+#ifdef USE_ZENOH
+#include <zenoh.hxx>
+#endif
+
+namespace google::protobuf {
+class MessageLite;
+}
+
+namespace navign::robot::vision {
+
+/**
+ * @brief Key expressions published by the vision service
+ */
+enum class VisionTopic {
+    AprilTags,  // robot/vision/apriltags - AprilTagResponse
+    Objects,    // robot/vision/objects   - ObjectDetectionResponse
+    Updates,    // robot/vision/updates   - VisionUpdate (detections)
+    Frames,     // robot/vision/frames    - Raw image bytes, layout in the encoding
+    Status,     // robot/vision/status    - StatusResponse (metrics and cameras)
+    CameraPose, // robot/vision/camera_pose - CameraExtrinsics (tag map localization)
+    Count,
+};
+
+const char* visionTopicKey(VisionTopic topic);
+
+/**
+ * @brief Request/response methods of the proto's VisionService, served as queryables
+ */
+enum class VisionRpc {
+    DetectAprilTags,       // robot/vision/rpc/detect_apriltags       - AprilTagRequest -> AprilTagResponse
+    DetectObjects,         // robot/vision/rpc/detect_objects         - ObjectDetectionRequest -> ObjectDetectionResponse
+    GetCameraCalibration,  // robot/vision/rpc/get_camera_calibration - CalibrationRequest -> CalibrationResponse
+    StreamVisionData,      // robot/vision/rpc/stream_vision_data     - VisionStreamRequest -> VisionUpdate
+    TransformCoordinates,  // robot/vision/rpc/transform_coordinates  - CoordinateTransformRequest -> CoordinateTransformResponse
+    GetComponentStatus,    // robot/vision/rpc/get_component_status   - StatusRequest -> StatusResponse
+    Count,
+};
+
+const char* visionRpcKey(VisionRpc rpc);
+
+/**
+ * @brief A query received by a queryable, answered at most once from any thread
+ *
+ * The request payload and attachment are copied out of Zenoh's callback, so
+ * the query can be handed to a worker and answered later. Destroying an
+ * unanswered query replies with an error, so callers never wait out their
+ * timeout.
+ */
+class ZenohQuery {
+public:
+    ~ZenohQuery();
+
+    ZenohQuery(const ZenohQuery&) = delete;
+    ZenohQuery& operator=(const ZenohQuery&) = delete;
+
+    const std::vector<uint8_t>& payload() const { return payload_; }
+    const std::string& attachment() const { return attachment_; }  // e.g. "width=640;height=480"
+
+    /**
+     * @brief Reply with a protobuf message and finish the query
+     */
+    bool reply(const google::protobuf::MessageLite& message, const std::string& attachment = {});
+
+    /**
+     * @brief Reply with an already serialized protobuf message, without copying it
+     */
+    bool replyBytes(std::shared_ptr<const std::string> bytes, const std::string& attachment = {});
+
+    /**
+     * @brief Reply with an error string instead of a message
+     */
+    bool replyError(const std::string& message);
+
+    bool answered() const { return answered_; }
+
+private:
+    friend class ZenohPublisher;
+    ZenohQuery() = default;
+
+    std::vector<uint8_t> payload_;
+    std::string attachment_;
+    bool answered_ = false;
+#ifdef USE_ZENOH
+    std::optional<zenoh::Query> query_;
+#endif
+};
+
+/**
+ * @brief Called on a Zenoh thread for every query; must not block
+ */
+using QueryHandler = std::function<void(std::unique_ptr<ZenohQuery>)>;
+
+/**
+ * @brief Zenoh session with one declared publisher per vision topic
+ *
+ * Messages are serialized straight into their outgoing payload: a block
+ * from a POSIX shared-memory provider when shared memory is enabled (same-host
+ * subscribers then map the block instead of copying it), or otherwise a
+ * recycled heap buffer handed to Zenoh without a copy. Either way the
+ * steady state performs no allocation per message.
+ *
+ * publish() may be called from several threads.
+ */
+class ZenohPublisher {
+public:
+    ZenohPublisher();
+    ~ZenohPublisher();
+
+    ZenohPublisher(const ZenohPublisher&) = delete;
+    ZenohPublisher& operator=(const ZenohPublisher&) = delete;
+
+    /**
+     * @brief Open the session and declare all publishers
+     * @param config_file Zenoh JSON5 config (empty for defaults)
+     * @param shared_memory Enable the shared-memory transport
+     * @param shm_pool_bytes Size of the shared-memory segment
+     * @return false if Zenoh is unavailable or the session failed to open
+     */
+    bool open(const std::string& config_file, bool shared_memory, size_t shm_pool_bytes = 16 << 20);
+    void close();
+
+    bool isOpen() const;
+    bool usesSharedMemory() const;
+
+    /**
+     * @brief Serialize and publish a protobuf message on a topic
+     * @param attachment Optional Zenoh attachment (e.g. "camera_id=1")
+     */
+    bool publish(
+        VisionTopic topic,
+        const google::protobuf::MessageLite& message,
+        const std::string& attachment = {}
+    );
+
+    /**
+     * @brief Publish raw bytes on a topic, copied once into the payload
+     * @param encoding Zenoh encoding string describing the payload layout
+     */
+    bool publishRaw(VisionTopic topic, const uint8_t* data, size_t size, const std::string& encoding);
+
+    /**
+     * @brief Publish an already serialized protobuf message
+     *
+     * Zenoh keeps a reference to the bytes instead of copying them (they are
+     * copied once into shared memory when that is enabled), so cached
+     * encodings can be published and served from the same buffer.
+     */
+    bool publishSerialized(VisionTopic topic, std::shared_ptr<const std::string> bytes,
+                           const std::string& attachment = {});
+
+    /**
+     * @brief Publish serialized bytes on a key without a declared publisher
+     *
+     * For keys created at runtime (e.g. stream rates); declared topics should
+     * use publishSerialized().
+     */
+    bool publishTo(const std::string& key, std::shared_ptr<const std::string> bytes,
+                   const std::string& attachment = {});
+
+    /**
+     * @brief Answer queries on a key expression until undeclared or closed
+     */
+    bool declareQueryable(const std::string& key, QueryHandler handler);
+
+    /**
+     * @brief Stop receiving queries; queries already handed out can still be answered
+     */
+    void undeclareQueryables();
+
+private:
+    // Recycled serialization buffers for the non-shared-memory path. Zenoh
+    // releases a payload when it is done with it, which returns the buffer.
+    struct PayloadStorage {
+        std::mutex mutex;
+        std::vector<std::unique_ptr<std::vector<uint8_t>>> free_list;
+    };
+    std::shared_ptr<PayloadStorage> payloads_;
+
+#ifdef USE_ZENOH
+    std::optional<zenoh::Session> session_;
+    std::array<std::optional<zenoh::Publisher>, static_cast<size_t>(VisionTopic::Count)> publishers_;
+    std::vector<zenoh::Queryable<void>> queryables_;
+#if defined(Z_FEATURE_SHARED_MEMORY) && defined(Z_FEATURE_UNSTABLE_API)
+    std::optional<zenoh::PosixShmProvider> shm_provider_;
+#endif
+
+    // Write a payload of the given size with fill(uint8_t*) and put it
+    template <typename Fill>
+    bool put(VisionTopic topic, size_t size, Fill&& fill, zenoh::Encoding encoding, const std::string& attachment);
+#endif
+};
+
+} // namespace navign::robot::vision
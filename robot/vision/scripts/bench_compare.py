@@ -0,0 +1,96 @@
+#!/usr/bin/env python3
+"""Compare two navign_vision_bench JSON reports and flag regressions.
+
+Reports come from `make bench_json` (or any run with
+--benchmark_out=<file> --benchmark_out_format=json). With repetitions the
+median aggregate is compared, otherwise the single run.
+
+Examples:
+    # Fail (exit 1) if any benchmark got more than 10% slower
+    python3 scripts/bench_compare.py release-0.1.0.json build/bench/navign_vision_bench.json
+
+    # Only the pipeline benchmarks, 5% tolerance
+    python3 scripts/bench_compare.py old.json new.json --filter BM_Pipeline --threshold 5
+"""
+
+import argparse
+import json
+import sys
+
+UNIT_TO_NS = {"ns": 1.0, "us": 1e3, "ms": 1e6, "s": 1e9}
+
+
+def load(path):
+    """Benchmark name -> (real time in ns, report context)."""
+    with open(path) as f:
+        report = json.load(f)
+
+    times = {}
+    has_aggregates = any(b.get("run_type") == "aggregate" for b in report["benchmarks"])
+    for bench in report["benchmarks"]:
+        if bench.get("error_occurred"):
+            continue
+        if has_aggregates:
+            if bench.get("aggregate_name") != "median":
+                continue
+            name = bench["run_name"]
+        else:
+            name = bench["name"]
+        times[name] = bench["real_time"] * UNIT_TO_NS[bench.get("time_unit", "ns")]
+    return times, report.get("context", {})
+
+
+def format_time(ns):
+    for unit in ("s", "ms", "us"):
+        if ns >= UNIT_TO_NS[unit]:
+            return f"{ns / UNIT_TO_NS[unit]:.3f} {unit}"
+    return f"{ns:.1f} ns"
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("baseline", help="JSON report of the reference build")
+    parser.add_argument("current", help="JSON report to check")
+    parser.add_argument("--threshold", type=float, default=10.0,
+                        help="allowed slowdown in percent (default: 10)")
+    parser.add_argument("--filter", default="", help="only compare benchmarks whose name contains this")
+    args = parser.parse_args()
+
+    baseline, baseline_context = load(args.baseline)
+    current, current_context = load(args.current)
+
+    for key in ("corpus", "corpus_frames", "frame_size", "model"):
+        if baseline_context.get(key) != current_context.get(key):
+            print(f"warning: {key} differs ({baseline_context.get(key)} vs {current_context.get(key)})",
+                  file=sys.stderr)
+
+    names = sorted(n for n in baseline.keys() & current.keys() if args.filter in n)
+    if not names:
+        print("no common benchmarks to compare", file=sys.stderr)
+        return 1
+
+    width = max(len(n) for n in names)
+    regressions = 0
+    print(f"{'benchmark':<{width}}  {'baseline':>12}  {'current':>12}  {'change':>8}")
+    for name in names:
+        change = (current[name] - baseline[name]) / baseline[name] * 100.0
+        flag = ""
+        if change > args.threshold:
+            flag = "  REGRESSION"
+            regressions += 1
+        print(f"{name:<{width}}  {format_time(baseline[name]):>12}  {format_time(current[name]):>12}  "
+              f"{change:+7.1f}%{flag}")
+
+    for name in sorted((baseline.keys() ^ current.keys())):
+        if args.filter in name:
+            side = "baseline" if name in baseline else "current"
+            print(f"{name}: only in {side}", file=sys.stderr)
+
+    if regressions:
+        print(f"{regressions} benchmark(s) slower than the {args.threshold:g}% threshold", file=sys.stderr)
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
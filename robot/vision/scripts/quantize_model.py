@@ -0,0 +1,189 @@
+#!/usr/bin/env python3
+"""Produce reduced-precision variants of the YOLO model for navign_vision.
+
+Writes the files ObjectDetector::loadModel() looks for next to the FP32
+model:
+
+    yolov8n.onnx -> yolov8n.int8.onnx   (static QDQ, ONNX Runtime / TensorRT / CPU)
+                 -> yolov8n.fp16.onnx   (GPU / Core ML execution providers)
+
+INT8 calibration uses frames recorded from our own cameras, preprocessed
+exactly like the C++ letterbox (uniform scale, centered, gray 114 border,
+RGB, [0, 1], CHW). Both variants keep FP32 inputs and outputs, so the
+service feeds them the same input tensor.
+
+Examples:
+    # Calibrate on a directory of recorded frames (PNG/JPG)
+    python3 scripts/quantize_model.py yolov8n.onnx --int8 --frames recordings/front/
+
+    # Grab 200 calibration frames from camera 0 instead
+    python3 scripts/quantize_model.py yolov8n.onnx --int8 --camera 0 --count 200
+
+    # FP16 variant (no calibration needed)
+    python3 scripts/quantize_model.py yolov8n.onnx --fp16
+
+Requires: onnx, onnxruntime, opencv-python, numpy (and onnxconverter-common
+for --fp16).
+"""
+
+import argparse
+import sys
+from pathlib import Path
+
+import cv2
+import numpy as np
+
+IMAGE_SUFFIXES = {".png", ".jpg", ".jpeg", ".bmp"}
+PAD_VALUE = 114
+
+
+def letterbox(image, input_size):
+    """Letterbox a BGR frame into a 1x3xHxW float32 tensor (matches letterbox.cpp)."""
+    input_w, input_h = input_size
+    h, w = image.shape[:2]
+    scale = min(input_w / w, input_h / h)
+    content_w = min(input_w, int(round(w * scale)))
+    content_h = min(input_h, int(round(h * scale)))
+    pad_x = (input_w - content_w) // 2
+    pad_y = (input_h - content_h) // 2
+
+    if (content_w, content_h) != (w, h):
+        image = cv2.resize(image, (content_w, content_h), interpolation=cv2.INTER_LINEAR)
+
+    canvas = np.full((input_h, input_w, 3), PAD_VALUE, dtype=np.uint8)
+    canvas[pad_y:pad_y + content_h, pad_x:pad_x + content_w] = image
+
+    rgb = canvas[:, :, ::-1].astype(np.float32) / 255.0
+    return np.ascontiguousarray(rgb.transpose(2, 0, 1)[np.newaxis])
+
+
+def load_frames(args):
+    """Calibration frames from a directory or a live camera."""
+    if args.frames:
+        paths = sorted(p for p in Path(args.frames).rglob("*") if p.suffix.lower() in IMAGE_SUFFIXES)
+        if args.count:
+            # Spread the sample over the whole recording
+            step = max(1, len(paths) // args.count)
+            paths = paths[::step][:args.count]
+        for path in paths:
+            image = cv2.imread(str(path), cv2.IMREAD_COLOR)
+            if image is not None:
+                yield image
+        return
+
+    capture = cv2.VideoCapture(args.camera)
+    if not capture.isOpened():
+        raise RuntimeError(f"failed to open camera {args.camera}")
+    try:
+        for _ in range(args.count or 100):
+            ok, image = capture.read()
+            if ok:
+                yield image
+    finally:
+        capture.release()
+
+
+def model_input(model_path):
+    """Input name and (W, H) of the model; dynamic spatial dims default to 640."""
+    import onnx
+
+    model = onnx.load(str(model_path))
+    tensor = model.graph.input[0]
+    dims = [d.dim_value for d in tensor.type.tensor_type.shape.dim]
+    height = dims[2] if len(dims) == 4 and dims[2] > 0 else 640
+    width = dims[3] if len(dims) == 4 and dims[3] > 0 else 640
+    return tensor.name, (width, height)
+
+
+def quantize_int8(model_path, output_path, args):
+    from onnxruntime.quantization import (CalibrationDataReader, CalibrationMethod, QuantFormat,
+                                          QuantType, quantize_static)
+    from onnxruntime.quantization.shape_inference import quant_pre_process
+
+    input_name, input_size = model_input(model_path)
+
+    class FrameReader(CalibrationDataReader):
+        def __init__(self):
+            self.frames = (letterbox(image, input_size) for image in load_frames(args))
+            self.count = 0
+
+        def get_next(self):
+            tensor = next(self.frames, None)
+            if tensor is None:
+                return None
+            self.count += 1
+            return {input_name: tensor}
+
+    # Shape inference and graph folding make the QDQ placement more accurate
+    prepared_path = output_path.with_suffix(".prep.onnx")
+    quant_pre_process(str(model_path), str(prepared_path))
+
+    reader = FrameReader()
+    try:
+        quantize_static(
+            str(prepared_path),
+            str(output_path),
+            reader,
+            quant_format=QuantFormat.QDQ,
+            activation_type=QuantType.QUInt8,
+            weight_type=QuantType.QInt8,
+            per_channel=True,
+            calibrate_method=CalibrationMethod[args.calibration],
+        )
+    finally:
+        prepared_path.unlink(missing_ok=True)
+
+    if reader.count == 0:
+        raise RuntimeError("no calibration frames were read")
+    print(f"INT8 model written to {output_path} ({reader.count} calibration frames)")
+
+
+def convert_fp16(model_path, output_path):
+    import onnx
+    from onnxconverter_common import float16
+
+    model = onnx.load(str(model_path))
+    # Keep FP32 I/O so the service can feed the same input tensor
+    model = float16.convert_float_to_float16(model, keep_io_types=True)
+    onnx.save(model, str(output_path))
+    print(f"FP16 model written to {output_path}")
+
+
+def variant_path(model_path, suffix):
+    return model_path.with_name(f"{model_path.stem}.{suffix}{model_path.suffix}")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("model", type=Path, help="FP32 ONNX model (e.g. yolov8n.onnx)")
+    parser.add_argument("--int8", action="store_true", help="write <model>.int8.onnx (static QDQ)")
+    parser.add_argument("--fp16", action="store_true", help="write <model>.fp16.onnx")
+    source = parser.add_mutually_exclusive_group()
+    source.add_argument("--frames", help="directory of recorded calibration frames")
+    source.add_argument("--camera", type=int, help="capture calibration frames from this camera")
+    parser.add_argument("--count", type=int, default=0,
+                        help="number of calibration frames (default: all recorded, or 100 from a camera)")
+    parser.add_argument("--calibration", choices=["MinMax", "Entropy", "Percentile"], default="MinMax",
+                        help="activation range calibration method (default: MinMax)")
+    args = parser.parse_args()
+
+    if not args.model.exists():
+        parser.error(f"model not found: {args.model}")
+    if not args.int8 and not args.fp16:
+        parser.error("select at least one of --int8, --fp16")
+    if args.int8 and args.frames is None and args.camera is None:
+        parser.error("--int8 needs calibration frames (--frames or --camera)")
+
+    try:
+        if args.int8:
+            quantize_int8(args.model, variant_path(args.model, "int8"), args)
+        if args.fp16:
+            convert_fp16(args.model, variant_path(args.model, "fp16"))
+    except RuntimeError as error:
+        print(f"error: {error}", file=sys.stderr)
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
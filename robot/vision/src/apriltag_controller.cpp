@@ -0,0 +1,153 @@
+#include "apriltag_controller.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <thread>
+
+namespace navign::robot::vision {
+
+namespace {
+
+constexpr std::array<float, 5> kDecimateLevels = {1.0f, 1.5f, 2.0f, 3.0f, 4.0f};
+
+// Exponential smoothing factor for the latency estimate
+constexpr double kLatencySmoothing = 0.2;
+
+// Step towards accuracy only while latency is below this share of budget
+constexpr double kHeadroomFraction = 0.6;
+
+// Frames to wait after a change before the next latency-driven change
+constexpr int kCooldownFrames = 15;
+
+// Tag side (pixels) that must survive decimation for reliable quad fitting
+constexpr double kMinDecimatedTagPx = 24.0;
+
+// Forget the smallest tag size after this many frames without tags
+constexpr int kTagMemoryFrames = 90;
+
+} // namespace
+
+AprilTagController::AprilTagController() {
+    configure(30.0);
+    reset(AprilTagTuning{});
+}
+
+void AprilTagController::configure(double target_fps, int max_threads) {
+    state_.budget_ms = 1000.0 / std::max(1.0, target_fps);
+    if (max_threads <= 0) {
+        max_threads = static_cast<int>(std::thread::hardware_concurrency());
+    }
+    max_threads_ = std::max(1, max_threads);
+}
+
+void AprilTagController::reset(const AprilTagTuning& tuning) {
+    state_.tuning = tuning;
+    state_.tuning.nthreads = std::clamp(tuning.nthreads, 1, max_threads_);
+
+    // Snap to the nearest supported decimation level
+    decimate_index_ = 0;
+    for (size_t i = 0; i < kDecimateLevels.size(); i++) {
+        if (std::abs(kDecimateLevels[i] - tuning.quad_decimate) <
+            std::abs(kDecimateLevels[decimate_index_] - tuning.quad_decimate)) {
+            decimate_index_ = static_cast<int>(i);
+        }
+    }
+    state_.tuning.quad_decimate = kDecimateLevels[decimate_index_];
+
+    state_.latency_ms = 0.0;
+    state_.smallest_tag_px = 0.0;
+    state_.max_decimate = kDecimateLevels.back();
+    cooldown_frames_ = 0;
+    frames_since_tag_ = 0;
+}
+
+const AprilTagTuning& AprilTagController::update(double latency_ms, double smallest_tag_px) {
+    state_.latency_ms = state_.latency_ms == 0.0
+        ? latency_ms
+        : (1.0 - kLatencySmoothing) * state_.latency_ms + kLatencySmoothing * latency_ms;
+
+    if (latency_ms > state_.budget_ms) {
+        state_.deadline_misses++;
+    }
+
+    // Track the smallest tag seen recently: shrink immediately, grow slowly
+    if (smallest_tag_px > 0.0) {
+        frames_since_tag_ = 0;
+        if (state_.smallest_tag_px == 0.0 || smallest_tag_px < state_.smallest_tag_px) {
+            state_.smallest_tag_px = smallest_tag_px;
+        } else {
+            state_.smallest_tag_px = 0.9 * state_.smallest_tag_px + 0.1 * smallest_tag_px;
+        }
+    } else if (++frames_since_tag_ > kTagMemoryFrames) {
+        state_.smallest_tag_px = 0.0;
+    }
+
+    state_.max_decimate = state_.smallest_tag_px > 0.0
+        ? static_cast<float>(std::max(1.0, state_.smallest_tag_px / kMinDecimatedTagPx))
+        : kDecimateLevels.back();
+
+    // The tag-size ceiling applies immediately, even during cooldown:
+    // losing far tags is worse than a missed deadline
+    bool changed = false;
+    while (decimate_index_ > 0 && kDecimateLevels[decimate_index_] > state_.max_decimate) {
+        decimate_index_--;
+        changed = true;
+    }
+
+    if (cooldown_frames_ > 0) {
+        cooldown_frames_--;
+    } else if (state_.latency_ms > state_.budget_ms) {
+        changed |= stepFaster();
+    } else if (state_.latency_ms < kHeadroomFraction * state_.budget_ms) {
+        changed |= stepMoreAccurate();
+    }
+
+    if (changed) {
+        state_.tuning.quad_decimate = kDecimateLevels[decimate_index_];
+        state_.adjustments++;
+        cooldown_frames_ = kCooldownFrames;
+    }
+
+    return state_.tuning;
+}
+
+bool AprilTagController::stepFaster() {
+    auto& tuning = state_.tuning;
+
+    if (tuning.nthreads < max_threads_) {
+        tuning.nthreads++;
+        return true;
+    }
+    if (decimate_index_ + 1 < static_cast<int>(kDecimateLevels.size()) &&
+        kDecimateLevels[decimate_index_ + 1] <= state_.max_decimate) {
+        decimate_index_++;
+        return true;
+    }
+    if (tuning.refine_edges) {
+        tuning.refine_edges = false;
+        return true;
+    }
+    return false;
+}
+
+bool AprilTagController::stepMoreAccurate() {
+    auto& tuning = state_.tuning;
+
+    if (!tuning.refine_edges) {
+        tuning.refine_edges = true;
+        return true;
+    }
+    if (decimate_index_ > 0) {
+        decimate_index_--;
+        return true;
+    }
+    // Already at full accuracy: give cores back to the other stages
+    if (tuning.nthreads > 1) {
+        tuning.nthreads--;
+        return true;
+    }
+    return false;
+}
+
+} // namespace navign::robot::vision
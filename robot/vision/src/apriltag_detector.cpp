@@ -1,15 +1,89 @@
 #include "apriltag_detector.hpp"
+#include <algorithm>
+#include <chrono>
 #include <iostream>
 
+#include <apriltag/common/workerpool.h>
+#include <apriltag/tag16h5.h>
+#include <apriltag/tag25h9.h>
+#include <apriltag/tag36h11.h>
+#include <apriltag/tagCircle21h7.h>
+#include <apriltag/tagCircle49h12.h>
+#include <apriltag/tagCustom48h12.h>
+#include <apriltag/tagStandard41h12.h>
+#include <apriltag/tagStandard52h13.h>
+
 namespace navign::robot::vision {
 
+namespace {
+
+// Search region growth around a tag's predicted bounds
+constexpr double kRoiMarginFactor = 0.5;
+constexpr double kMinRoiMargin = 16.0;
+
+// Lookup tables beyond 3 corrected bits need gigabytes
+constexpr int kMaxHamming = 3;
+
+struct FamilyFactory {
+    const char* name;
+    apriltag_family_t* (*create)();
+    void (*destroy)(apriltag_family_t*);
+};
+
+constexpr FamilyFactory kFamilies[] = {
+    {"tag36h11", tag36h11_create, tag36h11_destroy},
+    {"tag25h9", tag25h9_create, tag25h9_destroy},
+    {"tag16h5", tag16h5_create, tag16h5_destroy},
+    {"tagCircle21h7", tagCircle21h7_create, tagCircle21h7_destroy},
+    {"tagCircle49h12", tagCircle49h12_create, tagCircle49h12_destroy},
+    {"tagStandard41h12", tagStandard41h12_create, tagStandard41h12_destroy},
+    {"tagStandard52h13", tagStandard52h13_create, tagStandard52h13_destroy},
+    {"tagCustom48h12", tagCustom48h12_create, tagCustom48h12_destroy},
+};
+
+/**
+ * @brief Map a detection found in a crop back to full-frame pixel coordinates
+ *
+ * Shifts the center and corners, and left-multiplies the homography by the
+ * translation so pose estimation sees full-frame coordinates as well.
+ */
+void offsetDetection(apriltag_detection_t* det, int offset_x, int offset_y) {
+    det->c[0] += offset_x;
+    det->c[1] += offset_y;
+    for (int j = 0; j < 4; j++) {
+        det->p[j][0] += offset_x;
+        det->p[j][1] += offset_y;
+    }
+    for (int col = 0; col < 3; col++) {
+        MATD_EL(det->H, 0, col) += offset_x * MATD_EL(det->H, 2, col);
+        MATD_EL(det->H, 1, col) += offset_y * MATD_EL(det->H, 2, col);
+    }
+}
+
+/**
+ * @brief Axis-aligned bounds of a tag's corners
+ */
+template <typename Corners>
+cv::Rect2d cornerBounds(const Corners& corners) {
+    double min_x = corners[0].x, max_x = corners[0].x;
+    double min_y = corners[0].y, max_y = corners[0].y;
+    for (const auto& corner : corners) {
+        min_x = std::min(min_x, corner.x);
+        max_x = std::max(max_x, corner.x);
+        min_y = std::min(min_y, corner.y);
+        max_y = std::max(max_y, corner.y);
+    }
+    return cv::Rect2d(min_x, min_y, max_x - min_x, max_y - min_y);
+}
+
+} // namespace
+
 AprilTagDetector::AprilTagDetector() {
     // Create detector
     detector_ = apriltag_detector_create();
 
     // Create tag family (tag36h11)
-    tag_family_ = tag36h11_create();
-    apriltag_detector_add_family(detector_, tag_family_);
+    setTagFamily("tag36h11");
 
     // Default settings
     detector_->quad_decimate = 2.0;
@@ -24,113 +98,479 @@ AprilTagDetector::~AprilTagDetector() {
         apriltag_detector_destroy(detector_);
     }
     if (tag_family_) {
-        tag36h11_destroy(tag_family_);
+        family_destroy_(tag_family_);
+    }
+}
+
+bool AprilTagDetector::setTagFamily(const std::string& name) {
+    const auto* factory = std::find_if(std::begin(kFamilies), std::end(kFamilies),
+        [&name](const FamilyFactory& f) { return name == f.name; });
+    if (factory == std::end(kFamilies)) {
+        std::cerr << "Unknown AprilTag family: " << name << std::endl;
+        return false;
+    }
+
+    apriltag_detector_clear_families(detector_);
+    if (tag_family_) {
+        family_destroy_(tag_family_);
+    }
+
+    tag_family_ = factory->create();
+    family_destroy_ = factory->destroy;
+    family_name_ = factory->name;
+    stream_tracks_.clear();
+    rebuildFamily();
+    return true;
+}
+
+void AprilTagDetector::setFilter(const AprilTagFilter& filter, bool prune_family) {
+    filter_ = filter;
+    filter_.max_hamming = std::clamp(filter.max_hamming, 0, kMaxHamming);
+    prune_family_ = prune_family;
+    stream_tracks_.clear();
+    rebuildFamily();
+}
+
+void AprilTagDetector::rebuildFamily() {
+    apriltag_detector_clear_families(detector_);
+
+    allowed_ids_.clear();
+    if (!filter_.id_whitelist.empty()) {
+        allowed_ids_.assign(tag_family_->ncodes, false);
+        for (uint32_t id : filter_.id_whitelist) {
+            if (id < tag_family_->ncodes) {
+                allowed_ids_[id] = true;
+            } else {
+                std::cerr << "Tag ID " << id << " is not in " << family_name_ << std::endl;
+            }
+        }
+    }
+
+    subset_ids_.clear();
+    subset_codes_.clear();
+    if (!prune_family_ || allowed_ids_.empty()) {
+        apriltag_detector_add_family_bits(detector_, tag_family_, filter_.max_hamming);
+        return;
+    }
+
+    for (uint32_t id = 0; id < allowed_ids_.size(); id++) {
+        if (allowed_ids_[id]) {
+            subset_ids_.push_back(id);
+            subset_codes_.push_back(tag_family_->codes[id]);
+        }
+    }
+    if (subset_codes_.empty()) {
+        subset_ids_.clear();
+        apriltag_detector_add_family_bits(detector_, tag_family_, filter_.max_hamming);
+        return;
     }
+
+    // Same geometry and name, fewer codes; the decoder builds its own table
+    subset_family_ = *tag_family_;
+    subset_family_.ncodes = static_cast<uint32_t>(subset_codes_.size());
+    subset_family_.codes = subset_codes_.data();
+    subset_family_.impl = nullptr;
+    apriltag_detector_add_family_bits(detector_, &subset_family_, filter_.max_hamming);
+}
+
+bool AprilTagDetector::acceptDetection(apriltag_detection_t* det) {
+    if (!subset_ids_.empty()) {
+        det->id = static_cast<int>(subset_ids_[det->id]);
+    }
+
+    const bool accepted =
+        det->hamming <= filter_.max_hamming &&
+        det->decision_margin >= filter_.min_decision_margin &&
+        (allowed_ids_.empty() || allowed_ids_[det->id]);
+    if (!accepted) {
+        rejected_++;
+    }
+    return accepted;
 }
 
 std::vector<AprilTagResult> AprilTagDetector::detect(
     const cv::Mat& image,
     const cv::Mat& camera_matrix,
     const cv::Mat& dist_coeffs,
-    double tag_size
+    double tag_size,
+    uint32_t stream_id
 ) {
     std::vector<AprilTagResult> results;
+    detect(image, results, camera_matrix, dist_coeffs, tag_size, stream_id);
+    return results;
+}
 
-    // Convert to grayscale if needed
+void AprilTagDetector::detect(
+    const cv::Mat& image,
+    std::vector<AprilTagResult>& results,
+    const cv::Mat& camera_matrix,
+    const cv::Mat& dist_coeffs,
+    double tag_size,
+    uint32_t stream_id
+) {
+    StreamTracks& stream = stream_tracks_[stream_id];
+    detect(image, results, stream.state, ++stream.frames, camera_matrix, dist_coeffs, tag_size);
+}
+
+void AprilTagDetector::detect(
+    const cv::Mat& image,
+    std::vector<AprilTagResult>& results,
+    AprilTagTrackState& tracks,
+    uint64_t frame_id,
+    const cv::Mat& camera_matrix,
+    const cv::Mat& dist_coeffs,
+    double tag_size
+) {
+    results.clear();
+
+    // Convert to grayscale if needed. Gray input (e.g. the shared plane of a
+    // pooled frame) is used in place; apriltag only reads the buffer.
     cv::Mat gray;
     if (image.channels() == 3) {
-        cv::cvtColor(image, gray, cv::COLOR_BGR2GRAY);
+        cv::cvtColor(image, gray_buffer_, cv::COLOR_BGR2GRAY);
+        gray = gray_buffer_;
+    } else {
+        gray = image;
+    }
+
+    const auto start_time = std::chrono::steady_clock::now();
+    last_timings_ = AprilTagTimings{};
+    pose_detections_.clear();
+
+    // Claim the scan kind for this frame; other detectors of the stream see
+    // the claim, so a rescan or a lost track costs one full scan, not one per detector
+    bool full_scan = true;
+    double frames_ahead = 0.0;
+    if (tracking_enabled_) {
+        std::lock_guard<std::mutex> lock(tracks.mutex_);
+        full_scan = tracks.tracks_.empty() || tracks.track_lost_ ||
+                    tracks.frames_since_rescan_ >= rescan_interval_;
+        if (full_scan) {
+            tracks.frames_since_rescan_ = 0;
+            tracks.track_lost_ = false;
+        } else {
+            tracks.frames_since_rescan_++;
+            claimed_tracks_ = tracks.tracks_;
+            frames_ahead = static_cast<double>(frame_id) - static_cast<double>(tracks.last_frame_);
+        }
+    }
+
+    if (full_scan) {
+        // Create image_u8 structure for apriltag, honouring the real row stride
+        // so padded planes and ROI views work without a copy
+        image_u8_t im = {
+            .width = gray.cols,
+            .height = gray.rows,
+            .stride = static_cast<int32_t>(gray.step[0]),
+            .buf = gray.data
+        };
+
+        // Detect tags
+        zarray_t* detections = detectTimed(&im);
+
+        // Process detections; rejected candidates skip pose estimation
+        for (int i = 0; i < zarray_size(detections); i++) {
+            apriltag_detection_t* det;
+            zarray_get(detections, i, &det);
+            if (acceptDetection(det)) {
+                results.push_back(makeResult(det));
+                pose_detections_.push_back(det);
+            }
+        }
+
+        // Poses need the homographies, so run them before cleanup
+        estimatePoses(results, camera_matrix, tag_size);
+        apriltag_detections_destroy(detections);
+
+        full_scans_++;
+
+        // Only full scans reflect the decimation settings being tuned
+        if (adaptive_enabled_) {
+            const double latency_ms = std::chrono::duration<double, std::milli>(
+                std::chrono::steady_clock::now() - start_time).count();
+
+            double smallest_tag_px = 0.0;
+            for (const auto& result : results) {
+                const cv::Rect2d bounds = cornerBounds(result.corners);
+                const double side = std::min(bounds.width, bounds.height);
+                if (smallest_tag_px == 0.0 || side < smallest_tag_px) {
+                    smallest_tag_px = side;
+                }
+            }
+
+            applyTuning(controller_.update(latency_ms, smallest_tag_px));
+
+            std::lock_guard<std::mutex> lock(controller_mutex_);
+            controller_snapshot_ = controller_.state();
+        }
     } else {
-        gray = image.clone();
-    }
-
-    // Create image_u8 structure for apriltag
-    image_u8_t im = {
-        .width = gray.cols,
-        .height = gray.rows,
-        .stride = gray.cols,
-        .buf = gray.data
-    };
-
-    // Detect tags
-    zarray_t* detections = apriltag_detector_detect(detector_, &im);
-
-    // Process detections
-    for (int i = 0; i < zarray_size(detections); i++) {
-        apriltag_detection_t* det;
-        zarray_get(detections, i, &det);
-
-        AprilTagResult result;
-        result.tag_id = det->id;
-        result.center = cv::Point2d(det->c[0], det->c[1]);
-        result.decision_margin = det->decision_margin;
-        result.hamming_distance = det->hamming;
-
-        // Extract corners
-        for (int j = 0; j < 4; j++) {
-            result.corners.push_back(cv::Point2d(det->p[j][0], det->p[j][1]));
+        predictRois(frames_ahead, gray.size());
+
+        // Crops are small, so decode them without decimation
+        const float saved_decimate = detector_->quad_decimate;
+        detector_->quad_decimate = 1.0f;
+
+        for (const auto& roi : rois_) {
+            // View into the full frame: same stride, buffer offset to the crop
+            image_u8_t im = {
+                .width = roi.width,
+                .height = roi.height,
+                .stride = static_cast<int32_t>(gray.step[0]),
+                .buf = gray.data + roi.y * gray.step[0] + roi.x
+            };
+
+            zarray_t* detections = detectTimed(&im);
+
+            for (int i = 0; i < zarray_size(detections); i++) {
+                apriltag_detection_t* det;
+                zarray_get(detections, i, &det);
+                if (!acceptDetection(det)) {
+                    continue;
+                }
+
+                // Merged ROIs can overlap; keep the first sighting of each tag
+                bool duplicate = std::any_of(results.begin(), results.end(),
+                    [det](const AprilTagResult& r) { return r.tag_id == static_cast<uint32_t>(det->id); });
+                if (duplicate) {
+                    continue;
+                }
+
+                offsetDetection(det, roi.x, roi.y);
+                results.push_back(makeResult(det));
+                pose_detections_.push_back(det);
+            }
+
+            roi_detections_.push_back(detections);
         }
 
-        // Estimate pose if calibration provided
-        if (!camera_matrix.empty()) {
-            result.pose_valid = estimatePose(detections, i, camera_matrix, tag_size, result);
+        // All crops' poses in one parallel pass
+        estimatePoses(results, camera_matrix, tag_size);
+        for (zarray_t* detections : roi_detections_) {
+            apriltag_detections_destroy(detections);
         }
+        roi_detections_.clear();
 
-        results.push_back(result);
+        detector_->quad_decimate = saved_decimate;
+        roi_scans_++;
     }
 
-    // Cleanup
-    apriltag_detections_destroy(detections);
+    if (tracking_enabled_) {
+        std::lock_guard<std::mutex> lock(tracks.mutex_);
+        // A newer frame of the stream finished first; its tracks stay
+        if (!tracks.has_frame_ || frame_id > tracks.last_frame_) {
+            updateTracks(tracks, frame_id, results);
+        }
+    }
+}
 
-    return results;
+zarray_t* AprilTagDetector::detectTimed(image_u8_t* im) {
+    const auto decode_start = std::chrono::steady_clock::now();
+    zarray_t* detections = apriltag_detector_detect(detector_, im);
+    last_timings_.decode += std::chrono::steady_clock::now() - decode_start;
+    return detections;
 }
 
-bool AprilTagDetector::estimatePose(
-    zarray_t* detections,
-    int idx,
+AprilTagResult AprilTagDetector::makeResult(apriltag_detection_t* det) {
+    AprilTagResult result;
+    result.tag_id = det->id;
+    result.center = cv::Point2d(det->c[0], det->c[1]);
+    result.decision_margin = det->decision_margin;
+    result.hamming_distance = det->hamming;
+
+    // Extract corners
+    for (int j = 0; j < 4; j++) {
+        result.corners[j] = cv::Point2d(det->p[j][0], det->p[j][1]);
+    }
+
+    return result;
+}
+
+void AprilTagDetector::estimatePoses(
+    std::vector<AprilTagResult>& results,
     const cv::Mat& camera_matrix,
-    double tag_size,
-    AprilTagResult& result
+    double tag_size
 ) {
-    apriltag_detection_t* det;
-    zarray_get(detections, idx, &det);
+    // Pose estimation needs calibration
+    if (camera_matrix.empty() || results.empty()) {
+        return;
+    }
+
+    const auto pose_start = std::chrono::steady_clock::now();
 
     // Prepare detection info for pose estimation
-    apriltag_detection_info_t info;
-    info.det = det;
-    info.tagsize = tag_size;
-    info.fx = camera_matrix.at<double>(0, 0);
-    info.fy = camera_matrix.at<double>(1, 1);
-    info.cx = camera_matrix.at<double>(0, 2);
-    info.cy = camera_matrix.at<double>(1, 2);
+    pose_tasks_.resize(results.size());
+    for (size_t i = 0; i < results.size(); i++) {
+        PoseTask& task = pose_tasks_[i];
+        task.info.det = pose_detections_[i];
+        task.info.tagsize = tag_size;
+        task.info.fx = camera_matrix.at<double>(0, 0);
+        task.info.fy = camera_matrix.at<double>(1, 1);
+        task.info.cx = camera_matrix.at<double>(0, 2);
+        task.info.cy = camera_matrix.at<double>(1, 2);
+        task.result = &results[i];
+        task.method = pose_method_;
+    }
+
+    // The pool exists once apriltag_detector_detect() has run with nthreads
+    workerpool_t* pool = detector_->wp;
+    if (pool && results.size() > 1 && workerpool_get_nthreads(pool) > 1) {
+        for (auto& task : pose_tasks_) {
+            workerpool_add_task(pool, &AprilTagDetector::runPoseTask, &task);
+        }
+        workerpool_run(pool);
+    } else {
+        for (auto& task : pose_tasks_) {
+            runPoseTask(&task);
+        }
+    }
+
+    last_timings_.pose += std::chrono::steady_clock::now() - pose_start;
+}
+
+void AprilTagDetector::runPoseTask(void* p) {
+    auto& task = *static_cast<PoseTask*>(p);
+    AprilTagResult& result = *task.result;
 
     // Estimate pose
     apriltag_pose_t pose;
-    double err = estimate_tag_pose(&info, &pose);
+    if (task.method == AprilTagPoseMethod::Homography) {
+        estimate_pose_for_tag_homography(&task.info, &pose);
+        result.pose_error = 0.0;
+    } else {
+        result.pose_error = estimate_tag_pose(&task.info, &pose);
+    }
 
     // Convert to OpenCV format
-    result.rotation = cv::Mat(3, 3, CV_64F);
-    result.translation = cv::Mat(3, 1, CV_64F);
-
     for (int i = 0; i < 3; i++) {
         for (int j = 0; j < 3; j++) {
-            result.rotation.at<double>(i, j) = MATD_EL(pose.R, i, j);
+            result.rotation(i, j) = MATD_EL(pose.R, i, j);
         }
-        result.translation.at<double>(i, 0) = MATD_EL(pose.t, i, 0);
+        result.translation[i] = MATD_EL(pose.t, i, 0);
     }
-
-    // Extract position
-    result.position = cv::Point3d(
-        result.translation.at<double>(0, 0),
-        result.translation.at<double>(1, 0),
-        result.translation.at<double>(2, 0)
-    );
+    result.position = cv::Point3d(result.translation[0], result.translation[1], result.translation[2]);
+    result.pose_valid = true;
 
     // Cleanup
     matd_destroy(pose.R);
     matd_destroy(pose.t);
+}
 
-    return true;
+void AprilTagDetector::predictRois(double frames_ahead, cv::Size image_size) {
+    rois_.clear();
+    const cv::Rect frame_rect(0, 0, image_size.width, image_size.height);
+
+    for (const auto& track : claimed_tracks_) {
+        // Shift by last motion over the frame gap, then grow by half the tag
+        // size (at least kMinRoiMargin) to absorb acceleration and scale change
+        cv::Rect2d predicted = track.bounds + track.velocity * frames_ahead;
+        const double margin = std::max(kMinRoiMargin,
+                                       kRoiMarginFactor * std::max(predicted.width, predicted.height));
+        predicted.x -= margin;
+        predicted.y -= margin;
+        predicted.width += 2.0 * margin;
+        predicted.height += 2.0 * margin;
+
+        cv::Rect roi = cv::Rect(predicted) & frame_rect;
+        if (roi.area() > 0) {
+            rois_.push_back(roi);
+        }
+    }
+
+    // Merge overlapping regions so no area is decoded twice
+    bool merged = true;
+    while (merged) {
+        merged = false;
+        for (size_t i = 0; i < rois_.size() && !merged; i++) {
+            for (size_t j = i + 1; j < rois_.size(); j++) {
+                if ((rois_[i] & rois_[j]).area() > 0) {
+                    rois_[i] |= rois_[j];
+                    rois_.erase(rois_.begin() + j);
+                    merged = true;
+                    break;
+                }
+            }
+        }
+    }
+}
+
+void AprilTagDetector::updateTracks(AprilTagTrackState& state, uint64_t frame_id,
+                                    const std::vector<AprilTagResult>& results) {
+    // A tracked tag missing from this frame forces a full scan next frame
+    for (const auto& track : state.tracks_) {
+        bool found = std::any_of(results.begin(), results.end(),
+            [&track](const AprilTagResult& r) { return r.tag_id == track.tag_id; });
+        if (!found) {
+            state.track_lost_ = true;
+            break;
+        }
+    }
+
+    // Frames shed or handled elsewhere leave gaps; velocity is per stream frame
+    const double gap = state.has_frame_ ? static_cast<double>(frame_id - state.last_frame_) : 1.0;
+
+    updated_tracks_.clear();
+    for (const auto& result : results) {
+        AprilTagTrackState::TagTrack track;
+        track.tag_id = result.tag_id;
+        track.bounds = cornerBounds(result.corners);
+        track.velocity = cv::Point2d(0, 0);
+
+        for (const auto& previous : state.tracks_) {
+            if (previous.tag_id == result.tag_id) {
+                track.velocity = ((track.bounds.tl() + track.bounds.br()) * 0.5 -
+                                  (previous.bounds.tl() + previous.bounds.br()) * 0.5) / gap;
+                break;
+            }
+        }
+        updated_tracks_.push_back(track);
+    }
+    std::swap(state.tracks_, updated_tracks_);
+    state.last_frame_ = frame_id;
+    state.has_frame_ = true;
+}
+
+void AprilTagTrackState::reset() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    tracks_.clear();
+    last_frame_ = 0;
+    has_frame_ = false;
+    frames_since_rescan_ = 0;
+    track_lost_ = false;
+}
+
+void AprilTagDetector::setAdaptiveControl(bool enabled, double target_fps) {
+    adaptive_enabled_ = enabled;
+    controller_.configure(target_fps);
+
+    // Start from the current manual settings
+    AprilTagTuning tuning;
+    tuning.quad_decimate = detector_->quad_decimate;
+    tuning.nthreads = detector_->nthreads;
+    tuning.refine_edges = detector_->refine_edges != 0;
+    controller_.reset(tuning);
+    if (enabled) {
+        applyTuning(controller_.state().tuning);
+    }
+
+    std::lock_guard<std::mutex> lock(controller_mutex_);
+    controller_snapshot_ = controller_.state();
+}
+
+AprilTagControllerState AprilTagDetector::getControllerState() const {
+    std::lock_guard<std::mutex> lock(controller_mutex_);
+    return controller_snapshot_;
+}
+
+void AprilTagDetector::applyTuning(const AprilTagTuning& tuning) {
+    detector_->quad_decimate = tuning.quad_decimate;
+    detector_->nthreads = tuning.nthreads;
+    detector_->refine_edges = tuning.refine_edges ? 1 : 0;
+}
+
+void AprilTagDetector::setTrackingMode(bool enabled, int rescan_interval) {
+    tracking_enabled_ = enabled;
+    rescan_interval_ = std::max(1, rescan_interval);
+    stream_tracks_.clear();
 }
 
 void AprilTagDetector::setNumThreads(int threads) {
@@ -1,8 +1,115 @@
 #include "camera_calibration.hpp"
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 
 namespace navign::robot::vision {
 
+namespace {
+
+// Solver settings of the incremental refits; seeded refits converge fast
+const cv::TermCriteria kRefitCriteria(cv::TermCriteria::COUNT + cv::TermCriteria::EPS, 30, 1e-6);
+
+std::vector<cv::Point3f> boardPoints(cv::Size pattern_size, double square_size) {
+    std::vector<cv::Point3f> points;
+    points.reserve(static_cast<size_t>(pattern_size.area()));
+    for (int i = 0; i < pattern_size.height; i++) {
+        for (int j = 0; j < pattern_size.width; j++) {
+            points.push_back(cv::Point3f(j * square_size, i * square_size, 0.0));
+        }
+    }
+    return points;
+}
+
+} // namespace
+
+// IncrementalCalibration
+
+IncrementalCalibration::IncrementalCalibration(
+    cv::Size image_size,
+    cv::Size pattern_size,
+    double square_size,
+    const CalibrationConvergence& convergence
+) : image_size_(image_size),
+    pattern_size_(pattern_size),
+    convergence_(convergence),
+    board_points_(boardPoints(pattern_size, square_size)),
+    covered_cells_(kCoverageCols * kCoverageRows, false) {
+    convergence_.min_views = std::max(3, convergence_.min_views);
+    convergence_.max_views = std::max(convergence_.min_views, convergence_.max_views);
+    calibration_.image_size = image_size;
+}
+
+bool IncrementalCalibration::addView(const std::vector<cv::Point2f>& corners) {
+    if (corners.size() != board_points_.size() || image_size_.area() == 0) {
+        return false;
+    }
+    image_points_.push_back(corners);
+
+    std::vector<cv::Point2f> hull;
+    cv::convexHull(corners, hull);
+    progress_.view_coverage.push_back(cv::contourArea(hull) / image_size_.area());
+
+    for (const auto& corner : corners) {
+        const int col = std::clamp(static_cast<int>(corner.x * kCoverageCols / image_size_.width), 0, kCoverageCols - 1);
+        const int row = std::clamp(static_cast<int>(corner.y * kCoverageRows / image_size_.height), 0, kCoverageRows - 1);
+        covered_cells_[row * kCoverageCols + col] = true;
+    }
+    progress_.coverage = static_cast<double>(std::count(covered_cells_.begin(), covered_cells_.end(), true)) /
+                         covered_cells_.size();
+    progress_.views = image_points_.size();
+
+    if (progress_.views >= static_cast<size_t>(convergence_.min_views)) {
+        recalibrate();
+    }
+    return true;
+}
+
+void IncrementalCalibration::recalibrate() {
+    const std::vector<std::vector<cv::Point3f>> object_points(image_points_.size(), board_points_);
+
+    // Seeding with the previous estimate turns each refit into a few iterations
+    int flags = cv::CALIB_FIX_K3;
+    cv::Mat camera_matrix, dist_coeffs;
+    if (calibration_.is_valid) {
+        camera_matrix = calibration_.camera_matrix.clone();
+        dist_coeffs = calibration_.dist_coeffs.clone();
+        flags |= cv::CALIB_USE_INTRINSIC_GUESS;
+    } else {
+        camera_matrix = cv::Mat::eye(3, 3, CV_64F);
+        dist_coeffs = cv::Mat::zeros(5, 1, CV_64F);
+    }
+
+    std::vector<cv::Mat> rvecs, tvecs;
+    cv::Mat std_intrinsics, std_extrinsics, per_view_errors;
+    const double rms = cv::calibrateCamera(
+        object_points, image_points_, image_size_, camera_matrix, dist_coeffs, rvecs, tvecs,
+        std_intrinsics, std_extrinsics, per_view_errors, flags, kRefitCriteria);
+
+    const double previous = progress_.rms_error;
+    if (previous > 0.0 && std::abs(rms - previous) <= convergence_.rms_tolerance * previous) {
+        stable_count_++;
+    } else {
+        stable_count_ = 0;
+    }
+
+    calibration_.camera_matrix = camera_matrix;
+    calibration_.dist_coeffs = dist_coeffs;
+    calibration_.reprojection_error = rms;
+    calibration_.is_valid = true;
+
+    progress_.rms_error = rms;
+    progress_.view_errors.assign(per_view_errors.begin<double>(), per_view_errors.end<double>());
+    progress_.converged = stable_count_ >= convergence_.stable_views &&
+                          progress_.coverage >= convergence_.min_coverage;
+}
+
+bool IncrementalCalibration::done() const {
+    return progress_.converged || progress_.views >= static_cast<size_t>(convergence_.max_views);
+}
+
+// CameraCalibration
+
 CameraCalibration::CameraCalibration() = default;
 
 bool CameraCalibration::calibrate(
@@ -10,23 +117,25 @@ bool CameraCalibration::calibrate(
     cv::Size pattern_size,
     double square_size
 ) {
-    std::vector<std::vector<cv::Point2f>> image_points;
-    std::vector<std::vector<cv::Point3f>> object_points;
-
-    // Generate object points for chessboard
-    std::vector<cv::Point3f> obj_pts;
-    for (int i = 0; i < pattern_size.height; i++) {
-        for (int j = 0; j < pattern_size.width; j++) {
-            obj_pts.push_back(cv::Point3f(j * square_size, i * square_size, 0.0));
-        }
+    if (images.empty()) {
+        std::cerr << "Not enough valid calibration images (need at least 3)" << std::endl;
+        return false;
     }
+    return calibrateFromCorners(findChessboards(images, pattern_size), images[0].size(), pattern_size, square_size);
+}
 
-    // Find chessboard corners in all images
-    for (const auto& image : images) {
-        std::vector<cv::Point2f> corners;
-        if (detectChessboard(image, pattern_size, corners)) {
+bool CameraCalibration::calibrateFromCorners(
+    const std::vector<std::vector<cv::Point2f>>& corner_sets,
+    cv::Size image_size,
+    cv::Size pattern_size,
+    double square_size
+) {
+    const auto obj_pts = boardPoints(pattern_size, square_size);
+
+    std::vector<std::vector<cv::Point2f>> image_points;
+    for (const auto& corners : corner_sets) {
+        if (corners.size() == obj_pts.size()) {
             image_points.push_back(corners);
-            object_points.push_back(obj_pts);
         }
     }
 
@@ -38,41 +147,65 @@ bool CameraCalibration::calibrate(
     std::cout << "Calibrating with " << image_points.size() << " images..." << std::endl;
 
     // Calibrate camera
-    cv::Mat camera_matrix = cv::Mat::eye(3, 3, CV_64F);
-    cv::Mat dist_coeffs = cv::Mat::zeros(5, 1, CV_64F);
+    const std::vector<std::vector<cv::Point3f>> object_points(image_points.size(), obj_pts);
+    CalibrationData calibration;
+    calibration.camera_matrix = cv::Mat::eye(3, 3, CV_64F);
+    calibration.dist_coeffs = cv::Mat::zeros(5, 1, CV_64F);
+    calibration.image_size = image_size;
     std::vector<cv::Mat> rvecs, tvecs;
 
-    calibration_.image_size = images[0].size();
-
-    double rms_error = cv::calibrateCamera(
+    calibration.reprojection_error = cv::calibrateCamera(
         object_points,
         image_points,
-        calibration_.image_size,
-        camera_matrix,
-        dist_coeffs,
+        image_size,
+        calibration.camera_matrix,
+        calibration.dist_coeffs,
         rvecs,
         tvecs,
         cv::CALIB_FIX_K3
     );
+    calibration.is_valid = true;
 
-    calibration_.camera_matrix = camera_matrix;
-    calibration_.dist_coeffs = dist_coeffs;
-    calibration_.reprojection_error = rms_error;
-    calibration_.is_valid = true;
+    applyCalibration(calibration);
+    return true;
+}
 
-    std::cout << "Calibration complete!" << std::endl;
-    std::cout << "RMS reprojection error: " << rms_error << " pixels" << std::endl;
-    std::cout << "Camera matrix:\n" << camera_matrix << std::endl;
-    std::cout << "Distortion coefficients:\n" << dist_coeffs << std::endl;
+std::vector<std::vector<cv::Point2f>> CameraCalibration::findChessboards(
+    const std::vector<cv::Mat>& images,
+    cv::Size pattern_size
+) {
+    // One stripe per image: detection time varies a lot between images
+    std::vector<std::vector<cv::Point2f>> corner_sets(images.size());
+    cv::parallel_for_(cv::Range(0, static_cast<int>(images.size())), [&](const cv::Range& range) {
+        for (int i = range.start; i < range.end; i++) {
+            if (!detectChessboard(images[i], pattern_size, corner_sets[i])) {
+                corner_sets[i].clear();
+            }
+        }
+    }, static_cast<double>(images.size()));
+    return corner_sets;
+}
 
-    return true;
+void CameraCalibration::applyCalibration(const CalibrationData& calibration) {
+    calibration_.camera_matrix = calibration.camera_matrix;
+    calibration_.dist_coeffs = calibration.dist_coeffs;
+    calibration_.image_size = calibration.image_size;
+    calibration_.reprojection_error = calibration.reprojection_error;
+    calibration_.is_valid = calibration.is_valid;
+    updateUndistortionLut();
+
+    std::cout << "Calibration complete!" << std::endl;
+    std::cout << "RMS reprojection error: " << calibration_.reprojection_error << " pixels" << std::endl;
+    std::cout << "Camera matrix:\n" << calibration_.camera_matrix << std::endl;
+    std::cout << "Distortion coefficients:\n" << calibration_.dist_coeffs << std::endl;
 }
 
 bool CameraCalibration::calibrateFromCamera(
     int camera_index,
     cv::Size pattern_size,
     double square_size,
-    int num_frames
+    int num_frames,
+    const CalibrationConvergence& convergence
 ) {
     cv::VideoCapture camera(camera_index);
     if (!camera.isOpened()) {
@@ -80,37 +213,51 @@ bool CameraCalibration::calibrateFromCamera(
         return false;
     }
 
-    std::vector<cv::Mat> calibration_images;
-    int frames_collected = 0;
+    CalibrationConvergence limits = convergence;
+    limits.max_views = num_frames;
+    limits.min_views = std::min(limits.min_views, num_frames);
+    std::unique_ptr<IncrementalCalibration> session;  // Created with the first frame's size
 
     std::cout << "Collecting calibration images..." << std::endl;
     std::cout << "Press SPACE to capture, ESC to cancel" << std::endl;
 
-    while (frames_collected < num_frames) {
-        cv::Mat frame;
+    cv::Mat frame;
+    while (!session || !session->done()) {
         camera >> frame;
 
         if (frame.empty()) {
             continue;
         }
+        if (!session) {
+            session = std::make_unique<IncrementalCalibration>(frame.size(), pattern_size, square_size, limits);
+        }
 
         // Try to detect chessboard
         std::vector<cv::Point2f> corners;
-        bool found = detectChessboard(frame, pattern_size, corners);
+        bool found = detectChessboard(frame, pattern_size, corners, true);
 
         // Draw corners
         if (found) {
             cv::drawChessboardCorners(frame, pattern_size, corners, found);
         }
 
-        // Display instructions
+        // Display instructions and the live estimate
+        const CalibrationProgress& progress = session->progress();
         cv::putText(frame,
-                    "Frames: " + std::to_string(frames_collected) + "/" + std::to_string(num_frames),
+                    "Frames: " + std::to_string(progress.views) + "/" + std::to_string(num_frames),
                     cv::Point(10, 30),
                     cv::FONT_HERSHEY_SIMPLEX,
                     1.0,
                     cv::Scalar(0, 255, 0),
                     2);
+        cv::putText(frame,
+                    "RMS: " + (progress.rms_error > 0.0 ? cv::format("%.3f px", progress.rms_error) : "-") +
+                        cv::format("  Coverage: %d%%", static_cast<int>(progress.coverage * 100.0)),
+                    cv::Point(10, 65),
+                    cv::FONT_HERSHEY_SIMPLEX,
+                    0.8,
+                    cv::Scalar(0, 255, 0),
+                    2);
 
         cv::imshow("Camera Calibration", frame);
 
@@ -118,17 +265,29 @@ bool CameraCalibration::calibrateFromCamera(
         if (key == 27) { // ESC
             std::cout << "Calibration cancelled" << std::endl;
             return false;
-        } else if (key == ' ' && found) { // SPACE
-            calibration_images.push_back(frame.clone());
-            frames_collected++;
-            std::cout << "Captured frame " << frames_collected << "/" << num_frames << std::endl;
+        } else if (key == ' ' && found && session->addView(corners)) { // SPACE
+            std::cout << "Captured frame " << progress.views << "/" << num_frames
+                      << ": board covers " << static_cast<int>(progress.view_coverage.back() * 100.0)
+                      << "% of the image, coverage " << static_cast<int>(progress.coverage * 100.0) << "%";
+            if (progress.rms_error > 0.0) {
+                std::cout << ", RMS " << progress.rms_error << " px (this view "
+                          << progress.view_errors.back() << " px)";
+            }
+            std::cout << std::endl;
         }
     }
 
     cv::destroyAllWindows();
 
-    // Calibrate using collected images
-    return calibrate(calibration_images, pattern_size, square_size);
+    if (session->converged()) {
+        std::cout << "Calibration converged after " << session->progress().views << " frames" << std::endl;
+    }
+    if (!session->result().is_valid) {
+        std::cerr << "Not enough valid calibration images (need at least 3)" << std::endl;
+        return false;
+    }
+    applyCalibration(session->result());
+    return true;
 }
 
 bool CameraCalibration::save(const std::string& filename) const {
@@ -191,19 +350,77 @@ bool CameraCalibration::load(const std::string& filename) {
         std::cout << "Calibration loaded from: " << filename << std::endl;
     }
 
+    updateUndistortionLut(persist_undistortion_ ? filename + ".lut" : "");
+
     return calibration_.is_valid;
 }
 
+void CameraCalibration::updateUndistortionLut(const std::string& cache_file) {
+    // Invalidate first so a failed rebuild never leaves stale tables behind
+    undistortion_lut_.reset();
+    if (!calibration_.is_valid) {
+        return;
+    }
+
+    if (!cache_file.empty()) {
+        undistortion_lut_ = UndistortionLut::load(
+            cache_file, calibration_.camera_matrix, calibration_.dist_coeffs, calibration_.image_size);
+        if (undistortion_lut_) {
+            std::cout << "Undistortion tables loaded from: " << cache_file << std::endl;
+            return;
+        }
+    }
+
+    auto lut = UndistortionLut::build(
+        calibration_.camera_matrix, calibration_.dist_coeffs, calibration_.image_size);
+    if (!lut) {
+        return;
+    }
+
+    if (!cache_file.empty() && lut->save(cache_file)) {
+        std::cout << "Undistortion tables cached to: " << cache_file << std::endl;
+    }
+    undistortion_lut_ = std::move(lut);
+}
+
 cv::Mat CameraCalibration::undistort(const cv::Mat& image) const {
     if (!calibration_.is_valid) {
         return image;
     }
 
     cv::Mat undistorted;
-    cv::undistort(image, undistorted, calibration_.camera_matrix, calibration_.dist_coeffs);
+    undistort(image, undistorted);
     return undistorted;
 }
 
+void CameraCalibration::undistort(const cv::Mat& image, cv::Mat& undistorted) const {
+    if (!calibration_.is_valid) {
+        image.copyTo(undistorted);
+        return;
+    }
+
+    if (undistortion_lut_ && image.size() == undistortion_lut_->imageSize()) {
+        undistortion_lut_->undistort(image, undistorted);
+        return;
+    }
+
+    cv::undistort(image, undistorted, calibration_.camera_matrix, calibration_.dist_coeffs);
+}
+
+void CameraCalibration::undistort(const cv::UMat& image, cv::UMat& undistorted) const {
+    if (!calibration_.is_valid) {
+        image.copyTo(undistorted);
+        return;
+    }
+
+    if (undistortion_lut_ && image.size() == undistortion_lut_->imageSize()) {
+        undistortion_lut_->undistort(image, undistorted);
+        return;
+    }
+
+    cv::undistort(image, undistorted, calibration_.camera_matrix, calibration_.dist_coeffs);
+}
+
 cv::Mat CameraCalibration::getOptimalCameraMatrix(double alpha) const {
     if (!calibration_.is_valid) {
         return cv::Mat();
@@ -220,7 +437,8 @@ cv::Mat CameraCalibration::getOptimalCameraMatrix(double alpha) const {
 bool CameraCalibration::detectChessboard(
     const cv::Mat& image,
     cv::Size pattern_size,
-    std::vector<cv::Point2f>& corners
+    std::vector<cv::Point2f>& corners,
+    bool fast_check
 ) {
     cv::Mat gray;
     if (image.channels() == 3) {
@@ -233,7 +451,7 @@ bool CameraCalibration::detectChessboard(
         gray,
         pattern_size,
         corners,
-        cv::CALIB_CB_ADAPTIVE_THRESH | cv::CALIB_CB_NORMALIZE_IMAGE
+        cv::CALIB_CB_ADAPTIVE_THRESH | cv::CALIB_CB_NORMALIZE_IMAGE | (fast_check ? cv::CALIB_CB_FAST_CHECK : 0)
     );
 
     if (found) {
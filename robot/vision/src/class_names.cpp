@@ -0,0 +1,62 @@
+#include "class_names.hpp"
+
+#include <array>
+#include <atomic>
+#include <mutex>
+
+namespace navign::robot::vision {
+
+namespace {
+
+/**
+ * @brief Append-only name storage: writers serialize on the mutex, readers
+ *        only load the published pointers
+ */
+struct Table {
+    std::mutex mutex;
+    std::array<std::atomic<const std::string*>, ClassNames::kCapacity> names{};
+    std::atomic<size_t> size{1};
+
+    Table() {
+        names[ClassNames::kUnknown].store(new std::string("Unknown"), std::memory_order_relaxed);
+    }
+};
+
+Table& table() {
+    // Never destroyed: names may be looked up while other statics shut down
+    static Table* instance = new Table();
+    return *instance;
+}
+
+} // namespace
+
+uint16_t ClassNames::intern(std::string_view name) {
+    Table& names = table();
+    std::lock_guard<std::mutex> lock(names.mutex);
+
+    const size_t count = names.size.load(std::memory_order_relaxed);
+    for (size_t id = 1; id < count; id++) {
+        if (*names.names[id].load(std::memory_order_relaxed) == name) {
+            return static_cast<uint16_t>(id);
+        }
+    }
+    if (count >= kCapacity) {
+        return kUnknown;
+    }
+
+    names.names[count].store(new std::string(name), std::memory_order_release);
+    names.size.store(count + 1, std::memory_order_release);
+    return static_cast<uint16_t>(count);
+}
+
+const std::string& ClassNames::name(uint16_t id) {
+    Table& names = table();
+    const std::string* entry = id < kCapacity ? names.names[id].load(std::memory_order_acquire) : nullptr;
+    return entry ? *entry : *names.names[kUnknown].load(std::memory_order_relaxed);
+}
+
+size_t ClassNames::size() {
+    return table().size.load(std::memory_order_acquire);
+}
+
+} // namespace navign::robot::vision
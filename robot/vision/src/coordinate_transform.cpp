@@ -1,127 +1,241 @@
 #include "coordinate_transform.hpp"
+#include <cmath>
 #include <iostream>
+#include <limits>
 
 namespace navign::robot::vision {
 
+namespace {
+
+// Fixed-point iterations for inverting the distortion model, as cv::undistortPoints
+constexpr int kUndistortIterations = 5;
+
+constexpr double kParallelEpsilon = 1e-6;
+
+const cv::Point3d kInvalidPoint(
+    std::numeric_limits<double>::quiet_NaN(),
+    std::numeric_limits<double>::quiet_NaN(),
+    std::numeric_limits<double>::quiet_NaN()
+);
+
+enum class PlaneHit { Hit, Parallel, Behind };
+
+/**
+ * @brief Intersect a world-frame ray from the camera with the plane z = z_plane
+ */
+PlaneHit intersectGround(const cv::Vec3d& origin, const cv::Vec3d& ray, double z_plane, cv::Point3d& out) {
+    if (std::abs(ray[2]) < kParallelEpsilon) {
+        return PlaneHit::Parallel;
+    }
+
+    const double t = (z_plane - origin[2]) / ray[2];
+    if (t < 0) {
+        return PlaneHit::Behind;
+    }
+
+    out = cv::Point3d(origin[0] + t * ray[0], origin[1] + t * ray[1], z_plane);
+    return PlaneHit::Hit;
+}
+
+} // namespace
+
 void CoordinateTransform::setCalibration(const cv::Mat& camera_matrix, const cv::Mat& dist_coeffs) {
-    camera_matrix_ = camera_matrix.clone();
-    dist_coeffs_ = dist_coeffs.clone();
+    camera_matrix.convertTo(camera_matrix_, CV_64F);
+    dist_coeffs.convertTo(dist_coeffs_, CV_64F);
+
+    fx_ = camera_matrix_.at<double>(0, 0);
+    fy_ = camera_matrix_.at<double>(1, 1);
+    cx_ = camera_matrix_.at<double>(0, 2);
+    cy_ = camera_matrix_.at<double>(1, 2);
+
+    // OpenCV order: k1, k2, p1, p2[, k3[, k4, k5, k6[, s1..s4[, tx, ty]]]]
+    dist_.fill(0.0);
+    extended_distortion_ = false;
+    const auto* coeffs = dist_coeffs_.ptr<double>();
+    for (size_t i = 0; i < dist_coeffs_.total(); i++) {
+        if (i < dist_.size()) {
+            dist_[i] = coeffs[i];
+        } else if (coeffs[i] != 0.0) {
+            extended_distortion_ = true;
+        }
+    }
+
     has_calibration_ = true;
 }
 
 void CoordinateTransform::setCameraPose(const cv::Mat& rotation, const cv::Mat& translation) {
-    rotation_ = rotation.clone();
-    translation_ = translation.clone();
+    cv::Mat rotation_64f, translation_64f;
+    rotation.convertTo(rotation_64f, CV_64F);
+    translation.convertTo(translation_64f, CV_64F);
+
+    rotation_ = cv::Matx33d(rotation_64f.reshape(1, 1).ptr<double>());
+    rotation_inv_ = rotation_.t();
+    camera_position_ = cv::Vec3d(translation_64f.reshape(1, 1).ptr<double>());
     has_pose_ = true;
 }
 
-cv::Point3d CoordinateTransform::imageToWorld(const cv::Point2f& image_point, double z_plane) const {
-    if (!has_calibration_ || !has_pose_) {
-        std::cerr << "Missing calibration or pose information" << std::endl;
-        return cv::Point3d(0, 0, 0);
+cv::Point2d CoordinateTransform::normalize(const cv::Point2f& image_point) const {
+    cv::Point2d normalized_lut;
+    if (undistortion_lut_ && undistortion_lut_->lookup(image_point, normalized_lut)) {
+        return normalized_lut;
     }
 
-    // Step 1: Undistort and normalize the image point
-    std::vector<cv::Point2f> points_in = {image_point};
-    std::vector<cv::Point2f> points_out;
-    cv::undistortPoints(points_in, points_out, camera_matrix_, dist_coeffs_);
+    if (extended_distortion_) {
+        // Rational/thin-prism models: defer to OpenCV (allocates)
+        cv::Point2f normalized;
+        cv::Mat src(1, 1, CV_32FC2, const_cast<cv::Point2f*>(&image_point));
+        cv::Mat dst(1, 1, CV_32FC2, &normalized);
+        cv::undistortPoints(src, dst, camera_matrix_, dist_coeffs_);
+        return cv::Point2d(normalized.x, normalized.y);
+    }
 
-    cv::Point2f normalized = points_out[0];
+    const double k1 = dist_[0], k2 = dist_[1], p1 = dist_[2], p2 = dist_[3], k3 = dist_[4];
 
-    // Step 2: Create ray in camera coordinates
-    cv::Mat ray_camera = (cv::Mat_<double>(3, 1) << normalized.x, normalized.y, 1.0);
+    const double x0 = (image_point.x - cx_) / fx_;
+    const double y0 = (image_point.y - cy_) / fy_;
+    double x = x0;
+    double y = y0;
 
-    // Step 3: Transform ray to world coordinates
-    cv::Mat ray_world = rotation_ * ray_camera;
+    for (int i = 0; i < kUndistortIterations; i++) {
+        const double r2 = x * x + y * y;
+        const double icdist = 1.0 / (1.0 + ((k3 * r2 + k2) * r2 + k1) * r2);
+        const double delta_x = 2.0 * p1 * x * y + p2 * (r2 + 2.0 * x * x);
+        const double delta_y = p1 * (r2 + 2.0 * y * y) + 2.0 * p2 * x * y;
+        x = (x0 - delta_x) * icdist;
+        y = (y0 - delta_y) * icdist;
+    }
 
-    // Normalize ray direction
-    double norm = cv::norm(ray_world);
-    ray_world /= norm;
+    return cv::Point2d(x, y);
+}
 
-    // Step 4: Camera position in world coordinates
-    cv::Mat cam_pos_world = -rotation_.t() * translation_;
+cv::Point2f CoordinateTransform::project(double x, double y) const {
+    if (extended_distortion_) {
+        std::vector<cv::Point3d> object = {cv::Point3d(x, y, 1.0)};
+        std::vector<cv::Point2d> image;
+        cv::projectPoints(object, cv::Vec3d(0, 0, 0), cv::Vec3d(0, 0, 0),
+                          camera_matrix_, dist_coeffs_, image);
+        return cv::Point2f(static_cast<float>(image[0].x), static_cast<float>(image[0].y));
+    }
 
-    // Step 5: Intersect ray with z = z_plane
-    double cam_z = cam_pos_world.at<double>(2, 0);
-    double ray_z = ray_world.at<double>(2, 0);
+    const double k1 = dist_[0], k2 = dist_[1], p1 = dist_[2], p2 = dist_[3], k3 = dist_[4];
 
-    if (std::abs(ray_z) < 1e-6) {
-        std::cerr << "Ray is parallel to ground plane" << std::endl;
-        return cv::Point3d(0, 0, 0);
-    }
+    const double r2 = x * x + y * y;
+    const double radial = 1.0 + ((k3 * r2 + k2) * r2 + k1) * r2;
+    const double xd = x * radial + 2.0 * p1 * x * y + p2 * (r2 + 2.0 * x * x);
+    const double yd = y * radial + p1 * (r2 + 2.0 * y * y) + 2.0 * p2 * x * y;
 
-    double t = (z_plane - cam_z) / ray_z;
+    return cv::Point2f(
+        static_cast<float>(fx_ * xd + cx_),
+        static_cast<float>(fy_ * yd + cy_)
+    );
+}
 
-    if (t < 0) {
-        std::cerr << "Intersection behind camera" << std::endl;
+cv::Point3d CoordinateTransform::imageToWorld(const cv::Point2f& image_point, double z_plane) const {
+    if (!has_calibration_ || !has_pose_) {
+        std::cerr << "Missing calibration or pose information" << std::endl;
         return cv::Point3d(0, 0, 0);
     }
 
-    // Step 6: Compute intersection point
-    cv::Point3d world_point(
-        cam_pos_world.at<double>(0, 0) + t * ray_world.at<double>(0, 0),
-        cam_pos_world.at<double>(1, 0) + t * ray_world.at<double>(1, 0),
-        z_plane
-    );
+    // Undistort, build the camera-frame ray and rotate it into the world
+    const cv::Point2d normalized = normalize(image_point);
+    const cv::Vec3d ray_world = rotation_ * cv::Vec3d(normalized.x, normalized.y, 1.0);
+
+    cv::Point3d world_point;
+    switch (intersectGround(camera_position_, ray_world, z_plane, world_point)) {
+        case PlaneHit::Parallel:
+            std::cerr << "Ray is parallel to ground plane" << std::endl;
+            return cv::Point3d(0, 0, 0);
+        case PlaneHit::Behind:
+            std::cerr << "Intersection behind camera" << std::endl;
+            return cv::Point3d(0, 0, 0);
+        case PlaneHit::Hit:
+            break;
+    }
 
     return world_point;
 }
 
-cv::Point2f CoordinateTransform::worldToImage(const cv::Point3d& world_point) const {
+size_t CoordinateTransform::imageToWorld(
+    std::span<const cv::Point2f> image_points,
+    std::span<cv::Point3d> world_points,
+    double z_plane
+) const {
+    CV_Assert(world_points.size() >= image_points.size());
+
     if (!has_calibration_ || !has_pose_) {
-        std::cerr << "Missing calibration or pose information" << std::endl;
-        return cv::Point2f(0, 0);
+        std::fill(world_points.begin(), world_points.begin() + image_points.size(), kInvalidPoint);
+        return 0;
     }
 
-    // Convert world point to camera coordinates
-    cv::Mat world_pt = (cv::Mat_<double>(3, 1) << world_point.x, world_point.y, world_point.z);
-    cv::Mat camera_pt = rotation_.t() * (world_pt - translation_);
+    size_t valid = 0;
+    for (size_t i = 0; i < image_points.size(); i++) {
+        const cv::Point2d normalized = normalize(image_points[i]);
+        const cv::Vec3d ray_world = rotation_ * cv::Vec3d(normalized.x, normalized.y, 1.0);
 
-    // Project to image plane
-    double x = camera_pt.at<double>(0, 0) / camera_pt.at<double>(2, 0);
-    double y = camera_pt.at<double>(1, 0) / camera_pt.at<double>(2, 0);
+        if (intersectGround(camera_position_, ray_world, z_plane, world_points[i]) == PlaneHit::Hit) {
+            valid++;
+        } else {
+            world_points[i] = kInvalidPoint;
+        }
+    }
 
-    // Apply camera intrinsics
-    double fx = camera_matrix_.at<double>(0, 0);
-    double fy = camera_matrix_.at<double>(1, 1);
-    double cx = camera_matrix_.at<double>(0, 2);
-    double cy = camera_matrix_.at<double>(1, 2);
+    return valid;
+}
 
-    cv::Point2f image_point(
-        static_cast<float>(fx * x + cx),
-        static_cast<float>(fy * y + cy)
-    );
+cv::Point2f CoordinateTransform::worldToImage(const cv::Point3d& world_point) const {
+    if (!has_calibration_ || !has_pose_) {
+        std::cerr << "Missing calibration or pose information" << std::endl;
+        return cv::Point2f(0, 0);
+    }
 
+    cv::Point2f image_point;
+    worldToImage(std::span<const cv::Point3d>(&world_point, 1), std::span<cv::Point2f>(&image_point, 1));
     return image_point;
 }
 
-cv::Point3d CoordinateTransform::getRayDirection(const cv::Point2f& image_point) const {
+void CoordinateTransform::worldToImage(
+    std::span<const cv::Point3d> world_points,
+    std::span<cv::Point2f> image_points
+) const {
+    CV_Assert(image_points.size() >= world_points.size());
+
     if (!has_calibration_ || !has_pose_) {
-        return cv::Point3d(0, 0, 0);
+        std::fill(image_points.begin(), image_points.begin() + world_points.size(), cv::Point2f(0, 0));
+        return;
     }
 
-    // Undistort and normalize
-    std::vector<cv::Point2f> points_in = {image_point};
-    std::vector<cv::Point2f> points_out;
-    cv::undistortPoints(points_in, points_out, camera_matrix_, dist_coeffs_);
+    for (size_t i = 0; i < world_points.size(); i++) {
+        // Convert world point to camera coordinates
+        const cv::Vec3d world_pt(world_points[i].x, world_points[i].y, world_points[i].z);
+        const cv::Vec3d camera_pt = rotation_inv_ * (world_pt - camera_position_);
 
-    cv::Point2f normalized = points_out[0];
+        // Project to the image plane through the lens model
+        image_points[i] = project(camera_pt[0] / camera_pt[2], camera_pt[1] / camera_pt[2]);
+    }
+}
 
-    // Create ray in camera coordinates
-    cv::Mat ray_camera = (cv::Mat_<double>(3, 1) << normalized.x, normalized.y, 1.0);
+cv::Point3d CoordinateTransform::getRayDirection(const cv::Point2f& image_point) const {
+    cv::Point3d direction;
+    getRayDirections(std::span<const cv::Point2f>(&image_point, 1), std::span<cv::Point3d>(&direction, 1));
+    return direction;
+}
 
-    // Transform to world coordinates
-    cv::Mat ray_world = rotation_ * ray_camera;
+void CoordinateTransform::getRayDirections(
+    std::span<const cv::Point2f> image_points,
+    std::span<cv::Point3d> directions
+) const {
+    CV_Assert(directions.size() >= image_points.size());
 
-    // Normalize
-    double norm = cv::norm(ray_world);
-    ray_world /= norm;
+    if (!has_calibration_ || !has_pose_) {
+        std::fill(directions.begin(), directions.begin() + image_points.size(), cv::Point3d(0, 0, 0));
+        return;
+    }
 
-    return cv::Point3d(
-        ray_world.at<double>(0, 0),
-        ray_world.at<double>(1, 0),
-        ray_world.at<double>(2, 0)
-    );
+    for (size_t i = 0; i < image_points.size(); i++) {
+        const cv::Point2d normalized = normalize(image_points[i]);
+        const cv::Vec3d ray_world = cv::normalize(rotation_ * cv::Vec3d(normalized.x, normalized.y, 1.0));
+        directions[i] = cv::Point3d(ray_world[0], ray_world[1], ray_world[2]);
+    }
 }
 
 std::optional<cv::Point3d> CoordinateTransform::intersectRayPlane(
@@ -163,13 +277,17 @@ cv::Point3d CoordinateTransform::getCameraPosition() const {
         return cv::Point3d(0, 0, 0);
     }
 
-    cv::Mat cam_pos_world = -rotation_.t() * translation_;
+    return cv::Point3d(camera_position_[0], camera_position_[1], camera_position_[2]);
+}
 
-    return cv::Point3d(
-        cam_pos_world.at<double>(0, 0),
-        cam_pos_world.at<double>(1, 0),
-        cam_pos_world.at<double>(2, 0)
-    );
+cv::Point3d CoordinateTransform::cameraToWorld(const cv::Point3d& camera_point) const {
+    const cv::Vec3d world = rotation_ * cv::Vec3d(camera_point.x, camera_point.y, camera_point.z) + camera_position_;
+    return cv::Point3d(world[0], world[1], world[2]);
+}
+
+cv::Point3d CoordinateTransform::worldToCamera(const cv::Point3d& world_point) const {
+    const cv::Vec3d camera = rotation_inv_ * (cv::Vec3d(world_point.x, world_point.y, world_point.z) - camera_position_);
+    return cv::Point3d(camera[0], camera[1], camera[2]);
 }
 
 } // namespace navign::robot::vision
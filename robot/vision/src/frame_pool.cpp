@@ -0,0 +1,53 @@
+#include "frame_pool.hpp"
+
+namespace navign::robot::vision {
+
+FramePool::FramePool(size_t capacity, cv::Size frame_size)
+    : storage_(std::make_shared<Storage>()) {
+    storage_->frames.reserve(capacity);
+    storage_->free_list.reserve(capacity);
+
+    for (size_t i = 0; i < capacity; i++) {
+        auto frame = std::make_unique<Frame>();
+        frame->image.create(frame_size, CV_8UC3);
+        frame->gray.create(frame_size, CV_8UC1);
+        storage_->frame_bytes = frame->image.total() * frame->image.elemSize() +
+                                frame->gray.total() * frame->gray.elemSize();
+        storage_->free_list.push_back(frame.get());
+        storage_->frames.push_back(std::move(frame));
+    }
+}
+
+std::shared_ptr<Frame> FramePool::acquire() {
+    Frame* frame = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(storage_->mutex);
+        if (storage_->free_list.empty()) {
+            return nullptr;
+        }
+        frame = storage_->free_list.back();
+        storage_->free_list.pop_back();
+    }
+
+    // The deleter returns the frame to the free list; it holds the storage
+    // alive so frames may outlive the pool object itself.
+    return std::shared_ptr<Frame>(frame, [storage = storage_](Frame* released) {
+        std::lock_guard<std::mutex> lock(storage->mutex);
+        storage->free_list.push_back(released);
+    });
+}
+
+size_t FramePool::capacity() const {
+    return storage_->frames.size();
+}
+
+size_t FramePool::bytes() const {
+    return storage_->frames.size() * storage_->frame_bytes;
+}
+
+size_t FramePool::available() const {
+    std::lock_guard<std::mutex> lock(storage_->mutex);
+    return storage_->free_list.size();
+}
+
+} // namespace navign::robot::vision
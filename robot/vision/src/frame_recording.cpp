@@ -0,0 +1,362 @@
+#include "frame_recording.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace navign::robot::vision {
+
+namespace {
+
+constexpr char kHeaderMagic[8] = {'N', 'A', 'V', 'F', 'R', 'M', '0', '1'};
+constexpr char kFooterMagic[8] = {'N', 'A', 'V', 'I', 'D', 'X', '0', '1'};
+constexpr uint32_t kFormatVersion = 1;
+constexpr size_t kAlignment = 8;
+constexpr auto kWriterPollTimeout = std::chrono::milliseconds(100);
+
+struct FileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t codec;
+    uint32_t width;
+    uint32_t height;
+    uint64_t reserved;
+};
+
+struct RecordHeader {
+    uint64_t timestamp_ns;  // Since the first frame
+    uint32_t size;          // Payload bytes, before padding
+    uint32_t reserved;
+};
+
+struct FileFooter {
+    uint64_t index_offset;
+    uint64_t frame_count;
+    char magic[8];
+};
+
+static_assert(sizeof(FileHeader) == 32 && sizeof(RecordHeader) == 16 && sizeof(FileFooter) == 24,
+              "recording structs must have no padding");
+
+size_t padded(size_t size) {
+    return (size + kAlignment - 1) & ~(kAlignment - 1);
+}
+
+} // namespace
+
+// FrameRecorder
+
+FrameRecorder::~FrameRecorder() {
+    stop();
+}
+
+bool FrameRecorder::start(const std::string& path, cv::Size frame_size, RecordingCodec codec, int jpeg_quality) {
+    stop();
+
+    file_ = std::fopen(path.c_str(), "wb");
+    if (!file_) {
+        std::cerr << "Failed to create recording " << path << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    path_ = path;
+    frame_size_ = frame_size;
+    codec_ = codec;
+    jpeg_quality_ = jpeg_quality;
+    offsets_.clear();
+    position_ = 0;
+    has_first_timestamp_ = false;
+    frames_written_ = 0;
+
+    FileHeader header{};
+    std::memcpy(header.magic, kHeaderMagic, sizeof(header.magic));
+    header.version = kFormatVersion;
+    header.codec = static_cast<uint32_t>(codec);
+    header.width = static_cast<uint32_t>(frame_size.width);
+    header.height = static_cast<uint32_t>(frame_size.height);
+    if (!writeBytes(&header, sizeof(header))) {
+        std::fclose(file_);
+        file_ = nullptr;
+        return false;
+    }
+
+    queue_.reset();
+    running_ = true;
+    writer_ = std::thread(&FrameRecorder::writerLoop, this);
+    return true;
+}
+
+void FrameRecorder::record(FramePtr frame) {
+    if (running_.load()) {
+        queue_.push(std::move(frame));
+    }
+}
+
+void FrameRecorder::stop() {
+    if (!file_) {
+        return;
+    }
+
+    // The writer drains the queue before it exits
+    running_ = false;
+    queue_.close();
+    if (writer_.joinable()) {
+        writer_.join();
+    }
+
+    FileFooter footer{};
+    footer.index_offset = position_;
+    footer.frame_count = offsets_.size();
+    std::memcpy(footer.magic, kFooterMagic, sizeof(footer.magic));
+    const bool indexed = writeBytes(offsets_.data(), offsets_.size() * sizeof(uint64_t)) &&
+                         writeBytes(&footer, sizeof(footer));
+
+    std::fclose(file_);
+    file_ = nullptr;
+
+    std::cout << "Recorded " << offsets_.size() << " frames to " << path_;
+    if (queue_.droppedCount() > 0) {
+        std::cout << " (" << queue_.droppedCount() << " dropped)";
+    }
+    if (!indexed) {
+        std::cout << " without index";
+    }
+    std::cout << std::endl;
+}
+
+void FrameRecorder::writerLoop() {
+    while (running_.load() || queue_.size() > 0) {
+        auto frame = queue_.pop(kWriterPollTimeout);
+        if (frame && !writeFrame(**frame)) {
+            std::cerr << "Recording to " << path_ << " failed, stopping" << std::endl;
+            running_ = false;
+            return;
+        }
+    }
+}
+
+bool FrameRecorder::writeFrame(const Frame& frame) {
+    if (frame.image.size() != frame_size_ || frame.image.type() != CV_8UC3) {
+        return true;  // Skip frames the header does not describe
+    }
+
+    const uint8_t* payload = nullptr;
+    size_t payload_size = 0;
+    cv::Mat continuous;
+    if (codec_ == RecordingCodec::Mjpeg) {
+        cv::imencode(".jpg", frame.image, encoded_, {cv::IMWRITE_JPEG_QUALITY, jpeg_quality_});
+        payload = encoded_.data();
+        payload_size = encoded_.size();
+    } else {
+        continuous = frame.image.isContinuous() ? frame.image : frame.image.clone();
+        payload = continuous.data;
+        payload_size = continuous.total() * continuous.elemSize();
+    }
+
+    if (!has_first_timestamp_) {
+        first_timestamp_ = frame.capture_time;
+        has_first_timestamp_ = true;
+    }
+
+    RecordHeader record{};
+    record.timestamp_ns = static_cast<uint64_t>(std::max<int64_t>(0,
+        std::chrono::duration_cast<std::chrono::nanoseconds>(frame.capture_time - first_timestamp_).count()));
+    record.size = static_cast<uint32_t>(payload_size);
+
+    const uint64_t offset = position_;
+    static constexpr uint8_t kPadding[kAlignment] = {};
+    if (!writeBytes(&record, sizeof(record)) || !writeBytes(payload, payload_size) ||
+        !writeBytes(kPadding, padded(payload_size) - payload_size)) {
+        return false;
+    }
+
+    offsets_.push_back(offset);
+    frames_written_++;
+    return true;
+}
+
+bool FrameRecorder::writeBytes(const void* data, size_t size) {
+    if (size == 0) {
+        return true;
+    }
+    if (std::fwrite(data, 1, size, file_) != size) {
+        return false;
+    }
+    position_ += size;
+    return true;
+}
+
+// ReplaySource
+
+ReplaySource::~ReplaySource() {
+    release();
+}
+
+bool ReplaySource::open(const std::string& path, ReplayPacing pacing, bool loop) {
+    release();
+    path_ = path;
+    pacing_ = pacing;
+    loop_ = loop;
+
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::cerr << "Failed to open recording " << path << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    struct stat info {};
+    if (::fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(FileHeader)) {
+        std::cerr << "Recording " << path << " is empty" << std::endl;
+        ::close(fd);
+        return false;
+    }
+
+    // The mapping stays valid after the descriptor is closed
+    size_ = static_cast<size_t>(info.st_size);
+    void* mapping = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        std::cerr << "Failed to map recording " << path << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    ::madvise(mapping, size_, MADV_SEQUENTIAL);
+    ::madvise(mapping, size_, MADV_WILLNEED);
+    data_ = static_cast<const uint8_t*>(mapping);
+
+    FileHeader header;
+    std::memcpy(&header, data_, sizeof(header));
+    if (std::memcmp(header.magic, kHeaderMagic, sizeof(header.magic)) != 0 ||
+        header.version != kFormatVersion ||
+        header.codec > static_cast<uint32_t>(RecordingCodec::Mjpeg)) {
+        std::cerr << path << " is not a frame recording" << std::endl;
+        release();
+        return false;
+    }
+    codec_ = static_cast<RecordingCodec>(header.codec);
+    frame_size_ = cv::Size(static_cast<int>(header.width), static_cast<int>(header.height));
+
+    if (!indexRecords() || records_.empty()) {
+        std::cerr << "Recording " << path << " has no frames" << std::endl;
+        release();
+        return false;
+    }
+
+    next_ = 0;
+    finished_ = false;
+    started_ = false;
+    return true;
+}
+
+bool ReplaySource::indexRecords() {
+    records_.clear();
+    const size_t raw_size = static_cast<size_t>(frame_size_.area()) * 3;
+
+    auto addRecord = [&](uint64_t offset) {
+        if (offset + sizeof(RecordHeader) > size_) {
+            return false;
+        }
+        RecordHeader record;
+        std::memcpy(&record, data_ + offset, sizeof(record));
+        if (offset + sizeof(RecordHeader) + record.size > size_ ||
+            (codec_ == RecordingCodec::RawBgr && record.size != raw_size)) {
+            return false;
+        }
+        records_.push_back({record.timestamp_ns, data_ + offset + sizeof(RecordHeader), record.size});
+        return true;
+    };
+
+    // Complete recordings end with an index
+    if (size_ >= sizeof(FileHeader) + sizeof(FileFooter)) {
+        FileFooter footer;
+        std::memcpy(&footer, data_ + size_ - sizeof(footer), sizeof(footer));
+        const uint64_t index_end = footer.index_offset + footer.frame_count * sizeof(uint64_t);
+        if (std::memcmp(footer.magic, kFooterMagic, sizeof(footer.magic)) == 0 &&
+            index_end + sizeof(footer) == size_) {
+            records_.reserve(footer.frame_count);
+            for (uint64_t i = 0; i < footer.frame_count; i++) {
+                uint64_t offset;
+                std::memcpy(&offset, data_ + footer.index_offset + i * sizeof(uint64_t), sizeof(offset));
+                if (!addRecord(offset)) {
+                    return false;
+                }
+            }
+            return true;
+        }
+    }
+
+    // Cut short: walk the records up to the first incomplete one
+    std::cerr << "Recording " << path_ << " has no index, scanning frames" << std::endl;
+    uint64_t offset = sizeof(FileHeader);
+    while (addRecord(offset)) {
+        offset += sizeof(RecordHeader) + padded(records_.back().size);
+    }
+    return true;
+}
+
+bool ReplaySource::read(Frame& frame) {
+    if (!data_ || finished_) {
+        return false;
+    }
+    if (next_ >= records_.size()) {
+        if (!loop_) {
+            finished_ = true;
+            return false;
+        }
+        // The next pass continues the timeline one average frame interval
+        // after the last frame, so capture times keep increasing
+        const uint64_t last_ns = records_.back().timestamp_ns;
+        const uint64_t interval_ns = records_.size() > 1 ? last_ns / (records_.size() - 1) : 0;
+        start_time_ += std::chrono::nanoseconds(last_ns + interval_ns);
+        next_ = 0;
+    }
+
+    const Record& record = records_[next_];
+    if (!started_) {
+        start_time_ = std::chrono::steady_clock::now();
+        started_ = true;
+    }
+    const auto capture_time = start_time_ + std::chrono::nanoseconds(record.timestamp_ns);
+    if (pacing_ == ReplayPacing::Realtime) {
+        std::this_thread::sleep_until(capture_time);
+    }
+    next_++;
+
+    if (codec_ == RecordingCodec::Mjpeg) {
+        const cv::Mat encoded(1, static_cast<int>(record.size), CV_8UC1, const_cast<uint8_t*>(record.payload));
+        cv::imdecode(encoded, cv::IMREAD_COLOR, &frame.image);
+        if (frame.image.empty()) {
+            return false;
+        }
+    } else {
+        const cv::Mat image(frame_size_, CV_8UC3, const_cast<uint8_t*>(record.payload));
+        image.copyTo(frame.image);
+    }
+
+    // The recorded timing, also in fast mode where reading runs ahead of or
+    // behind it
+    frame.capture_time = capture_time;
+    return true;
+}
+
+void ReplaySource::skip() {
+    if (next_ < records_.size()) {
+        next_++;
+    }
+}
+
+void ReplaySource::release() {
+    if (data_) {
+        ::munmap(const_cast<uint8_t*>(data_), size_);
+        data_ = nullptr;
+    }
+    size_ = 0;
+    records_.clear();
+}
+
+} // namespace navign::robot::vision
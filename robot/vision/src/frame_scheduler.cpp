@@ -0,0 +1,135 @@
+#include "frame_scheduler.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <thread>
+
+#include <pthread.h>
+#include <sched.h>
+
+namespace navign::robot::vision {
+
+bool tuneCurrentThread(int priority, const std::vector<int>& cpus, const std::string& name) {
+    bool ok = true;
+
+    if (priority > 0) {
+        sched_param param{};
+        param.sched_priority = std::clamp(priority, sched_get_priority_min(SCHED_FIFO),
+                                          sched_get_priority_max(SCHED_FIFO));
+        const int result = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+        if (result != 0) {
+            std::cerr << "Warning: Cannot give " << name << " real-time priority " << param.sched_priority
+                      << ": " << std::strerror(result) << std::endl;
+            ok = false;
+        }
+    }
+
+    if (!cpus.empty()) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for (int cpu : cpus) {
+            if (cpu >= 0 && cpu < CPU_SETSIZE) {
+                CPU_SET(cpu, &set);
+            }
+        }
+        const int result = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+        if (result != 0) {
+            std::cerr << "Warning: Cannot pin " << name << " to its CPUs: " << std::strerror(result) << std::endl;
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+const char* loadSheddingName(LoadShedding shedding) {
+    switch (shedding) {
+        case LoadShedding::Off: return "off";
+        case LoadShedding::Objects: return "objects";
+        case LoadShedding::Frames: return "frames";
+    }
+    return "unknown";
+}
+
+void FrameScheduler::configure(const SchedulerConfig& config) {
+    config_ = config;
+    period_ = std::chrono::nanoseconds(std::chrono::seconds(1)) / std::max(1, config.fps);
+    object_period_ = config.object_fps > 0
+        ? std::chrono::nanoseconds(std::chrono::seconds(1)) / config.object_fps
+        : std::chrono::nanoseconds(0);
+
+    // YOLO running slower than the camera has until its own next slot
+    apriltag_deadline_ = config.deadline.count() > 0 ? config.deadline : period_;
+    object_deadline_ = std::max(apriltag_deadline_, object_period_);
+
+    next_slot_ = {};
+    next_object_due_ = {};
+    consecutive_frame_sheds_ = 0;
+    consecutive_object_sheds_ = 0;
+    for (auto& counters : deadlines_) {
+        counters.last_missed = false;
+    }
+}
+
+void FrameScheduler::waitForSlot() {
+    const auto now = Clock::now();
+    if (next_slot_ == Clock::time_point{} || now - next_slot_ > period_) {
+        next_slot_ = now;
+    } else {
+        std::this_thread::sleep_until(next_slot_);
+    }
+    next_slot_ += period_;
+}
+
+FrameScheduler::Work FrameScheduler::plan(Clock::time_point capture_time) {
+    const bool stale = Clock::now() - capture_time > period_;
+
+    if (config_.shedding == LoadShedding::Frames) {
+        const bool behind = stale || lastMissed(ResultKind::AprilTags);
+        if (behind && consecutive_frame_sheds_ < kMaxConsecutiveSheds) {
+            consecutive_frame_sheds_++;
+            frames_shed_.fetch_add(1, std::memory_order_relaxed);
+            return {};
+        }
+        consecutive_frame_sheds_ = 0;
+    }
+
+    // YOLO slots follow capture time, not arrival order
+    if (object_period_.count() > 0 && capture_time < next_object_due_) {
+        return {true, false};
+    }
+
+    if (config_.shedding == LoadShedding::Objects) {
+        const bool behind = stale || lastMissed(ResultKind::Objects);
+        if (behind && consecutive_object_sheds_ < kMaxConsecutiveSheds) {
+            // The slot stays open for the next frame
+            consecutive_object_sheds_++;
+            object_frames_shed_.fetch_add(1, std::memory_order_relaxed);
+            return {true, false};
+        }
+        consecutive_object_sheds_ = 0;
+    }
+
+    if (object_period_.count() > 0) {
+        // Stay on the grid unless more than a period behind
+        next_object_due_ = capture_time - next_object_due_ > object_period_
+            ? capture_time + object_period_ : next_object_due_ + object_period_;
+    }
+    return {true, true};
+}
+
+void FrameScheduler::recordResult(ResultKind kind, Clock::time_point capture_time, Clock::time_point published) {
+    const auto deadline = kind == ResultKind::AprilTags ? apriltag_deadline_ : object_deadline_;
+    const bool missed = published - capture_time > deadline;
+    auto& counters = deadlines_[static_cast<size_t>(kind)];
+    (missed ? counters.missed : counters.met).fetch_add(1, std::memory_order_relaxed);
+    counters.last_missed.store(missed, std::memory_order_relaxed);
+}
+
+FrameScheduler::DeadlineStats FrameScheduler::deadlineStats(ResultKind kind) const {
+    const auto& counters = deadlines_[static_cast<size_t>(kind)];
+    return {counters.met.load(std::memory_order_relaxed), counters.missed.load(std::memory_order_relaxed)};
+}
+
+} // namespace navign::robot::vision
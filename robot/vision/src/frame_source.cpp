@@ -0,0 +1,100 @@
+#include "frame_source.hpp"
+
+#include <iostream>
+#include <sstream>
+
+namespace navign::robot::vision {
+
+bool VideoCaptureSource::open(int device, cv::Size size, int fps) {
+    device_ = device;
+    if (!capture_.open(device)) {
+        return false;
+    }
+
+    capture_.set(cv::CAP_PROP_FRAME_WIDTH, size.width);
+    capture_.set(cv::CAP_PROP_FRAME_HEIGHT, size.height);
+    capture_.set(cv::CAP_PROP_FPS, fps);
+
+    // The driver may pick the closest mode it supports
+    frame_size_ = cv::Size(
+        static_cast<int>(capture_.get(cv::CAP_PROP_FRAME_WIDTH)),
+        static_cast<int>(capture_.get(cv::CAP_PROP_FRAME_HEIGHT))
+    );
+    if (frame_size_.area() <= 0) {
+        frame_size_ = size;
+    }
+    return true;
+}
+
+bool VideoCaptureSource::read(Frame& frame) {
+    if (!capture_.read(frame.image) || frame.image.empty()) {
+        return false;
+    }
+    frame.capture_time = std::chrono::steady_clock::now();
+    return true;
+}
+
+std::string GStreamerSource::pipeline(int device, cv::Size size, int fps, CapturePixelFormat format,
+                                      const std::string& jpeg_decoder) {
+    std::ostringstream caps;
+    caps << "width=" << size.width << ",height=" << size.height << ",framerate=" << fps << "/1";
+
+    // DMABUF buffers between v4l2src and the decoder avoid a copy on SoCs
+    // whose decoder imports them; videoconvert is a no-op when the decoder
+    // already outputs NV12
+    std::ostringstream out;
+    out << "v4l2src device=/dev/video" << device << " io-mode=dmabuf ! ";
+    switch (format) {
+        case CapturePixelFormat::Mjpeg:
+            out << "image/jpeg," << caps.str() << " ! " << jpeg_decoder << " ! ";
+            break;
+        case CapturePixelFormat::Yuyv:
+            out << "video/x-raw,format=YUY2," << caps.str() << " ! ";
+            break;
+        case CapturePixelFormat::Nv12:
+            out << "video/x-raw,format=NV12," << caps.str() << " ! ";
+            break;
+        case CapturePixelFormat::Auto:
+            out << "video/x-raw," << caps.str() << " ! ";
+            break;
+    }
+    out << "videoconvert ! video/x-raw,format=NV12 ! appsink drop=true max-buffers=2 sync=false";
+    return out.str();
+}
+
+bool GStreamerSource::open(int device, cv::Size size, int fps, CapturePixelFormat format,
+                           const std::string& jpeg_decoder) {
+    device_ = device;
+    const std::string description = pipeline(device, size, fps, format, jpeg_decoder);
+    if (!capture_.open(description, cv::CAP_GSTREAMER)) {
+        std::cerr << "Failed to launch GStreamer pipeline: " << description << std::endl;
+        return false;
+    }
+
+    // NV12 arrives as one (height * 3/2) x width plane
+    frame_size_ = cv::Size(
+        static_cast<int>(capture_.get(cv::CAP_PROP_FRAME_WIDTH)),
+        static_cast<int>(capture_.get(cv::CAP_PROP_FRAME_HEIGHT))
+    );
+    if (frame_size_.area() <= 0) {
+        frame_size_ = size;
+    }
+    return true;
+}
+
+bool GStreamerSource::read(Frame& frame) {
+    if (!capture_.read(nv12_) || nv12_.empty() || nv12_.type() != CV_8UC1 ||
+        nv12_.rows != frame_size_.height * 3 / 2 || nv12_.cols != frame_size_.width) {
+        return false;
+    }
+    frame.capture_time = std::chrono::steady_clock::now();
+
+    // The Y plane is the gray image AprilTag decodes
+    nv12_.rowRange(0, frame_size_.height).copyTo(frame.gray);
+    if (color_output_) {
+        cv::cvtColor(nv12_, frame.image, cv::COLOR_YUV2BGR_NV12);
+    }
+    return true;
+}
+
+} // namespace navign::robot::vision
@@ -0,0 +1,79 @@
+#include "inference_backend.hpp"
+
+#include <algorithm>
+#include <cctype>
+
+namespace navign::robot::vision {
+
+namespace {
+
+std::string toLower(const std::string& name) {
+    std::string lower = name;
+    std::transform(lower.begin(), lower.end(), lower.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return lower;
+}
+
+} // namespace
+
+std::optional<ExecutionProvider> parseExecutionProvider(const std::string& name) {
+    const std::string lower = toLower(name);
+
+    if (lower == "cpu") return ExecutionProvider::CPU;
+    if (lower == "cuda") return ExecutionProvider::CUDA;
+    if (lower == "tensorrt" || lower == "trt") return ExecutionProvider::TensorRT;
+    if (lower == "openvino") return ExecutionProvider::OpenVINO;
+    if (lower == "coreml") return ExecutionProvider::CoreML;
+    return std::nullopt;
+}
+
+std::optional<ModelPrecision> parseModelPrecision(const std::string& name) {
+    const std::string lower = toLower(name);
+
+    if (lower == "auto") return ModelPrecision::Auto;
+    if (lower == "fp32") return ModelPrecision::FP32;
+    if (lower == "fp16") return ModelPrecision::FP16;
+    if (lower == "int8") return ModelPrecision::INT8;
+    return std::nullopt;
+}
+
+const char* executionProviderName(ExecutionProvider provider) {
+    switch (provider) {
+        case ExecutionProvider::CPU: return "cpu";
+        case ExecutionProvider::CUDA: return "cuda";
+        case ExecutionProvider::TensorRT: return "tensorrt";
+        case ExecutionProvider::OpenVINO: return "openvino";
+        case ExecutionProvider::CoreML: return "coreml";
+    }
+    return "unknown";
+}
+
+std::optional<DnnTarget> parseDnnTarget(const std::string& name) {
+    const std::string lower = toLower(name);
+
+    if (lower == "cpu") return DnnTarget::CPU;
+    if (lower == "opencl" || lower == "ocl") return DnnTarget::OpenCL;
+    if (lower == "cuda") return DnnTarget::CUDA;
+    return std::nullopt;
+}
+
+const char* dnnTargetName(DnnTarget target) {
+    switch (target) {
+        case DnnTarget::CPU: return "cpu";
+        case DnnTarget::OpenCL: return "opencl";
+        case DnnTarget::CUDA: return "cuda";
+    }
+    return "unknown";
+}
+
+const char* modelPrecisionName(ModelPrecision precision) {
+    switch (precision) {
+        case ModelPrecision::Auto: return "auto";
+        case ModelPrecision::FP32: return "fp32";
+        case ModelPrecision::FP16: return "fp16";
+        case ModelPrecision::INT8: return "int8";
+    }
+    return "unknown";
+}
+
+} // namespace navign::robot::vision
@@ -0,0 +1,65 @@
+#include "inference_scheduler.hpp"
+
+#include <algorithm>
+
+namespace navign::robot::vision {
+
+InferenceScheduler::InferenceScheduler(
+    ObjectDetector& detector,
+    size_t max_batch,
+    std::chrono::microseconds latency_budget
+)
+    : detector_(detector), max_batch_(std::max<size_t>(1, max_batch)), latency_budget_(latency_budget) {
+    // Larger batches than the model takes would only be split up again
+    const int model_limit = detector_.maxBatchSize();
+    if (model_limit > 0) {
+        max_batch_ = std::min(max_batch_, static_cast<size_t>(model_limit));
+    }
+
+    pending_.reserve(max_batch_);
+    images_.reserve(max_batch_);
+    device_images_.reserve(max_batch_);
+    results_.reserve(max_batch_);
+}
+
+bool InferenceScheduler::collect(FairQueue<FramePtr>& queue, std::chrono::milliseconds idle_timeout) {
+    pending_.clear();
+
+    auto first = queue.pop(idle_timeout);
+    if (!first) {
+        return false;
+    }
+    pending_.push_back(std::move(*first));
+
+    // The budget bounds the extra latency of the first frame in the batch
+    const auto deadline = std::chrono::steady_clock::now() + latency_budget_;
+    while (pending_.size() < max_batch_) {
+        auto next = queue.popUntil(deadline);
+        if (!next) {
+            break;
+        }
+        pending_.push_back(std::move(*next));
+    }
+    return true;
+}
+
+std::vector<InferenceScheduler::Result>& InferenceScheduler::run(float confidence_threshold, float nms_threshold) {
+    images_.clear();
+    device_images_.clear();
+    for (const auto& frame : pending_) {
+        images_.push_back(frame->image);
+        device_images_.push_back(frame->device_image);
+    }
+
+    auto objects = detector_.detectBatch(images_, confidence_threshold, nms_threshold, device_images_);
+
+    results_.resize(pending_.size());
+    for (size_t i = 0; i < pending_.size(); i++) {
+        results_[i].frame = std::move(pending_[i]);
+        results_[i].objects = std::move(objects[i]);
+    }
+    pending_.clear();
+    return results_;
+}
+
+} // namespace navign::robot::vision
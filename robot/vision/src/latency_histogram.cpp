@@ -0,0 +1,107 @@
+#include "latency_histogram.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+namespace navign::robot::vision {
+
+const char* pipelineStageName(PipelineStage stage) {
+    switch (stage) {
+        case PipelineStage::Capture: return "capture";
+        case PipelineStage::Grayscale: return "grayscale";
+        case PipelineStage::AprilTagDecode: return "apriltag_decode";
+        case PipelineStage::PoseEstimation: return "pose_estimation";
+        case PipelineStage::Localization: return "localization";
+        case PipelineStage::YoloPreprocess: return "yolo_preprocess";
+        case PipelineStage::YoloInference: return "yolo_inference";
+        case PipelineStage::YoloPostprocess: return "yolo_postprocess";
+        case PipelineStage::GroundProjection: return "ground_projection";
+        case PipelineStage::Tracking: return "tracking";
+        case PipelineStage::Publish: return "publish";
+        case PipelineStage::EndToEnd: return "end_to_end";
+        case PipelineStage::Count: break;
+    }
+    return "unknown";
+}
+
+size_t LatencyHistogram::bucketIndex(uint64_t micros) {
+    if (micros < kSubBuckets) {
+        return static_cast<size_t>(micros);
+    }
+
+    // micros lies in [2^exponent, 2^(exponent + 1)), exponent >= 4
+    const size_t exponent = std::min<size_t>(std::bit_width(micros) - 1, kMaxExponent);
+    if (exponent == kMaxExponent && (micros >> kMaxExponent) > 1) {
+        return kBucketCount - 1;
+    }
+    const size_t sub = static_cast<size_t>(micros >> (exponent - 4)) - kSubBuckets;
+    return kSubBuckets + (exponent - 4) * kSubBuckets + sub;
+}
+
+double LatencyHistogram::bucketMidpointUs(size_t index) {
+    if (index < kSubBuckets) {
+        return static_cast<double>(index);
+    }
+
+    const size_t exponent = (index - kSubBuckets) / kSubBuckets + 4;
+    const size_t sub = (index - kSubBuckets) % kSubBuckets;
+    const double width = std::ldexp(1.0, static_cast<int>(exponent - 4));
+    const double lower = (kSubBuckets + sub) * width;
+    return lower + width / 2.0;
+}
+
+void LatencyHistogram::record(std::chrono::nanoseconds duration) {
+    const auto micros = static_cast<uint64_t>(std::max<int64_t>(0, duration.count() / 1000));
+    counts_[bucketIndex(micros)].fetch_add(1, std::memory_order_relaxed);
+    sum_us_.fetch_add(micros, std::memory_order_relaxed);
+}
+
+void LatencyHistogram::addTo(LatencySnapshot& snapshot) const {
+    snapshot.counts.resize(kBucketCount, 0);
+    for (size_t i = 0; i < kBucketCount; i++) {
+        const uint64_t count = counts_[i].load(std::memory_order_relaxed);
+        snapshot.counts[i] += count;
+        snapshot.count += count;
+    }
+    snapshot.sum_us += sum_us_.load(std::memory_order_relaxed);
+}
+
+double LatencySnapshot::percentileMs(double quantile) const {
+    if (count == 0) {
+        return 0.0;
+    }
+
+    const auto rank = static_cast<uint64_t>(std::ceil(std::clamp(quantile, 0.0, 1.0) * count));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < counts.size(); i++) {
+        seen += counts[i];
+        if (seen >= std::max<uint64_t>(rank, 1)) {
+            return LatencyHistogram::bucketMidpointUs(i) / 1000.0;
+        }
+    }
+    return LatencyHistogram::bucketMidpointUs(counts.size() - 1) / 1000.0;
+}
+
+double LatencySnapshot::meanMs() const {
+    return count == 0 ? 0.0 : static_cast<double>(sum_us) / count / 1000.0;
+}
+
+LatencyMetrics::ThreadRecorder& LatencyMetrics::registerThread() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    recorders_.push_back(std::make_unique<ThreadRecorder>());
+    return *recorders_.back();
+}
+
+LatencySnapshot LatencyMetrics::snapshot(PipelineStage stage) const {
+    LatencySnapshot merged;
+    merged.counts.assign(LatencyHistogram::kBucketCount, 0);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& recorder : recorders_) {
+        recorder->histograms_[static_cast<size_t>(stage)].addTo(merged);
+    }
+    return merged;
+}
+
+} // namespace navign::robot::vision
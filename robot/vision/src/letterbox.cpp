@@ -0,0 +1,134 @@
+#include "letterbox.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace navign::robot::vision {
+
+namespace {
+
+constexpr float kNormalize = 1.0f / 255.0f;
+constexpr float kPadValue = 114.0f / 255.0f;
+
+#if defined(__AVX2__)
+// Gather one channel of 8 BGR pixels (24 bytes) into the low 8 bytes:
+// pixels 0-4 come from bytes 0-15, pixels 5-7 from bytes 8-23
+inline __m128i gatherChannel(__m128i lo, __m128i hi, int c) {
+    const __m128i lo_mask = _mm_setr_epi8(
+        static_cast<char>(c), static_cast<char>(3 + c), static_cast<char>(6 + c),
+        static_cast<char>(9 + c), static_cast<char>(12 + c), -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1);
+    const __m128i hi_mask = _mm_setr_epi8(
+        -1, -1, -1, -1, -1, static_cast<char>(7 + c), static_cast<char>(10 + c), static_cast<char>(13 + c),
+        -1, -1, -1, -1, -1, -1, -1, -1);
+    return _mm_or_si128(_mm_shuffle_epi8(lo, lo_mask), _mm_shuffle_epi8(hi, hi_mask));
+}
+
+inline void storeNormalized(float* dst, __m128i bytes) {
+    const __m256 values = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(bytes));
+    _mm256_storeu_ps(dst, _mm256_mul_ps(values, _mm256_set1_ps(kNormalize)));
+}
+#elif defined(__ARM_NEON)
+inline void storeNormalized(float* dst, uint8x8_t bytes) {
+    const uint16x8_t wide = vmovl_u8(bytes);
+    const float32x4_t scale = vdupq_n_f32(kNormalize);
+    vst1q_f32(dst, vmulq_f32(vcvtq_f32_u32(vmovl_u16(vget_low_u16(wide))), scale));
+    vst1q_f32(dst + 4, vmulq_f32(vcvtq_f32_u32(vmovl_u16(vget_high_u16(wide))), scale));
+}
+#endif
+
+/**
+ * @brief Convert one BGR row into normalized R, G and B plane rows
+ */
+void convertRow(const uint8_t* bgr, int width, float* r, float* g, float* b) {
+    int x = 0;
+
+#if defined(__AVX2__)
+    for (; x + 8 <= width; x += 8) {
+        const uint8_t* src = bgr + 3 * x;
+        const __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+        const __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 8));
+        storeNormalized(b + x, gatherChannel(lo, hi, 0));
+        storeNormalized(g + x, gatherChannel(lo, hi, 1));
+        storeNormalized(r + x, gatherChannel(lo, hi, 2));
+    }
+#elif defined(__ARM_NEON)
+    for (; x + 8 <= width; x += 8) {
+        const uint8x8x3_t pixels = vld3_u8(bgr + 3 * x);
+        storeNormalized(b + x, pixels.val[0]);
+        storeNormalized(g + x, pixels.val[1]);
+        storeNormalized(r + x, pixels.val[2]);
+    }
+#endif
+
+    for (; x < width; x++) {
+        b[x] = bgr[3 * x] * kNormalize;
+        g[x] = bgr[3 * x + 1] * kNormalize;
+        r[x] = bgr[3 * x + 2] * kNormalize;
+    }
+}
+
+} // namespace
+
+LetterboxTransform LetterboxTransform::fit(cv::Size image, cv::Size input) {
+    LetterboxTransform transform;
+    if (image.area() <= 0) {
+        transform.content = input;
+        return transform;
+    }
+
+    transform.scale = std::min(static_cast<double>(input.width) / image.width,
+                               static_cast<double>(input.height) / image.height);
+    transform.content = cv::Size(
+        std::min(input.width, static_cast<int>(std::lround(image.width * transform.scale))),
+        std::min(input.height, static_cast<int>(std::lround(image.height * transform.scale)))
+    );
+    transform.pad_x = (input.width - transform.content.width) / 2;
+    transform.pad_y = (input.height - transform.content.height) / 2;
+    return transform;
+}
+
+LetterboxTransform LetterboxPreprocessor::apply(const cv::Mat& image, cv::Size input, float* dst) {
+    CV_Assert(image.type() == CV_8UC3);
+
+    const LetterboxTransform transform = LetterboxTransform::fit(image.size(), input);
+
+    const cv::Mat* source = &image;
+    if (image.size() != transform.content) {
+        cv::resize(image, resized_, transform.content, 0, 0, cv::INTER_LINEAR);
+        source = &resized_;
+    }
+
+    const size_t plane = static_cast<size_t>(input.area());
+    float* r = dst;
+    float* g = dst + plane;
+    float* b = dst + 2 * plane;
+
+    // Top and bottom borders are whole rows of every plane
+    const int bottom = transform.pad_y + transform.content.height;
+    for (float* channel : {r, g, b}) {
+        std::fill(channel, channel + static_cast<size_t>(transform.pad_y) * input.width, kPadValue);
+        std::fill(channel + static_cast<size_t>(bottom) * input.width, channel + plane, kPadValue);
+    }
+
+    const int right = transform.pad_x + transform.content.width;
+    for (int y = 0; y < transform.content.height; y++) {
+        const size_t row = static_cast<size_t>(transform.pad_y + y) * input.width;
+        for (float* channel : {r, g, b}) {
+            std::fill(channel + row, channel + row + transform.pad_x, kPadValue);
+            std::fill(channel + row + right, channel + row + input.width, kPadValue);
+        }
+        convertRow(source->ptr<uint8_t>(y), transform.content.width,
+                   r + row + transform.pad_x, g + row + transform.pad_x, b + row + transform.pad_x);
+    }
+
+    return transform;
+}
+
+} // namespace navign::robot::vision
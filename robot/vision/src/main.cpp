@@ -1,10 +1,41 @@
 #include "vision_service.hpp"
 #include <iostream>
 #include <csignal>
+#include <algorithm>
 #include <atomic>
+#include <cctype>
+#include <cmath>
+#include <filesystem>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
 
 std::atomic<bool> keep_running{true};
 
+// Comma-separated IDs and inclusive ranges, e.g. "0,3,10-19" (tag IDs, CPUs)
+bool parseTagIds(const std::string& spec, std::vector<uint32_t>& ids) {
+    std::stringstream stream(spec);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        if (item.empty()) {
+            continue;
+        }
+        const auto dash = item.find('-');
+        try {
+            const unsigned long first = std::stoul(item.substr(0, dash));
+            const unsigned long last = dash == std::string::npos ? first : std::stoul(item.substr(dash + 1));
+            for (unsigned long id = first; id <= last; id++) {
+                ids.push_back(static_cast<uint32_t>(id));
+            }
+        } catch (const std::exception&) {
+            return false;
+        }
+    }
+    return true;
+}
+
 void signalHandler(int signal) {
     std::cout << "\nReceived signal " << signal << ", shutting down..." << std::endl;
     keep_running.store(false);
@@ -24,21 +55,315 @@ int main(int argc, char** argv) {
     int camera_index = 0;
     int fps = 30;
     double apriltag_size = 0.015; // 15mm
+    auto provider = navign::robot::vision::ExecutionProvider::CPU;
+    auto precision = navign::robot::vision::ModelPrecision::Auto;
+    auto dnn_target = navign::robot::vision::DnnTarget::CPU;
+    bool model_cache = true;
+    std::string model_cache_dir;
+    int memory_budget_mb = 0;
+    int ort_arena_mb = 0;
+    bool tag_tracking = false;
+    bool tag_adaptive = false;
+    int tag_rescan_interval = 10;
+    std::string tag_family = "tag36h11";
+    navign::robot::vision::AprilTagFilter tag_filter;
+    bool tag_prune_family = false;
+    auto tag_pose = navign::robot::vision::AprilTagPoseMethod::OrthogonalIteration;
+    int metrics_port = 0;
+    std::string zenoh_config;
+    bool zenoh_shm = false;
+    bool publish_frames = false;
+    int request_workers = 1;
+    std::string tag_map;
+    std::vector<navign::robot::vision::CameraConfig> cameras;
+    double floor_z = 0.0;
+    int tag_workers = 1;
+    int yolo_workers = 1;
+    int yolo_batch = 1;
+    double yolo_batch_budget_ms = 5.0;
+    bool yolo_track = false;
+    int yolo_interval = 1;
+    std::string record_file;
+    auto record_codec = navign::robot::vision::RecordingCodec::Mjpeg;
+    std::string replay_file;
+    auto replay_pacing = navign::robot::vision::ReplayPacing::Realtime;
+    bool replay_loop = false;
+    auto capture_backend = navign::robot::vision::CaptureBackend::OpenCV;
+    auto capture_format = navign::robot::vision::CapturePixelFormat::Auto;
+    std::string jpeg_decoder = "jpegdec";
+    auto shedding = navign::robot::vision::LoadShedding::Objects;
+    int yolo_fps = 0;
+    int deadline_ms = 0;
+    navign::robot::vision::ThreadTuning thread_tuning;
 
     for (int i = 1; i < argc; i++) {
         std::string arg = argv[i];
         if (arg == "--camera" && i + 1 < argc) {
             camera_index = std::atoi(argv[++i]);
+        } else if (arg == "--add-camera" && i + 1 < argc) {
+            // <index or recording>[:<calibration file>[:<floor z>]]; sources
+            // are numbered in order (primary, secondary, ...)
+            std::string spec = argv[++i];
+            navign::robot::vision::CameraConfig config;
+            const auto colon = spec.find(':');
+            const std::string source = spec.substr(0, colon);
+            if (!source.empty() && std::all_of(source.begin(), source.end(), ::isdigit)) {
+                config.device_index = std::atoi(source.c_str());
+            } else {
+                config.replay_file = source;
+            }
+            config.camera_id = static_cast<uint32_t>(cameras.size() + 1);
+            config.calibration_file = "calibration_" + std::to_string(config.device_index) + ".yml";
+            config.floor_z = std::numeric_limits<double>::quiet_NaN();  // --floor-z unless given
+            if (colon != std::string::npos) {
+                std::string calibration = spec.substr(colon + 1);
+                const auto floor_colon = calibration.find(':');
+                if (floor_colon != std::string::npos) {
+                    config.floor_z = std::atof(calibration.substr(floor_colon + 1).c_str());
+                    calibration.resize(floor_colon);
+                }
+                if (!calibration.empty()) {
+                    config.calibration_file = calibration;
+                }
+            }
+            cameras.push_back(config);
+        } else if (arg == "--capture" && i + 1 < argc) {
+            std::string backend = argv[++i];
+            if (backend == "opencv") {
+                capture_backend = navign::robot::vision::CaptureBackend::OpenCV;
+            } else if (backend == "v4l2") {
+                capture_backend = navign::robot::vision::CaptureBackend::V4L2;
+            } else if (backend == "gstreamer") {
+                capture_backend = navign::robot::vision::CaptureBackend::GStreamer;
+            } else {
+                std::cerr << "Unknown capture backend: " << backend << std::endl;
+                return 1;
+            }
+        } else if (arg == "--capture-format" && i + 1 < argc) {
+            std::string format = argv[++i];
+            if (format == "auto") {
+                capture_format = navign::robot::vision::CapturePixelFormat::Auto;
+            } else if (format == "yuyv") {
+                capture_format = navign::robot::vision::CapturePixelFormat::Yuyv;
+            } else if (format == "nv12") {
+                capture_format = navign::robot::vision::CapturePixelFormat::Nv12;
+            } else if (format == "mjpeg") {
+                capture_format = navign::robot::vision::CapturePixelFormat::Mjpeg;
+            } else {
+                std::cerr << "Unknown capture format: " << format << std::endl;
+                return 1;
+            }
+        } else if (arg == "--jpeg-decoder" && i + 1 < argc) {
+            jpeg_decoder = argv[++i];
+        } else if (arg == "--record" && i + 1 < argc) {
+            record_file = argv[++i];
+        } else if (arg == "--record-codec" && i + 1 < argc) {
+            std::string codec = argv[++i];
+            if (codec == "raw") {
+                record_codec = navign::robot::vision::RecordingCodec::RawBgr;
+            } else if (codec == "mjpeg") {
+                record_codec = navign::robot::vision::RecordingCodec::Mjpeg;
+            } else {
+                std::cerr << "Unknown recording codec: " << codec << std::endl;
+                return 1;
+            }
+        } else if (arg == "--replay" && i + 1 < argc) {
+            replay_file = argv[++i];
+        } else if (arg == "--replay-speed" && i + 1 < argc) {
+            std::string speed = argv[++i];
+            if (speed == "realtime") {
+                replay_pacing = navign::robot::vision::ReplayPacing::Realtime;
+            } else if (speed == "fast") {
+                replay_pacing = navign::robot::vision::ReplayPacing::Fast;
+            } else {
+                std::cerr << "Unknown replay speed: " << speed << std::endl;
+                return 1;
+            }
+        } else if (arg == "--replay-loop") {
+            replay_loop = true;
+        } else if (arg == "--floor-z" && i + 1 < argc) {
+            floor_z = std::atof(argv[++i]);
+        } else if (arg == "--tag-workers" && i + 1 < argc) {
+            tag_workers = std::atoi(argv[++i]);
+        } else if (arg == "--yolo-workers" && i + 1 < argc) {
+            yolo_workers = std::atoi(argv[++i]);
+        } else if (arg == "--yolo-batch" && i + 1 < argc) {
+            yolo_batch = std::atoi(argv[++i]);
+        } else if (arg == "--yolo-batch-budget-ms" && i + 1 < argc) {
+            yolo_batch_budget_ms = std::atof(argv[++i]);
+        } else if (arg == "--yolo-track") {
+            yolo_track = true;
+        } else if (arg == "--yolo-interval" && i + 1 < argc) {
+            // Skipping detections relies on the tracker's prediction
+            yolo_interval = std::atoi(argv[++i]);
+            yolo_track = true;
         } else if (arg == "--fps" && i + 1 < argc) {
             fps = std::atoi(argv[++i]);
+        } else if (arg == "--yolo-fps" && i + 1 < argc) {
+            yolo_fps = std::atoi(argv[++i]);
+        } else if (arg == "--shed" && i + 1 < argc) {
+            std::string policy = argv[++i];
+            if (policy == "off") {
+                shedding = navign::robot::vision::LoadShedding::Off;
+            } else if (policy == "objects") {
+                shedding = navign::robot::vision::LoadShedding::Objects;
+            } else if (policy == "frames") {
+                shedding = navign::robot::vision::LoadShedding::Frames;
+            } else {
+                std::cerr << "Unknown shedding policy: " << policy << std::endl;
+                return 1;
+            }
+        } else if (arg == "--deadline-ms" && i + 1 < argc) {
+            deadline_ms = std::atoi(argv[++i]);
+        } else if (arg == "--rt-priority" && i + 1 < argc) {
+            // <capture>[,<detection>]
+            const std::string spec = argv[++i];
+            const auto comma = spec.find(',');
+            thread_tuning.capture_priority = std::atoi(spec.substr(0, comma).c_str());
+            thread_tuning.detection_priority = comma == std::string::npos
+                ? thread_tuning.capture_priority : std::atoi(spec.substr(comma + 1).c_str());
+        } else if ((arg == "--capture-cpus" || arg == "--detect-cpus") && i + 1 < argc) {
+            std::vector<uint32_t> cpus;
+            if (!parseTagIds(argv[++i], cpus)) {
+                std::cerr << "Invalid CPU list: " << argv[i] << std::endl;
+                return 1;
+            }
+            auto& target = arg == "--capture-cpus" ? thread_tuning.capture_cpus : thread_tuning.detection_cpus;
+            target.assign(cpus.begin(), cpus.end());
         } else if (arg == "--tag-size" && i + 1 < argc) {
             apriltag_size = std::atof(argv[++i]);
+        } else if (arg == "--tag-tracking") {
+            tag_tracking = true;
+        } else if (arg == "--tag-adaptive") {
+            tag_adaptive = true;
+        } else if (arg == "--tag-rescan" && i + 1 < argc) {
+            tag_rescan_interval = std::atoi(argv[++i]);
+        } else if (arg == "--tag-family" && i + 1 < argc) {
+            tag_family = argv[++i];
+        } else if (arg == "--tag-ids" && i + 1 < argc) {
+            if (!parseTagIds(argv[++i], tag_filter.id_whitelist)) {
+                std::cerr << "Invalid tag ID list: " << argv[i] << std::endl;
+                return 1;
+            }
+        } else if (arg == "--tag-max-hamming" && i + 1 < argc) {
+            tag_filter.max_hamming = std::atoi(argv[++i]);
+        } else if (arg == "--tag-min-margin" && i + 1 < argc) {
+            tag_filter.min_decision_margin = std::atof(argv[++i]);
+        } else if (arg == "--tag-prune-family") {
+            tag_prune_family = true;
+        } else if (arg == "--tag-pose" && i + 1 < argc) {
+            const std::string method = argv[++i];
+            if (method == "homography") {
+                tag_pose = navign::robot::vision::AprilTagPoseMethod::Homography;
+            } else if (method == "orthogonal") {
+                tag_pose = navign::robot::vision::AprilTagPoseMethod::OrthogonalIteration;
+            } else {
+                std::cerr << "Unknown pose method: " << method << std::endl;
+                return 1;
+            }
+        } else if (arg == "--provider" && i + 1 < argc) {
+            auto parsed = navign::robot::vision::parseExecutionProvider(argv[++i]);
+            if (!parsed) {
+                std::cerr << "Unknown execution provider: " << argv[i] << std::endl;
+                return 1;
+            }
+            provider = *parsed;
+        } else if (arg == "--precision" && i + 1 < argc) {
+            auto parsed = navign::robot::vision::parseModelPrecision(argv[++i]);
+            if (!parsed) {
+                std::cerr << "Unknown model precision: " << argv[i] << std::endl;
+                return 1;
+            }
+            precision = *parsed;
+        } else if (arg == "--dnn-target" && i + 1 < argc) {
+            auto parsed = navign::robot::vision::parseDnnTarget(argv[++i]);
+            if (!parsed) {
+                std::cerr << "Unknown DNN target: " << argv[i] << std::endl;
+                return 1;
+            }
+            dnn_target = *parsed;
+        } else if (arg == "--model-cache" && i + 1 < argc) {
+            model_cache_dir = argv[++i];
+        } else if (arg == "--no-model-cache") {
+            model_cache = false;
+        } else if (arg == "--memory-budget" && i + 1 < argc) {
+            memory_budget_mb = std::atoi(argv[++i]);
+        } else if (arg == "--ort-arena-mb" && i + 1 < argc) {
+            ort_arena_mb = std::atoi(argv[++i]);
+        } else if (arg == "--metrics-port" && i + 1 < argc) {
+            metrics_port = std::atoi(argv[++i]);
+        } else if (arg == "--zenoh-config" && i + 1 < argc) {
+            zenoh_config = argv[++i];
+        } else if (arg == "--zenoh-shm") {
+            zenoh_shm = true;
+        } else if (arg == "--publish-frames") {
+            publish_frames = true;
+        } else if (arg == "--request-workers" && i + 1 < argc) {
+            request_workers = std::atoi(argv[++i]);
+        } else if (arg == "--tag-map" && i + 1 < argc) {
+            tag_map = argv[++i];
         } else if (arg == "--help") {
             std::cout << "Usage: " << argv[0] << " [options]\n";
             std::cout << "Options:\n";
             std::cout << "  --camera <index>       Camera device index (default: 0)\n";
+            std::cout << "  --add-camera <index|recording>[:<calibration>[:<floor z>]]\n";
+            std::cout << "                         Add a camera source (repeatable; replaces --camera).\n";
+            std::cout << "                         Calibration defaults to calibration_<index>.yml\n";
+            std::cout << "                         Floor z defaults to --floor-z\n";
+            std::cout << "  --capture <backend>    Live capture: opencv, v4l2, gstreamer (default: opencv)\n";
+            std::cout << "  --capture-format <f>   v4l2/gstreamer pixel format: auto, yuyv, nv12, mjpeg\n";
+            std::cout << "                         (default: auto)\n";
+            std::cout << "  --jpeg-decoder <elem>  GStreamer MJPEG decoder, e.g. nvjpegdec (default: jpegdec)\n";
+            std::cout << "  --record <file>        Record captured frames; with several cameras\n";
+            std::cout << "                         each writes <stem>_<camera id><ext>\n";
+            std::cout << "  --record-codec <c>     Recording codec: raw, mjpeg (default: mjpeg)\n";
+            std::cout << "  --replay <file>        Replay a recording instead of opening --camera\n";
+            std::cout << "  --replay-speed <s>     realtime, or fast without frame drops (default: realtime)\n";
+            std::cout << "  --replay-loop          Restart replays at the end instead of exiting\n";
+            std::cout << "  --floor-z <meters>     World z of the floor plane objects stand on (default: 0)\n";
+            std::cout << "  --tag-workers <n>      AprilTag worker threads shared by all cameras (default: 1)\n";
+            std::cout << "  --yolo-workers <n>     YOLO worker threads shared by all cameras (default: 1)\n";
+            std::cout << "  --yolo-batch <n>       Frames per YOLO forward pass, across cameras (default: 1)\n";
+            std::cout << "  --yolo-batch-budget-ms <ms>\n";
+            std::cout << "                         Longest a frame waits for its YOLO batch to fill (default: 5)\n";
+            std::cout << "  --yolo-track           Track objects: stable IDs and velocities across frames\n";
+            std::cout << "  --yolo-interval <k>    Run YOLO every k-th frame, predict the rest (implies --yolo-track)\n";
             std::cout << "  --fps <fps>            Target frame rate (default: 30)\n";
+            std::cout << "  --yolo-fps <fps>       Run YOLO on a lower-rate grid of frames (default: every frame)\n";
+            std::cout << "  --shed <policy>        Work shed by late frames: off, objects, frames (default: objects)\n";
+            std::cout << "  --deadline-ms <ms>     Capture-to-publish deadline (default: one frame period)\n";
+            std::cout << "  --rt-priority <c>[,<d>]\n";
+            std::cout << "                         SCHED_FIFO priority of capture[, detector] threads (default: off)\n";
+            std::cout << "  --capture-cpus <list>  Pin capture threads to these CPUs, e.g. 0-1\n";
+            std::cout << "  --detect-cpus <list>   Pin detector threads to these CPUs, e.g. 2-5\n";
             std::cout << "  --tag-size <meters>    AprilTag physical size in meters (default: 0.015)\n";
+            std::cout << "  --tag-tracking         Track AprilTags in predicted regions between full scans\n";
+            std::cout << "  --tag-rescan <frames>  Frames between full-frame scans in tracking mode (default: 10)\n";
+            std::cout << "  --tag-adaptive         Tune AprilTag decimation/threads to meet the target FPS\n";
+            std::cout << "  --tag-family <name>    AprilTag family (default: tag36h11)\n";
+            std::cout << "  --tag-ids <list>       Accept only these tag IDs, e.g. 0,3,10-19 (default: all)\n";
+            std::cout << "  --tag-max-hamming <n>  Bit errors corrected when decoding, 0-3 (default: 2)\n";
+            std::cout << "  --tag-min-margin <m>   Minimum decision margin (default: 0)\n";
+            std::cout << "  --tag-prune-family     Decode only the --tag-ids codes (smaller, faster decoder)\n";
+            std::cout << "  --tag-pose <method>    Tag pose: orthogonal, homography (default: orthogonal)\n";
+            std::cout << "  --tag-map <file>       Surveyed tag poses; localizes each camera in the world\n";
+            std::cout << "  --provider <name>      ONNX Runtime execution provider: cpu, cuda, tensorrt,\n";
+            std::cout << "                         openvino, coreml (default: cpu)\n";
+            std::cout << "  --precision <p>        YOLO model precision: auto, fp32, fp16, int8 (default: auto)\n";
+            std::cout << "  --dnn-target <t>       Run YOLO on OpenCV DNN on cpu, opencl or cuda; anything\n";
+            std::cout << "                         but cpu overrides ONNX Runtime (default: cpu)\n";
+            std::cout << "  --model-cache <dir>    Where the optimized model and TensorRT/OpenVINO engines are\n";
+            std::cout << "                         cached between runs (default: next to the model)\n";
+            std::cout << "  --no-model-cache       Optimize the model from scratch at every start\n";
+            std::cout << "  --memory-budget <MB>   Low-memory mode for small robots; warns above the budget\n";
+            std::cout << "                         (default: off)\n";
+            std::cout << "  --ort-arena-mb <MB>    Cap ONNX Runtime's CPU (and CUDA) arena (default: no cap)\n";
+            std::cout << "  --metrics-port <port>  Serve Prometheus metrics over HTTP (default: off)\n";
+            std::cout << "  --zenoh-config <file>  Zenoh JSON5 configuration (default: peer mode)\n";
+            std::cout << "  --zenoh-shm            Publish through Zenoh shared memory to same-host subscribers\n";
+            std::cout << "  --publish-frames       Publish raw BGR frames on robot/vision/frames\n";
+            std::cout << "  --request-workers <n>  Threads serving robot/vision/rpc/* image requests,\n";
+            std::cout << "                         0 disables the queryables (default: 1)\n";
             std::cout << "  --help                 Show this help message\n";
             return 0;
         }
@@ -47,8 +372,52 @@ int main(int argc, char** argv) {
     // Create and configure vision service
     navign::robot::vision::VisionService service;
     service.setCameraIndex(camera_index);
+    service.setFloorHeight(floor_z);
+    service.setCaptureBackend(capture_backend, capture_format, jpeg_decoder);
+    service.setReplayFile(replay_file);
+    service.setRecordFile(record_file);
+    service.setReplayOptions(replay_pacing, replay_loop);
+    service.setRecordingCodec(record_codec);
+    for (auto& camera : cameras) {
+        if (std::isnan(camera.floor_z)) {
+            camera.floor_z = floor_z;
+        }
+        if (!record_file.empty()) {
+            if (cameras.size() == 1) {
+                camera.record_file = record_file;
+            } else {
+                const std::filesystem::path path(record_file);
+                camera.record_file = (path.parent_path() / (path.stem().string() + "_" +
+                    std::to_string(camera.camera_id) + path.extension().string())).string();
+            }
+        }
+        service.addCamera(camera);
+    }
+    service.setWorkerCounts(tag_workers, yolo_workers);
+    service.setObjectBatching(yolo_batch, std::chrono::microseconds(
+        static_cast<int64_t>(yolo_batch_budget_ms * 1000.0)));
+    service.setObjectTracking(yolo_track, yolo_interval);
     service.setFrameRate(fps);
+    service.setLoadShedding(shedding, yolo_fps, std::chrono::milliseconds(deadline_ms));
+    service.setThreadTuning(thread_tuning);
     service.setAprilTagSize(apriltag_size);
+    service.setExecutionProvider(provider);
+    service.setModelPrecision(precision);
+    service.setDnnTarget(dnn_target);
+    service.setModelCache(model_cache, model_cache_dir);
+    service.setMemoryBudget(static_cast<size_t>(std::max(0, memory_budget_mb)) * 1024 * 1024);
+    service.setOnnxArenaLimit(static_cast<size_t>(std::max(0, ort_arena_mb)) * 1024 * 1024);
+    service.setAprilTagTracking(tag_tracking, tag_rescan_interval);
+    service.setAprilTagAdaptive(tag_adaptive);
+    service.setAprilTagFamily(tag_family);
+    service.setAprilTagFilter(tag_filter, tag_prune_family);
+    service.setAprilTagPoseMethod(tag_pose);
+    service.setMetricsPort(metrics_port);
+    service.setZenohConfig(zenoh_config);
+    service.setZenohSharedMemory(zenoh_shm);
+    service.setPublishFrames(publish_frames);
+    service.setRequestWorkers(request_workers);
+    service.setTagMap(tag_map);
 
     // Start service
     if (!service.start()) {
@@ -58,7 +427,7 @@ int main(int argc, char** argv) {
 
     // Keep running until signal received
     std::cout << "Vision service running... Press Ctrl+C to stop" << std::endl;
-    while (keep_running.load()) {
+    while (keep_running.load() && !service.isCaptureFinished()) {
         std::this_thread::sleep_for(std::chrono::milliseconds(100));
     }
 
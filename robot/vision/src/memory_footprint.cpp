@@ -0,0 +1,71 @@
+#include "memory_footprint.hpp"
+
+#include <cstdio>
+#include <cstring>
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+namespace navign::robot::vision {
+
+namespace {
+
+/**
+ * @brief Value of a "<key>:  <n> kB" line in /proc/self/status, in bytes
+ */
+size_t statusBytes(const char* line, const char* key) {
+    const size_t length = std::strlen(key);
+    if (std::strncmp(line, key, length) != 0) {
+        return 0;
+    }
+    unsigned long long kilobytes = 0;
+    if (std::sscanf(line + length, " %llu", &kilobytes) != 1) {
+        return 0;
+    }
+    return static_cast<size_t>(kilobytes) * 1024;
+}
+
+} // namespace
+
+MemoryFootprint MemoryFootprint::sample() {
+    MemoryFootprint footprint;
+
+    if (FILE* status = std::fopen("/proc/self/status", "r")) {
+        char line[256];
+        while (std::fgets(line, sizeof(line), status)) {
+            if (const size_t rss = statusBytes(line, "VmRSS:")) {
+                footprint.rss_bytes = rss;
+            } else if (const size_t peak = statusBytes(line, "VmHWM:")) {
+                footprint.peak_rss_bytes = peak;
+            }
+        }
+        std::fclose(status);
+    }
+
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+    // Covers every arena; large blocks are mmapped separately (hblkhd)
+    const struct mallinfo2 info = mallinfo2();
+    footprint.heap_used_bytes = info.uordblks + info.hblkhd;
+    footprint.heap_free_bytes = info.fordblks;
+#endif
+    return footprint;
+}
+
+void limitHeapArenas(int max_arenas) {
+#if defined(__GLIBC__)
+    mallopt(M_ARENA_MAX, max_arenas);
+#else
+    (void)max_arenas;
+#endif
+}
+
+bool releaseFreeHeap() {
+#if defined(__GLIBC__)
+    return malloc_trim(0) != 0;
+#else
+    return false;
+#endif
+}
+
+} // namespace navign::robot::vision
@@ -0,0 +1,142 @@
+#include "metrics_server.hpp"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+namespace navign::robot::vision {
+
+namespace {
+
+// Bounds how long stop() waits for the accept loop to notice
+constexpr int kAcceptPollMs = 200;
+// Bounds reading a request and, separately, writing the response
+constexpr int kClientTimeoutMs = 1000;
+
+/**
+ * @brief Write all of data before the deadline
+ *
+ * The socket is only written when poll() reports room, so a scraper that
+ * stops reading cannot block the serve thread (and stop()) past the deadline.
+ */
+bool sendAll(int fd, const char* data, size_t size, std::chrono::steady_clock::time_point deadline) {
+    while (size > 0) {
+        const auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+            deadline - std::chrono::steady_clock::now()).count();
+        pollfd pfd{fd, POLLOUT, 0};
+        if (remaining <= 0 || ::poll(&pfd, 1, static_cast<int>(remaining)) <= 0) {
+            return false;
+        }
+
+        const ssize_t sent = ::send(fd, data, size, MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (sent < 0) {
+            if (errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK) {
+                continue;
+            }
+            return false;
+        }
+        data += sent;
+        size -= static_cast<size_t>(sent);
+    }
+    return true;
+}
+
+} // namespace
+
+MetricsServer::MetricsServer(RenderFn render) : render_(std::move(render)) {}
+
+MetricsServer::~MetricsServer() {
+    stop();
+}
+
+bool MetricsServer::start(int port) {
+    if (running_.load()) {
+        return true;
+    }
+
+    listen_fd_ = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (listen_fd_ < 0) {
+        std::cerr << "Metrics server: socket() failed: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    const int reuse = 1;
+    ::setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(static_cast<uint16_t>(port));
+
+    if (::bind(listen_fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 ||
+        ::listen(listen_fd_, 4) < 0) {
+        std::cerr << "Metrics server: cannot listen on port " << port << ": "
+                  << std::strerror(errno) << std::endl;
+        ::close(listen_fd_);
+        listen_fd_ = -1;
+        return false;
+    }
+
+    running_.store(true);
+    thread_ = std::thread(&MetricsServer::serveLoop, this);
+    return true;
+}
+
+void MetricsServer::stop() {
+    if (!running_.exchange(false)) {
+        return;
+    }
+
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    ::close(listen_fd_);
+    listen_fd_ = -1;
+}
+
+void MetricsServer::serveLoop() {
+    while (running_.load()) {
+        pollfd pfd{listen_fd_, POLLIN, 0};
+        if (::poll(&pfd, 1, kAcceptPollMs) <= 0) {
+            continue;
+        }
+
+        const int client_fd = ::accept(listen_fd_, nullptr, nullptr);
+        if (client_fd < 0) {
+            continue;
+        }
+        handleClient(client_fd);
+        ::close(client_fd);
+    }
+}
+
+void MetricsServer::handleClient(int client_fd) {
+    // Read (and ignore) the request head; one buffer covers any scraper
+    char request[2048];
+    pollfd pfd{client_fd, POLLIN, 0};
+    if (::poll(&pfd, 1, kClientTimeoutMs) <= 0 || ::recv(client_fd, request, sizeof(request), 0) <= 0) {
+        return;
+    }
+
+    const std::string body = render_();
+    const std::string header =
+        "HTTP/1.1 200 OK\r\n"
+        "Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n"
+        "Content-Length: " + std::to_string(body.size()) + "\r\n"
+        "Connection: close\r\n\r\n";
+
+    // One budget for the whole response, however slowly the client reads
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(kClientTimeoutMs);
+    if (sendAll(client_fd, header.data(), header.size(), deadline)) {
+        sendAll(client_fd, body.data(), body.size(), deadline);
+    }
+}
+
+} // namespace navign::robot::vision
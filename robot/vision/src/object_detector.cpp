@@ -1,51 +1,254 @@
 #include "object_detector.hpp"
+#include <opencv2/core/cuda.hpp>
+#include <opencv2/core/ocl.hpp>
+#include <chrono>
 #include <fstream>
 #include <iostream>
 #include <algorithm>
+#include <filesystem>
+#include <mutex>
 
 namespace navign::robot::vision {
 
-ObjectDetector::ObjectDetector() {
+namespace {
+
+// OpenCV DNN runs FP32 models with FP16 arithmetic on CPUs that have it
+#if defined(__ARM_FEATURE_FP16_VECTOR_ARITHMETIC) && \
+    (CV_VERSION_MAJOR > 4 || (CV_VERSION_MAJOR == 4 && CV_VERSION_MINOR >= 9))
+constexpr bool kDnnCpuFp16 = true;
+#else
+constexpr bool kDnnCpuFp16 = false;
+#endif
+
+/**
+ * @brief Path of a reduced-precision variant: model.onnx -> model.int8.onnx
+ */
+std::string modelVariantPath(const std::string& model_path, ModelPrecision precision) {
+    if (precision != ModelPrecision::FP16 && precision != ModelPrecision::INT8) {
+        return model_path;
+    }
+    std::filesystem::path path(model_path);
+    const std::string suffix = precision == ModelPrecision::FP16 ? ".fp16" : ".int8";
+    path.replace_filename(path.stem().string() + suffix + path.extension().string());
+    return path.string();
+}
+
+/**
+ * @brief A cache is usable when it was written after its source model
+ */
+bool isCacheFresh(const std::string& cache_path, const std::string& model_path) {
+    std::error_code error;
+    const auto cache_time = std::filesystem::last_write_time(cache_path, error);
+    if (error) {
+        return false;
+    }
+    const auto model_time = std::filesystem::last_write_time(model_path, error);
+    return !error && cache_time >= model_time;
+}
+
 #ifdef USE_ONNXRUNTIME
-    use_onnx_ = true;
-    onnx_env_ = std::make_unique<Ort::Env>(ORT_LOGGING_LEVEL_WARNING, "NavignVision");
+/**
+ * @brief The process's ONNX Runtime environment
+ *
+ * ORT keeps a single environment per process however many Ort::Env
+ * objects refer to it, and allocators registered on it are process-wide,
+ * so every detector shares one. Never destroyed: sessions may still be
+ * released while other statics shut down.
+ */
+Ort::Env& onnxEnvironment() {
+    static Ort::Env* env = new Ort::Env(ORT_LOGGING_LEVEL_WARNING, "NavignVision");
+    return *env;
+}
+
+/**
+ * @brief Register the shared, bounded CPU arena on first use
+ * @return true if sessions can allocate from it (session.use_env_allocators)
+ */
+bool sharedOnnxArena(bool compact, size_t max_bytes) {
+    static std::once_flag once;
+    static bool registered = false;
+    std::call_once(once, [&] {
+        try {
+            const Ort::ArenaCfg arena_cfg(max_bytes, compact ? 1 : 0, -1, -1);
+            const auto memory_info = Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault);
+            onnxEnvironment().CreateAndRegisterAllocator(memory_info, arena_cfg);
+            registered = true;
+            if (max_bytes > 0) {
+                std::cout << "ONNX Runtime CPU arena capped at " << max_bytes / (1024 * 1024)
+                          << " MB" << std::endl;
+            }
+        } catch (const Ort::Exception& e) {
+            std::cerr << "ONNX Runtime arena limit unavailable: " << e.what() << std::endl;
+        }
+    });
+    return registered;
+}
+
+/**
+ * @brief CUDA provider options with the arena bounds applied
+ */
+OrtCUDAProviderOptions cudaProviderOptions(bool compact_arena, size_t arena_max_bytes) {
+    OrtCUDAProviderOptions options{};
+    if (compact_arena) {
+        options.arena_extend_strategy = 1;  // kSameAsRequested
+    }
+    if (arena_max_bytes > 0) {
+        options.gpu_mem_limit = arena_max_bytes;
+    }
+    return options;
+}
 #endif
+
+/**
+ * @brief Device copies of images [offset, offset + count), clipped to those given
+ */
+std::span<const cv::UMat> deviceSlice(std::span<const cv::UMat> device_images, size_t offset, size_t count) {
+    if (offset >= device_images.size()) {
+        return {};
+    }
+    return device_images.subspan(offset, std::min(count, device_images.size() - offset));
 }
 
+} // namespace
+
+ObjectDetector::ObjectDetector() = default;
+
 ObjectDetector::~ObjectDetector() = default;
 
+std::vector<ModelPrecision> ObjectDetector::candidatePrecisions(bool onnx) const {
+    if (precision_ != ModelPrecision::Auto) {
+        // An explicit precision still falls back to the FP32 model
+        if (precision_ == ModelPrecision::FP32) {
+            return {ModelPrecision::FP32};
+        }
+        return {precision_, ModelPrecision::FP32};
+    }
+
+    if (!onnx) {
+        if (kDnnCpuFp16 || dnn_target_ != DnnTarget::CPU) {
+            return {ModelPrecision::FP16, ModelPrecision::FP32};
+        }
+        return {ModelPrecision::FP32};
+    }
+
+    // INT8 QDQ pays off on CPUs (dot-product / VNNI kernels) and TensorRT;
+    // FP16 on GPUs and the Neural Engine
+    switch (provider_) {
+        case ExecutionProvider::TensorRT:
+            return {ModelPrecision::INT8, ModelPrecision::FP16, ModelPrecision::FP32};
+        case ExecutionProvider::CUDA:
+        case ExecutionProvider::CoreML:
+            return {ModelPrecision::FP16, ModelPrecision::FP32};
+        case ExecutionProvider::CPU:
+        case ExecutionProvider::OpenVINO:
+            break;
+    }
+    return {ModelPrecision::INT8, ModelPrecision::FP32};
+}
+
 bool ObjectDetector::loadModel(const std::string& model_path, const std::string& config_path) {
+    model_batch_ = 0;
+    batch_supported_ = true;
+    forward_ = nullptr;
+    device_input_ = false;
+
 #ifdef USE_ONNXRUNTIME
+    use_onnx_ = backend_ != InferenceBackend::OpenCvDnn;
     if (use_onnx_) {
-        try {
-            session_options_ = std::make_unique<Ort::SessionOptions>();
-            session_options_->SetIntraOpNumThreads(4);
-            session_options_->SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_ENABLE_ALL);
-
-            onnx_session_ = std::make_unique<Ort::Session>(*onnx_env_, model_path.c_str(), *session_options_);
-            std::cout << "ONNX model loaded: " << model_path << std::endl;
-            return true;
-        } catch (const Ort::Exception& e) {
-            std::cerr << "ONNX Runtime error: " << e.what() << std::endl;
-            use_onnx_ = false;
-            // Fall back to OpenCV DNN
+        for (ModelPrecision precision : candidatePrecisions(true)) {
+            const std::string path = modelVariantPath(model_path, precision);
+            if (precision != ModelPrecision::FP32 && !std::filesystem::exists(path)) {
+                continue;
+            }
+            if (loadOnnxModel(path)) {
+                forward_ = &ObjectDetector::forwardOnnx;
+                loaded_precision_ = precision;
+                std::cout << "YOLO model precision: " << modelPrecisionName(precision) << std::endl;
+                return true;
+            }
+        }
+        use_onnx_ = false;
+        if (backend_ == InferenceBackend::OnnxRuntime) {
+            return false;
         }
+        // Fall back to OpenCV DNN
+    }
+#else
+    if (backend_ == InferenceBackend::OnnxRuntime) {
+        std::cerr << "ONNX Runtime backend requested but not compiled in" << std::endl;
+        return false;
     }
 #endif
 
-    // Use OpenCV DNN backend
+    // Use OpenCV DNN backend, on the CPU unless a usable device was selected
+    DnnTarget target = dnn_target_;
+    if (target == DnnTarget::OpenCL && !cv::ocl::haveOpenCL()) {
+        std::cerr << "No OpenCL device, running OpenCV DNN on the CPU" << std::endl;
+        target = DnnTarget::CPU;
+    }
+    if (target == DnnTarget::CUDA && cv::cuda::getCudaEnabledDeviceCount() == 0) {
+        std::cerr << "OpenCV has no CUDA device, running OpenCV DNN on the CPU" << std::endl;
+        target = DnnTarget::CPU;
+    }
+
+    // FP16 runs the FP32 model on an FP16 target; INT8 loads the QDQ model
+    // into OpenCV's int8 layers, which exist on the CPU only.
+    ModelPrecision precision = ModelPrecision::FP32;
+    std::string path = model_path;
+    for (ModelPrecision candidate : candidatePrecisions(false)) {
+        if (candidate == ModelPrecision::FP16 && target == DnnTarget::CPU && !kDnnCpuFp16) {
+            std::cerr << "FP16 is not supported by OpenCV DNN on this CPU" << std::endl;
+            continue;
+        }
+        if (candidate == ModelPrecision::INT8 && target != DnnTarget::CPU) {
+            std::cerr << "INT8 models run on the OpenCV DNN CPU target only" << std::endl;
+            continue;
+        }
+        const std::string candidate_path = modelVariantPath(model_path, candidate);
+        if (candidate == ModelPrecision::INT8 && !std::filesystem::exists(candidate_path)) {
+            continue;
+        }
+        precision = candidate;
+        path = candidate == ModelPrecision::FP16 ? model_path : candidate_path;
+        break;
+    }
+
     try {
-        net_ = cv::dnn::readNetFromONNX(model_path);
+        net_ = cv::dnn::readNetFromONNX(path);
         if (net_.empty()) {
-            std::cerr << "Failed to load model: " << model_path << std::endl;
+            std::cerr << "Failed to load model: " << path << std::endl;
             return false;
         }
 
         // Set backend and target
-        net_.setPreferableBackend(cv::dnn::DNN_BACKEND_OPENCV);
-        net_.setPreferableTarget(cv::dnn::DNN_TARGET_CPU);
+        const bool fp16 = precision == ModelPrecision::FP16;
+        switch (target) {
+            case DnnTarget::OpenCL:
+                cv::ocl::setUseOpenCL(true);
+                net_.setPreferableBackend(cv::dnn::DNN_BACKEND_OPENCV);
+                net_.setPreferableTarget(fp16 ? cv::dnn::DNN_TARGET_OPENCL_FP16 : cv::dnn::DNN_TARGET_OPENCL);
+                break;
+            case DnnTarget::CUDA:
+                // Takes the host blob and uploads it once per forward pass
+                net_.setPreferableBackend(cv::dnn::DNN_BACKEND_CUDA);
+                net_.setPreferableTarget(fp16 ? cv::dnn::DNN_TARGET_CUDA_FP16 : cv::dnn::DNN_TARGET_CUDA);
+                break;
+            case DnnTarget::CPU:
+                net_.setPreferableBackend(cv::dnn::DNN_BACKEND_OPENCV);
+#if CV_VERSION_MAJOR > 4 || (CV_VERSION_MAJOR == 4 && CV_VERSION_MINOR >= 9)
+                net_.setPreferableTarget(fp16 ? cv::dnn::DNN_TARGET_CPU_FP16 : cv::dnn::DNN_TARGET_CPU);
+#else
+                net_.setPreferableTarget(cv::dnn::DNN_TARGET_CPU);
+#endif
+                break;
+        }
+        output_names_ = net_.getUnconnectedOutLayersNames();
+        loaded_precision_ = precision;
+        device_input_ = target == DnnTarget::OpenCL;
+        forward_ = device_input_ ? &ObjectDetector::forwardDnnDevice : &ObjectDetector::forwardDnn;
 
-        std::cout << "OpenCV DNN model loaded: " << model_path << std::endl;
+        std::cout << "OpenCV DNN model loaded: " << path << " (" << modelPrecisionName(precision)
+                  << ", " << dnnTargetName(target) << ")" << std::endl;
         return true;
     } catch (const cv::Exception& e) {
         std::cerr << "OpenCV error: " << e.what() << std::endl;
@@ -53,6 +256,209 @@ bool ObjectDetector::loadModel(const std::string& model_path, const std::string&
     }
 }
 
+#ifdef USE_ONNXRUNTIME
+bool ObjectDetector::loadOnnxModel(const std::string& model_path) {
+    try {
+        onnx_session_ = createOnnxSession(model_path);
+
+        Ort::AllocatorWithDefaultOptions allocator;
+        input_name_ = onnx_session_->GetInputNameAllocated(0, allocator).get();
+        output_name_ = onnx_session_->GetOutputNameAllocated(0, allocator).get();
+
+        auto memory_info = Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault);
+        io_binding_ = std::make_unique<Ort::IoBinding>(*onnx_session_);
+
+        // Batch dimension of the input: fixed (usually 1) or dynamic (<= 0).
+        // The input itself is bound over blob_ lazily, once its batch size is known.
+        auto input_shape = onnx_session_->GetInputTypeInfo(0).GetTensorTypeAndShapeInfo().GetShape();
+        model_batch_ = input_shape.empty() ? 1 : static_cast<int>(input_shape[0]);
+
+        // A static spatial shape overrides the configured input size
+        if (input_shape.size() == 4 && input_shape[2] > 0 && input_shape[3] > 0) {
+            input_size_ = cv::Size(static_cast<int>(input_shape[3]), static_cast<int>(input_shape[2]));
+        }
+        bound_input_data_ = nullptr;
+        bound_batch_ = 0;
+
+        // Output: preallocate when the model declares a static shape
+        // (e.g. [1, 84, 8400]); otherwise let ORT allocate on each Run()
+        auto output_shape = onnx_session_->GetOutputTypeInfo(0).GetTensorTypeAndShapeInfo().GetShape();
+        dynamic_output_ = std::any_of(output_shape.begin(), output_shape.end(),
+                                      [](int64_t dim) { return dim <= 0; });
+        if (dynamic_output_) {
+            io_binding_->BindOutput(output_name_.c_str(), memory_info);
+        } else {
+            std::vector<int> output_sizes(output_shape.begin(), output_shape.end());
+            onnx_output_.create(static_cast<int>(output_sizes.size()), output_sizes.data(), CV_32F);
+            output_tensor_ = std::make_unique<Ort::Value>(Ort::Value::CreateTensor<float>(
+                memory_info, onnx_output_.ptr<float>(), onnx_output_.total(),
+                output_shape.data(), output_shape.size()));
+            io_binding_->BindOutput(output_name_.c_str(), *output_tensor_);
+        }
+
+        std::cout << "ONNX model loaded: " << model_path << std::endl;
+        return true;
+    } catch (const Ort::Exception& e) {
+        std::cerr << "ONNX Runtime error: " << e.what() << std::endl;
+        io_binding_.reset();
+        onnx_session_.reset();
+        return false;
+    }
+}
+
+std::unique_ptr<Ort::Session> ObjectDetector::createOnnxSession(const std::string& model_path) {
+    std::string cache_dir;
+    if (model_cache_) {
+        const auto parent = std::filesystem::path(model_path).parent_path();
+        cache_dir = !model_cache_dir_.empty() ? model_cache_dir_ : parent.empty() ? "." : parent.string();
+        std::error_code error;
+        std::filesystem::create_directories(cache_dir, error);
+    }
+
+    // Providers that compile the graph into their own nodes cannot save it;
+    // TensorRT and OpenVINO keep engine caches of their own instead
+    std::string cache_path;
+    if (!cache_dir.empty() && (provider_ == ExecutionProvider::CPU || provider_ == ExecutionProvider::CUDA)) {
+        cache_path = (std::filesystem::path(cache_dir) / (std::filesystem::path(model_path).stem().string() +
+                      "." + executionProviderName(provider_) + ".opt.onnx")).string();
+        if (isCacheFresh(cache_path, model_path)) {
+            try {
+                auto options = makeSessionOptions(GraphOptimizationLevel::ORT_DISABLE_ALL, "", cache_dir);
+                auto session = std::make_unique<Ort::Session>(onnxEnvironment(), cache_path.c_str(), *options);
+                session_options_ = std::move(options);
+                std::cout << "Optimized model loaded from cache: " << cache_path << std::endl;
+                return session;
+            } catch (const Ort::Exception& e) {
+                // Written by another ORT version, or the write was cut short
+                std::cerr << "Rebuilding model cache " << cache_path << ": " << e.what() << std::endl;
+            }
+        }
+    }
+
+    if (!cache_path.empty()) {
+        try {
+            session_options_ = makeSessionOptions(GraphOptimizationLevel::ORT_ENABLE_ALL, cache_path, cache_dir);
+            auto session = std::make_unique<Ort::Session>(onnxEnvironment(), model_path.c_str(), *session_options_);
+            std::cout << "Optimized model cached at " << cache_path << std::endl;
+            return session;
+        } catch (const Ort::Exception& e) {
+            // An unwritable cache must not keep the model from loading
+            std::cerr << "Model cache disabled: " << e.what() << std::endl;
+        }
+    }
+    session_options_ = makeSessionOptions(GraphOptimizationLevel::ORT_ENABLE_ALL, "", cache_dir);
+    return std::make_unique<Ort::Session>(onnxEnvironment(), model_path.c_str(), *session_options_);
+}
+
+std::unique_ptr<Ort::SessionOptions> ObjectDetector::makeSessionOptions(GraphOptimizationLevel level,
+                                                                        const std::string& optimized_path,
+                                                                        const std::string& engine_cache_dir) const {
+    auto options = std::make_unique<Ort::SessionOptions>();
+    options->SetIntraOpNumThreads(4);
+    options->SetGraphOptimizationLevel(level);
+    if (!optimized_path.empty()) {
+        options->SetOptimizedModelFilePath(optimized_path.c_str());
+    }
+    if (onnx_arena_compact_ || onnx_arena_max_bytes_ > 0) {
+        options->DisableMemPattern();
+        if (sharedOnnxArena(onnx_arena_compact_, onnx_arena_max_bytes_)) {
+            options->AddConfigEntry("session.use_env_allocators", "1");
+        }
+    }
+    appendExecutionProvider(*options, engine_cache_dir);
+    return options;
+}
+
+void ObjectDetector::appendExecutionProvider(Ort::SessionOptions& options,
+                                             const std::string& engine_cache_dir) const {
+    // Providers missing from the ORT build throw; keep the CPU provider then
+    try {
+        switch (provider_) {
+            case ExecutionProvider::CPU:
+                return;
+            case ExecutionProvider::CUDA: {
+                options.AppendExecutionProvider_CUDA(cudaProviderOptions(onnx_arena_compact_,
+                                                                         onnx_arena_max_bytes_));
+                break;
+            }
+            case ExecutionProvider::TensorRT: {
+                OrtTensorRTProviderOptionsV2* trt_options = nullptr;
+                Ort::ThrowOnError(Ort::GetApi().CreateTensorRTProviderOptions(&trt_options));
+                if (!engine_cache_dir.empty()) {
+                    // Building engines takes minutes on Jetson; reuse them across restarts
+                    const char* keys[] = {"trt_engine_cache_enable", "trt_engine_cache_path",
+                                          "trt_timing_cache_enable", "trt_timing_cache_path"};
+                    const char* values[] = {"1", engine_cache_dir.c_str(), "1", engine_cache_dir.c_str()};
+                    Ort::ThrowOnError(Ort::GetApi().UpdateTensorRTProviderOptions(trt_options, keys, values, 4));
+                }
+                options.AppendExecutionProvider_TensorRT_V2(*trt_options);
+                Ort::GetApi().ReleaseTensorRTProviderOptions(trt_options);
+
+                // Nodes TensorRT cannot take run on CUDA rather than CPU
+                options.AppendExecutionProvider_CUDA(cudaProviderOptions(onnx_arena_compact_,
+                                                                         onnx_arena_max_bytes_));
+                break;
+            }
+            case ExecutionProvider::OpenVINO: {
+                OrtOpenVINOProviderOptions openvino_options{};
+                if (!engine_cache_dir.empty()) {
+                    openvino_options.cache_dir = engine_cache_dir.c_str();
+                }
+                options.AppendExecutionProvider_OpenVINO(openvino_options);
+                break;
+            }
+            case ExecutionProvider::CoreML:
+                options.AppendExecutionProvider("CoreML", {});
+                break;
+        }
+        std::cout << "ONNX Runtime execution provider enabled" << std::endl;
+    } catch (const Ort::Exception& e) {
+        std::cerr << "Execution provider unavailable, using CPU: " << e.what() << std::endl;
+    }
+}
+
+void ObjectDetector::bindOnnxInput() {
+    // blob_ keeps its buffer while the batch size stays the same, so the
+    // input is only rebound when preprocess() reallocated it
+    const int batch = blob_.size[0];
+    if (blob_.data == bound_input_data_ && batch == bound_batch_) {
+        return;
+    }
+
+    auto memory_info = Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault);
+    const std::vector<int64_t> input_shape = {batch, 3, input_size_.height, input_size_.width};
+    input_tensor_ = std::make_unique<Ort::Value>(Ort::Value::CreateTensor<float>(
+        memory_info, blob_.ptr<float>(), blob_.total(), input_shape.data(), input_shape.size()));
+    io_binding_->BindInput(input_name_.c_str(), *input_tensor_);
+
+    bound_input_data_ = blob_.data;
+    bound_batch_ = batch;
+}
+
+void ObjectDetector::runOnnx() {
+    bindOnnxInput();
+    onnx_session_->Run(Ort::RunOptions{nullptr}, *io_binding_);
+
+    if (!dynamic_output_) {
+        outputs_.assign(1, onnx_output_);
+        return;
+    }
+
+    // Dynamic output: wrap the ORT-owned tensor; it stays valid until the
+    // next Run() on this binding
+    auto values = io_binding_->GetOutputValues();
+    auto shape = values[0].GetTensorTypeAndShapeInfo().GetShape();
+    std::vector<int> sizes(shape.begin(), shape.end());
+    output_tensor_ = std::make_unique<Ort::Value>(std::move(values[0]));
+    outputs_.assign(1, cv::Mat(static_cast<int>(sizes.size()), sizes.data(), CV_32F,
+                               output_tensor_->GetTensorMutableData<float>()));
+}
+#endif
+
+bool ObjectDetector::isLoaded() const {
+    return forward_ != nullptr;
+}
+
 bool ObjectDetector::loadClassNames(const std::string& names_file) {
     std::ifstream ifs(names_file);
     if (!ifs.is_open()) {
@@ -62,117 +468,287 @@ bool ObjectDetector::loadClassNames(const std::string& names_file) {
 
     std::string line;
     while (std::getline(ifs, line)) {
-        class_names_.push_back(line);
+        class_ids_.push_back(ClassNames::intern(line));
     }
 
-    std::cout << "Loaded " << class_names_.size() << " class names" << std::endl;
+    std::cout << "Loaded " << class_ids_.size() << " class names" << std::endl;
     return true;
 }
 
-std::string ObjectDetector::getClassName(int class_id) const {
-    if (class_id >= 0 && class_id < static_cast<int>(class_names_.size())) {
-        return class_names_[class_id];
+uint16_t ObjectDetector::getClassId(int class_index) const {
+    if (class_index >= 0 && class_index < static_cast<int>(class_ids_.size())) {
+        return class_ids_[class_index];
+    }
+    return ClassNames::kUnknown;
+}
+
+void ObjectDetector::preprocess(std::span<const cv::Mat> images, int batch,
+                                std::span<const cv::UMat> device_images) {
+    if (device_input_) {
+        preprocessDevice(images, batch, device_images);
+        return;
+    }
+
+    // Reuses blob_ while the batch size stays the same
+    const int sizes[] = {batch, 3, input_size_.height, input_size_.width};
+    blob_.create(4, sizes, CV_32F);
+
+    const size_t item = 3 * static_cast<size_t>(input_size_.area());
+    letterboxes_.resize(static_cast<size_t>(batch));
+    for (size_t i = 0; i < static_cast<size_t>(batch); i++) {
+        float* dst = blob_.ptr<float>() + i * item;
+        if (i < images.size()) {
+            letterboxes_[i] = letterbox_.apply(images[i], input_size_, dst);
+        } else {
+            // Padding for fixed-batch models repeats the last item; its results are dropped
+            std::copy(dst - item, dst, dst);
+            letterboxes_[i] = letterboxes_[i - 1];
+        }
     }
-    return "Unknown";
 }
 
-std::vector<DetectedObject> ObjectDetector::detect(
+void ObjectDetector::preprocessDevice(std::span<const cv::Mat> images, int batch,
+                                      std::span<const cv::UMat> device_images) {
+    const auto count = static_cast<size_t>(batch);
+    device_uploads_.resize(count);
+    device_resized_.resize(count);
+    device_items_.resize(count);
+    letterboxes_.resize(count);
+
+    for (size_t i = 0; i < count; i++) {
+        if (i >= images.size()) {
+            // Padding for fixed-batch models shares the last item's buffer
+            device_items_[i] = device_items_[i - 1];
+            letterboxes_[i] = letterboxes_[i - 1];
+            continue;
+        }
+
+        // The one host-to-device copy, skipped when the caller has one already
+        const cv::UMat* source = &device_uploads_[i];
+        if (i < device_images.size() && !device_images[i].empty()) {
+            source = &device_images[i];
+        } else {
+            images[i].copyTo(device_uploads_[i]);
+        }
+
+        const LetterboxTransform transform = LetterboxTransform::fit(images[i].size(), input_size_);
+        letterboxes_[i] = transform;
+        if (source->size() != transform.content) {
+            cv::resize(*source, device_resized_[i], transform.content, 0, 0, cv::INTER_LINEAR);
+            source = &device_resized_[i];
+        }
+        const int bottom = input_size_.height - transform.content.height - transform.pad_y;
+        const int right = input_size_.width - transform.content.width - transform.pad_x;
+        cv::copyMakeBorder(*source, device_items_[i], transform.pad_y, bottom, transform.pad_x, right,
+                           cv::BORDER_CONSTANT, cv::Scalar::all(114));
+    }
+
+    // RGB, [0, 1], CHW; OpenCV >= 4.8 builds a UMat blob without leaving the device
+    cv::dnn::blobFromImages(device_items_, device_blob_, 1.0 / 255.0, input_size_, cv::Scalar(), true, false, CV_32F);
+}
+
+#ifdef USE_ONNXRUNTIME
+bool ObjectDetector::forwardOnnx() {
+    try {
+        runOnnx();
+    } catch (const Ort::Exception& e) {
+        std::cerr << "ONNX Runtime error: " << e.what() << std::endl;
+        return false;
+    }
+    return true;
+}
+#endif
+
+bool ObjectDetector::forwardDnn() {
+    try {
+        net_.setInput(blob_);
+        net_.forward(outputs_, output_names_);
+    } catch (const cv::Exception& e) {
+        std::cerr << "OpenCV DNN error: " << e.what() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool ObjectDetector::forwardDnnDevice() {
+    try {
+        // Host outputs_: the head output is the only device-to-host copy
+        net_.setInput(device_blob_);
+        net_.forward(outputs_, output_names_);
+    } catch (const cv::Exception& e) {
+        std::cerr << "OpenCV DNN error: " << e.what() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+std::vector<ObjectResult> ObjectDetector::detect(
     const cv::Mat& image,
     float confidence_threshold,
-    float nms_threshold
+    float nms_threshold,
+    const cv::UMat& device_image
 ) {
-    if (net_.empty() && !use_onnx_) {
+    if (!isLoaded()) {
         std::cerr << "Model not loaded" << std::endl;
         return {};
     }
 
-    // Prepare input blob
-    cv::Mat blob;
-    cv::dnn::blobFromImage(image, blob, 1.0 / 255.0, input_size_, cv::Scalar(), true, false);
+    // Fixed-batch models (batch > 1) only run through detectBatch()
+    if (model_batch_ > 1) {
+        auto results = detectBatch(std::span<const cv::Mat>(&image, 1), confidence_threshold, nms_threshold,
+                                   std::span<const cv::UMat>(&device_image, 1));
+        return std::move(results[0]);
+    }
+
+    const auto preprocess_start = std::chrono::steady_clock::now();
+
+    // Letterbox into the input blob (reuses the buffer from the previous frame)
+    preprocess(std::span<const cv::Mat>(&image, 1), 1, std::span<const cv::UMat>(&device_image, 1));
+
+    const auto inference_start = std::chrono::steady_clock::now();
+    last_timings_.preprocess = inference_start - preprocess_start;
 
     // Forward pass
-    net_.setInput(blob);
-    std::vector<cv::Mat> outputs;
-    net_.forward(outputs, net_.getUnconnectedOutLayersNames());
+    if (!forward()) {
+        return {};
+    }
+
+    const auto postprocess_start = std::chrono::steady_clock::now();
+    last_timings_.inference = postprocess_start - inference_start;
 
     // Post-process
-    return postprocess(outputs, image, confidence_threshold, nms_threshold);
+    auto results = postprocess(outputs_[0], letterboxes_[0], image.size(), confidence_threshold, nms_threshold);
+    last_timings_.postprocess = std::chrono::steady_clock::now() - postprocess_start;
+
+    return results;
 }
 
-std::vector<DetectedObject> ObjectDetector::postprocess(
-    const std::vector<cv::Mat>& outputs,
-    const cv::Mat& image,
-    float conf_threshold,
-    float nms_threshold
+std::vector<std::vector<ObjectResult>> ObjectDetector::detectBatch(
+    std::span<const cv::Mat> images,
+    float confidence_threshold,
+    float nms_threshold,
+    std::span<const cv::UMat> device_images
 ) {
-    std::vector<DetectedObject> results;
-    std::vector<int> class_ids;
-    std::vector<float> confidences;
-    std::vector<cv::Rect> boxes;
-
-    // Parse YOLO output
-    // YOLOv8 output format: [batch, num_detections, 4 + num_classes]
-    // Where 4 = [x, y, w, h]
-    for (const auto& output : outputs) {
-        const auto* data = (float*)output.data;
-        const int num_detections = output.size[1];
-        const int num_classes = output.size[2] - 4;
-
-        for (int i = 0; i < num_detections; i++) {
-            const float* detection = data + i * (4 + num_classes);
-
-            // Get class scores
-            float max_conf = 0.0f;
-            int max_class_id = 0;
-
-            for (int j = 0; j < num_classes; j++) {
-                float conf = detection[4 + j];
-                if (conf > max_conf) {
-                    max_conf = conf;
-                    max_class_id = j;
-                }
-            }
+    std::vector<std::vector<ObjectResult>> results(images.size());
+    if (!isLoaded()) {
+        std::cerr << "Model not loaded" << std::endl;
+        return results;
+    }
+
+    // A fixed batch above 1 must go through the padded path below, even for
+    // a single image: detect() forwards those models back here
+    const int limit = maxBatchSize();
+    if (model_batch_ <= 1 && (limit == 1 || images.size() == 1)) {
+        DetectionTimings total;
+        for (size_t i = 0; i < images.size(); i++) {
+            const auto device_slice = deviceSlice(device_images, i, 1);
+            results[i] = detect(images[i], confidence_threshold, nms_threshold,
+                                device_slice.empty() ? cv::UMat() : device_slice[0]);
+            total.preprocess += last_timings_.preprocess;
+            total.inference += last_timings_.inference;
+            total.postprocess += last_timings_.postprocess;
+        }
+        last_timings_ = total;
+        return results;
+    }
+
+    const size_t chunk = limit > 0 ? static_cast<size_t>(limit) : images.size();
+    last_timings_ = DetectionTimings{};
+
+    for (size_t start = 0; start < images.size(); start += chunk) {
+        const size_t count = std::min(chunk, images.size() - start);
+
+        const auto preprocess_start = std::chrono::steady_clock::now();
+
+        // A fixed batch dimension must be filled completely
+        const int batch = model_batch_ > 1 ? model_batch_ : static_cast<int>(count);
+        preprocess(images.subspan(start, count), batch, deviceSlice(device_images, start, count));
+
+        const auto inference_start = std::chrono::steady_clock::now();
+        const bool ok = forward();
+        const auto postprocess_start = std::chrono::steady_clock::now();
+        last_timings_.preprocess += inference_start - preprocess_start;
+        last_timings_.inference += postprocess_start - inference_start;
 
-            if (max_conf > conf_threshold) {
-                // Extract bounding box
-                float cx = detection[0];
-                float cy = detection[1];
-                float w = detection[2];
-                float h = detection[3];
-
-                // Convert to pixel coordinates
-                float scale_x = static_cast<float>(image.cols) / input_size_.width;
-                float scale_y = static_cast<float>(image.rows) / input_size_.height;
-
-                int left = static_cast<int>((cx - w / 2.0f) * scale_x);
-                int top = static_cast<int>((cy - h / 2.0f) * scale_y);
-                int width = static_cast<int>(w * scale_x);
-                int height = static_cast<int>(h * scale_y);
-
-                boxes.push_back(cv::Rect(left, top, width, height));
-                confidences.push_back(max_conf);
-                class_ids.push_back(max_class_id);
+        // Models exported with a static batch of 1 fail (or return a single
+        // item) on OpenCV DNN; remember that and run frame by frame
+        const cv::Mat& output = ok && !outputs_.empty() ? outputs_[0] : cv::Mat();
+        if (!ok || output.dims != 3 || output.size[0] < static_cast<int>(count)) {
+            if (!use_onnx_ && batch_supported_) {
+                std::cerr << "Model does not accept batched input; running frame by frame" << std::endl;
+                batch_supported_ = false;
+                auto remaining = detectBatch(images.subspan(start), confidence_threshold, nms_threshold,
+                                             deviceSlice(device_images, start, images.size() - start));
+                std::move(remaining.begin(), remaining.end(), results.begin() + start);
             }
+            return results;
         }
+
+        // Scatter: every item is decoded with its own image's letterbox
+        for (size_t i = 0; i < count; i++) {
+            const cv::Mat head(output.size[1], output.size[2], CV_32F,
+                               const_cast<float*>(output.ptr<float>(static_cast<int>(i))));
+            results[start + i] = postprocess(head, letterboxes_[i], images[start + i].size(),
+                                             confidence_threshold, nms_threshold);
+        }
+        last_timings_.postprocess += std::chrono::steady_clock::now() - postprocess_start;
+    }
+
+    return results;
+}
+
+int ObjectDetector::maxBatchSize() const {
+    if (use_onnx_) {
+        return model_batch_ > 0 ? model_batch_ : 0;
+    }
+    return batch_supported_ ? 0 : 1;
+}
+
+std::vector<ObjectResult> ObjectDetector::postprocess(
+    const cv::Mat& output,
+    const LetterboxTransform& letterbox,
+    cv::Size image_size,
+    float conf_threshold,
+    float nms_threshold
+) {
+    std::vector<ObjectResult> results;
+    if (output.empty()) {
+        return results;
     }
 
-    // Apply Non-Maximum Suppression
-    std::vector<int> indices;
-    cv::dnn::NMSBoxes(boxes, confidences, conf_threshold, nms_threshold, indices);
+    // Decode YOLOv8 output ([1, 4 + C, N] or [1, N, 4 + C]) and suppress
+    // overlaps; boxes come back in model input coordinates
+    postprocessor_.decode(output, conf_threshold);
+    const auto& indices = postprocessor_.suppress(conf_threshold, nms_threshold, nms_mode_);
+
+    const auto& boxes = postprocessor_.boxes();
+    const auto& scores = postprocessor_.scores();
+    const auto& class_ids = postprocessor_.classIds();
+
+    // Undo the letterbox and clip to the image
+    const cv::Rect2d image_bounds(0, 0, image_size.width, image_size.height);
 
     // Create final results
+    results.reserve(indices.size());
     for (int idx : indices) {
-        DetectedObject obj;
+        const cv::Rect2d box = letterbox.toImage(boxes[idx]) & image_bounds;
+
+        ObjectResult obj;
         obj.object_id = static_cast<uint32_t>(results.size());
-        obj.class_name = getClassName(class_ids[idx]);
-        obj.confidence = confidences[idx];
-        obj.bbox = boxes[idx];
+        obj.class_id = getClassId(class_ids[idx]);
+        obj.confidence = scores[idx];
+        obj.bbox = cv::Rect(
+            static_cast<int>(box.x),
+            static_cast<int>(box.y),
+            static_cast<int>(box.width),
+            static_cast<int>(box.height)
+        );
         obj.center = cv::Point2f(
-            boxes[idx].x + boxes[idx].width / 2.0f,
-            boxes[idx].y + boxes[idx].height / 2.0f
+            obj.bbox.x + obj.bbox.width / 2.0f,
+            obj.bbox.y + obj.bbox.height / 2.0f
         );
 
-        results.push_back(obj);
+        results.push_back(std::move(obj));
     }
 
     return results;
@@ -0,0 +1,244 @@
+#include "object_tracker.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace navign::robot::vision {
+
+namespace {
+
+// Alpha-beta gains: position follows detections closely, velocity is smoothed
+constexpr double kCenterAlpha = 0.6;
+constexpr double kVelocityBeta = 0.2;
+constexpr double kSizeAlpha = 0.4;
+
+// Exponential smoothing of the finite-difference world velocity
+constexpr double kWorldVelocityAlpha = 0.5;
+
+double seconds(ObjectTracker::Clock::duration duration) {
+    return std::chrono::duration<double>(duration).count();
+}
+
+double iou(const cv::Rect2d& a, const cv::Rect2d& b) {
+    const double inter = (a & b).area();
+    const double uni = a.area() + b.area() - inter;
+    return uni > 0.0 ? inter / uni : 0.0;
+}
+
+cv::Rect2d boxAt(const cv::Point2d& center, const cv::Size2d& size) {
+    return cv::Rect2d(center.x - size.width / 2.0, center.y - size.height / 2.0, size.width, size.height);
+}
+
+cv::Point2d boxCenter(const cv::Rect& box) {
+    return cv::Point2d(box.x + box.width / 2.0, box.y + box.height / 2.0);
+}
+
+} // namespace
+
+bool ObjectTracker::update(std::vector<ObjectResult>& objects, Clock::time_point timestamp) {
+    if (initialized_ && timestamp <= last_timestamp_) {
+        return false;
+    }
+    initialized_ = true;
+    last_timestamp_ = timestamp;
+
+    // Every track extrapolated to this frame
+    predicted_.resize(tracks_.size());
+    for (size_t i = 0; i < tracks_.size(); i++) {
+        Track& track = tracks_[i];
+        const double dt = seconds(timestamp - track.last_update);
+        predicted_[i] = boxAt(track.center + track.velocity * dt, track.size);
+        track.matched = false;
+    }
+
+    detection_track_.assign(objects.size(), -1);
+    associate(objects, true);
+    associate(objects, false);
+
+    for (size_t d = 0; d < objects.size(); d++) {
+        if (detection_track_[d] >= 0) {
+            correct(tracks_[detection_track_[d]], objects[d], timestamp);
+        } else if (objects[d].confidence >= config_.high_threshold) {
+            // Only confident detections start tracks
+            Track track;
+            track.id = next_id_++;
+            track.class_id = objects[d].class_id;
+            track.center = boxCenter(objects[d].bbox);
+            track.size = cv::Size2d(objects[d].bbox.width, objects[d].bbox.height);
+            correct(track, objects[d], timestamp);
+            tracks_.push_back(std::move(track));
+        }
+    }
+
+    // Tentative tracks die on their first miss, confirmed ones coast up to max_age
+    lost_confirmed_ = false;
+    std::erase_if(tracks_, [&](const Track& track) {
+        if (track.matched) {
+            return false;
+        }
+        if (!confirmed(track)) {
+            return true;
+        }
+        lost_confirmed_ = true;
+        return timestamp - track.last_update > config_.max_age;
+    });
+
+    output_.clear();
+    for (const Track& track : tracks_) {
+        if (track.matched && confirmed(track)) {
+            output_.push_back(makeResult(track, 0.0, track.score));
+        }
+    }
+    objects.swap(output_);
+    return true;
+}
+
+void ObjectTracker::associate(const std::vector<ObjectResult>& objects, bool high_pass) {
+    // Greedy matching in order of decreasing overlap
+    candidates_.clear();
+    for (size_t d = 0; d < objects.size(); d++) {
+        const float score = objects[d].confidence;
+        const bool eligible = high_pass
+            ? score >= config_.high_threshold
+            : score >= config_.low_threshold && score < config_.high_threshold;
+        if (!eligible || detection_track_[d] >= 0) {
+            continue;
+        }
+
+        const cv::Rect2d box(objects[d].bbox);
+        for (size_t t = 0; t < tracks_.size(); t++) {
+            if (tracks_[t].matched || tracks_[t].class_id != objects[d].class_id) {
+                continue;
+            }
+            const double overlap = iou(predicted_[t], box);
+            if (overlap >= config_.match_iou) {
+                candidates_.push_back({overlap, static_cast<int>(t), static_cast<int>(d)});
+            }
+        }
+    }
+
+    std::sort(candidates_.begin(), candidates_.end(),
+              [](const Candidate& a, const Candidate& b) { return a.iou > b.iou; });
+
+    for (const Candidate& candidate : candidates_) {
+        if (tracks_[candidate.track].matched || detection_track_[candidate.detection] >= 0) {
+            continue;
+        }
+        // Marked now, corrected once both passes are done
+        tracks_[candidate.track].matched = true;
+        detection_track_[candidate.detection] = candidate.track;
+    }
+}
+
+void ObjectTracker::correct(Track& track, const ObjectResult& detection, Clock::time_point timestamp) {
+    const double dt = track.hits > 0 ? seconds(timestamp - track.last_update) : 0.0;
+    const cv::Point2d measured = boxCenter(detection.bbox);
+
+    if (dt > 0.0) {
+        const cv::Point2d predicted = track.center + track.velocity * dt;
+        const cv::Point2d residual = measured - predicted;
+        track.center = predicted + residual * kCenterAlpha;
+        track.velocity += residual * (kVelocityBeta / dt);
+    } else {
+        track.center = measured;
+    }
+    track.size.width += kSizeAlpha * (detection.bbox.width - track.size.width);
+    track.size.height += kSizeAlpha * (detection.bbox.height - track.size.height);
+
+    if (detection.has_3d) {
+        if (track.has_world && dt > 0.0) {
+            const cv::Point3d velocity = (detection.world_position - track.world_position) * (1.0 / dt);
+            track.world_velocity = track.has_world_velocity
+                ? track.world_velocity + (velocity - track.world_velocity) * kWorldVelocityAlpha
+                : velocity;
+            track.has_world_velocity = true;
+        }
+        track.has_world = true;
+        track.world_position = detection.world_position;
+        track.distance_meters = detection.distance_meters;
+    } else {
+        track.has_world = false;
+        track.has_world_velocity = false;
+    }
+
+    track.score = detection.confidence;
+    track.hits++;
+    track.matched = true;
+    track.last_update = timestamp;
+}
+
+ObjectResult ObjectTracker::makeResult(const Track& track, double dt, float confidence) const {
+    const cv::Point2d center = track.center + track.velocity * dt;
+    const cv::Rect2d box = boxAt(center, track.size);
+
+    ObjectResult obj;
+    obj.object_id = track.id;
+    obj.class_id = track.class_id;
+    obj.confidence = confidence;
+    obj.bbox = cv::Rect(
+        static_cast<int>(std::lround(box.x)),
+        static_cast<int>(std::lround(box.y)),
+        static_cast<int>(std::lround(box.width)),
+        static_cast<int>(std::lround(box.height))
+    );
+    obj.center = cv::Point2f(static_cast<float>(center.x), static_cast<float>(center.y));
+    obj.image_velocity = cv::Point2f(static_cast<float>(track.velocity.x), static_cast<float>(track.velocity.y));
+
+    if (track.has_world) {
+        obj.has_3d = true;
+        obj.world_position = track.has_world_velocity
+            ? track.world_position + track.world_velocity * dt
+            : track.world_position;
+        obj.distance_meters = track.distance_meters;
+    }
+    if (track.has_world_velocity) {
+        obj.has_velocity = true;
+        obj.velocity = track.world_velocity;
+    }
+
+    return obj;
+}
+
+void ObjectTracker::predict(Clock::time_point timestamp, std::vector<ObjectResult>& objects) const {
+    objects.clear();
+    for (const Track& track : tracks_) {
+        if (!confirmed(track) || timestamp - track.last_update > config_.max_age) {
+            continue;
+        }
+        const double dt = std::max(0.0, seconds(timestamp - track.last_update));
+        objects.push_back(makeResult(track, dt, decayedScore(track, timestamp)));
+    }
+}
+
+float ObjectTracker::decayedScore(const Track& track, Clock::time_point timestamp) const {
+    const double age = std::max(0.0, seconds(timestamp - track.last_update));
+    const double half_life = std::max(1e-3, seconds(config_.confidence_half_life));
+    return static_cast<float>(track.score * std::exp2(-age / half_life));
+}
+
+float ObjectTracker::predictionConfidence(Clock::time_point timestamp) const {
+    float lowest = 1.0f;
+    for (const Track& track : tracks_) {
+        if (confirmed(track)) {
+            lowest = std::min(lowest, decayedScore(track, timestamp));
+        }
+    }
+    return lowest;
+}
+
+bool ObjectTracker::needsDetection(Clock::time_point timestamp, float min_confidence) const {
+    if (!initialized_ || lost_confirmed_) {
+        return true;
+    }
+    const bool tentative = std::any_of(tracks_.begin(), tracks_.end(),
+                                       [this](const Track& track) { return !confirmed(track); });
+    return tentative || predictionConfidence(timestamp) < min_confidence;
+}
+
+void ObjectTracker::reset() {
+    tracks_.clear();
+    initialized_ = false;
+    lost_confirmed_ = false;
+}
+
+} // namespace navign::robot::vision
@@ -0,0 +1,207 @@
+#include "tag_localizer.hpp"
+
+#include <cmath>
+#include <iostream>
+
+namespace navign::robot::vision {
+
+namespace {
+
+// A previous pose older than this is no longer a useful seed
+constexpr int kMaxWarmStartGap = 5;
+
+// Refinements that fit the corners worse than this are redone from scratch
+constexpr double kMaxWarmStartErrorPx = 3.0;
+
+// Reject solves whose corners do not reproject within this error
+constexpr double kMaxReprojectionErrorPx = 8.0;
+
+cv::Matx33d quaternionToRotation(double w, double x, double y, double z) {
+    const double norm = std::sqrt(w * w + x * x + y * y + z * z);
+    w /= norm;
+    x /= norm;
+    y /= norm;
+    z /= norm;
+    return cv::Matx33d(
+        1 - 2 * (y * y + z * z), 2 * (x * y - z * w),     2 * (x * z + y * w),
+        2 * (x * y + z * w),     1 - 2 * (x * x + z * z), 2 * (y * z - x * w),
+        2 * (x * z - y * w),     2 * (y * z + x * w),     1 - 2 * (x * x + y * y)
+    );
+}
+
+} // namespace
+
+bool TagLocalizer::loadMap(const std::string& filename) {
+    cv::FileStorage fs(filename, cv::FileStorage::READ);
+    if (!fs.isOpened()) {
+        std::cerr << "Failed to open tag map: " << filename << std::endl;
+        return false;
+    }
+
+    double default_size = 0.0;
+    fs["tag_size"] >> default_size;
+
+    map_.clear();
+    for (const auto& node : fs["tags"]) {
+        int id = -1;
+        node["id"] >> id;
+
+        std::vector<double> position, quaternion, rotation;
+        node["position"] >> position;
+        node["quaternion"] >> quaternion;
+        node["rotation"] >> rotation;
+
+        double size = default_size;
+        if (!node["size"].empty()) {
+            node["size"] >> size;
+        }
+
+        cv::Matx33d R;
+        if (quaternion.size() == 4) {
+            R = quaternionToRotation(quaternion[0], quaternion[1], quaternion[2], quaternion[3]);
+        } else if (rotation.size() == 9) {
+            R = cv::Matx33d(rotation.data());
+        } else {
+            std::cerr << "Tag " << id << ": missing quaternion or rotation" << std::endl;
+            continue;
+        }
+
+        if (id < 0 || position.size() != 3 || size <= 0.0) {
+            std::cerr << "Tag map entry " << id << " is incomplete" << std::endl;
+            continue;
+        }
+
+        // Corner order of apriltag_detection_t::p, in tag coordinates
+        const double half = size / 2.0;
+        const cv::Vec3d t(position[0], position[1], position[2]);
+        const cv::Vec3d corners[4] = {{-half, half, 0}, {half, half, 0}, {half, -half, 0}, {-half, -half, 0}};
+
+        std::array<cv::Point3d, 4> world;
+        for (int i = 0; i < 4; i++) {
+            const cv::Vec3d p = R * corners[i] + t;
+            world[i] = cv::Point3d(p[0], p[1], p[2]);
+        }
+        map_[static_cast<uint32_t>(id)] = world;
+    }
+
+    fs.release();
+    reset();
+
+    std::cout << "Tag map loaded from " << filename << ": " << map_.size() << " tags" << std::endl;
+    return !map_.empty();
+}
+
+void TagLocalizer::setCalibration(const cv::Mat& camera_matrix, const cv::Mat& dist_coeffs) {
+    camera_matrix.convertTo(camera_matrix_, CV_64F);
+    dist_coeffs.convertTo(dist_coeffs_, CV_64F);
+    reset();
+}
+
+void TagLocalizer::reset() {
+    frames_since_solve_ = -1;
+    estimate_ = CameraPoseEstimate{};
+}
+
+const CameraPoseEstimate& TagLocalizer::localize(std::span<const AprilTagResult> tags) {
+    estimate_.valid = false;
+    estimate_.tags_used = 0;
+
+    if (frames_since_solve_ >= 0) {
+        frames_since_solve_++;
+    }
+    if (map_.empty() || camera_matrix_.empty()) {
+        return estimate_;
+    }
+
+    object_points_.clear();
+    image_points_.clear();
+    for (const auto& tag : tags) {
+        auto it = map_.find(tag.tag_id);
+        if (it == map_.end()) {
+            continue;
+        }
+        for (int i = 0; i < 4; i++) {
+            object_points_.push_back(it->second[i]);
+            image_points_.push_back(tag.corners[i]);
+        }
+        estimate_.tags_used++;
+    }
+    if (estimate_.tags_used == 0) {
+        return estimate_;
+    }
+
+    const bool warm = frames_since_solve_ >= 0 && frames_since_solve_ <= kMaxWarmStartGap;
+    double error = 0.0;
+    bool solved = warm && solve(true) && (error = reprojectionError()) <= kMaxWarmStartErrorPx;
+    if (!solved) {
+        solved = solve(false) && (error = reprojectionError()) <= kMaxReprojectionErrorPx;
+    }
+    if (!solved) {
+        return estimate_;
+    }
+
+    // solvePnP gives world to camera; the service wants camera to world
+    cv::Matx33d R_wc;
+    cv::Rodrigues(rvec_, R_wc);
+    const cv::Vec3d t_wc(tvec_.ptr<double>());
+
+    estimate_.rotation = R_wc.t();
+    estimate_.position = -(estimate_.rotation * t_wc);
+    estimate_.reprojection_error_px = error;
+    estimate_.valid = true;
+    frames_since_solve_ = 0;
+    return estimate_;
+}
+
+bool TagLocalizer::solve(bool warm_start) {
+    // Keep the previous pose intact in case this attempt is discarded
+    cv::Mat rvec = warm_start ? rvec_.clone() : cv::Mat();
+    cv::Mat tvec = warm_start ? tvec_.clone() : cv::Mat();
+
+    try {
+        bool ok;
+        if (warm_start) {
+            ok = cv::solvePnP(object_points_, image_points_, camera_matrix_, dist_coeffs_,
+                              rvec, tvec, true, cv::SOLVEPNP_ITERATIVE);
+        } else if (object_points_.size() == 4) {
+            // A single planar tag
+            ok = cv::solvePnP(object_points_, image_points_, camera_matrix_, dist_coeffs_,
+                              rvec, tvec, false, cv::SOLVEPNP_IPPE);
+        } else {
+#if CV_VERSION_MAJOR > 4 || (CV_VERSION_MAJOR == 4 && CV_VERSION_MINOR >= 6)
+            constexpr int kGlobalSolver = cv::SOLVEPNP_SQPNP;
+#else
+            constexpr int kGlobalSolver = cv::SOLVEPNP_EPNP;
+#endif
+            ok = cv::solvePnP(object_points_, image_points_, camera_matrix_, dist_coeffs_,
+                              rvec, tvec, false, kGlobalSolver);
+            if (ok) {
+                // Polish the global solve with Levenberg-Marquardt
+                cv::solvePnPRefineLM(object_points_, image_points_, camera_matrix_, dist_coeffs_, rvec, tvec);
+            }
+        }
+        if (!ok) {
+            return false;
+        }
+    } catch (const cv::Exception& e) {
+        std::cerr << "Tag localization failed: " << e.what() << std::endl;
+        return false;
+    }
+
+    rvec_ = rvec;
+    tvec_ = tvec;
+    return true;
+}
+
+double TagLocalizer::reprojectionError() {
+    cv::projectPoints(object_points_, rvec_, tvec_, camera_matrix_, dist_coeffs_, projected_);
+
+    double sum = 0.0;
+    for (size_t i = 0; i < projected_.size(); i++) {
+        const cv::Point2d d = projected_[i] - image_points_[i];
+        sum += d.dot(d);
+    }
+    return std::sqrt(sum / projected_.size());
+}
+
+} // namespace navign::robot::vision
@@ -0,0 +1,202 @@
+#include "undistortion_lut.hpp"
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+namespace navign::robot::vision {
+
+namespace {
+
+constexpr std::array<char, 8> kLutMagic = {'N', 'V', 'L', 'U', 'T', '\0', '\0', '1'};
+
+template <typename T>
+void writeValue(std::ofstream& ofs, const T& value) {
+    ofs.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+bool readValue(std::ifstream& ifs, T& value) {
+    return static_cast<bool>(ifs.read(reinterpret_cast<char*>(&value), sizeof(T)));
+}
+
+void writeMat(std::ofstream& ofs, const cv::Mat& mat) {
+    ofs.write(reinterpret_cast<const char*>(mat.ptr()), static_cast<std::streamsize>(mat.total() * mat.elemSize()));
+}
+
+bool readMat(std::ifstream& ifs, cv::Mat& mat, cv::Size size, int type) {
+    mat.create(size, type);
+    return static_cast<bool>(ifs.read(reinterpret_cast<char*>(mat.ptr()),
+                                      static_cast<std::streamsize>(mat.total() * mat.elemSize())));
+}
+
+} // namespace
+
+std::shared_ptr<UndistortionLut> UndistortionLut::build(
+    const cv::Mat& camera_matrix,
+    const cv::Mat& dist_coeffs,
+    cv::Size image_size
+) {
+    if (camera_matrix.empty() || image_size.area() <= 0) {
+        return nullptr;
+    }
+
+    auto lut = std::make_shared<UndistortionLut>();
+    lut->image_size_ = image_size;
+    camera_matrix.convertTo(lut->camera_matrix_, CV_64F);
+    dist_coeffs.convertTo(lut->dist_coeffs_, CV_64F);
+
+    // Fixed-point remap tables: roughly half the memory of float maps and
+    // the fastest cv::remap path
+    cv::initUndistortRectifyMap(
+        lut->camera_matrix_,
+        lut->dist_coeffs_,
+        cv::noArray(),
+        lut->camera_matrix_,
+        image_size,
+        CV_16SC2,
+        lut->map1_,
+        lut->map2_
+    );
+
+    // Undistort every pixel once; lookups then replace iterative undistortion
+    cv::Mat pixels(1, image_size.area(), CV_32FC2);
+    auto* pixel = pixels.ptr<cv::Vec2f>();
+    for (int y = 0; y < image_size.height; y++) {
+        for (int x = 0; x < image_size.width; x++) {
+            *pixel++ = cv::Vec2f(static_cast<float>(x), static_cast<float>(y));
+        }
+    }
+
+    cv::Mat normalized;
+    cv::undistortPoints(pixels, normalized, lut->camera_matrix_, lut->dist_coeffs_);
+    lut->ray_lut_ = normalized.reshape(2, image_size.height);
+
+    return lut;
+}
+
+std::shared_ptr<UndistortionLut> UndistortionLut::load(
+    const std::string& filename,
+    const cv::Mat& camera_matrix,
+    const cv::Mat& dist_coeffs,
+    cv::Size image_size
+) {
+    std::ifstream ifs(filename, std::ios::binary);
+    if (!ifs.is_open()) {
+        return nullptr;
+    }
+
+    std::array<char, 8> magic{};
+    if (!ifs.read(magic.data(), magic.size()) || magic != kLutMagic) {
+        std::cerr << "Ignoring invalid undistortion cache: " << filename << std::endl;
+        return nullptr;
+    }
+
+    auto lut = std::make_shared<UndistortionLut>();
+    int32_t width = 0, height = 0, num_dist = 0;
+    if (!readValue(ifs, width) || !readValue(ifs, height) || !readValue(ifs, num_dist) ||
+        width <= 0 || height <= 0 || num_dist < 0 || num_dist > 14) {
+        return nullptr;
+    }
+    lut->image_size_ = cv::Size(width, height);
+
+    lut->camera_matrix_.create(3, 3, CV_64F);
+    lut->dist_coeffs_.create(num_dist, 1, CV_64F);
+    for (int i = 0; i < 9; i++) {
+        if (!readValue(ifs, lut->camera_matrix_.ptr<double>()[i])) return nullptr;
+    }
+    for (int i = 0; i < num_dist; i++) {
+        if (!readValue(ifs, lut->dist_coeffs_.ptr<double>()[i])) return nullptr;
+    }
+
+    // Stale cache from an earlier calibration
+    if (!lut->matches(camera_matrix, dist_coeffs, image_size)) {
+        return nullptr;
+    }
+
+    if (!readMat(ifs, lut->map1_, lut->image_size_, CV_16SC2) ||
+        !readMat(ifs, lut->map2_, lut->image_size_, CV_16UC1) ||
+        !readMat(ifs, lut->ray_lut_, lut->image_size_, CV_32FC2)) {
+        std::cerr << "Truncated undistortion cache: " << filename << std::endl;
+        return nullptr;
+    }
+
+    return lut;
+}
+
+bool UndistortionLut::save(const std::string& filename) const {
+    std::ofstream ofs(filename, std::ios::binary | std::ios::trunc);
+    if (!ofs.is_open()) {
+        std::cerr << "Failed to open file for writing: " << filename << std::endl;
+        return false;
+    }
+
+    ofs.write(kLutMagic.data(), kLutMagic.size());
+    writeValue(ofs, static_cast<int32_t>(image_size_.width));
+    writeValue(ofs, static_cast<int32_t>(image_size_.height));
+    writeValue(ofs, static_cast<int32_t>(dist_coeffs_.total()));
+    writeMat(ofs, camera_matrix_);
+    writeMat(ofs, dist_coeffs_);
+    writeMat(ofs, map1_);
+    writeMat(ofs, map2_);
+    writeMat(ofs, ray_lut_);
+
+    return static_cast<bool>(ofs);
+}
+
+void UndistortionLut::undistort(const cv::Mat& image, cv::Mat& undistorted) const {
+    cv::remap(image, undistorted, map1_, map2_, cv::INTER_LINEAR);
+}
+
+void UndistortionLut::undistort(const cv::UMat& image, cv::UMat& undistorted) const {
+    std::call_once(device_maps_once_, [this] {
+        map1_.copyTo(device_map1_);
+        map2_.copyTo(device_map2_);
+    });
+    cv::remap(image, undistorted, device_map1_, device_map2_, cv::INTER_LINEAR);
+}
+
+bool UndistortionLut::lookup(const cv::Point2f& image_point, cv::Point2d& normalized) const {
+    const float u = image_point.x;
+    const float v = image_point.y;
+
+    // Also rejects NaN
+    if (!(u >= 0.0f && v >= 0.0f && u <= image_size_.width - 1 && v <= image_size_.height - 1)) {
+        return false;
+    }
+
+    const int x0 = static_cast<int>(u);
+    const int y0 = static_cast<int>(v);
+    const int x1 = std::min(x0 + 1, image_size_.width - 1);
+    const int y1 = std::min(y0 + 1, image_size_.height - 1);
+    const float ax = u - x0;
+    const float ay = v - y0;
+
+    const auto* row0 = ray_lut_.ptr<cv::Vec2f>(y0);
+    const auto* row1 = ray_lut_.ptr<cv::Vec2f>(y1);
+    const cv::Vec2f top = row0[x0] * (1.0f - ax) + row0[x1] * ax;
+    const cv::Vec2f bottom = row1[x0] * (1.0f - ax) + row1[x1] * ax;
+    const cv::Vec2f value = top * (1.0f - ay) + bottom * ay;
+
+    normalized = cv::Point2d(value[0], value[1]);
+    return true;
+}
+
+bool UndistortionLut::matches(const cv::Mat& camera_matrix, const cv::Mat& dist_coeffs, cv::Size image_size) const {
+    if (image_size != image_size_) {
+        return false;
+    }
+
+    cv::Mat k, d;
+    camera_matrix.convertTo(k, CV_64F);
+    dist_coeffs.convertTo(d, CV_64F);
+    if (k.total() != camera_matrix_.total() || d.total() != dist_coeffs_.total()) {
+        return false;
+    }
+
+    return std::memcmp(k.ptr(), camera_matrix_.ptr(), k.total() * sizeof(double)) == 0 &&
+           (d.total() == 0 || std::memcmp(d.ptr(), dist_coeffs_.ptr(), d.total() * sizeof(double)) == 0);
+}
+
+} // namespace navign::robot::vision
@@ -0,0 +1,305 @@
+#include "v4l2_source.hpp"
+
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+#include <fcntl.h>
+#include <linux/videodev2.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace navign::robot::vision {
+
+namespace {
+
+constexpr int kPollTimeoutMs = 1000;
+
+int xioctl(int fd, unsigned long request, void* arg) {
+    int result;
+    do {
+        result = ::ioctl(fd, request, arg);
+    } while (result < 0 && errno == EINTR);
+    return result;
+}
+
+uint32_t fourcc(CapturePixelFormat format) {
+    switch (format) {
+        case CapturePixelFormat::Yuyv: return V4L2_PIX_FMT_YUYV;
+        case CapturePixelFormat::Nv12: return V4L2_PIX_FMT_NV12;
+        case CapturePixelFormat::Mjpeg: return V4L2_PIX_FMT_MJPEG;
+        case CapturePixelFormat::Auto: break;
+    }
+    return 0;
+}
+
+const char* formatName(CapturePixelFormat format) {
+    switch (format) {
+        case CapturePixelFormat::Yuyv: return "YUYV";
+        case CapturePixelFormat::Nv12: return "NV12";
+        case CapturePixelFormat::Mjpeg: return "MJPEG";
+        case CapturePixelFormat::Auto: break;
+    }
+    return "auto";
+}
+
+} // namespace
+
+V4L2Source::~V4L2Source() {
+    release();
+}
+
+bool V4L2Source::open(int device, cv::Size size, int fps, CapturePixelFormat format) {
+    release();
+    device_ = device;
+
+    const std::string path = "/dev/video" + std::to_string(device);
+    fd_ = ::open(path.c_str(), O_RDWR | O_NONBLOCK | O_CLOEXEC);
+    if (fd_ < 0) {
+        std::cerr << "Failed to open " << path << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    v4l2_capability capability{};
+    if (xioctl(fd_, VIDIOC_QUERYCAP, &capability) < 0) {
+        std::cerr << path << " is not a V4L2 device" << std::endl;
+        release();
+        return false;
+    }
+    const uint32_t caps = (capability.capabilities & V4L2_CAP_DEVICE_CAPS) ? capability.device_caps
+                                                                          : capability.capabilities;
+    if (!(caps & V4L2_CAP_VIDEO_CAPTURE) || !(caps & V4L2_CAP_STREAMING)) {
+        std::cerr << path << " does not support single-planar streaming capture" << std::endl;
+        release();
+        return false;
+    }
+
+    // Raw formats first: their Y plane needs no decode at all
+    bool negotiated = false;
+    if (format == CapturePixelFormat::Auto) {
+        for (auto candidate : {CapturePixelFormat::Yuyv, CapturePixelFormat::Nv12, CapturePixelFormat::Mjpeg}) {
+            if (setFormat(candidate, size)) {
+                negotiated = true;
+                break;
+            }
+        }
+    } else {
+        negotiated = setFormat(format, size);
+    }
+    if (!negotiated) {
+        std::cerr << path << " supports none of the requested pixel formats (" << formatName(format) << ")"
+                  << std::endl;
+        release();
+        return false;
+    }
+
+    // Best effort: not every driver lets the frame rate be set
+    v4l2_streamparm parm{};
+    parm.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    parm.parm.capture.timeperframe.numerator = 1;
+    parm.parm.capture.timeperframe.denominator = static_cast<uint32_t>(fps);
+    xioctl(fd_, VIDIOC_S_PARM, &parm);
+
+    if (!startStreaming()) {
+        release();
+        return false;
+    }
+
+    std::cout << "  V4L2 " << formatName(format_) << " " << frame_size_.width << "x" << frame_size_.height
+              << ", " << buffers_.size() << " mmap buffers" << std::endl;
+    return true;
+}
+
+bool V4L2Source::setFormat(CapturePixelFormat format, cv::Size size) {
+    v4l2_format fmt{};
+    fmt.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    fmt.fmt.pix.width = static_cast<uint32_t>(size.width);
+    fmt.fmt.pix.height = static_cast<uint32_t>(size.height);
+    fmt.fmt.pix.pixelformat = fourcc(format);
+    fmt.fmt.pix.field = V4L2_FIELD_NONE;
+
+    // Drivers substitute a supported format instead of failing
+    if (xioctl(fd_, VIDIOC_S_FMT, &fmt) < 0 || fmt.fmt.pix.pixelformat != fourcc(format)) {
+        return false;
+    }
+
+    format_ = format;
+    frame_size_ = cv::Size(static_cast<int>(fmt.fmt.pix.width), static_cast<int>(fmt.fmt.pix.height));
+    bytes_per_line_ = fmt.fmt.pix.bytesperline;
+    if (bytes_per_line_ == 0 && format != CapturePixelFormat::Mjpeg) {
+        bytes_per_line_ = static_cast<uint32_t>(frame_size_.width * (format == CapturePixelFormat::Yuyv ? 2 : 1));
+    }
+    return true;
+}
+
+bool V4L2Source::startStreaming() {
+    v4l2_requestbuffers request{};
+    request.count = kBufferCount;
+    request.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    request.memory = V4L2_MEMORY_MMAP;
+    if (xioctl(fd_, VIDIOC_REQBUFS, &request) < 0 || request.count < 2) {
+        std::cerr << "Failed to allocate V4L2 buffers: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    buffers_.resize(request.count);
+    for (uint32_t i = 0; i < request.count; i++) {
+        v4l2_buffer buffer{};
+        buffer.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        buffer.memory = V4L2_MEMORY_MMAP;
+        buffer.index = i;
+        if (xioctl(fd_, VIDIOC_QUERYBUF, &buffer) < 0) {
+            std::cerr << "Failed to query V4L2 buffer " << i << ": " << std::strerror(errno) << std::endl;
+            return false;
+        }
+
+        void* start = ::mmap(nullptr, buffer.length, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, buffer.m.offset);
+        if (start == MAP_FAILED) {
+            std::cerr << "Failed to map V4L2 buffer " << i << ": " << std::strerror(errno) << std::endl;
+            return false;
+        }
+        buffers_[i] = {start, buffer.length};
+
+        if (xioctl(fd_, VIDIOC_QBUF, &buffer) < 0) {
+            std::cerr << "Failed to queue V4L2 buffer " << i << ": " << std::strerror(errno) << std::endl;
+            return false;
+        }
+    }
+
+    v4l2_buf_type type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    if (xioctl(fd_, VIDIOC_STREAMON, &type) < 0) {
+        std::cerr << "Failed to start V4L2 streaming: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    streaming_ = true;
+    return true;
+}
+
+bool V4L2Source::read(Frame& frame) {
+    if (!streaming_) {
+        return false;
+    }
+
+    pollfd descriptor{fd_, POLLIN, 0};
+    if (::poll(&descriptor, 1, kPollTimeoutMs) <= 0) {
+        return false;
+    }
+
+    v4l2_buffer buffer{};
+    buffer.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    buffer.memory = V4L2_MEMORY_MMAP;
+    if (xioctl(fd_, VIDIOC_DQBUF, &buffer) < 0) {
+        return false;
+    }
+
+    // Monotonic driver timestamps share steady_clock's epoch on Linux
+    if ((buffer.flags & V4L2_BUF_FLAG_TIMESTAMP_MASK) == V4L2_BUF_FLAG_TIMESTAMP_MONOTONIC) {
+        frame.capture_time = std::chrono::steady_clock::time_point(
+            std::chrono::seconds(buffer.timestamp.tv_sec) + std::chrono::microseconds(buffer.timestamp.tv_usec));
+    } else {
+        frame.capture_time = std::chrono::steady_clock::now();
+    }
+
+    const bool ok = !(buffer.flags & V4L2_BUF_FLAG_ERROR) &&
+                    convert(static_cast<const uint8_t*>(buffers_[buffer.index].start), buffer.bytesused, frame);
+
+    // Hand the buffer back to the driver as soon as the frame is converted
+    xioctl(fd_, VIDIOC_QBUF, &buffer);
+    return ok;
+}
+
+bool V4L2Source::convert(const uint8_t* data, size_t size, Frame& frame) {
+    const int width = frame_size_.width;
+    const int height = frame_size_.height;
+    uint8_t* pixels = const_cast<uint8_t*>(data);
+
+    switch (format_) {
+        case CapturePixelFormat::Yuyv: {
+            if (size < static_cast<size_t>(bytes_per_line_) * height) {
+                return false;
+            }
+            // Luma is every other byte
+            const cv::Mat yuyv(height, width, CV_8UC2, pixels, bytes_per_line_);
+            cv::extractChannel(yuyv, frame.gray, 0);
+            if (color_output_) {
+                cv::cvtColor(yuyv, frame.image, cv::COLOR_YUV2BGR_YUYV);
+            }
+            return true;
+        }
+        case CapturePixelFormat::Nv12: {
+            if (size < static_cast<size_t>(bytes_per_line_) * height * 3 / 2) {
+                return false;
+            }
+            // Luma is the first plane
+            const cv::Mat nv12(height * 3 / 2, width, CV_8UC1, pixels, bytes_per_line_);
+            nv12.rowRange(0, height).copyTo(frame.gray);
+            if (color_output_) {
+                cv::cvtColor(nv12, frame.image, cv::COLOR_YUV2BGR_NV12);
+            }
+            return true;
+        }
+        case CapturePixelFormat::Mjpeg: {
+            const cv::Mat jpeg(1, static_cast<int>(size), CV_8UC1, pixels);
+            if (color_output_) {
+                cv::imdecode(jpeg, cv::IMREAD_COLOR, &frame.image);
+                if (frame.image.size() != frame_size_) {
+                    return false;
+                }
+                cv::cvtColor(frame.image, frame.gray, cv::COLOR_BGR2GRAY);
+            } else {
+                cv::imdecode(jpeg, cv::IMREAD_GRAYSCALE, &frame.gray);
+            }
+            return frame.gray.size() == frame_size_;
+        }
+        case CapturePixelFormat::Auto:
+            break;
+    }
+    return false;
+}
+
+void V4L2Source::skip() {
+    if (!streaming_) {
+        return;
+    }
+    v4l2_buffer buffer{};
+    buffer.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    buffer.memory = V4L2_MEMORY_MMAP;
+    if (xioctl(fd_, VIDIOC_DQBUF, &buffer) == 0) {
+        xioctl(fd_, VIDIOC_QBUF, &buffer);
+    }
+}
+
+void V4L2Source::release() {
+    if (fd_ < 0) {
+        return;
+    }
+    if (streaming_) {
+        v4l2_buf_type type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        xioctl(fd_, VIDIOC_STREAMOFF, &type);
+        streaming_ = false;
+    }
+    for (const auto& buffer : buffers_) {
+        if (buffer.start) {
+            ::munmap(buffer.start, buffer.length);
+        }
+    }
+    buffers_.clear();
+
+    v4l2_requestbuffers request{};
+    request.count = 0;
+    request.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    request.memory = V4L2_MEMORY_MMAP;
+    xioctl(fd_, VIDIOC_REQBUFS, &request);
+
+    ::close(fd_);
+    fd_ = -1;
+}
+
+std::string V4L2Source::describe() const {
+    return "camera " + std::to_string(device_) + " (V4L2 " + formatName(format_) + ")";
+}
+
+} // namespace navign::robot::vision
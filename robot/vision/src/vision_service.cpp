@@ -3,128 +3,1443 @@
 #include "object_detector.hpp"
 #include "camera_calibration.hpp"
 #include "coordinate_transform.hpp"
+#include "frame_pool.hpp"
+#include "frame_recording.hpp"
+#include "frame_scheduler.hpp"
+#include "frame_source.hpp"
+#ifdef USE_V4L2
+#include "v4l2_source.hpp"
+#endif
+#include "inference_scheduler.hpp"
+#include "memory_footprint.hpp"
+#include "metrics_server.hpp"
+#include "object_tracker.hpp"
+#include "result_cache.hpp"
+#include "tag_localizer.hpp"
+#include "zenoh_publisher.hpp"
+#include "vision.pb.h"
+
+#include <opencv2/core/ocl.hpp>
 
 #include <iostream>
 #include <chrono>
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <cmath>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <sstream>
+#include <string>
 #include <thread>
 
 namespace navign::robot::vision {
 
-VisionService::VisionService() {
-    // Initialize components
-    apriltag_detector_ = std::make_unique<AprilTagDetector>();
-    object_detector_ = std::make_unique<ObjectDetector>();
-    camera_calibration_ = std::make_unique<CameraCalibration>();
-    coordinate_transform_ = std::make_unique<CoordinateTransform>();
+namespace {
+
+// Detector queues hold at most a couple of frames so workers never fall
+// behind the camera; the publish queue absorbs bursts from both workers.
+constexpr size_t kDetectorQueueCapacity = 2;
+constexpr size_t kPublishQueueCapacity = 8;
+constexpr auto kStagePollTimeout = std::chrono::milliseconds(100);
+constexpr uint32_t kStatusIntervalFrames = 100;
+
+// Image requests waiting for a request worker; older ones are dropped first
+constexpr size_t kRequestQueueCapacity = 8;
+
+// Distinct StreamVisionData streams (camera, data types, rate); further
+// requests share the closest rate of the same camera and data types
+constexpr size_t kMaxStreamRates = 16;
+
+// Result kinds of a stream, as a mask over DetectionBatch kinds
+constexpr uint32_t kStreamAprilTags = 1u << 0;
+constexpr uint32_t kStreamObjects = 1u << 1;
+constexpr uint32_t kStreamAllKinds = kStreamAprilTags | kStreamObjects;
+
+// YOLO thresholds; with tracking the detector also reports low-score boxes
+// for the tracker's second association pass
+constexpr float kObjectConfidenceThreshold = 0.5f;
+constexpr float kObjectNmsThreshold = 0.4f;
+
+// Enough frames to fill every queue, plus one in flight per stage; object
+// workers additionally hold the frames of the batch being collected
+constexpr size_t kFramePoolSize = 2 * kDetectorQueueCapacity + kPublishQueueCapacity + 4;
+
+// Low-memory mode: a backed-up publish queue holds capture back (the pool
+// runs dry and frames are dropped) instead of having frames of its own
+constexpr size_t kLowMemoryFramePoolSize = 2 * kDetectorQueueCapacity + 4;
+
+// Recycled result batches: a full publish queue plus one per worker in flight
+constexpr size_t kMaxPooledBatches = kPublishQueueCapacity + 8;
+
+// glibc malloc arenas in low-memory mode
+constexpr int kLowMemoryHeapArenas = 2;
+
+// Quantiles exported for every stage
+constexpr double kLatencyQuantiles[] = {0.5, 0.95, 0.99};
+
+using Clock = std::chrono::steady_clock;
+
+// Camera timestamps are monotonic; messages carry wall-clock time
+void setTimestamp(google::protobuf::Timestamp* timestamp, Clock::time_point capture_time) {
+    const auto wall_time = std::chrono::system_clock::now() -
+        std::chrono::duration_cast<std::chrono::system_clock::duration>(Clock::now() - capture_time);
+    const auto nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(wall_time.time_since_epoch()).count();
+    timestamp->set_seconds(nanos / 1'000'000'000);
+    timestamp->set_nanos(static_cast<int32_t>(nanos % 1'000'000'000));
+}
+
+void setOrientation(const cv::Matx33d& R, common::Quaternion* quaternion) {
+    const double trace = R(0, 0) + R(1, 1) + R(2, 2);
+
+    double w, x, y, z;
+    if (trace > 0.0) {
+        const double s = 0.5 / std::sqrt(trace + 1.0);
+        w = 0.25 / s;
+        x = (R(2, 1) - R(1, 2)) * s;
+        y = (R(0, 2) - R(2, 0)) * s;
+        z = (R(1, 0) - R(0, 1)) * s;
+    } else if (R(0, 0) > R(1, 1) && R(0, 0) > R(2, 2)) {
+        const double s = 2.0 * std::sqrt(1.0 + R(0, 0) - R(1, 1) - R(2, 2));
+        w = (R(2, 1) - R(1, 2)) / s;
+        x = 0.25 * s;
+        y = (R(0, 1) + R(1, 0)) / s;
+        z = (R(0, 2) + R(2, 0)) / s;
+    } else if (R(1, 1) > R(2, 2)) {
+        const double s = 2.0 * std::sqrt(1.0 + R(1, 1) - R(0, 0) - R(2, 2));
+        w = (R(0, 2) - R(2, 0)) / s;
+        x = (R(0, 1) + R(1, 0)) / s;
+        y = 0.25 * s;
+        z = (R(1, 2) + R(2, 1)) / s;
+    } else {
+        const double s = 2.0 * std::sqrt(1.0 + R(2, 2) - R(0, 0) - R(1, 1));
+        w = (R(1, 0) - R(0, 1)) / s;
+        x = (R(0, 2) + R(2, 0)) / s;
+        y = (R(1, 2) + R(2, 1)) / s;
+        z = 0.25 * s;
+    }
+
+    quaternion->set_w(w);
+    quaternion->set_x(x);
+    quaternion->set_y(y);
+    quaternion->set_z(z);
+}
+
+} // namespace
+
+/**
+ * @brief Output of a detector worker for one frame, consumed by the publish stage
+ */
+struct DetectionBatch {
+    enum class Kind { AprilTags, Objects };
+
+    Kind kind;
+    FramePtr frame;
+    std::vector<AprilTagResult> tags;
+    std::vector<ObjectResult> objects;
+    std::chrono::nanoseconds processing_time{0};
+    CameraPoseEstimate camera_pose;  // Tag map localization of this frame
+};
+
+/**
+ * @brief Recycles DetectionBatch objects: the per-frame result arena
+ *
+ * When the publish stage (and any stream consumer) drops a batch, the
+ * deleter clears it, releasing its frame, and keeps it for a later frame.
+ * The tag and object vectors keep their capacity, so steady-state results
+ * are written into memory that is already there instead of being
+ * allocated on a worker and freed on the publish thread. Batches are
+ * created on demand (the queues bound how many are in flight) and at most
+ * max_free are kept. Like FramePool, the storage outlives the pool.
+ */
+class DetectionBatchPool {
+public:
+    explicit DetectionBatchPool(size_t max_free) : storage_(std::make_shared<Storage>()) {
+        storage_->max_free = max_free;
+    }
+
+    std::shared_ptr<DetectionBatch> acquire(DetectionBatch::Kind kind) {
+        std::unique_ptr<DetectionBatch> batch;
+        {
+            std::lock_guard<std::mutex> lock(storage_->mutex);
+            if (!storage_->free_list.empty()) {
+                batch = std::move(storage_->free_list.back());
+                storage_->free_list.pop_back();
+            }
+        }
+        if (!batch) {
+            batch = std::make_unique<DetectionBatch>();
+        }
+        batch->kind = kind;
+
+        return std::shared_ptr<DetectionBatch>(batch.release(), [storage = storage_](DetectionBatch* released) {
+            std::unique_ptr<DetectionBatch> recycled(released);
+            recycled->frame.reset();
+            recycled->tags.clear();
+            recycled->objects.clear();
+            recycled->processing_time = std::chrono::nanoseconds(0);
+            recycled->camera_pose = CameraPoseEstimate{};
+
+            std::lock_guard<std::mutex> lock(storage->mutex);
+            if (storage->free_list.size() < storage->max_free) {
+                storage->free_list.push_back(std::move(recycled));
+            }
+        });
+    }
+
+    /**
+     * @brief Batches kept for reuse
+     */
+    size_t available() const {
+        std::lock_guard<std::mutex> lock(storage_->mutex);
+        return storage_->free_list.size();
+    }
+
+    /**
+     * @brief Memory of the kept batches, including their result storage
+     */
+    size_t bytes() const {
+        std::lock_guard<std::mutex> lock(storage_->mutex);
+        size_t total = 0;
+        for (const auto& batch : storage_->free_list) {
+            total += sizeof(DetectionBatch) + batch->tags.capacity() * sizeof(AprilTagResult) +
+                     batch->objects.capacity() * sizeof(ObjectResult);
+        }
+        return total;
+    }
+
+private:
+    struct Storage {
+        mutable std::mutex mutex;
+        std::vector<std::unique_ptr<DetectionBatch>> free_list;
+        size_t max_free = 0;
+    };
+
+    std::shared_ptr<Storage> storage_;
+};
+
+/**
+ * @brief A camera source with its own capture thread, buffers and calibration
+ */
+struct CameraContext {
+    CameraConfig config;
+    uint32_t index = 0;
+
+    std::unique_ptr<FrameSource> source;
+    std::unique_ptr<FrameRecorder> recorder;
+    std::unique_ptr<FramePool> frame_pool;
+    CameraCalibration calibration;
+    std::thread thread;
+
+    // Camera pose from the tag map, updated by whichever AprilTag worker
+    // handles the camera's frame; guarded by pose_mutex, like the newest
+    // frame whose tags were published
+    std::mutex pose_mutex;
+    TagLocalizer localizer;
+    CoordinateTransform transform;
+    uint64_t last_apriltag_frame = 0;
+    bool has_apriltag_frame = false;
+
+    // ROI tracking of the camera, shared by every AprilTag worker
+    AprilTagTrackState apriltag_tracks;
+
+    // Object tracks, updated by whichever YOLO worker handles the camera's
+    // frame and predicted by the capture thread; guarded by track_mutex
+    std::mutex track_mutex;
+    ObjectTracker tracker;
+    int frames_since_detection = 0;
+
+    // Written before the capture thread starts, read-only afterwards
+    cv::Size frame_size;
+    bool connected = false;
+    std::string error_message;
+
+    // Pacing and load shedding; deadlines are accounted by the publish thread
+    FrameScheduler scheduler;
+
+    std::atomic<uint64_t> frames_captured{0};
+    std::atomic<uint32_t> pool_exhausted_drops{0};
+    std::atomic<uint32_t> apriltag_stale_drops{0};  // Finished after a newer frame
+    std::atomic<bool> capture_finished{false};  // Finite source reached its end
+
+    // Latest live results, serialized once by the publish thread and shared
+    // with the topics, the update stream and requests without an image
+    LatestResult latest_apriltags;
+    LatestResult latest_objects;
+
+    // Frame rate over the last status interval (publish thread only)
+    uint64_t last_status_frames = 0;
+    float current_fps = 0.0f;
+    FrameScheduler::DeadlineStats last_status_deadlines[2];
+};
+
+/**
+ * @brief Per-topic protobuf messages, refilled for every publish
+ *
+ * Clear() keeps the storage of repeated sub-messages, so steady-state
+ * publishing rebuilds the same objects instead of allocating new ones.
+ * Only the publish thread touches these.
+ */
+struct PublishMessages {
+    AprilTagResponse apriltags;
+    ObjectDetectionResponse objects;
+    VisionUpdate update_header;
+    StatusResponse status;
+    CameraExtrinsics camera_pose;
+    std::string frame_encoding;
+    std::string attachment;
+};
+
+namespace {
+
+/**
+ * @brief Places detections on the floor plane of their camera
+ *
+ * The bottom-center of a box is where the object stands, so every box's
+ * foot point goes through one batched (LUT-backed) imageToWorld() call.
+ * The camera's transform is copied under its pose mutex, keeping the lock
+ * out of the projection. One instance per object worker.
+ */
+class GroundProjector {
+public:
+    void apply(CameraContext& camera, std::vector<ObjectResult>& objects) {
+        if (objects.empty()) {
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(camera.pose_mutex);
+            transform_ = camera.transform;
+        }
+        if (!transform_.isCalibrated() || !transform_.hasPose()) {
+            return;
+        }
+
+        image_points_.resize(objects.size());
+        world_points_.resize(objects.size());
+        for (size_t i = 0; i < objects.size(); i++) {
+            const cv::Rect& box = objects[i].bbox;
+            image_points_[i] = cv::Point2f(box.x + box.width * 0.5f, static_cast<float>(box.y + box.height));
+        }
+
+        if (transform_.imageToWorld(image_points_, world_points_, camera.config.floor_z) == 0) {
+            return;
+        }
+
+        const cv::Point3d camera_position = transform_.getCameraPosition();
+        for (size_t i = 0; i < objects.size(); i++) {
+            const cv::Point3d& point = world_points_[i];
+            if (std::isnan(point.x)) {
+                continue;  // Foot point at or above the horizon
+            }
+            objects[i].has_3d = true;
+            objects[i].world_position = point;
+            objects[i].distance_meters = cv::norm(point - camera_position);
+        }
+    }
+
+private:
+    CoordinateTransform transform_;
+    std::vector<cv::Point2f> image_points_;
+    std::vector<cv::Point3d> world_points_;
+};
+
+void fillAprilTagResponse(const DetectionBatch& batch, const std::string& tag_family, AprilTagResponse& response) {
+    response.Clear();
+    response.set_frame_id(static_cast<uint32_t>(batch.frame->frame_id));
+    setTimestamp(response.mutable_timestamp(), batch.frame->capture_time);
+
+    for (const auto& tag : batch.tags) {
+        AprilTag* msg = response.add_tags();
+        msg->set_tag_id(tag.tag_id);
+        msg->set_decision_margin(static_cast<float>(tag.decision_margin));
+        msg->set_hamming_distance(static_cast<uint32_t>(tag.hamming_distance));
+        msg->set_tag_family(tag_family);
+
+        // Image-plane center; the 3D position is carried by the pose
+        msg->mutable_center()->set_x(tag.center.x);
+        msg->mutable_center()->set_y(tag.center.y);
+
+        for (const auto& corner : tag.corners) {
+            Corner* c = msg->add_corners();
+            c->set_x(static_cast<float>(corner.x));
+            c->set_y(static_cast<float>(corner.y));
+        }
+
+        if (tag.pose_valid) {
+            auto* position = msg->mutable_pose()->mutable_position();
+            position->set_x(tag.position.x);
+            position->set_y(tag.position.y);
+            position->set_z(tag.position.z);
+            setOrientation(tag.rotation, msg->mutable_pose()->mutable_orientation());
+
+            auto* elements = msg->mutable_rotation()->mutable_elements();
+            for (int i = 0; i < 9; i++) {
+                elements->Add(tag.rotation.val[i]);
+            }
+            msg->mutable_translation()->set_x(tag.position.x);
+            msg->mutable_translation()->set_y(tag.position.y);
+            msg->mutable_translation()->set_z(tag.position.z);
+        }
+    }
+}
+
+void fillObjectResponse(const DetectionBatch& batch, ObjectDetectionResponse& response) {
+    response.Clear();
+    response.set_frame_id(static_cast<uint32_t>(batch.frame->frame_id));
+    setTimestamp(response.mutable_timestamp(), batch.frame->capture_time);
+    response.set_processing_time_ms(static_cast<uint32_t>(
+        std::chrono::duration_cast<std::chrono::milliseconds>(batch.processing_time).count()));
+
+    for (const auto& obj : batch.objects) {
+        DetectedObject* msg = response.add_objects();
+        msg->set_object_id(obj.object_id);
+        msg->set_class_name(obj.className());
+        msg->set_confidence(obj.confidence);
+
+        auto* bbox = msg->mutable_bbox();
+        bbox->set_x_min(static_cast<float>(obj.bbox.x));
+        bbox->set_y_min(static_cast<float>(obj.bbox.y));
+        bbox->set_x_max(static_cast<float>(obj.bbox.x + obj.bbox.width));
+        bbox->set_y_max(static_cast<float>(obj.bbox.y + obj.bbox.height));
+        bbox->set_confidence(obj.confidence);
+
+        if (obj.has_3d) {
+            msg->mutable_world_position()->set_x(obj.world_position.x);
+            msg->mutable_world_position()->set_y(obj.world_position.y);
+            msg->mutable_world_position()->set_z(obj.world_position.z);
+            msg->set_distance_meters(static_cast<float>(obj.distance_meters));
+        }
+
+        if (obj.has_velocity) {
+            msg->mutable_velocity()->set_vx(obj.velocity.x);
+            msg->mutable_velocity()->set_vy(obj.velocity.y);
+            msg->mutable_velocity()->set_vz(obj.velocity.z);
+        }
+    }
+}
+
+void setStatus(common::Response* status, bool success, const std::string& message = {}) {
+    status->set_success(success);
+    status->set_message(message);
+}
+
+// Serialize a message into a new snapshot of a result stream
+ResultSnapshotPtr publishLatest(LatestResult& latest, uint64_t frame_id, uint32_t camera_id,
+                                const google::protobuf::MessageLite& message) {
+    std::string bytes;
+    message.SerializeToString(&bytes);
+    return latest.publish(frame_id, camera_id, std::move(bytes));
+}
+
+// Bytes of a snapshot, sharing its ownership
+std::shared_ptr<const std::string> snapshotBytes(const ResultSnapshotPtr& snapshot) {
+    return std::shared_ptr<const std::string>(snapshot, &snapshot->bytes);
+}
+
+std::string snapshotAttachment(const ResultSnapshot& snapshot) {
+    return "camera_id=" + std::to_string(snapshot.camera_id) + ";frame_id=" + std::to_string(snapshot.frame_id) +
+           ";sequence=" + std::to_string(snapshot.sequence);
+}
+
+/**
+ * @brief A VisionUpdate wrapping an already serialized response
+ *
+ * Protobuf fields may appear in any order on the wire, so the header fields
+ * (timestamp, frame_id) are serialized normally and the response is
+ * appended as its length-delimited field, without parsing or re-encoding it.
+ */
+std::shared_ptr<const std::string> encodeUpdate(const VisionUpdate& header, int field_number,
+                                                const std::string& response) {
+    auto bytes = std::make_shared<std::string>();
+    header.SerializeToString(bytes.get());
+
+    auto appendVarint = [&bytes](uint64_t value) {
+        while (value >= 0x80) {
+            bytes->push_back(static_cast<char>((value & 0x7f) | 0x80));
+            value >>= 7;
+        }
+        bytes->push_back(static_cast<char>(value));
+    };
+    appendVarint((static_cast<uint64_t>(field_number) << 3) | 2);  // Wire type 2: length-delimited
+    appendVarint(response.size());
+    bytes->append(response);
+    return bytes;
+}
+
+// Value of name in a "key=value;key=value" attachment, or 0
+int attachmentValue(const std::string& attachment, const std::string& name) {
+    size_t start = 0;
+    while (start < attachment.size()) {
+        size_t end = attachment.find(';', start);
+        if (end == std::string::npos) {
+            end = attachment.size();
+        }
+        const size_t equals = attachment.find('=', start);
+        if (equals < end && attachment.compare(start, equals - start, name) == 0) {
+            return std::atoi(attachment.substr(equals + 1, end - equals - 1).c_str());
+        }
+        start = end + 1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Decode a request's image_data into gray (AprilTag) or BGR (YOLO)
+ *
+ * Raw pixel formats carry no dimensions in the proto: they come from a
+ * "width=<w>;height=<h>" query attachment, or default to the camera's frame
+ * size.
+ */
+bool decodeRequestImage(const std::string& data, ImageFormat format, const std::string& attachment,
+                        cv::Size camera_size, bool gray, cv::Mat& image, std::string& error) {
+    switch (format) {
+        case IMAGE_FORMAT_RGB:
+        case IMAGE_FORMAT_BGR:
+        case IMAGE_FORMAT_GRAY: {
+            const int channels = format == IMAGE_FORMAT_GRAY ? 1 : 3;
+            cv::Size size(attachmentValue(attachment, "width"), attachmentValue(attachment, "height"));
+            if (size.area() <= 0) {
+                size = camera_size;
+            }
+            if (size.area() <= 0 || data.size() != static_cast<size_t>(size.area()) * channels) {
+                error = "raw image_data does not match its size; send width=<w>;height=<h> as attachment";
+                return false;
+            }
+
+            const cv::Mat raw(size, channels == 1 ? CV_8UC1 : CV_8UC3, const_cast<char*>(data.data()));
+            if (format == IMAGE_FORMAT_GRAY) {
+                if (gray) {
+                    raw.copyTo(image);
+                } else {
+                    cv::cvtColor(raw, image, cv::COLOR_GRAY2BGR);
+                }
+            } else if (format == IMAGE_FORMAT_RGB) {
+                cv::cvtColor(raw, image, gray ? cv::COLOR_RGB2GRAY : cv::COLOR_RGB2BGR);
+            } else if (gray) {
+                cv::cvtColor(raw, image, cv::COLOR_BGR2GRAY);
+            } else {
+                raw.copyTo(image);
+            }
+            return true;
+        }
+        default: {
+            // JPEG, PNG or unspecified: let OpenCV sniff the container
+            const cv::Mat encoded(1, static_cast<int>(data.size()), CV_8UC1, const_cast<char*>(data.data()));
+            image = cv::imdecode(encoded, gray ? cv::IMREAD_GRAYSCALE : cv::IMREAD_COLOR);
+            if (image.empty()) {
+                error = "image_data could not be decoded";
+                return false;
+            }
+            return true;
+        }
+    }
+}
+
+bool keepObject(const ObjectDetectionRequest& request, const std::string& class_name, float confidence) {
+    if (confidence < request.confidence_threshold()) {
+        return false;
+    }
+    if (request.filter_classes_size() == 0) {
+        return true;
+    }
+    return std::find(request.filter_classes().begin(), request.filter_classes().end(), class_name) !=
+           request.filter_classes().end();
+}
+
+// Identifies the filter of a request, for sharing filtered results
+std::string filterKey(const ObjectDetectionRequest& request) {
+    std::string key = std::to_string(request.confidence_threshold());
+    for (const auto& class_name : request.filter_classes()) {
+        key += ';';
+        key += class_name;
+    }
+    return key;
+}
+
+/**
+ * @brief Memory the pipeline preallocates itself
+ */
+struct PipelineMemory {
+    size_t frame_pools = 0;
+    size_t undistortion_tables = 0;  // Shared by a camera's calibration and transform
+};
+
+PipelineMemory pipelineMemory(const std::vector<std::unique_ptr<CameraContext>>& cameras) {
+    PipelineMemory memory;
+    for (const auto& camera : cameras) {
+        if (camera->frame_pool) {
+            memory.frame_pools += camera->frame_pool->bytes();
+        }
+        if (const auto lut = camera->calibration.getUndistortionLut()) {
+            memory.undistortion_tables += lut->bytes();
+        }
+    }
+    return memory;
+}
+
+double megabytes(size_t bytes) {
+    return std::round(bytes / (1024.0 * 1024.0) * 10.0) / 10.0;
+}
+
+} // namespace
+
+/**
+ * @brief Detectors of one request worker, separate from the live pipeline's
+ */
+struct RequestWorker {
+    AprilTagDetector apriltag_detector;
+#ifdef USE_OBJECT_DETECTION
+    std::unique_ptr<ObjectDetector> object_detector;  // Loaded on the first object request with an image
+    bool object_detector_failed = false;
+#endif
+    GroundProjector ground_projector;
+};
+
+/**
+ * @brief A parsed request waiting for a request worker
+ */
+struct RpcRequest {
+    VisionRpc rpc;
+    std::unique_ptr<ZenohQuery> query;
+    AprilTagRequest apriltags;
+    ObjectDetectionRequest objects;
+};
+
+/**
+ * @brief Decimated copies of robot/vision/updates, one key per requested stream
+ *
+ * A stream is a camera (or all cameras), a set of result kinds and a rate.
+ * StreamVisionData queries register streams from Zenoh threads; the publish
+ * thread forwards every update to each stream that covers its camera and
+ * kind and whose period has elapsed. The cost grows with the number of
+ * distinct streams, not with the number of subscribers. Streams are only
+ * ever appended: a slot is written before count is released, and never
+ * changes afterwards.
+ */
+struct StreamRates {
+    struct Rate {
+        int fps = 0;
+        uint32_t camera_id = CAMERA_SOURCE_UNSPECIFIED;  // Unspecified: every camera
+        uint32_t kinds = kStreamAllKinds;
+        std::string key;  // robot/vision/stream/<camera>/<kinds>/<fps>
+        Clock::duration period{};
+    };
+
+    std::array<Rate, kMaxStreamRates> rates;
+    std::atomic<size_t> count{0};
+    std::mutex register_mutex;
+
+    // Publish thread only: next due time per stream, camera and kind
+    std::array<std::vector<std::array<Clock::time_point, 2>>, kMaxStreamRates> next_due;
+
+    /**
+     * @return The stream, or nullptr when all slots are taken by other cameras or kinds
+     */
+    const Rate* add(int fps, uint32_t camera_id, uint32_t kinds) {
+        std::lock_guard<std::mutex> lock(register_mutex);
+        const size_t size = count.load(std::memory_order_relaxed);
+        const Rate* closest = nullptr;
+        for (size_t i = 0; i < size; i++) {
+            if (rates[i].camera_id != camera_id || rates[i].kinds != kinds) {
+                continue;
+            }
+            if (rates[i].fps == fps) {
+                return &rates[i];
+            }
+            if (!closest || std::abs(rates[i].fps - fps) < std::abs(closest->fps - fps)) {
+                closest = &rates[i];
+            }
+        }
+        if (size == rates.size()) {
+            return closest;
+        }
+
+        Rate& rate = rates[size];
+        rate.fps = fps;
+        rate.camera_id = camera_id;
+        rate.kinds = kinds;
+        rate.key = "robot/vision/stream/" + streamCameraName(camera_id) + "/" + streamKindsName(kinds) + "/" +
+                   std::to_string(fps);
+        rate.period = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / fps));
+        count.store(size + 1, std::memory_order_release);
+        return &rate;
+    }
+
+private:
+    static std::string streamCameraName(uint32_t camera_id) {
+        switch (camera_id) {
+            case CAMERA_SOURCE_UNSPECIFIED: return "all";
+            case CAMERA_SOURCE_PRIMARY: return "primary";
+            case CAMERA_SOURCE_SECONDARY: return "secondary";
+            case CAMERA_SOURCE_DEPTH: return "depth";
+        }
+        return std::to_string(camera_id);
+    }
+
+    static const char* streamKindsName(uint32_t kinds) {
+        switch (kinds) {
+            case kStreamAprilTags: return "apriltags";
+            case kStreamObjects: return "objects";
+        }
+        return "all";
+    }
+};
+
+VisionService::VisionService()
+    : apriltag_queue_(kDetectorQueueCapacity),
+      object_queue_(kDetectorQueueCapacity),
+      publish_queue_(kPublishQueueCapacity),
+      request_queue_(kRequestQueueCapacity),
+      batch_pool_(std::make_unique<DetectionBatchPool>(kMaxPooledBatches)) {
+    // Worker 0 components exist up front; extra workers are added in start()
+    apriltag_detectors_.push_back(std::make_unique<AprilTagDetector>());
+#ifdef USE_OBJECT_DETECTION
+    object_detectors_.push_back(std::make_unique<ObjectDetector>());
+#endif
+    zenoh_ = std::make_unique<ZenohPublisher>();
+    messages_ = std::make_unique<PublishMessages>();
+    stream_rates_ = std::make_unique<StreamRates>();
 }
 
 VisionService::~VisionService() {
     stop();
 }
 
-bool VisionService::start() {
-    if (running_.load()) {
-        std::cerr << "Vision service already running" << std::endl;
-        return false;
-    }
+void VisionService::setWorkerCounts(int apriltag_workers, int object_workers) {
+    apriltag_worker_count_ = static_cast<size_t>(std::max(1, apriltag_workers));
+    object_worker_count_ = static_cast<size_t>(std::max(1, object_workers));
+}
+
+AprilTagDetector* VisionService::getAprilTagDetector(size_t worker) {
+    return worker < apriltag_detectors_.size() ? apriltag_detectors_[worker].get() : nullptr;
+}
+
+ObjectDetector* VisionService::getObjectDetector(size_t worker) {
+#ifdef USE_OBJECT_DETECTION
+    return worker < object_detectors_.size() ? object_detectors_[worker].get() : nullptr;
+#else
+    (void)worker;
+    return nullptr;
+#endif
+}
+
+CameraCalibration* VisionService::getCameraCalibration(size_t camera) {
+    return camera < cameras_.size() ? &cameras_[camera]->calibration : nullptr;
+}
+
+bool VisionService::openCamera(CameraContext& camera) {
+    const int device = camera.config.device_index;
+
+    // The calibration (and its undistortion maps) builds while the device opens
+    auto calibration_loaded = std::async(std::launch::async, [&camera] {
+        return camera.calibration.load(camera.config.calibration_file);
+    });
+
+    if (!camera.config.replay_file.empty()) {
+        std::cout << "Replaying " << camera.config.replay_file << " (source " << camera.config.camera_id
+                  << ")..." << std::endl;
+        auto replay = std::make_unique<ReplaySource>();
+        if (!replay->open(camera.config.replay_file, replay_pacing_, replay_loop_)) {
+            camera.error_message = "failed to open recording " + camera.config.replay_file;
+            return false;
+        }
+        std::cout << "  " << replay->frameCount() << " frames, "
+                  << (replay_pacing_ == ReplayPacing::Fast ? "as fast as possible" : "original timing") << std::endl;
+        camera.source = std::move(replay);
+    } else {
+        std::cout << "Opening camera " << device << " (source " << camera.config.camera_id << ")..." << std::endl;
+        const cv::Size requested_size(640, 480);
+        bool opened = false;
+        switch (capture_backend_) {
+            case CaptureBackend::V4L2: {
+#ifdef USE_V4L2
+                auto capture = std::make_unique<V4L2Source>();
+                opened = capture->open(device, requested_size, target_fps_, capture_format_);
+                camera.source = std::move(capture);
+#else
+                std::cerr << "V4L2 capture not compiled in, using OpenCV" << std::endl;
+                auto capture = std::make_unique<VideoCaptureSource>();
+                opened = capture->open(device, requested_size, target_fps_);
+                camera.source = std::move(capture);
+#endif
+                break;
+            }
+            case CaptureBackend::GStreamer: {
+                auto capture = std::make_unique<GStreamerSource>();
+                opened = capture->open(device, requested_size, target_fps_, capture_format_, capture_jpeg_decoder_);
+                camera.source = std::move(capture);
+                break;
+            }
+            case CaptureBackend::OpenCV: {
+                auto capture = std::make_unique<VideoCaptureSource>();
+                opened = capture->open(device, requested_size, target_fps_);
+                camera.source = std::move(capture);
+                break;
+            }
+        }
+        if (!opened) {
+            camera.error_message = "failed to open device " + std::to_string(device);
+            std::cerr << "Failed to open camera " << device << std::endl;
+            return false;
+        }
+    }
+
+    // Preallocate frame buffers at the size the source actually delivers
+    camera.frame_size = camera.source->frameSize();
+    const size_t batched_frames = object_worker_count_ * (object_max_batch_ - 1);
+    const size_t recorded_frames = camera.config.record_file.empty() ? 0 : FrameRecorder::kQueueCapacity;
+    const size_t pooled_frames = memory_budget_ > 0 ? kLowMemoryFramePoolSize : kFramePoolSize;
+    camera.frame_pool = std::make_unique<FramePool>(pooled_frames + batched_frames + recorded_frames,
+                                                    camera.frame_size);
+
+    if (!camera.config.record_file.empty()) {
+        camera.recorder = std::make_unique<FrameRecorder>();
+        if (camera.recorder->start(camera.config.record_file, camera.frame_size,
+                                   recording_codec_, recording_jpeg_quality_)) {
+            std::cout << "Recording to " << camera.config.record_file << std::endl;
+        } else {
+            camera.recorder.reset();
+        }
+    }
+
+    // Load camera calibration if available
+    if (calibration_loaded.get()) {
+        std::cout << "Camera calibration loaded from " << camera.config.calibration_file << std::endl;
+        const auto& calib = camera.calibration.getCalibration();
+        camera.transform.setCalibration(calib.camera_matrix, calib.dist_coeffs);
+        camera.transform.setUndistortionLut(camera.calibration.getUndistortionLut());
+
+        // A fixed mount may carry its extrinsics; a tag map overrides them per frame
+        if (!calib.rotation.empty() && !calib.translation.empty()) {
+            camera.transform.setCameraPose(calib.rotation, calib.translation);
+        }
+
+        // Without intrinsics the map cannot be used
+        if (!tag_map_file_.empty() && camera.localizer.loadMap(tag_map_file_)) {
+            camera.localizer.setCalibration(calib.camera_matrix, calib.dist_coeffs);
+        }
+    } else {
+        std::cout << "No calibration file " << camera.config.calibration_file
+                  << " - pose estimation will be less accurate" << std::endl;
+    }
+
+    camera.connected = true;
+    return true;
+}
+
+bool VisionService::start() {
+    if (running_.load()) {
+        std::cerr << "Vision service already running" << std::endl;
+        return false;
+    }
+
+    std::cout << "Starting Vision service..." << std::endl;
+    const auto start_time = Clock::now();
+
+    // Before the first pipeline thread, so every thread sees the arena limit
+    if (memory_budget_ > 0) {
+        limitHeapArenas(kLowMemoryHeapArenas);
+        if (dnn_target_ == DnnTarget::OpenCL && cv::ocl::haveOpenCL()) {
+            // OpenCL otherwise keeps freed device buffers around for reuse
+            if (auto* buffer_pool = cv::ocl::getOpenCLAllocator()->getBufferPoolController()) {
+                buffer_pool->setMaxReservedSize(0);
+            }
+        }
+        std::cout << "Low-memory mode: budget " << memory_budget_ / (1024 * 1024) << " MB" << std::endl;
+    }
+
+    // YOLO loads while the cameras open; AprilTag publishes without waiting for it
+    object_detection_enabled_ = false;
+    device_frames_ = false;
+#ifdef USE_OBJECT_DETECTION
+    object_models_loaded_ = false;
+    object_models_loading_ = true;
+    model_thread_ = std::thread(&VisionService::loadObjectModels, this, start_time);
+#else
+    std::cout << "AprilTag-only build: object detection not compiled in" << std::endl;
+#endif
+
+    // Initialize cameras; a single primary camera unless configured otherwise
+    std::vector<CameraConfig> configs = camera_configs_;
+    if (configs.empty()) {
+        CameraConfig primary;
+        primary.device_index = camera_index_;
+        primary.floor_z = floor_z_;
+        primary.replay_file = replay_file_;
+        primary.record_file = record_file_;
+        configs.push_back(primary);
+    }
+
+    cameras_.clear();
+    size_t connected = 0;
+    for (const auto& config : configs) {
+        auto camera = std::make_unique<CameraContext>();
+        camera->config = config;
+        camera->index = static_cast<uint32_t>(cameras_.size());
+        if (openCamera(*camera)) {
+            connected++;
+        }
+        cameras_.push_back(std::move(camera));
+    }
+
+    if (connected == 0) {
+        std::cerr << "No camera could be opened" << std::endl;
+        cameras_.clear();
+        waitForObjectModels();
+        return false;
+    }
+
+    // One detector per worker. Each AprilTag worker sees frames from every
+    // camera, so its adaptive deadline is the aggregate per-worker period.
+    while (apriltag_detectors_.size() < apriltag_worker_count_) {
+        apriltag_detectors_.push_back(std::make_unique<AprilTagDetector>());
+    }
+    const double worker_fps = static_cast<double>(target_fps_) * connected / apriltag_worker_count_;
+    for (size_t i = 0; i < apriltag_worker_count_; i++) {
+        if (!apriltag_detectors_[i]->setTagFamily(apriltag_family_)) {
+            cameras_.clear();
+            waitForObjectModels();
+            return false;
+        }
+        apriltag_detectors_[i]->setFilter(apriltag_filter_, apriltag_prune_family_);
+        apriltag_detectors_[i]->setPoseMethod(apriltag_pose_method_);
+        apriltag_detectors_[i]->setTrackingMode(apriltag_tracking_, apriltag_rescan_interval_);
+        apriltag_detectors_[i]->setAdaptiveControl(apriltag_adaptive_, worker_fps);
+    }
+
+    if (kObjectDetectionBuilt && object_tracking_) {
+        for (auto& camera : cameras_) {
+            camera->tracker.setConfig(object_tracker_config_);
+        }
+        std::cout << "Tracking objects, YOLO every " << object_detect_interval_ << " frame(s)" << std::endl;
+    }
+
+    // Initialize Zenoh
+    if (!initializeZenoh()) {
+        std::cerr << "Warning: Zenoh initialization failed - pub/sub disabled" << std::endl;
+    }
+
+    // Expose the Prometheus endpoint
+    if (metrics_port_ > 0) {
+        metrics_server_ = std::make_unique<MetricsServer>([this] { return renderPrometheusMetrics(); });
+        if (metrics_server_->start(metrics_port_)) {
+            std::cout << "Serving metrics on port " << metrics_port_ << std::endl;
+        } else {
+            std::cerr << "Warning: Metrics endpoint disabled" << std::endl;
+            metrics_server_.reset();
+        }
+    }
+
+    SchedulerConfig scheduling;
+    scheduling.fps = target_fps_;
+    scheduling.object_fps = object_fps_;
+    scheduling.shedding = load_shedding_;
+    scheduling.deadline = frame_deadline_;
+    for (auto& camera : cameras_) {
+        camera->scheduler.configure(scheduling);
+    }
+
+    // Start pipeline stages
+    last_status_time_ = Clock::now();
+    last_status_frames_ = total_frames_processed_.load();
+    apriltag_queue_.reset(cameras_.size());
+    object_queue_.reset(cameras_.size());
+    publish_queue_.reset();
+
+    running_.store(true);
+    publish_thread_ = std::thread(&VisionService::publishLoop, this);
+    for (size_t i = 0; i < apriltag_worker_count_; i++) {
+        apriltag_threads_.emplace_back(&VisionService::aprilTagLoop, this, i);
+    }
+#ifdef USE_OBJECT_DETECTION
+    {
+        // Otherwise the loader starts them when it finishes
+        std::lock_guard<std::mutex> lock(object_start_mutex_);
+        if (object_models_loaded_) {
+            startObjectWorkers();
+        }
+    }
+#endif
+    for (auto& camera : cameras_) {
+        if (camera->connected) {
+            camera->thread = std::thread(&VisionService::captureLoop, this, std::ref(*camera));
+        }
+    }
+
+    // Request workers mirror the live detector settings, without tracking
+    if (zenoh_->isOpen() && request_worker_count_ > 0) {
+        request_queue_.reset();
+        while (request_workers_.size() < request_worker_count_) {
+            request_workers_.push_back(std::make_unique<RequestWorker>());
+        }
+        for (size_t i = 0; i < request_worker_count_; i++) {
+            auto& detector = request_workers_[i]->apriltag_detector;
+            detector.setTagFamily(apriltag_family_);
+            detector.setFilter(apriltag_filter_, apriltag_prune_family_);
+            detector.setPoseMethod(apriltag_pose_method_);
+            request_threads_.emplace_back(&VisionService::requestLoop, this, i);
+        }
+        declareQueryables();
+    }
+
+    std::cout << "Vision service started successfully with " << connected << " camera(s)" << std::endl;
+    return true;
+}
+
+void VisionService::stop() {
+    if (!running_.load()) {
+        return;
+    }
+
+    std::cout << "Stopping Vision service..." << std::endl;
+    running_.store(false);
+
+    // No new queries; queued ones are still answered
+    zenoh_->undeclareQueryables();
+    request_queue_.close();
+    for (auto& thread : request_threads_) {
+        thread.join();
+    }
+    request_threads_.clear();
+
+    // Stop upstream first so downstream stages can drain and exit
+    for (auto& camera : cameras_) {
+        if (camera->thread.joinable()) {
+            camera->thread.join();
+        }
+    }
+
+    // A YOLO load still in progress finishes first; ORT cannot be interrupted
+    waitForObjectModels();
+
+    apriltag_queue_.close();
+    object_queue_.close();
+    for (auto& thread : apriltag_threads_) {
+        thread.join();
+    }
+    for (auto& thread : object_threads_) {
+        thread.join();
+    }
+    apriltag_threads_.clear();
+    object_threads_.clear();
+
+    publish_queue_.close();
+    if (publish_thread_.joinable()) {
+        publish_thread_.join();
+    }
+
+    zenoh_->close();
+
+    if (metrics_server_) {
+        metrics_server_->stop();
+        metrics_server_.reset();
+    }
+
+    // Release devices but keep contexts so final statistics stay readable
+    for (auto& camera : cameras_) {
+        if (camera->recorder) {
+            camera->recorder->stop();
+        }
+        if (camera->source && camera->source->isOpened()) {
+            camera->source->release();
+        }
+        camera->connected = false;
+    }
+
+    std::cout << "Vision service stopped" << std::endl;
+}
+
+#ifdef USE_OBJECT_DETECTION
+void VisionService::configureObjectDetector(ObjectDetector& detector) const {
+    if (dnn_target_ != DnnTarget::CPU) {
+        detector.setBackend(InferenceBackend::OpenCvDnn);
+    }
+    detector.setExecutionProvider(execution_provider_);
+    detector.setDnnTarget(dnn_target_);
+    detector.setPrecision(model_precision_);
+    detector.setModelCache(model_cache_, model_cache_dir_);
+    detector.setOnnxArena(memory_budget_ > 0, onnx_arena_limit_);
+}
+
+void VisionService::loadObjectModels(Clock::time_point start_time) {
+    std::cout << "Loading YOLO model..." << std::endl;
+    while (object_detectors_.size() < object_worker_count_) {
+        object_detectors_.push_back(std::make_unique<ObjectDetector>());
+    }
+    bool loaded = true;
+    for (size_t i = 0; i < object_worker_count_; i++) {
+        auto& detector = object_detectors_[i];
+        configureObjectDetector(*detector);
+        if (!detector->loadModel("yolov8n.onnx")) {
+            std::cerr << "Warning: Failed to load YOLO model - object detection disabled" << std::endl;
+            loaded = false;
+            break;
+        }
+
+        // Load class names
+        if (!detector->loadClassNames("coco.names")) {
+            std::cerr << "Warning: Failed to load class names" << std::endl;
+        }
+    }
+
+    // Batch limits depend on the loaded model
+    inference_schedulers_.clear();
+    if (loaded) {
+        for (size_t i = 0; i < object_worker_count_; i++) {
+            inference_schedulers_.push_back(std::make_unique<InferenceScheduler>(
+                *object_detectors_[i], object_max_batch_, object_batch_budget_));
+        }
+        if (inference_schedulers_[0]->maxBatch() > 1) {
+            std::cout << "Batching YOLO inference: up to " << inference_schedulers_[0]->maxBatch()
+                      << " frames within " << object_batch_budget_.count() << " us" << std::endl;
+        }
+        std::cout << "YOLO ready after "
+                  << std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - start_time).count()
+                  << " ms" << std::endl;
+    }
+
+    std::lock_guard<std::mutex> lock(object_start_mutex_);
+    device_frames_ = loaded && object_detectors_[0]->usesDeviceInput();
+    object_models_loaded_ = loaded;
+    object_models_loading_ = false;
+    if (loaded && running_.load()) {
+        startObjectWorkers();
+    }
+}
+
+void VisionService::startObjectWorkers() {
+    if (!object_threads_.empty()) {
+        return;
+    }
+    for (size_t i = 0; i < object_worker_count_; i++) {
+        object_threads_.emplace_back(&VisionService::objectLoop, this, i);
+    }
+    // Capture threads send frames only once the workers exist
+    object_detection_enabled_.store(true, std::memory_order_release);
+}
+#endif
+
+void VisionService::waitForObjectModels() {
+#ifdef USE_OBJECT_DETECTION
+    if (model_thread_.joinable()) {
+        model_thread_.join();
+    }
+#endif
+}
+
+bool VisionService::wantsColorOutput(const CameraContext& camera) const {
+    // Assume YOLO will need color while its model is still loading
+    const bool objects = kObjectDetectionBuilt &&
+                         (object_models_loading_.load(std::memory_order_acquire) || objectDetectionEnabled());
+    return objects || publish_frames_ || camera.recorder != nullptr;
+}
+
+void VisionService::captureLoop(CameraContext& camera) {
+    tuneCurrentThread(thread_tuning_.capture_priority, thread_tuning_.capture_cpus,
+                      "capture thread of camera " + std::to_string(camera.config.device_index));
+    auto& latency = latency_metrics_.registerThread();
+    FrameSource& source = *camera.source;
+    FrameScheduler& scheduler = camera.scheduler;
+    const bool lossless = source.lossless();
+    const bool paced = source.paced();
+    const bool gray_from_source = source.providesGray();
+    cv::UMat device_gray;
+    uint64_t frame_id = 0;
+
+    // Gray-providing sources skip the BGR conversion when only AprilTag reads frames
+    bool color_output = wantsColorOutput(camera);
+    source.setColorOutput(color_output);
+
+    while (running_.load()) {
+        if (!paced) {
+            scheduler.waitForSlot();
+        }
+
+        // Changes once, when the YOLO model loading in the background fails
+        if (gray_from_source && wantsColorOutput(camera) != color_output) {
+            color_output = !color_output;
+            source.setColorOutput(color_output);
+        }
+
+        auto frame = camera.frame_pool->acquire();
+        if (!frame) {
+            if (lossless) {
+                // Wait for downstream to release a buffer instead of skipping
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                continue;
+            }
+            // Every buffer is still referenced downstream; discard this frame
+            // so the camera buffer does not fill with stale images
+            source.skip();
+            camera.pool_exhausted_drops++;
+            continue;
+        }
+
+        // Decodes straight into the pooled buffer when size and type match
+        const auto read_start = Clock::now();
+        if (!source.read(*frame)) {
+            if (source.finished()) {
+                std::cout << "End of " << source.describe() << " after " << frame_id << " frames" << std::endl;
+                camera.capture_finished = true;
+                return;
+            }
+            std::cerr << "Failed to read frame from " << source.describe() << std::endl;
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            continue;
+        }
+
+        frame->frame_id = ++frame_id;
+        frame->camera_index = camera.index;
+        const auto read_end = Clock::now();
+        frame->received_time = lossless ? read_end : frame->capture_time;
+        latency.record(PipelineStage::Capture, read_end - read_start);
+
+        // V4L2 and GStreamer sources deliver the Y plane as gray already.
+        // For YOLO on OpenCL the frame goes to the device once, here: gray is
+        // converted there and read back for AprilTag (a blocking read, so the
+        // upload is complete before the frame is published).
+        if (!gray_from_source && device_frames_.load(std::memory_order_relaxed) && objectDetectionEnabled()) {
+            frame->image.copyTo(frame->device_image);
+            cv::cvtColor(frame->device_image, device_gray, cv::COLOR_BGR2GRAY);
+            device_gray.copyTo(frame->gray);
+            latency.record(PipelineStage::Grayscale, Clock::now() - read_end);
+        } else if (!gray_from_source) {
+            if (!frame->device_image.empty()) {
+                frame->device_image.release();
+            }
+            cv::cvtColor(frame->image, frame->gray, cv::COLOR_BGR2GRAY);
+            latency.record(PipelineStage::Grayscale, Clock::now() - read_end);
+        }
+        camera.frames_captured++;
+        total_frames_processed_++;
+
+        // Both detectors read the same immutable frame concurrently
+        FramePtr shared_frame = std::move(frame);
+        if (camera.recorder) {
+            camera.recorder->record(shared_frame);
+        }
+        if (lossless) {
+            // Replays keep every frame: wait for room instead of evicting
+            while (running_.load() && !apriltag_queue_.pushWait(camera.index, shared_frame, kStagePollTimeout)) {}
+            if (objectDetectionEnabled() && !predictObjects(camera, shared_frame, latency)) {
+                while (running_.load() &&
+                       !object_queue_.pushWait(camera.index, shared_frame, kStagePollTimeout)) {}
+            }
+            continue;
+        }
+
+        // Decided on the capture timestamp, so frames that waited in the
+        // driver's queue count as late
+        const auto work = scheduler.plan(shared_frame->capture_time);
+        if (work.apriltags) {
+            apriltag_queue_.push(camera.index, shared_frame);
+        }
+        if (work.objects && objectDetectionEnabled() && !predictObjects(camera, shared_frame, latency)) {
+            object_queue_.push(camera.index, std::move(shared_frame));
+        }
+    }
+}
+
+void VisionService::aprilTagLoop(size_t worker) {
+    tuneCurrentThread(thread_tuning_.detection_priority, thread_tuning_.detection_cpus,
+                      "AprilTag worker " + std::to_string(worker));
+    auto& detector = *apriltag_detectors_[worker];
+    auto& latency = latency_metrics_.registerThread();
+
+    while (running_.load()) {
+        auto frame = apriltag_queue_.pop(kStagePollTimeout);
+        if (!frame) {
+            continue;
+        }
+
+        // Calibration is loaded before capture starts and read-only afterwards
+        CameraContext& camera = *cameras_[(*frame)->camera_index];
+        cv::Mat camera_matrix, dist_coeffs;
+        if (camera.calibration.isValid()) {
+            const auto& calib = camera.calibration.getCalibration();
+            camera_matrix = calib.camera_matrix;
+            dist_coeffs = calib.dist_coeffs;
+        }
+
+        auto batch = batch_pool_->acquire(DetectionBatch::Kind::AprilTags);
+        batch->frame = *frame;
+        detector.detect((*frame)->gray, batch->tags, camera.apriltag_tracks, (*frame)->frame_id,
+                        camera_matrix, dist_coeffs, apriltag_size_);
+        total_tags_detected_ += batch->tags.size();
 
-    std::cout << "Starting Vision service..." << std::endl;
+        const auto& timings = detector.getLastTimings();
+        latency.record(PipelineStage::AprilTagDecode, timings.decode);
+        latency.record(PipelineStage::PoseEstimation, timings.pose);
+
+        {
+            const auto localization_start = Clock::now();
+            std::lock_guard<std::mutex> lock(camera.pose_mutex);
+            // Another worker already finished a newer frame of this camera;
+            // publishing older tags, or localizing from them, would go back in time
+            if (camera.has_apriltag_frame && (*frame)->frame_id <= camera.last_apriltag_frame) {
+                camera.apriltag_stale_drops++;
+                continue;
+            }
+            camera.last_apriltag_frame = (*frame)->frame_id;
+            camera.has_apriltag_frame = true;
 
-    // Initialize camera
-    std::cout << "Opening camera " << camera_index_ << "..." << std::endl;
-    camera_.open(camera_index_);
+            if (camera.localizer.hasMap()) {
+                batch->camera_pose = camera.localizer.localize(batch->tags);
+                if (batch->camera_pose.valid) {
+                    camera.transform.setCameraPose(cv::Mat(batch->camera_pose.rotation),
+                                                   cv::Mat(batch->camera_pose.position));
+                }
+                latency.record(PipelineStage::Localization, Clock::now() - localization_start);
+            }
+        }
 
-    if (!camera_.isOpened()) {
-        std::cerr << "Failed to open camera " << camera_index_ << std::endl;
-        return false;
+        publish_queue_.push(std::move(batch));
     }
+}
 
-    // Set camera properties
-    camera_.set(cv::CAP_PROP_FRAME_WIDTH, 640);
-    camera_.set(cv::CAP_PROP_FRAME_HEIGHT, 480);
-    camera_.set(cv::CAP_PROP_FPS, target_fps_);
+#ifdef USE_OBJECT_DETECTION
+void VisionService::objectLoop(size_t worker) {
+    tuneCurrentThread(thread_tuning_.detection_priority, thread_tuning_.detection_cpus,
+                      "object worker " + std::to_string(worker));
+    auto& detector = *object_detectors_[worker];
+    auto& scheduler = *inference_schedulers_[worker];
+    auto& latency = latency_metrics_.registerThread();
+    GroundProjector ground_projector;
 
-    // Load camera calibration if available
-    if (camera_calibration_->load("calibration.yml")) {
-        std::cout << "Camera calibration loaded" << std::endl;
-        const auto& calib = camera_calibration_->getCalibration();
-        coordinate_transform_->setCalibration(calib.camera_matrix, calib.dist_coeffs);
-    } else {
-        std::cout << "No calibration file found - pose estimation will be less accurate" << std::endl;
-    }
+    while (running_.load()) {
+        if (!scheduler.collect(object_queue_, kStagePollTimeout)) {
+            continue;
+        }
 
-    // Load YOLO model
-    std::cout << "Loading YOLO model..." << std::endl;
-    if (!object_detector_->loadModel("yolov8n.onnx")) {
-        std::cerr << "Warning: Failed to load YOLO model - object detection disabled" << std::endl;
-    }
+        // One forward pass for the whole batch; stage latency is per pass
+        const float conf_threshold = object_tracking_ ? object_tracker_config_.low_threshold
+                                                      : kObjectConfidenceThreshold;
+        auto& results = scheduler.run(conf_threshold, kObjectNmsThreshold);
+        const auto& timings = detector.getLastTimings();
+        const auto processing_time = timings.preprocess + timings.inference + timings.postprocess;
+        latency.record(PipelineStage::YoloPreprocess, timings.preprocess);
+        latency.record(PipelineStage::YoloInference, timings.inference);
+        latency.record(PipelineStage::YoloPostprocess, timings.postprocess);
+        object_batches_run_++;
+        object_frames_batched_ += results.size();
 
-    // Load class names
-    if (!object_detector_->loadClassNames("coco.names")) {
-        std::cerr << "Warning: Failed to load class names" << std::endl;
-    }
+        for (auto& result : results) {
+            auto& camera = *cameras_[result.frame->camera_index];
 
-    // Initialize Zenoh
-    if (!initializeZenoh()) {
-        std::cerr << "Warning: Zenoh initialization failed - pub/sub disabled" << std::endl;
-    }
+            // World positions first, so the tracker can derive velocities
+            const auto projection_start = Clock::now();
+            ground_projector.apply(camera, result.objects);
+            latency.record(PipelineStage::GroundProjection, Clock::now() - projection_start);
 
-    // Start processing loop
-    running_.store(true);
-    processing_thread_ = std::thread(&VisionService::processingLoop, this);
+            if (object_tracking_) {
+                const auto track_start = Clock::now();
+                std::lock_guard<std::mutex> lock(camera.track_mutex);
+                // Another worker already applied a newer frame of this camera;
+                // publishing untracked boxes would break the ID sequence
+                const bool applied = camera.tracker.update(result.objects, result.frame->capture_time);
+                latency.record(PipelineStage::Tracking, Clock::now() - track_start);
+                if (!applied) {
+                    continue;
+                }
+            }
 
-    std::cout << "Vision service started successfully" << std::endl;
-    return true;
-}
+            // Copied into the batch's kept storage, so the detector's vector
+            // is freed on this worker rather than on the publish thread
+            auto batch = batch_pool_->acquire(DetectionBatch::Kind::Objects);
+            batch->frame = std::move(result.frame);
+            batch->objects.assign(result.objects.begin(), result.objects.end());
+            batch->processing_time = processing_time;
+            total_objects_detected_ += batch->objects.size();
 
-void VisionService::stop() {
-    if (!running_.load()) {
-        return;
+            publish_queue_.push(std::move(batch));
+        }
     }
+}
 
-    std::cout << "Stopping Vision service..." << std::endl;
-    running_.store(false);
+#endif
 
-    if (processing_thread_.joinable()) {
-        processing_thread_.join();
+bool VisionService::predictObjects(CameraContext& camera, const FramePtr& frame,
+                                   LatencyMetrics::ThreadRecorder& latency) {
+    if (!object_tracking_ || object_detect_interval_ <= 1) {
+        return false;
     }
 
-    if (camera_.isOpened()) {
-        camera_.release();
+    const auto predict_start = Clock::now();
+    auto batch = batch_pool_->acquire(DetectionBatch::Kind::Objects);
+    {
+        std::lock_guard<std::mutex> lock(camera.track_mutex);
+        if (++camera.frames_since_detection >= object_detect_interval_ ||
+            camera.tracker.needsDetection(frame->capture_time, object_track_min_confidence_)) {
+            camera.frames_since_detection = 0;
+            return false;
+        }
+        camera.tracker.predict(frame->capture_time, batch->objects);
     }
 
-    std::cout << "Vision service stopped" << std::endl;
-}
+    // Extrapolated boxes may run past the image border
+    const cv::Rect image_bounds(0, 0, frame->image.cols, frame->image.rows);
+    for (auto& obj : batch->objects) {
+        obj.bbox &= image_bounds;
+    }
 
-void VisionService::processingLoop() {
-    const auto frame_duration = std::chrono::milliseconds(1000 / target_fps_);
+    batch->frame = frame;
+    batch->processing_time = Clock::now() - predict_start;
+    latency.record(PipelineStage::Tracking, batch->processing_time);
+    object_frames_predicted_++;
 
-    while (running_.load()) {
-        auto start_time = std::chrono::steady_clock::now();
+    publish_queue_.push(std::move(batch));
+    return true;
+}
 
-        cv::Mat frame;
-        camera_ >> frame;
+void VisionService::publishLoop() {
+    uint32_t last_status_frame = total_frames_processed_.load();
+    auto& latency = latency_metrics_.registerThread();
 
-        if (frame.empty()) {
-            std::cerr << "Failed to read frame from camera" << std::endl;
-            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    // Keep draining after running_ is cleared so results already computed are
+    // still published; pop() returns nullopt once the queue is closed and empty.
+    while (running_.load() || publish_queue_.size() > 0) {
+        auto batch = publish_queue_.pop(kStagePollTimeout);
+        if (!batch) {
             continue;
         }
 
-        frame_count_++;
-        total_frames_processed_++;
+        const auto publish_start = Clock::now();
+        if ((*batch)->kind == DetectionBatch::Kind::AprilTags) {
+            publishAprilTags(**batch);
+            // Every frame passes through the AprilTag worker exactly once
+            if (publish_frames_) {
+                publishFrame(*(*batch)->frame);
+            }
+        } else {
+            publishObjects(**batch);
+        }
+        const auto publish_end = Clock::now();
+        latency.record(PipelineStage::Publish, publish_end - publish_start);
+        latency.record(PipelineStage::EndToEnd, publish_end - (*batch)->frame->received_time);
+        cameras_[(*batch)->frame->camera_index]->scheduler.recordResult(
+            (*batch)->kind == DetectionBatch::Kind::AprilTags ? FrameScheduler::ResultKind::AprilTags
+                                                               : FrameScheduler::ResultKind::Objects,
+            (*batch)->frame->received_time, publish_end);
 
-        // Detect AprilTags
-        cv::Mat camera_matrix, dist_coeffs;
-        if (camera_calibration_->isValid()) {
-            const auto& calib = camera_calibration_->getCalibration();
-            camera_matrix = calib.camera_matrix;
-            dist_coeffs = calib.dist_coeffs;
+        // Publish status periodically, counting frames from all cameras
+        const uint32_t frames = total_frames_processed_.load();
+        if (frames >= last_status_frame + kStatusIntervalFrames) {
+            last_status_frame = frames;
+            publishStatus();
         }
+    }
+}
+
+bool VisionService::initializeZenoh() {
+    return zenoh_->open(zenoh_config_, zenoh_shared_memory_);
+}
 
-        auto tags = apriltag_detector_->detect(frame, camera_matrix, dist_coeffs, apriltag_size_);
-        total_tags_detected_ += tags.size();
+void VisionService::publishAprilTags(const DetectionBatch& batch) {
+    const auto& tags = batch.tags;
 
+    if (!zenoh_->isOpen()) {
+        // No subscribers reachable; keep detections visible on stdout
         if (!tags.empty()) {
             std::cout << "Detected " << tags.size() << " AprilTags" << std::endl;
             for (const auto& tag : tags) {
@@ -136,60 +1451,860 @@ void VisionService::processingLoop() {
                 }
             }
         }
+        if (batch.camera_pose.valid) {
+            const auto& position = batch.camera_pose.position;
+            std::cout << "  Camera at (" << position[0] << ", " << position[1] << ", " << position[2]
+                      << ") from " << batch.camera_pose.tags_used << " mapped tags" << std::endl;
+        }
+        return;
+    }
+
+    // Responses have no camera field; the source travels as an attachment
+    auto& attachment = messages_->attachment;
+    attachment = "camera_id=" + std::to_string(cameras_[batch.frame->camera_index]->config.camera_id);
 
-        // Detect objects with YOLO
-        auto objects = object_detector_->detect(frame, 0.5f, 0.4f);
-        total_objects_detected_ += objects.size();
+    auto& response = messages_->apriltags;
+    fillAprilTagResponse(batch, apriltag_family_, response);
 
+    // Serialized once: the topic, the update and requests share the bytes
+    CameraContext& camera = *cameras_[batch.frame->camera_index];
+    const auto snapshot = publishLatest(camera.latest_apriltags, batch.frame->frame_id,
+                                        camera.config.camera_id, response);
+    zenoh_->publishSerialized(VisionTopic::AprilTags, snapshotBytes(snapshot), attachment);
+
+    auto& header = messages_->update_header;
+    header.set_frame_id(response.frame_id());
+    *header.mutable_timestamp() = response.timestamp();
+    auto update = encodeUpdate(header, VisionUpdate::kApriltagDataFieldNumber, snapshot->bytes);
+    zenoh_->publishSerialized(VisionTopic::Updates, update, attachment);
+    forwardToStreams(batch, update);
+
+    publishCameraPose(batch);
+}
+
+void VisionService::publishCameraPose(const DetectionBatch& batch) {
+    const CameraPoseEstimate& estimate = batch.camera_pose;
+    if (!estimate.valid) {
+        return;
+    }
+
+    CameraExtrinsics& pose = messages_->camera_pose;
+    pose.Clear();
+    auto* elements = pose.mutable_rotation()->mutable_elements();
+    for (int i = 0; i < 9; i++) {
+        elements->Add(estimate.rotation.val[i]);
+    }
+    pose.mutable_translation()->set_x(estimate.position[0]);
+    pose.mutable_translation()->set_y(estimate.position[1]);
+    pose.mutable_translation()->set_z(estimate.position[2]);
+
+    // Same camera_id attachment as the AprilTag response of this frame
+    zenoh_->publish(VisionTopic::CameraPose, pose, messages_->attachment);
+}
+
+void VisionService::publishObjects(const DetectionBatch& batch) {
+    const auto& objects = batch.objects;
+
+    if (!zenoh_->isOpen()) {
         if (!objects.empty()) {
             std::cout << "Detected " << objects.size() << " objects" << std::endl;
             for (const auto& obj : objects) {
-                std::cout << "  " << obj.class_name << " ("
+                std::cout << "  #" << obj.object_id << " " << obj.className() << " ("
                           << obj.confidence << ") at ("
                           << obj.center.x << ", " << obj.center.y << ")" << std::endl;
+                if (obj.has_3d) {
+                    std::cout << "    On floor at (" << obj.world_position.x << ", " << obj.world_position.y
+                              << "), " << obj.distance_meters << " m away" << std::endl;
+                }
             }
         }
+        return;
+    }
 
-        // Publish updates (if Zenoh is available)
-        // TODO: Implement Zenoh publishing
+    auto& attachment = messages_->attachment;
+    attachment = "camera_id=" + std::to_string(cameras_[batch.frame->camera_index]->config.camera_id);
 
-        // Publish status periodically
-        if (frame_count_ % 100 == 0) {
-            publishStatus();
+    auto& response = messages_->objects;
+    fillObjectResponse(batch, response);
+
+    CameraContext& camera = *cameras_[batch.frame->camera_index];
+    const auto snapshot = publishLatest(camera.latest_objects, batch.frame->frame_id,
+                                        camera.config.camera_id, response);
+    zenoh_->publishSerialized(VisionTopic::Objects, snapshotBytes(snapshot), attachment);
+
+    auto& header = messages_->update_header;
+    header.set_frame_id(response.frame_id());
+    *header.mutable_timestamp() = response.timestamp();
+    auto update = encodeUpdate(header, VisionUpdate::kObjectDataFieldNumber, snapshot->bytes);
+    zenoh_->publishSerialized(VisionTopic::Updates, update, attachment);
+    forwardToStreams(batch, update);
+}
+
+void VisionService::forwardToStreams(const DetectionBatch& batch, const std::shared_ptr<const std::string>& update) {
+    const size_t rate_count = stream_rates_->count.load(std::memory_order_acquire);
+    if (rate_count == 0) {
+        return;
+    }
+
+    // Half a frame of slack keeps capture jitter from skipping a due frame
+    const auto slack = std::chrono::milliseconds(500 / std::max(1, target_fps_));
+    const auto capture_time = batch.frame->capture_time;
+    const size_t kind = batch.kind == DetectionBatch::Kind::AprilTags ? 0 : 1;
+    const uint32_t kind_bit = kind == 0 ? kStreamAprilTags : kStreamObjects;
+    const uint32_t camera_id = cameras_[batch.frame->camera_index]->config.camera_id;
+
+    for (size_t i = 0; i < rate_count; i++) {
+        const auto& rate = stream_rates_->rates[i];
+        if ((rate.kinds & kind_bit) == 0 ||
+            (rate.camera_id != CAMERA_SOURCE_UNSPECIFIED && rate.camera_id != camera_id)) {
+            continue;
+        }
+        auto& next_due = stream_rates_->next_due[i];
+        next_due.resize(cameras_.size());
+
+        auto& due = next_due[batch.frame->camera_index][kind];
+        if (capture_time + slack < due) {
+            continue;
+        }
+        // Stay on the rate's grid unless more than a period behind
+        due = (capture_time - due > rate.period) ? capture_time + rate.period : due + rate.period;
+        zenoh_->publishTo(rate.key, update, messages_->attachment);
+    }
+}
+
+void VisionService::publishFrame(const Frame& frame) {
+    if (!zenoh_->isOpen() || !frame.image.isContinuous()) {
+        return;
+    }
+
+    // Raw BGR8 pixels, copied once into the (shared-memory) payload; the
+    // encoding tells subscribers the layout without a protobuf wrapper
+    auto& encoding = messages_->frame_encoding;
+    encoding = "image/x-bgr8;";
+    encoding += std::to_string(frame.image.cols) + "x" + std::to_string(frame.image.rows);
+    encoding += ";frame_id=" + std::to_string(frame.frame_id);
+    encoding += ";camera_id=" + std::to_string(cameras_[frame.camera_index]->config.camera_id);
+
+    zenoh_->publishRaw(VisionTopic::Frames, frame.image.data,
+                       frame.image.total() * frame.image.elemSize(), encoding);
+}
+
+void VisionService::publishStatus() {
+    const size_t apriltag_depth = apriltag_queue_.size();
+    const size_t object_depth = object_queue_.size();
+    const size_t publish_depth = publish_queue_.size();
+
+    // Real capture rate since the previous status report
+    const auto now = Clock::now();
+    const uint32_t frames = total_frames_processed_.load();
+    const double elapsed_s = std::chrono::duration<double>(now - last_status_time_).count();
+    const double fps = elapsed_s > 0.0 ? (frames - last_status_frames_) / elapsed_s : 0.0;
+    last_status_time_ = now;
+    last_status_frames_ = frames;
+
+    const LatencySnapshot end_to_end = latency_metrics_.snapshot(PipelineStage::EndToEnd);
+
+    StatusResponse& status = messages_->status;
+    status.Clear();
+
+    auto* component = status.mutable_component();
+    component->set_component_id("vision");
+    component->set_type(common::COMPONENT_TYPE_VISION);
+    component->set_status(common::COMPONENT_STATUS_READY);
+    setTimestamp(component->mutable_timestamp(), now);
+
+    VisionMetrics& metrics = *status.mutable_metrics();
+    metrics.set_frames_processed(frames);
+    metrics.set_average_fps(static_cast<float>(fps));
+    metrics.set_average_latency_ms(static_cast<float>(end_to_end.meanMs()));
+    metrics.set_tags_detected(total_tags_detected_.load());
+    metrics.set_objects_detected(total_objects_detected_.load());
+    metrics.set_processing_queue_size(static_cast<uint32_t>(apriltag_depth + object_depth + publish_depth));
+
+    for (auto& camera : cameras_) {
+        const uint64_t captured = camera->frames_captured.load();
+        camera->current_fps = elapsed_s > 0.0
+            ? static_cast<float>((captured - camera->last_status_frames) / elapsed_s) : 0.0f;
+        camera->last_status_frames = captured;
+
+        CameraStatus* camera_status = status.add_cameras();
+        camera_status->set_camera_id(static_cast<CameraSource>(camera->config.camera_id));
+        camera_status->set_connected(camera->connected);
+        camera_status->set_width(static_cast<uint32_t>(camera->frame_size.width));
+        camera_status->set_height(static_cast<uint32_t>(camera->frame_size.height));
+        camera_status->set_current_fps(camera->current_fps);
+        camera_status->set_error_message(camera->error_message);
+    }
+
+    zenoh_->publishSerialized(VisionTopic::Status, snapshotBytes(publishLatest(latest_status_, 0, 0, status)));
+
+    std::cout << "Vision Status:" << std::endl;
+    std::cout << "  Frames processed: " << metrics.frames_processed() << std::endl;
+    std::cout << "  Tags detected: " << metrics.tags_detected() << std::endl;
+    std::cout << "  Objects detected: " << metrics.objects_detected() << std::endl;
+    std::cout << "  Average FPS: " << metrics.average_fps() << std::endl;
+    std::cout << "  Latency (p50/p95/p99 ms):" << std::endl;
+    for (size_t i = 0; i < kPipelineStageCount; i++) {
+        const auto stage = static_cast<PipelineStage>(i);
+        const LatencySnapshot snapshot = latency_metrics_.snapshot(stage);
+        if (snapshot.count == 0) {
+            continue;
         }
+        std::cout << "    " << pipelineStageName(stage) << ": "
+                  << snapshot.percentileMs(0.5) << " / "
+                  << snapshot.percentileMs(0.95) << " / "
+                  << snapshot.percentileMs(0.99) << std::endl;
+    }
+    std::cout << "  Queue depth: " << metrics.processing_queue_size()
+              << " (apriltag " << apriltag_depth << ", objects " << object_depth
+              << ", publish " << publish_depth << ")" << std::endl;
+    std::cout << "  Dropped frames: publish " << publish_queue_.droppedCount() << std::endl;
 
-        // Control frame rate
-        auto end_time = std::chrono::steady_clock::now();
-        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
-        auto sleep_time = frame_duration - elapsed;
+    const MemoryFootprint footprint = MemoryFootprint::sample();
+    const PipelineMemory pipeline = pipelineMemory(cameras_);
+    std::cout << "  Memory: RSS " << megabytes(footprint.rss_bytes) << " MB"
+              << ", peak " << megabytes(footprint.peak_rss_bytes) << " MB"
+              << ", heap " << megabytes(footprint.heap_used_bytes) << " MB used / "
+              << megabytes(footprint.heap_free_bytes) << " MB free";
+    if (memory_budget_ > 0) {
+        std::cout << ", budget " << megabytes(memory_budget_) << " MB";
+    }
+    std::cout << std::endl;
+    std::cout << "    frame pools " << megabytes(pipeline.frame_pools) << " MB"
+              << ", undistortion tables " << megabytes(pipeline.undistortion_tables) << " MB"
+              << ", result batches " << batch_pool_->available() << " kept ("
+              << megabytes(batch_pool_->bytes()) << " MB)" << std::endl;
+    if (memory_budget_ > 0) {
+        if (footprint.rss_bytes > memory_budget_) {
+            std::cerr << "Warning: Resident set of " << megabytes(footprint.rss_bytes)
+                      << " MB exceeds the memory budget of " << megabytes(memory_budget_) << " MB" << std::endl;
+        }
+        releaseFreeHeap();
+    }
+    if (result_cache_hits_.load() > 0) {
+        std::cout << "  Cached results served: " << result_cache_hits_.load()
+                  << ", filtered copies shared " << result_cache_coalesced_.load() << std::endl;
+    }
+    if (object_max_batch_ > 1) {
+        const uint64_t batches = object_batches_run_.load();
+        std::cout << "  YOLO batches: " << batches << ", average size "
+                  << (batches > 0 ? static_cast<double>(object_frames_batched_.load()) / batches : 0.0)
+                  << std::endl;
+    }
+    for (const auto& camera : cameras_) {
+        std::cout << "  Camera " << camera->config.device_index
+                  << " (source " << camera->config.camera_id << "): "
+                  << (camera->connected ? "connected" : "disconnected")
+                  << ", " << camera->current_fps << " FPS"
+                  << ", dropped apriltag " << apriltag_queue_.droppedCount(camera->index)
+                  << ", objects " << object_queue_.droppedCount(camera->index)
+                  << ", pool exhausted " << camera->pool_exhausted_drops.load()
+                  << ", stale apriltag " << camera->apriltag_stale_drops.load()
+                  << ", shed frames " << camera->scheduler.framesShed()
+                  << ", shed YOLO " << camera->scheduler.objectFramesShed();
 
-        if (sleep_time.count() > 0) {
-            std::this_thread::sleep_for(sleep_time);
+        // Miss rate over this status interval
+        for (const auto kind : {FrameScheduler::ResultKind::AprilTags, FrameScheduler::ResultKind::Objects}) {
+            const auto total = camera->scheduler.deadlineStats(kind);
+            auto& last = camera->last_status_deadlines[static_cast<size_t>(kind)];
+            const FrameScheduler::DeadlineStats interval{total.met - last.met, total.missed - last.missed};
+            last = total;
+            if (interval.met + interval.missed > 0) {
+                std::cout << ", " << (kind == FrameScheduler::ResultKind::AprilTags ? "apriltag" : "objects")
+                          << " deadline misses " << interval.missRate() * 100.0 << "%";
+            }
+        }
+        if (!camera->error_message.empty()) {
+            std::cout << " (" << camera->error_message << ")";
+        }
+        std::cout << std::endl;
+    }
+    for (size_t i = 0; i < apriltag_worker_count_; i++) {
+        const auto& detector = *apriltag_detectors_[i];
+        std::cout << "  AprilTag worker " << i << ": scans full " << detector.getFullScanCount()
+                  << ", tracked ROI " << detector.getRoiScanCount()
+                  << ", rejected " << detector.getRejectedCount() << std::endl;
+        if (apriltag_adaptive_) {
+            const auto controller = detector.getControllerState();
+            std::cout << "    tuning: decimate " << controller.tuning.quad_decimate
+                      << " (max " << controller.max_decimate << ")"
+                      << ", threads " << controller.tuning.nthreads
+                      << ", refine " << (controller.tuning.refine_edges ? "on" : "off")
+                      << ", latency " << controller.latency_ms << "/" << controller.budget_ms << " ms"
+                      << ", smallest tag " << controller.smallest_tag_px << " px"
+                      << ", misses " << controller.deadline_misses
+                      << ", adjustments " << controller.adjustments << std::endl;
         }
     }
 }
 
-bool VisionService::initializeZenoh() {
-    // TODO: Initialize Zenoh session
-    // This requires zenoh-cpp library
-    std::cout << "Zenoh initialization not yet implemented" << std::endl;
-    return false;
+CameraContext* VisionService::findCamera(uint32_t camera_id) const {
+    if (cameras_.empty()) {
+        return nullptr;
+    }
+    if (camera_id == CAMERA_SOURCE_UNSPECIFIED) {
+        return cameras_.front().get();
+    }
+    for (const auto& camera : cameras_) {
+        if (camera->config.camera_id == camera_id) {
+            return camera.get();
+        }
+    }
+    return nullptr;
 }
 
-void VisionService::publishAprilTags() {
-    // TODO: Publish AprilTag detections via Zenoh
+void VisionService::declareQueryables() {
+    size_t declared = 0;
+    for (size_t i = 0; i < static_cast<size_t>(VisionRpc::Count); i++) {
+        const auto rpc = static_cast<VisionRpc>(i);
+        if (zenoh_->declareQueryable(visionRpcKey(rpc), [this, rpc](std::unique_ptr<ZenohQuery> query) {
+                handleQuery(rpc, std::move(query));
+            })) {
+            declared++;
+        }
+    }
+    std::cout << "Serving " << declared << " request types on robot/vision/rpc/* with "
+              << request_worker_count_ << " request worker(s)" << std::endl;
 }
 
-void VisionService::publishObjects() {
-    // TODO: Publish object detections via Zenoh
+void VisionService::handleQuery(VisionRpc rpc, std::unique_ptr<ZenohQuery> query) {
+    const auto& payload = query->payload();
+    const int payload_size = static_cast<int>(payload.size());
+
+    switch (rpc) {
+        case VisionRpc::DetectAprilTags: {
+            auto request = std::make_shared<RpcRequest>();
+            request->rpc = rpc;
+            if (!request->apriltags.ParseFromArray(payload.data(), payload_size)) {
+                query->replyError("malformed AprilTagRequest");
+                return;
+            }
+            if (!request->apriltags.image_data().empty()) {
+                request->query = std::move(query);
+                request_queue_.push(std::move(request));
+                return;
+            }
+
+            // Live camera: the latest published result, already serialized
+            CameraContext* camera = findCamera(request->apriltags.camera_id());
+            auto latest = camera ? camera->latest_apriltags.load() : nullptr;
+            if (!latest) {
+                AprilTagResponse response;
+                setStatus(response.mutable_status(), false, camera ? "no live result yet" : "unknown camera");
+                query->reply(response);
+                return;
+            }
+            result_cache_hits_++;
+            query->replyBytes(snapshotBytes(latest), snapshotAttachment(*latest));
+            return;
+        }
+
+        case VisionRpc::DetectObjects: {
+            auto request = std::make_shared<RpcRequest>();
+            request->rpc = rpc;
+            if (!request->objects.ParseFromArray(payload.data(), payload_size)) {
+                query->replyError("malformed ObjectDetectionRequest");
+                return;
+            }
+            if (!request->objects.image_data().empty()) {
+                request->query = std::move(query);
+                request_queue_.push(std::move(request));
+                return;
+            }
+
+            CameraContext* camera = findCamera(request->objects.camera_id());
+            auto latest = camera ? camera->latest_objects.load() : nullptr;
+            if (!latest) {
+                ObjectDetectionResponse response;
+                setStatus(response.mutable_status(), false, camera ? "no live result yet" : "unknown camera");
+                query->reply(response);
+                return;
+            }
+            result_cache_hits_++;
+            if (request->objects.filter_classes_size() == 0 && request->objects.confidence_threshold() <= 0.0f) {
+                query->replyBytes(snapshotBytes(latest), snapshotAttachment(*latest));
+                return;
+            }
+
+            // A filtered copy is built once per frame and filter, so clients
+            // polling with the same filter share one encoding
+            bool coalesced = false;
+            auto filtered = latest->derived(filterKey(request->objects), [&](std::string& out) {
+                ObjectDetectionResponse response;
+                response.ParseFromString(latest->bytes);
+                auto* objects = response.mutable_objects();
+                int kept = 0;
+                for (int i = 0; i < objects->size(); i++) {
+                    if (keepObject(request->objects, objects->Get(i).class_name(), objects->Get(i).confidence())) {
+                        objects->SwapElements(i, kept++);
+                    }
+                }
+                objects->DeleteSubrange(kept, objects->size() - kept);
+                response.SerializeToString(&out);
+            }, &coalesced);
+            if (coalesced) {
+                result_cache_coalesced_++;
+            }
+            query->replyBytes(std::move(filtered), snapshotAttachment(*latest));
+            return;
+        }
+
+        case VisionRpc::GetCameraCalibration: {
+            CalibrationRequest request;
+            if (!request.ParseFromArray(payload.data(), payload_size)) {
+                query->replyError("malformed CalibrationRequest");
+                return;
+            }
+
+            CalibrationResponse response;
+            CameraContext* camera = findCamera(request.camera_id());
+            if (!camera) {
+                setStatus(response.mutable_status(), false, "unknown camera");
+            } else if (!camera->calibration.isValid()) {
+                setStatus(response.mutable_status(), false, "camera not calibrated");
+            } else {
+                // Calibration is read-only once capture runs
+                const auto& calib = camera->calibration.getCalibration();
+                cv::Mat K, dist;
+                calib.camera_matrix.convertTo(K, CV_64F);
+                calib.dist_coeffs.convertTo(dist, CV_64F);
+                dist = dist.reshape(1, 1);
+
+                auto* intrinsics = response.mutable_intrinsics();
+                intrinsics->set_fx(K.at<double>(0, 0));
+                intrinsics->set_fy(K.at<double>(1, 1));
+                intrinsics->set_cx(K.at<double>(0, 2));
+                intrinsics->set_cy(K.at<double>(1, 2));
+                intrinsics->set_image_width(static_cast<uint32_t>(camera->frame_size.width));
+                intrinsics->set_image_height(static_cast<uint32_t>(camera->frame_size.height));
+
+                // OpenCV order: k1, k2, p1, p2[, k3[, k4, k5, k6]]
+                auto* distortion = response.mutable_distortion();
+                for (int i = 0; i < dist.cols; i++) {
+                    if (i == 2 || i == 3) {
+                        distortion->add_tangential(dist.at<double>(0, i));
+                    } else if (i < 8) {
+                        distortion->add_radial(dist.at<double>(0, i));
+                    }
+                }
+
+                CoordinateTransform transform;
+                {
+                    std::lock_guard<std::mutex> lock(camera->pose_mutex);
+                    transform = camera->transform;
+                }
+                if (transform.hasPose()) {
+                    auto* extrinsics = response.mutable_extrinsics();
+                    auto* elements = extrinsics->mutable_rotation()->mutable_elements();
+                    for (int i = 0; i < 9; i++) {
+                        elements->Add(transform.getRotation().val[i]);
+                    }
+                    const cv::Point3d position = transform.getCameraPosition();
+                    extrinsics->mutable_translation()->set_x(position.x);
+                    extrinsics->mutable_translation()->set_y(position.y);
+                    extrinsics->mutable_translation()->set_z(position.z);
+                }
+                setStatus(response.mutable_status(), true);
+            }
+            query->reply(response);
+            return;
+        }
+
+        case VisionRpc::StreamVisionData: {
+            VisionStreamRequest request;
+            if (!request.ParseFromArray(payload.data(), payload_size)) {
+                query->replyError("malformed VisionStreamRequest");
+                return;
+            }
+
+            // No data types means every result kind; raw images and depth
+            // are not carried by VisionUpdate
+            uint32_t kinds = 0;
+            for (const int type : request.data_types()) {
+                if (type == VISION_DATA_TYPE_APRILTAGS) {
+                    kinds |= kStreamAprilTags;
+                } else if (type == VISION_DATA_TYPE_OBJECTS) {
+                    kinds |= kStreamObjects;
+                } else if (type != VISION_DATA_TYPE_UNSPECIFIED) {
+                    query->replyError("unsupported data type " + std::to_string(type) +
+                                      ": streams carry AprilTags and objects only");
+                    return;
+                }
+            }
+            if (kinds == 0) {
+                kinds = kStreamAllKinds;
+            }
+            if (request.camera_id() != CAMERA_SOURCE_UNSPECIFIED && !findCamera(request.camera_id())) {
+                query->replyError("unknown camera");
+                return;
+            }
+
+            // Each distinct (camera, data types, rate) is one decimated stream
+            // shared by all its subscribers; the reply names the key to subscribe to
+            const int fps = std::clamp(request.fps() > 0 ? static_cast<int>(request.fps()) : target_fps_,
+                                       1, std::max(1, target_fps_));
+            const auto* rate = stream_rates_->add(fps, request.camera_id(), kinds);
+            if (!rate) {
+                query->replyError("too many streams");
+                return;
+            }
+            VisionUpdate update;
+            query->reply(update, "stream=" + rate->key + ";fps=" + std::to_string(rate->fps));
+            return;
+        }
+
+        case VisionRpc::TransformCoordinates: {
+            CoordinateTransformRequest request;
+            if (!request.ParseFromArray(payload.data(), payload_size)) {
+                query->replyError("malformed CoordinateTransformRequest");
+                return;
+            }
+
+            CoordinateTransformResponse response;
+            CameraContext* camera = findCamera(request.camera_id());
+            const auto source = request.source_frame() == COORDINATE_FRAME_UNSPECIFIED
+                ? COORDINATE_FRAME_CAMERA : request.source_frame();
+            const auto target = request.target_frame() == COORDINATE_FRAME_UNSPECIFIED
+                ? COORDINATE_FRAME_WORLD : request.target_frame();
+            if (!camera) {
+                setStatus(response.mutable_status(), false, "unknown camera");
+            } else if (source == COORDINATE_FRAME_ROBOT || target == COORDINATE_FRAME_ROBOT) {
+                setStatus(response.mutable_status(), false, "robot frame not available");
+            } else {
+                CoordinateTransform transform;
+                {
+                    std::lock_guard<std::mutex> lock(camera->pose_mutex);
+                    transform = camera->transform;
+                }
+                for (const auto& point : request.points()) {
+                    cv::Point3d mapped(point.x(), point.y(), point.z());
+                    if (source == COORDINATE_FRAME_CAMERA && target == COORDINATE_FRAME_WORLD) {
+                        mapped = transform.cameraToWorld(mapped);
+                    } else if (source == COORDINATE_FRAME_WORLD && target == COORDINATE_FRAME_CAMERA) {
+                        mapped = transform.worldToCamera(mapped);
+                    }
+                    auto* out = response.add_transformed_points();
+                    out->set_x(mapped.x);
+                    out->set_y(mapped.y);
+                    out->set_z(mapped.z);
+                }
+                setStatus(response.mutable_status(), true, transform.hasPose() ? "" : "camera pose unknown");
+            }
+            query->reply(response);
+            return;
+        }
+
+        case VisionRpc::GetComponentStatus: {
+            if (auto latest = latest_status_.load()) {
+                query->replyBytes(snapshotBytes(latest));
+                return;
+            }
+
+            // Before the first status interval
+            StatusResponse status;
+            auto* component = status.mutable_component();
+            component->set_component_id("vision");
+            component->set_type(common::COMPONENT_TYPE_VISION);
+            component->set_status(common::COMPONENT_STATUS_INITIALIZING);
+            setTimestamp(component->mutable_timestamp(), Clock::now());
+            query->reply(status);
+            return;
+        }
+
+        case VisionRpc::Count:
+            break;
+    }
+    query->replyError("unknown request");
 }
 
-void VisionService::publishStatus() {
-    std::cout << "Vision Status:" << std::endl;
-    std::cout << "  Frames processed: " << total_frames_processed_ << std::endl;
-    std::cout << "  Tags detected: " << total_tags_detected_ << std::endl;
-    std::cout << "  Objects detected: " << total_objects_detected_ << std::endl;
-    std::cout << "  Average FPS: " << (total_frames_processed_ / (frame_count_ / static_cast<float>(target_fps_))) << std::endl;
+void VisionService::requestLoop(size_t worker) {
+    auto& state = *request_workers_[worker];
+
+    // Queued requests are answered even while stopping; pop() returns
+    // nullopt once the queue is closed and drained
+    while (true) {
+        auto request = request_queue_.pop(kStagePollTimeout);
+        if (!request) {
+            if (!running_.load() && request_queue_.size() == 0) {
+                break;
+            }
+            continue;
+        }
+
+        if ((*request)->rpc == VisionRpc::DetectAprilTags) {
+            detectAprilTags(**request, state);
+        } else {
+            detectObjects(**request, state);
+        }
+    }
+}
+
+void VisionService::detectAprilTags(RpcRequest& request, RequestWorker& worker) {
+    const auto start_time = Clock::now();
+    AprilTagResponse response;
+    CameraContext* camera = findCamera(request.apriltags.camera_id());
+    if (!camera) {
+        setStatus(response.mutable_status(), false, "unknown camera");
+        request.query->reply(response);
+        return;
+    }
+
+    auto frame = std::make_shared<Frame>();
+    frame->camera_index = camera->index;
+    frame->capture_time = start_time;
+    frame->received_time = start_time;
+    std::string error;
+    if (!decodeRequestImage(request.apriltags.image_data(), request.apriltags.format(),
+                            request.query->attachment(), camera->frame_size, true, frame->gray, error)) {
+        setStatus(response.mutable_status(), false, error);
+        request.query->reply(response);
+        return;
+    }
+
+    // The camera's intrinsics only apply to images from that camera
+    cv::Mat camera_matrix, dist_coeffs;
+    if (camera->calibration.isValid() && frame->gray.size() == camera->frame_size) {
+        camera_matrix = camera->calibration.getCalibration().camera_matrix;
+        dist_coeffs = camera->calibration.getCalibration().dist_coeffs;
+    }
+
+    DetectionBatch batch;
+    batch.kind = DetectionBatch::Kind::AprilTags;
+    batch.frame = frame;
+    batch.tags = worker.apriltag_detector.detect(frame->gray, camera_matrix, dist_coeffs, apriltag_size_);
+    fillAprilTagResponse(batch, apriltag_family_, response);
+    setStatus(response.mutable_status(), true);
+    request.query->reply(response, "camera_id=" + std::to_string(camera->config.camera_id));
+}
+
+void VisionService::detectObjects(RpcRequest& request, RequestWorker& worker) {
+#ifndef USE_OBJECT_DETECTION
+    (void)worker;
+    ObjectDetectionResponse response;
+    setStatus(response.mutable_status(), false, "object detection not built");
+    request.query->reply(response);
+#else
+    const auto start_time = Clock::now();
+    ObjectDetectionResponse response;
+    CameraContext* camera = findCamera(request.objects.camera_id());
+    if (!camera) {
+        setStatus(response.mutable_status(), false, "unknown camera");
+        request.query->reply(response);
+        return;
+    }
+
+    // A private detector, so requests never contend with the live workers
+    if (!worker.object_detector && !worker.object_detector_failed) {
+        worker.object_detector = std::make_unique<ObjectDetector>();
+        configureObjectDetector(*worker.object_detector);
+        if (worker.object_detector->loadModel("yolov8n.onnx")) {
+            worker.object_detector->loadClassNames("coco.names");
+        } else {
+            worker.object_detector.reset();
+            worker.object_detector_failed = true;
+        }
+    }
+    if (!worker.object_detector) {
+        setStatus(response.mutable_status(), false, "object detection unavailable");
+        request.query->reply(response);
+        return;
+    }
+
+    auto frame = std::make_shared<Frame>();
+    frame->camera_index = camera->index;
+    frame->capture_time = start_time;
+    frame->received_time = start_time;
+    std::string error;
+    if (!decodeRequestImage(request.objects.image_data(), request.objects.format(),
+                            request.query->attachment(), camera->frame_size, false, frame->image, error)) {
+        setStatus(response.mutable_status(), false, error);
+        request.query->reply(response);
+        return;
+    }
+
+    const float threshold = request.objects.confidence_threshold() > 0.0f
+        ? request.objects.confidence_threshold() : kObjectConfidenceThreshold;
+    DetectionBatch batch;
+    batch.kind = DetectionBatch::Kind::Objects;
+    batch.frame = frame;
+    batch.objects = worker.object_detector->detect(frame->image, threshold, kObjectNmsThreshold);
+    std::erase_if(batch.objects, [&](const ObjectResult& obj) {
+        return !keepObject(request.objects, obj.className(), obj.confidence);
+    });
+
+    // Floor positions need the camera's pose, so only for that camera's images
+    if (request.objects.camera_id() != CAMERA_SOURCE_UNSPECIFIED && frame->image.size() == camera->frame_size) {
+        worker.ground_projector.apply(*camera, batch.objects);
+    }
+
+    batch.processing_time = Clock::now() - start_time;
+    fillObjectResponse(batch, response);
+    setStatus(response.mutable_status(), true);
+    request.query->reply(response, "camera_id=" + std::to_string(camera->config.camera_id));
+#endif
+}
+
+bool VisionService::isCaptureFinished() const {
+    if (cameras_.empty()) {
+        return false;
+    }
+    return std::all_of(cameras_.begin(), cameras_.end(),
+                       [](const auto& camera) { return camera->capture_finished.load(); });
+}
+
+ResultSnapshotPtr VisionService::getLatestAprilTags(uint32_t camera_id) const {
+    CameraContext* camera = findCamera(camera_id);
+    return camera ? camera->latest_apriltags.load() : nullptr;
+}
+
+ResultSnapshotPtr VisionService::getLatestObjects(uint32_t camera_id) const {
+    CameraContext* camera = findCamera(camera_id);
+    return camera ? camera->latest_objects.load() : nullptr;
+}
+
+std::string VisionService::renderPrometheusMetrics() const {
+    std::ostringstream out;
+
+    out << "# HELP navign_vision_stage_latency_seconds Per-stage pipeline latency\n"
+        << "# TYPE navign_vision_stage_latency_seconds summary\n";
+    for (size_t i = 0; i < kPipelineStageCount; i++) {
+        const auto stage = static_cast<PipelineStage>(i);
+        const char* name = pipelineStageName(stage);
+        const LatencySnapshot snapshot = latency_metrics_.snapshot(stage);
+
+        for (double quantile : kLatencyQuantiles) {
+            out << "navign_vision_stage_latency_seconds{stage=\"" << name << "\",quantile=\""
+                << quantile << "\"} " << snapshot.percentileMs(quantile) / 1000.0 << "\n";
+        }
+        out << "navign_vision_stage_latency_seconds_sum{stage=\"" << name << "\"} "
+            << snapshot.sum_us / 1e6 << "\n"
+            << "navign_vision_stage_latency_seconds_count{stage=\"" << name << "\"} "
+            << snapshot.count << "\n";
+    }
+
+    out << "# TYPE navign_vision_frames_processed_total counter\n"
+        << "navign_vision_frames_processed_total " << total_frames_processed_.load() << "\n"
+        << "# TYPE navign_vision_tags_detected_total counter\n"
+        << "navign_vision_tags_detected_total " << total_tags_detected_.load() << "\n"
+        << "# TYPE navign_vision_objects_detected_total counter\n"
+        << "navign_vision_objects_detected_total " << total_objects_detected_.load() << "\n";
+
+    out << "# TYPE navign_vision_yolo_batches_total counter\n"
+        << "navign_vision_yolo_batches_total " << object_batches_run_.load() << "\n"
+        << "# TYPE navign_vision_yolo_batched_frames_total counter\n"
+        << "navign_vision_yolo_batched_frames_total " << object_frames_batched_.load() << "\n"
+        << "# TYPE navign_vision_yolo_predicted_frames_total counter\n"
+        << "navign_vision_yolo_predicted_frames_total " << object_frames_predicted_.load() << "\n";
+
+    out << "# TYPE navign_vision_result_cache_hits_total counter\n"
+        << "navign_vision_result_cache_hits_total " << result_cache_hits_.load() << "\n"
+        << "# TYPE navign_vision_result_cache_coalesced_total counter\n"
+        << "navign_vision_result_cache_coalesced_total " << result_cache_coalesced_.load() << "\n";
+
+    out << "# TYPE navign_vision_frames_dropped_total counter\n"
+        << "navign_vision_frames_dropped_total{stage=\"publish\"} " << publish_queue_.droppedCount() << "\n";
+    for (const auto& camera : cameras_) {
+        const std::string label = "camera=\"" + std::to_string(camera->config.camera_id) + "\"";
+        out << "navign_vision_frames_dropped_total{stage=\"apriltag\"," << label << "} "
+            << apriltag_queue_.droppedCount(camera->index) << "\n"
+            << "navign_vision_frames_dropped_total{stage=\"objects\"," << label << "} "
+            << object_queue_.droppedCount(camera->index) << "\n"
+            << "navign_vision_frames_dropped_total{stage=\"pool\"," << label << "} "
+            << camera->pool_exhausted_drops.load() << "\n"
+            << "navign_vision_frames_dropped_total{stage=\"apriltag_stale\"," << label << "} "
+            << camera->apriltag_stale_drops.load() << "\n";
+    }
+
+    out << "# TYPE navign_vision_frames_shed_total counter\n";
+    for (const auto& camera : cameras_) {
+        const std::string label = "camera=\"" + std::to_string(camera->config.camera_id) + "\"";
+        out << "navign_vision_frames_shed_total{stage=\"frame\"," << label << "} "
+            << camera->scheduler.framesShed() << "\n"
+            << "navign_vision_frames_shed_total{stage=\"objects\"," << label << "} "
+            << camera->scheduler.objectFramesShed() << "\n";
+    }
+
+    out << "# HELP navign_vision_deadline_results_total Published results by whether they met their deadline\n"
+        << "# TYPE navign_vision_deadline_results_total counter\n";
+    for (const auto& camera : cameras_) {
+        const std::string label = "camera=\"" + std::to_string(camera->config.camera_id) + "\"";
+        for (const auto kind : {FrameScheduler::ResultKind::AprilTags, FrameScheduler::ResultKind::Objects}) {
+            const auto stats = camera->scheduler.deadlineStats(kind);
+            const char* stage = kind == FrameScheduler::ResultKind::AprilTags ? "apriltag" : "objects";
+            out << "navign_vision_deadline_results_total{stage=\"" << stage << "\"," << label
+                << ",result=\"met\"} " << stats.met << "\n"
+                << "navign_vision_deadline_results_total{stage=\"" << stage << "\"," << label
+                << ",result=\"missed\"} " << stats.missed << "\n";
+        }
+    }
+
+    out << "# TYPE navign_vision_camera_frames_total counter\n";
+    for (const auto& camera : cameras_) {
+        out << "navign_vision_camera_frames_total{camera=\"" << camera->config.camera_id << "\"} "
+            << camera->frames_captured.load() << "\n";
+    }
+
+    if (apriltag_adaptive_) {
+        std::vector<AprilTagControllerState> controllers;
+        for (size_t i = 0; i < apriltag_worker_count_; i++) {
+            controllers.push_back(apriltag_detectors_[i]->getControllerState());
+        }
+
+        out << "# HELP navign_vision_apriltag_tuning Detector parameters chosen by the adaptive controller\n"
+            << "# TYPE navign_vision_apriltag_tuning gauge\n";
+        for (size_t i = 0; i < controllers.size(); i++) {
+            const auto& state = controllers[i];
+            const std::string label = "worker=\"" + std::to_string(i) + "\"";
+            out << "navign_vision_apriltag_tuning{" << label << ",parameter=\"quad_decimate\"} "
+                << state.tuning.quad_decimate << "\n"
+                << "navign_vision_apriltag_tuning{" << label << ",parameter=\"max_decimate\"} "
+                << state.max_decimate << "\n"
+                << "navign_vision_apriltag_tuning{" << label << ",parameter=\"nthreads\"} "
+                << state.tuning.nthreads << "\n"
+                << "navign_vision_apriltag_tuning{" << label << ",parameter=\"refine_edges\"} "
+                << (state.tuning.refine_edges ? 1 : 0) << "\n";
+        }
+
+        out << "# HELP navign_vision_apriltag_controller_ms Smoothed full-scan latency and its budget\n"
+            << "# TYPE navign_vision_apriltag_controller_ms gauge\n";
+        for (size_t i = 0; i < controllers.size(); i++) {
+            const std::string label = "worker=\"" + std::to_string(i) + "\"";
+            out << "navign_vision_apriltag_controller_ms{" << label << ",value=\"latency\"} "
+                << controllers[i].latency_ms << "\n"
+                << "navign_vision_apriltag_controller_ms{" << label << ",value=\"budget\"} "
+                << controllers[i].budget_ms << "\n";
+        }
+
+        out << "# TYPE navign_vision_apriltag_deadline_misses_total counter\n";
+        for (size_t i = 0; i < controllers.size(); i++) {
+            out << "navign_vision_apriltag_deadline_misses_total{worker=\"" << i << "\"} "
+                << controllers[i].deadline_misses << "\n";
+        }
+        out << "# TYPE navign_vision_apriltag_adjustments_total counter\n";
+        for (size_t i = 0; i < controllers.size(); i++) {
+            out << "navign_vision_apriltag_adjustments_total{worker=\"" << i << "\"} "
+                << controllers[i].adjustments << "\n";
+        }
+    }
+
+    const MemoryFootprint footprint = MemoryFootprint::sample();
+    const PipelineMemory pipeline = pipelineMemory(cameras_);
+    out << "# HELP navign_vision_memory_bytes Process footprint and the pipeline's own buffers\n"
+        << "# TYPE navign_vision_memory_bytes gauge\n"
+        << "navign_vision_memory_bytes{kind=\"rss\"} " << footprint.rss_bytes << "\n"
+        << "navign_vision_memory_bytes{kind=\"peak_rss\"} " << footprint.peak_rss_bytes << "\n"
+        << "navign_vision_memory_bytes{kind=\"heap_used\"} " << footprint.heap_used_bytes << "\n"
+        << "navign_vision_memory_bytes{kind=\"heap_free\"} " << footprint.heap_free_bytes << "\n"
+        << "navign_vision_memory_bytes{kind=\"frame_pools\"} " << pipeline.frame_pools << "\n"
+        << "navign_vision_memory_bytes{kind=\"undistortion_tables\"} " << pipeline.undistortion_tables << "\n"
+        << "navign_vision_memory_bytes{kind=\"result_batches\"} " << batch_pool_->bytes() << "\n";
+
+    out << "# TYPE navign_vision_queue_depth gauge\n"
+        << "navign_vision_queue_depth{stage=\"apriltag\"} " << apriltag_queue_.size() << "\n"
+        << "navign_vision_queue_depth{stage=\"objects\"} " << object_queue_.size() << "\n"
+        << "navign_vision_queue_depth{stage=\"publish\"} " << publish_queue_.size() << "\n";
+
+    return out.str();
 }
 
 } // namespace navign::robot::vision
@@ -0,0 +1,238 @@
+#include "yolo_postprocess.hpp"
+#include <opencv2/dnn.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace navign::robot::vision {
+
+namespace {
+
+/**
+ * @brief Per-anchor argmax over class rows
+ *
+ * rows points at class 0; class c starts at rows + c * stride. Ties keep the
+ * lowest class index, matching a scalar "strictly greater" scan.
+ */
+void argmaxRows(
+    const float* rows,
+    size_t stride,
+    int num_classes,
+    int num_anchors,
+    float* best_score,
+    int32_t* best_class
+) {
+    std::memcpy(best_score, rows, sizeof(float) * num_anchors);
+    std::fill(best_class, best_class + num_anchors, 0);
+
+    for (int c = 1; c < num_classes; c++) {
+        const float* row = rows + c * stride;
+        int a = 0;
+
+#if defined(__AVX2__)
+        const __m256 class_vec = _mm256_castsi256_ps(_mm256_set1_epi32(c));
+        for (; a + 8 <= num_anchors; a += 8) {
+            const __m256 score = _mm256_loadu_ps(row + a);
+            const __m256 best = _mm256_loadu_ps(best_score + a);
+            const __m256 mask = _mm256_cmp_ps(score, best, _CMP_GT_OQ);
+            _mm256_storeu_ps(best_score + a, _mm256_blendv_ps(best, score, mask));
+
+            auto* cls_ptr = reinterpret_cast<__m256i*>(best_class + a);
+            const __m256 cls = _mm256_castsi256_ps(_mm256_loadu_si256(cls_ptr));
+            _mm256_storeu_si256(cls_ptr, _mm256_castps_si256(_mm256_blendv_ps(cls, class_vec, mask)));
+        }
+#elif defined(__ARM_NEON)
+        const int32x4_t class_vec = vdupq_n_s32(c);
+        for (; a + 4 <= num_anchors; a += 4) {
+            const float32x4_t score = vld1q_f32(row + a);
+            const float32x4_t best = vld1q_f32(best_score + a);
+            const uint32x4_t mask = vcgtq_f32(score, best);
+            vst1q_f32(best_score + a, vbslq_f32(mask, score, best));
+            vst1q_s32(best_class + a, vbslq_s32(mask, class_vec, vld1q_s32(best_class + a)));
+        }
+#endif
+
+        for (; a < num_anchors; a++) {
+            if (row[a] > best_score[a]) {
+                best_score[a] = row[a];
+                best_class[a] = c;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Call emit(anchor) for every anchor whose best score exceeds threshold
+ *
+ * Almost all anchors fail the threshold, so whole vectors are skipped with a
+ * single compare where SIMD is available.
+ */
+template <typename Emit>
+void forEachAboveThreshold(const float* best_score, int num_anchors, float threshold, Emit&& emit) {
+    int a = 0;
+
+#if defined(__AVX2__)
+    const __m256 thr = _mm256_set1_ps(threshold);
+    for (; a + 8 <= num_anchors; a += 8) {
+        int bits = _mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps(best_score + a), thr, _CMP_GT_OQ));
+        while (bits) {
+            emit(a + __builtin_ctz(bits));
+            bits &= bits - 1;
+        }
+    }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    const float32x4_t thr = vdupq_n_f32(threshold);
+    for (; a + 4 <= num_anchors; a += 4) {
+        if (vmaxvq_u32(vcgtq_f32(vld1q_f32(best_score + a), thr)) == 0) {
+            continue;
+        }
+        for (int lane = 0; lane < 4; lane++) {
+            if (best_score[a + lane] > threshold) {
+                emit(a + lane);
+            }
+        }
+    }
+#endif
+
+    for (; a < num_anchors; a++) {
+        if (best_score[a] > threshold) {
+            emit(a);
+        }
+    }
+}
+
+double iou(const cv::Rect2d& a, const cv::Rect2d& b) {
+    const double inter = (a & b).area();
+    const double uni = a.area() + b.area() - inter;
+    return uni > 0.0 ? inter / uni : 0.0;
+}
+
+} // namespace
+
+size_t YoloPostprocessor::decode(const cv::Mat& output, float conf_threshold) {
+    boxes_.clear();
+    scores_.clear();
+    class_ids_.clear();
+
+    if (output.empty() || output.depth() != CV_32F || !output.isContinuous()) {
+        return 0;
+    }
+
+    // Collapse the batch dimension: [1, A, B] or [A, B]
+    int rows = 0;
+    int cols = 0;
+    if (output.dims == 3) {
+        rows = output.size[1];
+        cols = output.size[2];
+    } else if (output.dims == 2) {
+        rows = output.rows;
+        cols = output.cols;
+    } else {
+        return 0;
+    }
+
+    cv::Mat head(rows, cols, CV_32F, const_cast<uchar*>(output.ptr()));
+
+    // Heads have far fewer channels (4 + C) than anchors, so the longer axis
+    // identifies the layout. Bring [N, 4 + C] into the SoA [4 + C, N] form.
+    cv::Mat soa;
+    if (rows > cols) {
+        cv::transpose(head, transposed_);
+        soa = transposed_;
+    } else {
+        soa = head;
+    }
+
+    const int num_anchors = soa.cols;
+    const int num_classes = soa.rows - 4;
+    if (num_classes <= 0 || num_anchors <= 0) {
+        return 0;
+    }
+
+    best_score_.resize(num_anchors);
+    best_class_.resize(num_anchors);
+    argmaxRows(soa.ptr<float>(4), soa.step1(), num_classes, num_anchors,
+               best_score_.data(), best_class_.data());
+
+    const float* cx = soa.ptr<float>(0);
+    const float* cy = soa.ptr<float>(1);
+    const float* w = soa.ptr<float>(2);
+    const float* h = soa.ptr<float>(3);
+
+    forEachAboveThreshold(best_score_.data(), num_anchors, conf_threshold, [&](int a) {
+        boxes_.emplace_back(cx[a] - w[a] / 2.0f, cy[a] - h[a] / 2.0f, w[a], h[a]);
+        scores_.push_back(best_score_[a]);
+        class_ids_.push_back(best_class_[a]);
+    });
+
+    return boxes_.size();
+}
+
+const std::vector<int>& YoloPostprocessor::suppress(float conf_threshold, float nms_threshold, NmsMode mode) {
+    keep_.clear();
+    if (boxes_.empty()) {
+        return keep_;
+    }
+
+    switch (mode) {
+        case NmsMode::Agnostic:
+            cv::dnn::NMSBoxes(boxes_, scores_, conf_threshold, nms_threshold, keep_);
+            break;
+
+        case NmsMode::Batched: {
+            // Shift each class into its own coordinate range so boxes of
+            // different classes never overlap, then run one NMS pass. Boxes
+            // at the image edge start at negative coordinates, so the range
+            // spans the full extent, not just [0, max]
+            double min_coord = boxes_.front().x;
+            double max_coord = min_coord;
+            for (const auto& box : boxes_) {
+                min_coord = std::min({min_coord, box.x, box.y});
+                max_coord = std::max({max_coord, box.x + box.width, box.y + box.height});
+            }
+            const double class_offset = max_coord - min_coord + 1.0;
+
+            offset_boxes_.resize(boxes_.size());
+            for (size_t i = 0; i < boxes_.size(); i++) {
+                const double offset = class_ids_[i] * class_offset;
+                offset_boxes_[i] = boxes_[i] + cv::Point2d(offset, offset);
+            }
+            cv::dnn::NMSBoxes(offset_boxes_, scores_, conf_threshold, nms_threshold, keep_);
+            break;
+        }
+
+        case NmsMode::ClassAware:
+            greedyClassAware(nms_threshold);
+            break;
+    }
+
+    return keep_;
+}
+
+void YoloPostprocessor::greedyClassAware(float nms_threshold) {
+    order_.resize(boxes_.size());
+    std::iota(order_.begin(), order_.end(), 0);
+    std::sort(order_.begin(), order_.end(), [this](int a, int b) { return scores_[a] > scores_[b]; });
+
+    for (int idx : order_) {
+        bool suppressed = false;
+        for (int kept : keep_) {
+            if (class_ids_[kept] == class_ids_[idx] && iou(boxes_[kept], boxes_[idx]) > nms_threshold) {
+                suppressed = true;
+                break;
+            }
+        }
+        if (!suppressed) {
+            keep_.push_back(idx);
+        }
+    }
+}
+
+} // namespace navign::robot::vision
@@ -0,0 +1,386 @@
+#include "zenoh_publisher.hpp"
+
+#include <google/protobuf/message_lite.h>
+#include <cstring>
+#include <iostream>
+#include <variant>
+
+namespace navign::robot::vision {
+
+const char* visionTopicKey(VisionTopic topic) {
+    switch (topic) {
+        case VisionTopic::AprilTags: return "robot/vision/apriltags";
+        case VisionTopic::Objects: return "robot/vision/objects";
+        case VisionTopic::Updates: return "robot/vision/updates";
+        case VisionTopic::Frames: return "robot/vision/frames";
+        case VisionTopic::Status: return "robot/vision/status";
+        case VisionTopic::CameraPose: return "robot/vision/camera_pose";
+        case VisionTopic::Count: break;
+    }
+    return "";
+}
+
+const char* visionRpcKey(VisionRpc rpc) {
+    switch (rpc) {
+        case VisionRpc::DetectAprilTags: return "robot/vision/rpc/detect_apriltags";
+        case VisionRpc::DetectObjects: return "robot/vision/rpc/detect_objects";
+        case VisionRpc::GetCameraCalibration: return "robot/vision/rpc/get_camera_calibration";
+        case VisionRpc::StreamVisionData: return "robot/vision/rpc/stream_vision_data";
+        case VisionRpc::TransformCoordinates: return "robot/vision/rpc/transform_coordinates";
+        case VisionRpc::GetComponentStatus: return "robot/vision/rpc/get_component_status";
+        case VisionRpc::Count: break;
+    }
+    return "";
+}
+
+ZenohPublisher::ZenohPublisher() : payloads_(std::make_shared<PayloadStorage>()) {}
+
+ZenohQuery::~ZenohQuery() {
+    if (!answered_) {
+        replyError("request dropped");
+    }
+}
+
+ZenohPublisher::~ZenohPublisher() {
+    close();
+}
+
+#ifdef USE_ZENOH
+
+bool ZenohPublisher::open(const std::string& config_file, bool shared_memory, size_t shm_pool_bytes) {
+    close();
+
+    try {
+        auto config = config_file.empty() ? zenoh::Config::create_default()
+                                          : zenoh::Config::from_file(config_file);
+
+#if defined(Z_FEATURE_SHARED_MEMORY) && defined(Z_FEATURE_UNSTABLE_API)
+        if (shared_memory) {
+            config.insert_json5("transport/shared_memory/enabled", "true");
+            shm_provider_.emplace(zenoh::MemoryLayout(shm_pool_bytes, zenoh::AllocAlignment({0})));
+        }
+#else
+        if (shared_memory) {
+            std::cerr << "Zenoh built without shared-memory support; using heap payloads" << std::endl;
+        }
+        (void)shm_pool_bytes;
+#endif
+
+        session_.emplace(zenoh::Session::open(std::move(config)));
+        for (size_t i = 0; i < publishers_.size(); i++) {
+            const auto topic = static_cast<VisionTopic>(i);
+            publishers_[i].emplace(session_->declare_publisher(zenoh::KeyExpr(visionTopicKey(topic))));
+        }
+    } catch (const zenoh::ZException& e) {
+        std::cerr << "Failed to open Zenoh session: " << e.what() << std::endl;
+        close();
+        return false;
+    }
+
+    std::cout << "Zenoh session opened"
+              << (usesSharedMemory() ? " (shared-memory payloads)" : "") << std::endl;
+    return true;
+}
+
+void ZenohPublisher::close() {
+    queryables_.clear();
+    for (auto& publisher : publishers_) {
+        publisher.reset();
+    }
+#if defined(Z_FEATURE_SHARED_MEMORY) && defined(Z_FEATURE_UNSTABLE_API)
+    shm_provider_.reset();
+#endif
+    session_.reset();
+}
+
+bool ZenohPublisher::isOpen() const {
+    return session_.has_value();
+}
+
+bool ZenohPublisher::usesSharedMemory() const {
+#if defined(Z_FEATURE_SHARED_MEMORY) && defined(Z_FEATURE_UNSTABLE_API)
+    return shm_provider_.has_value();
+#else
+    return false;
+#endif
+}
+
+template <typename Fill>
+bool ZenohPublisher::put(
+    VisionTopic topic,
+    size_t size,
+    Fill&& fill,
+    zenoh::Encoding encoding,
+    const std::string& attachment
+) {
+    auto& publisher = publishers_[static_cast<size_t>(topic)];
+    if (!publisher) {
+        return false;
+    }
+
+    zenoh::Publisher::PutOptions options;
+    options.encoding = std::move(encoding);
+    if (!attachment.empty()) {
+        options.attachment = zenoh::Bytes(attachment);
+    }
+
+    try {
+#if defined(Z_FEATURE_SHARED_MEMORY) && defined(Z_FEATURE_UNSTABLE_API)
+        if (shm_provider_) {
+            // Non-blocking: a full segment falls back to the heap path
+            // instead of stalling the pipeline
+            auto result = shm_provider_->alloc_gc_defrag(size, zenoh::AllocAlignment({0}));
+            if (auto* buffer = std::get_if<zenoh::ZShmMut>(&result)) {
+                fill(buffer->data());
+                publisher->put(zenoh::Bytes(std::move(*buffer)), std::move(options));
+                return true;
+            }
+        }
+#endif
+
+        std::unique_ptr<std::vector<uint8_t>> buffer;
+        {
+            std::lock_guard<std::mutex> lock(payloads_->mutex);
+            if (!payloads_->free_list.empty()) {
+                buffer = std::move(payloads_->free_list.back());
+                payloads_->free_list.pop_back();
+            }
+        }
+        if (!buffer) {
+            buffer = std::make_unique<std::vector<uint8_t>>();
+        }
+
+        // Capacity is kept across uses, so this only allocates while warming up
+        buffer->resize(size);
+        fill(buffer->data());
+
+        // Zenoh takes the bytes without copying and calls the deleter once the
+        // payload is released, returning the buffer to the free list
+        auto* raw = buffer.release();
+        zenoh::Bytes payload(raw->data(), size, [storage = payloads_, raw](uint8_t*) {
+            std::lock_guard<std::mutex> lock(storage->mutex);
+            storage->free_list.emplace_back(raw);
+        });
+        publisher->put(std::move(payload), std::move(options));
+        return true;
+    } catch (const zenoh::ZException& e) {
+        std::cerr << "Zenoh publish on " << visionTopicKey(topic) << " failed: " << e.what() << std::endl;
+        return false;
+    }
+}
+
+bool ZenohPublisher::publish(
+    VisionTopic topic,
+    const google::protobuf::MessageLite& message,
+    const std::string& attachment
+) {
+    // Computes and caches the size, so serialization below skips it
+    const size_t size = message.ByteSizeLong();
+    return put(topic, size,
+               [&message](uint8_t* out) { message.SerializeWithCachedSizesToArray(out); },
+               zenoh::Encoding::Predefined::application_protobuf(), attachment);
+}
+
+bool ZenohPublisher::publishRaw(VisionTopic topic, const uint8_t* data, size_t size, const std::string& encoding) {
+    return put(topic, size,
+               [data, size](uint8_t* out) { std::memcpy(out, data, size); },
+               zenoh::Encoding(encoding), {});
+}
+
+bool ZenohPublisher::publishSerialized(
+    VisionTopic topic,
+    std::shared_ptr<const std::string> bytes,
+    const std::string& attachment
+) {
+    auto& publisher = publishers_[static_cast<size_t>(topic)];
+    if (!publisher || !bytes) {
+        return false;
+    }
+
+#if defined(Z_FEATURE_SHARED_MEMORY) && defined(Z_FEATURE_UNSTABLE_API)
+    if (shm_provider_) {
+        return put(topic, bytes->size(),
+                   [&bytes](uint8_t* out) { std::memcpy(out, bytes->data(), bytes->size()); },
+                   zenoh::Encoding::Predefined::application_protobuf(), attachment);
+    }
+#endif
+
+    zenoh::Publisher::PutOptions options;
+    options.encoding = zenoh::Encoding::Predefined::application_protobuf();
+    if (!attachment.empty()) {
+        options.attachment = zenoh::Bytes(attachment);
+    }
+
+    try {
+        // The payload holds a reference until Zenoh releases it
+        auto* data = reinterpret_cast<uint8_t*>(const_cast<char*>(bytes->data()));
+        const size_t size = bytes->size();
+        publisher->put(zenoh::Bytes(data, size, [bytes = std::move(bytes)](uint8_t*) {}), std::move(options));
+        return true;
+    } catch (const zenoh::ZException& e) {
+        std::cerr << "Zenoh publish on " << visionTopicKey(topic) << " failed: " << e.what() << std::endl;
+        return false;
+    }
+}
+
+bool ZenohPublisher::publishTo(
+    const std::string& key,
+    std::shared_ptr<const std::string> bytes,
+    const std::string& attachment
+) {
+    if (!session_ || !bytes) {
+        return false;
+    }
+
+    zenoh::Session::PutOptions options;
+    options.encoding = zenoh::Encoding::Predefined::application_protobuf();
+    if (!attachment.empty()) {
+        options.attachment = zenoh::Bytes(attachment);
+    }
+
+    try {
+        auto* data = reinterpret_cast<uint8_t*>(const_cast<char*>(bytes->data()));
+        const size_t size = bytes->size();
+        session_->put(zenoh::KeyExpr(key), zenoh::Bytes(data, size, [bytes = std::move(bytes)](uint8_t*) {}),
+                      std::move(options));
+        return true;
+    } catch (const zenoh::ZException& e) {
+        std::cerr << "Zenoh publish on " << key << " failed: " << e.what() << std::endl;
+        return false;
+    }
+}
+
+bool ZenohPublisher::declareQueryable(const std::string& key, QueryHandler handler) {
+    if (!session_) {
+        return false;
+    }
+
+    try {
+        queryables_.push_back(session_->declare_queryable(
+            zenoh::KeyExpr(key),
+            [handler = std::move(handler)](const zenoh::Query& query) {
+                std::unique_ptr<ZenohQuery> request(new ZenohQuery());
+                if (auto payload = query.get_payload()) {
+                    request->payload_ = payload->get().as_vector();
+                }
+                if (auto attachment = query.get_attachment()) {
+                    request->attachment_ = attachment->get().as_string();
+                }
+                // The clone keeps the query open after this callback returns
+                request->query_.emplace(query.clone());
+                handler(std::move(request));
+            },
+            zenoh::closures::none));
+    } catch (const zenoh::ZException& e) {
+        std::cerr << "Failed to declare queryable " << key << ": " << e.what() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void ZenohPublisher::undeclareQueryables() {
+    queryables_.clear();
+}
+
+bool ZenohQuery::reply(const google::protobuf::MessageLite& message, const std::string& attachment) {
+    auto bytes = std::make_shared<std::string>();
+    message.SerializeToString(bytes.get());
+    return replyBytes(std::move(bytes), attachment);
+}
+
+bool ZenohQuery::replyBytes(std::shared_ptr<const std::string> bytes, const std::string& attachment) {
+    if (answered_ || !query_) {
+        return false;
+    }
+    answered_ = true;
+
+    zenoh::Query::ReplyOptions options;
+    options.encoding = zenoh::Encoding::Predefined::application_protobuf();
+    if (!attachment.empty()) {
+        options.attachment = zenoh::Bytes(attachment);
+    }
+
+    try {
+        auto* data = reinterpret_cast<uint8_t*>(const_cast<char*>(bytes->data()));
+        const size_t size = bytes->size();
+        query_->reply(query_->get_keyexpr(), zenoh::Bytes(data, size, [bytes = std::move(bytes)](uint8_t*) {}),
+                      std::move(options));
+    } catch (const zenoh::ZException& e) {
+        std::cerr << "Zenoh reply failed: " << e.what() << std::endl;
+        return false;
+    }
+    // Dropping the query sends the final reply
+    query_.reset();
+    return true;
+}
+
+bool ZenohQuery::replyError(const std::string& message) {
+    if (answered_ || !query_) {
+        return false;
+    }
+    answered_ = true;
+
+    try {
+        query_->reply_err(zenoh::Bytes(message));
+    } catch (const zenoh::ZException& e) {
+        std::cerr << "Zenoh error reply failed: " << e.what() << std::endl;
+        return false;
+    }
+    query_.reset();
+    return true;
+}
+
+#else
+
+bool ZenohPublisher::open(const std::string&, bool, size_t) {
+    std::cerr << "Vision service built without Zenoh (zenoh-cpp not found)" << std::endl;
+    return false;
+}
+
+void ZenohPublisher::close() {}
+
+bool ZenohPublisher::isOpen() const {
+    return false;
+}
+
+bool ZenohPublisher::usesSharedMemory() const {
+    return false;
+}
+
+bool ZenohPublisher::publish(VisionTopic, const google::protobuf::MessageLite&, const std::string&) {
+    return false;
+}
+
+bool ZenohPublisher::publishRaw(VisionTopic, const uint8_t*, size_t, const std::string&) {
+    return false;
+}
+
+bool ZenohPublisher::publishSerialized(VisionTopic, std::shared_ptr<const std::string>, const std::string&) {
+    return false;
+}
+
+bool ZenohPublisher::publishTo(const std::string&, std::shared_ptr<const std::string>, const std::string&) {
+    return false;
+}
+
+bool ZenohPublisher::declareQueryable(const std::string&, QueryHandler) {
+    return false;
+}
+
+void ZenohPublisher::undeclareQueryables() {}
+
+bool ZenohQuery::reply(const google::protobuf::MessageLite&, const std::string&) {
+    return false;
+}
+
+bool ZenohQuery::replyBytes(std::shared_ptr<const std::string>, const std::string&) {
+    return false;
+}
+
+bool ZenohQuery::replyError(const std::string&) {
+    return false;
+}
+
+#endif
+
+} // namespace navign::robot::vision
@@ -0,0 +1,73 @@
+#include <gtest/gtest.h>
+
+#include "apriltag_controller.hpp"
+
+using namespace navign::robot::vision;
+
+namespace {
+
+AprilTagController makeController(const AprilTagTuning& tuning) {
+    AprilTagController controller;
+    controller.configure(30.0, 8);
+    controller.reset(tuning);
+    return controller;
+}
+
+void feed(AprilTagController& controller, int frames, double latency_ms, double smallest_tag_px = 0.0) {
+    for (int i = 0; i < frames; i++) {
+        controller.update(latency_ms, smallest_tag_px);
+    }
+}
+
+} // namespace
+
+TEST(AprilTagController, OverBudgetConvergesToFastestSettings) {
+    auto controller = makeController({2.0f, 1, true});
+    feed(controller, 500, 100.0);
+
+    const auto& state = controller.state();
+    EXPECT_EQ(state.tuning.nthreads, 8);
+    EXPECT_FLOAT_EQ(state.tuning.quad_decimate, 4.0f);
+    EXPECT_FALSE(state.tuning.refine_edges);
+    EXPECT_EQ(state.deadline_misses, 500u);
+    EXPECT_NEAR(state.budget_ms, 1000.0 / 30.0, 1e-9);
+}
+
+TEST(AprilTagController, HeadroomConvergesToMostAccurateSettings) {
+    auto controller = makeController({4.0f, 8, false});
+    feed(controller, 500, 1.0);
+
+    const auto& state = controller.state();
+    EXPECT_TRUE(state.tuning.refine_edges);
+    EXPECT_FLOAT_EQ(state.tuning.quad_decimate, 1.0f);
+    EXPECT_EQ(state.tuning.nthreads, 1);
+    EXPECT_EQ(state.deadline_misses, 0u);
+}
+
+TEST(AprilTagController, SettlesWithinBudgetBand) {
+    auto controller = makeController({2.0f, 4, true});
+    feed(controller, 200, 25.0);
+
+    const auto& state = controller.state();
+    EXPECT_EQ(state.adjustments, 0u);
+    EXPECT_FLOAT_EQ(state.tuning.quad_decimate, 2.0f);
+    EXPECT_EQ(state.tuning.nthreads, 4);
+}
+
+TEST(AprilTagController, SmallTagsCapDecimationImmediately) {
+    auto controller = makeController({4.0f, 8, true});
+    controller.update(25.0, 30.0);
+
+    EXPECT_FLOAT_EQ(controller.state().tuning.quad_decimate, 1.0f);
+    EXPECT_NEAR(controller.state().max_decimate, 30.0 / 24.0, 1e-6);
+}
+
+TEST(AprilTagController, OverloadRespectsTagSizeCeiling) {
+    auto controller = makeController({1.0f, 8, true});
+    feed(controller, 500, 100.0, 50.0);
+
+    const auto& state = controller.state();
+    EXPECT_FLOAT_EQ(state.tuning.quad_decimate, 2.0f);
+    EXPECT_LE(state.tuning.quad_decimate, state.max_decimate);
+    EXPECT_FALSE(state.tuning.refine_edges);
+}
@@ -0,0 +1,59 @@
+#include <gtest/gtest.h>
+
+#include "frame_pool.hpp"
+
+using namespace navign::robot::vision;
+
+TEST(FramePool, PreallocatesFrames) {
+    FramePool pool(2, cv::Size(64, 48));
+    EXPECT_EQ(pool.capacity(), 2u);
+    EXPECT_EQ(pool.available(), 2u);
+    EXPECT_EQ(pool.bytes(), 2u * (64 * 48 * 3 + 64 * 48));
+
+    const auto frame = pool.acquire();
+    ASSERT_NE(frame, nullptr);
+    EXPECT_EQ(frame->image.size(), cv::Size(64, 48));
+    EXPECT_EQ(frame->image.type(), CV_8UC3);
+    EXPECT_EQ(frame->gray.size(), cv::Size(64, 48));
+    EXPECT_EQ(frame->gray.type(), CV_8UC1);
+}
+
+TEST(FramePool, ReturnsNullWhenExhausted) {
+    FramePool pool(2, cv::Size(16, 16));
+    const auto first = pool.acquire();
+    const auto second = pool.acquire();
+    ASSERT_NE(first, nullptr);
+    ASSERT_NE(second, nullptr);
+    EXPECT_EQ(pool.available(), 0u);
+    EXPECT_EQ(pool.acquire(), nullptr);
+}
+
+TEST(FramePool, RecyclesReleasedFrames) {
+    FramePool pool(1, cv::Size(32, 32));
+    auto frame = pool.acquire();
+    ASSERT_NE(frame, nullptr);
+    const uint8_t* pixels = frame->image.data;
+
+    // Shared readers keep the frame out of the pool
+    FramePtr reader = frame;
+    frame.reset();
+    EXPECT_EQ(pool.available(), 0u);
+    reader.reset();
+    EXPECT_EQ(pool.available(), 1u);
+
+    const auto again = pool.acquire();
+    ASSERT_NE(again, nullptr);
+    EXPECT_EQ(again->image.data, pixels);
+}
+
+TEST(FramePool, FramesOutliveThePool) {
+    std::shared_ptr<Frame> frame;
+    {
+        FramePool pool(1, cv::Size(16, 16));
+        frame = pool.acquire();
+    }
+    ASSERT_NE(frame, nullptr);
+    frame->image.setTo(cv::Scalar(1, 2, 3));
+    EXPECT_EQ(frame->image.at<cv::Vec3b>(0, 0), cv::Vec3b(1, 2, 3));
+    frame.reset();
+}
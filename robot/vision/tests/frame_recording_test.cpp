@@ -0,0 +1,148 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "frame_recording.hpp"
+
+using namespace navign::robot::vision;
+using namespace std::chrono_literals;
+
+namespace {
+
+constexpr auto kFrameInterval = 20ms;
+
+/**
+ * @brief Recording in the temp directory, removed when the test ends
+ */
+class RecordingFile {
+public:
+    RecordingFile()
+        : path_((std::filesystem::temp_directory_path() /
+                 (std::string("navign_vision_") +
+                  ::testing::UnitTest::GetInstance()->current_test_info()->name() + ".navfrm")).string()) {}
+    ~RecordingFile() { std::filesystem::remove(path_); }
+
+    const std::string& path() const { return path_; }
+
+private:
+    std::string path_;
+};
+
+std::vector<FramePtr> makeFrames(size_t count, cv::Size size, bool noise) {
+    std::vector<FramePtr> frames;
+    const auto start = std::chrono::steady_clock::now();
+    cv::RNG rng(42);
+    for (size_t i = 0; i < count; i++) {
+        auto frame = std::make_shared<Frame>();
+        frame->frame_id = i + 1;
+        frame->capture_time = start + static_cast<int>(i) * kFrameInterval;
+        frame->image.create(size, CV_8UC3);
+        if (noise) {
+            rng.fill(frame->image, cv::RNG::UNIFORM, 0, 256);
+        } else {
+            // Smooth content survives JPEG with small errors
+            for (int y = 0; y < size.height; y++) {
+                for (int x = 0; x < size.width; x++) {
+                    frame->image.at<cv::Vec3b>(y, x) = cv::Vec3b(
+                        static_cast<uint8_t>(x * 4), static_cast<uint8_t>(y * 4), static_cast<uint8_t>(i * 40));
+                }
+            }
+        }
+        frames.push_back(std::move(frame));
+    }
+    return frames;
+}
+
+std::chrono::nanoseconds sinceFirst(const Frame& frame, std::chrono::steady_clock::time_point first) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(frame.capture_time - first);
+}
+
+void record(const std::string& path, const std::vector<FramePtr>& frames, RecordingCodec codec) {
+    FrameRecorder recorder;
+    ASSERT_TRUE(recorder.start(path, frames.front()->image.size(), codec));
+    for (const auto& frame : frames) {
+        recorder.record(frame);
+    }
+    recorder.stop();
+    EXPECT_EQ(recorder.framesWritten(), frames.size());
+    EXPECT_EQ(recorder.framesDropped(), 0u);
+}
+
+} // namespace
+
+TEST(FrameRecording, RawRoundTripIsExact) {
+    RecordingFile file;
+    const auto frames = makeFrames(3, cv::Size(64, 48), true);
+    record(file.path(), frames, RecordingCodec::RawBgr);
+
+    ReplaySource replay;
+    ASSERT_TRUE(replay.open(file.path(), ReplayPacing::Fast));
+    EXPECT_EQ(replay.frameCount(), frames.size());
+    EXPECT_EQ(replay.codec(), RecordingCodec::RawBgr);
+    EXPECT_EQ(replay.frameSize(), cv::Size(64, 48));
+    EXPECT_TRUE(replay.lossless());
+
+    std::chrono::steady_clock::time_point first;
+    for (size_t i = 0; i < frames.size(); i++) {
+        Frame frame;
+        ASSERT_TRUE(replay.read(frame)) << "frame " << i;
+        EXPECT_EQ(cv::norm(frame.image, frames[i]->image, cv::NORM_INF), 0.0) << "frame " << i;
+        if (i == 0) {
+            first = frame.capture_time;
+        }
+        // Replayed frames keep the recorded spacing, even in fast mode
+        EXPECT_EQ(sinceFirst(frame, first), static_cast<int>(i) * kFrameInterval) << "frame " << i;
+    }
+
+    Frame end;
+    EXPECT_FALSE(replay.read(end));
+    EXPECT_TRUE(replay.finished());
+}
+
+TEST(FrameRecording, MjpegRoundTripIsClose) {
+    RecordingFile file;
+    const auto frames = makeFrames(3, cv::Size(64, 48), false);
+    record(file.path(), frames, RecordingCodec::Mjpeg);
+
+    ReplaySource replay;
+    ASSERT_TRUE(replay.open(file.path(), ReplayPacing::Fast));
+    EXPECT_EQ(replay.codec(), RecordingCodec::Mjpeg);
+    for (size_t i = 0; i < frames.size(); i++) {
+        Frame frame;
+        ASSERT_TRUE(replay.read(frame)) << "frame " << i;
+        ASSERT_EQ(frame.image.size(), frames[i]->image.size());
+        EXPECT_LT(cv::norm(frame.image, frames[i]->image, cv::NORM_L1) / frame.image.total(), 6.0)
+            << "frame " << i;
+    }
+}
+
+TEST(FrameRecording, LoopedReplayKeepsTimeIncreasing) {
+    RecordingFile file;
+    const auto frames = makeFrames(3, cv::Size(16, 16), true);
+    record(file.path(), frames, RecordingCodec::RawBgr);
+
+    ReplaySource replay;
+    ASSERT_TRUE(replay.open(file.path(), ReplayPacing::Fast, true));
+
+    std::chrono::steady_clock::time_point first;
+    for (size_t i = 0; i < 2 * frames.size(); i++) {
+        Frame frame;
+        ASSERT_TRUE(replay.read(frame)) << "frame " << i;
+        EXPECT_EQ(cv::norm(frame.image, frames[i % frames.size()]->image, cv::NORM_INF), 0.0);
+        if (i == 0) {
+            first = frame.capture_time;
+        }
+        // The second pass continues one frame interval after the last frame
+        EXPECT_EQ(sinceFirst(frame, first), static_cast<int>(i) * kFrameInterval) << "frame " << i;
+    }
+    EXPECT_FALSE(replay.finished());
+}
+
+TEST(FrameRecording, OpenRejectsMissingFile) {
+    ReplaySource replay;
+    EXPECT_FALSE(replay.open("/nonexistent/recording.navfrm", ReplayPacing::Fast));
+    EXPECT_FALSE(replay.isOpened());
+}
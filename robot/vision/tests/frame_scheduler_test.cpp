@@ -0,0 +1,104 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+
+#include "frame_scheduler.hpp"
+
+using namespace navign::robot::vision;
+using namespace std::chrono_literals;
+using Clock = FrameScheduler::Clock;
+
+namespace {
+
+SchedulerConfig makeConfig(LoadShedding shedding, int fps = 30, int object_fps = 0) {
+    SchedulerConfig config;
+    config.fps = fps;
+    config.object_fps = object_fps;
+    config.shedding = shedding;
+    return config;
+}
+
+} // namespace
+
+TEST(FrameScheduler, FreshFramesGoToBothDetectors) {
+    FrameScheduler scheduler;
+    scheduler.configure(makeConfig(LoadShedding::Objects));
+    for (int i = 0; i < 10; i++) {
+        const auto work = scheduler.plan(Clock::now());
+        EXPECT_TRUE(work.apriltags);
+        EXPECT_TRUE(work.objects);
+    }
+    EXPECT_EQ(scheduler.objectFramesShed(), 0u);
+    EXPECT_EQ(scheduler.framesShed(), 0u);
+}
+
+TEST(FrameScheduler, StaleFramesShedObjectsBoundedly) {
+    FrameScheduler scheduler;
+    scheduler.configure(makeConfig(LoadShedding::Objects));
+    for (int i = 0; i < FrameScheduler::kMaxConsecutiveSheds; i++) {
+        const auto work = scheduler.plan(Clock::now() - 1s);
+        EXPECT_TRUE(work.apriltags);
+        EXPECT_FALSE(work.objects);
+    }
+    // Sustained overload still lets YOLO through every few frames
+    const auto work = scheduler.plan(Clock::now() - 1s);
+    EXPECT_TRUE(work.apriltags);
+    EXPECT_TRUE(work.objects);
+    EXPECT_EQ(scheduler.objectFramesShed(), static_cast<uint64_t>(FrameScheduler::kMaxConsecutiveSheds));
+}
+
+TEST(FrameScheduler, StaleFramesShedWholeFrames) {
+    FrameScheduler scheduler;
+    scheduler.configure(makeConfig(LoadShedding::Frames));
+    for (int i = 0; i < FrameScheduler::kMaxConsecutiveSheds; i++) {
+        const auto work = scheduler.plan(Clock::now() - 1s);
+        EXPECT_FALSE(work.apriltags);
+        EXPECT_FALSE(work.objects);
+    }
+    const auto work = scheduler.plan(Clock::now() - 1s);
+    EXPECT_TRUE(work.apriltags);
+    EXPECT_TRUE(work.objects);
+    EXPECT_EQ(scheduler.framesShed(), static_cast<uint64_t>(FrameScheduler::kMaxConsecutiveSheds));
+    EXPECT_EQ(scheduler.objectFramesShed(), 0u);
+}
+
+TEST(FrameScheduler, SheddingOffKeepsEveryFrame) {
+    FrameScheduler scheduler;
+    scheduler.configure(makeConfig(LoadShedding::Off));
+    scheduler.recordResult(FrameScheduler::ResultKind::Objects, Clock::now() - 1s, Clock::now());
+    for (int i = 0; i < 10; i++) {
+        const auto work = scheduler.plan(Clock::now() - 1s);
+        EXPECT_TRUE(work.apriltags);
+        EXPECT_TRUE(work.objects);
+    }
+}
+
+TEST(FrameScheduler, MissedDeadlineShedsUntilMet) {
+    FrameScheduler scheduler;
+    scheduler.configure(makeConfig(LoadShedding::Objects));
+    const auto now = Clock::now();
+    scheduler.recordResult(FrameScheduler::ResultKind::Objects, now - 1s, now);
+
+    const auto stats = scheduler.deadlineStats(FrameScheduler::ResultKind::Objects);
+    EXPECT_EQ(stats.missed, 1u);
+    EXPECT_EQ(stats.met, 0u);
+    EXPECT_DOUBLE_EQ(stats.missRate(), 1.0);
+    EXPECT_FALSE(scheduler.plan(Clock::now()).objects);
+
+    scheduler.recordResult(FrameScheduler::ResultKind::Objects, now, now + 1ms);
+    EXPECT_TRUE(scheduler.plan(Clock::now()).objects);
+    EXPECT_DOUBLE_EQ(scheduler.deadlineStats(FrameScheduler::ResultKind::Objects).missRate(), 0.5);
+}
+
+TEST(FrameScheduler, ObjectRateFollowsCaptureGrid) {
+    // 40 fps camera, YOLO at 10 fps: every fourth frame
+    FrameScheduler scheduler;
+    scheduler.configure(makeConfig(LoadShedding::Objects, 40, 10));
+    const auto start = Clock::now();
+    for (int i = 0; i < 12; i++) {
+        const auto work = scheduler.plan(start + i * 25ms);
+        EXPECT_TRUE(work.apriltags);
+        EXPECT_EQ(work.objects, i % 4 == 0) << "frame " << i;
+    }
+    EXPECT_EQ(scheduler.objectFramesShed(), 0u);
+}
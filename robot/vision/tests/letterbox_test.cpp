@@ -0,0 +1,83 @@
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "letterbox.hpp"
+
+using namespace navign::robot::vision;
+
+namespace {
+
+/**
+ * @brief Per-pixel letterbox, the reference for the vectorized rows
+ */
+std::vector<float> referenceLetterbox(const cv::Mat& image, cv::Size input) {
+    const auto transform = LetterboxTransform::fit(image.size(), input);
+    cv::Mat content = image;
+    if (image.size() != transform.content) {
+        cv::resize(image, content, transform.content, 0, 0, cv::INTER_LINEAR);
+    }
+
+    const size_t plane = static_cast<size_t>(input.area());
+    std::vector<float> tensor(3 * plane, 114.0f / 255.0f);
+    for (int y = 0; y < content.rows; y++) {
+        for (int x = 0; x < content.cols; x++) {
+            const cv::Vec3b& bgr = content.at<cv::Vec3b>(y, x);
+            const size_t i = static_cast<size_t>(transform.pad_y + y) * input.width + transform.pad_x + x;
+            tensor[i] = bgr[2] * (1.0f / 255.0f);
+            tensor[plane + i] = bgr[1] * (1.0f / 255.0f);
+            tensor[2 * plane + i] = bgr[0] * (1.0f / 255.0f);
+        }
+    }
+    return tensor;
+}
+
+void expectMatchesReference(cv::Size image_size, cv::Size input) {
+    cv::Mat image(image_size, CV_8UC3);
+    cv::RNG(7).fill(image, cv::RNG::UNIFORM, 0, 256);
+
+    LetterboxPreprocessor preprocessor;
+    std::vector<float> tensor(3 * static_cast<size_t>(input.area()), -1.0f);
+    const auto transform = preprocessor.apply(image, input, tensor.data());
+    const auto expected = referenceLetterbox(image, input);
+
+    const auto fitted = LetterboxTransform::fit(image_size, input);
+    EXPECT_EQ(transform.pad_x, fitted.pad_x);
+    EXPECT_EQ(transform.pad_y, fitted.pad_y);
+    EXPECT_EQ(transform.content, fitted.content);
+
+    ASSERT_EQ(tensor.size(), expected.size());
+    for (size_t i = 0; i < tensor.size(); i++) {
+        ASSERT_EQ(tensor[i], expected[i]) << image_size << " -> " << input << " at " << i;
+    }
+}
+
+} // namespace
+
+TEST(Letterbox, FitCentersContent) {
+    const auto transform = LetterboxTransform::fit(cv::Size(640, 480), cv::Size(640, 640));
+    EXPECT_DOUBLE_EQ(transform.scale, 1.0);
+    EXPECT_EQ(transform.content, cv::Size(640, 480));
+    EXPECT_EQ(transform.pad_x, 0);
+    EXPECT_EQ(transform.pad_y, 80);
+
+    const cv::Rect2d box = transform.toImage(cv::Rect2d(10, 90, 20, 30));
+    EXPECT_DOUBLE_EQ(box.x, 10.0);
+    EXPECT_DOUBLE_EQ(box.y, 10.0);
+    EXPECT_DOUBLE_EQ(box.width, 20.0);
+    EXPECT_DOUBLE_EQ(box.height, 30.0);
+}
+
+TEST(Letterbox, MatchesScalarWithoutResize) {
+    expectMatchesReference(cv::Size(640, 480), cv::Size(640, 640));
+}
+
+TEST(Letterbox, MatchesScalarWithResize) {
+    expectMatchesReference(cv::Size(1280, 720), cv::Size(640, 640));
+}
+
+TEST(Letterbox, MatchesScalarOnOddWidths) {
+    // Content widths that leave a scalar tail after the 8-pixel vectors
+    expectMatchesReference(cv::Size(37, 23), cv::Size(64, 64));
+    expectMatchesReference(cv::Size(101, 50), cv::Size(96, 96));
+}
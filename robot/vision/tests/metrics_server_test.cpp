@@ -0,0 +1,76 @@
+#include <gtest/gtest.h>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <string>
+#include <thread>
+
+#include "metrics_server.hpp"
+
+using namespace navign::robot::vision;
+using namespace std::chrono_literals;
+
+namespace {
+
+constexpr int kPort = 19464;
+
+/**
+ * @brief Connect to the server and send a scrape request
+ * @return The socket, or -1
+ */
+int sendRequest() {
+    const int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(kPort);
+    if (fd < 0 || ::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+        if (fd >= 0) {
+            ::close(fd);
+        }
+        return -1;
+    }
+    const std::string request = "GET /metrics HTTP/1.1\r\nHost: localhost\r\n\r\n";
+    ::send(fd, request.data(), request.size(), MSG_NOSIGNAL);
+    return fd;
+}
+
+} // namespace
+
+TEST(MetricsServer, ServesRenderedMetrics) {
+    MetricsServer server([] { return std::string("navign_vision_up 1\n"); });
+    ASSERT_TRUE(server.start(kPort));
+
+    const int fd = sendRequest();
+    ASSERT_GE(fd, 0);
+    std::string response;
+    char buffer[4096];
+    ssize_t received = 0;
+    while ((received = ::recv(fd, buffer, sizeof(buffer), 0)) > 0) {
+        response.append(buffer, static_cast<size_t>(received));
+    }
+    ::close(fd);
+    server.stop();
+
+    EXPECT_EQ(response.rfind("HTTP/1.1 200 OK\r\n", 0), 0u);
+    EXPECT_NE(response.find("\r\n\r\nnavign_vision_up 1\n"), std::string::npos);
+}
+
+TEST(MetricsServer, StalledScraperDoesNotBlockStop) {
+    // Far more than the socket buffers hold, so sending stalls
+    MetricsServer server([] { return std::string(64 << 20, '#'); });
+    ASSERT_TRUE(server.start(kPort));
+
+    const int fd = sendRequest();
+    ASSERT_GE(fd, 0);
+    std::this_thread::sleep_for(100ms);
+
+    const auto start = std::chrono::steady_clock::now();
+    server.stop();
+    EXPECT_LT(std::chrono::steady_clock::now() - start, 3s);
+    ::close(fd);
+}
@@ -0,0 +1,149 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "fair_queue.hpp"
+#include "inference_scheduler.hpp"
+#include "object_detector.hpp"
+
+using namespace navign::robot::vision;
+using namespace std::chrono_literals;
+
+namespace {
+
+constexpr int kModelBatch = 2;
+constexpr int kInputSide = 32;
+constexpr int kAnchors = 512;  // 3 * 32 * 32 values reshaped to 6 rows (4 + 2 classes)
+
+// Minimal protobuf writer, enough to encode an ONNX ModelProto
+void varint(std::string& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<char>((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<char>(value));
+}
+
+void intField(std::string& out, int field, uint64_t value) {
+    varint(out, static_cast<uint64_t>(field) << 3);
+    varint(out, value);
+}
+
+void bytesField(std::string& out, int field, const std::string& bytes) {
+    varint(out, (static_cast<uint64_t>(field) << 3) | 2);
+    varint(out, bytes.size());
+    out += bytes;
+}
+
+// ValueInfoProto of a float tensor with a static shape
+std::string tensorInfo(const std::string& name, const std::vector<int64_t>& dims) {
+    std::string shape;
+    for (int64_t dim : dims) {
+        std::string dimension;
+        intField(dimension, 1, static_cast<uint64_t>(dim));  // dim_value
+        bytesField(shape, 1, dimension);
+    }
+    std::string tensor_type;
+    intField(tensor_type, 1, 1);  // elem_type FLOAT
+    bytesField(tensor_type, 2, shape);
+    std::string type;
+    bytesField(type, 1, tensor_type);
+
+    std::string info;
+    bytesField(info, 1, name);
+    bytesField(info, 2, type);
+    return info;
+}
+
+/**
+ * @brief YOLO-shaped model with a fixed batch: Reshape [2, 3, 32, 32] -> [2, 6, 512]
+ */
+std::string fixedBatchModel() {
+    const std::vector<int64_t> output_dims = {kModelBatch, 6, kAnchors};
+
+    std::string shape;  // TensorProto initializer holding the target shape
+    intField(shape, 1, output_dims.size());  // dims
+    intField(shape, 2, 7);                    // data_type INT64
+    std::string values;
+    for (int64_t dim : output_dims) {
+        varint(values, static_cast<uint64_t>(dim));
+    }
+    bytesField(shape, 7, values);  // int64_data (packed)
+    bytesField(shape, 8, "shape");
+
+    std::string node;
+    bytesField(node, 1, "images");
+    bytesField(node, 1, "shape");
+    bytesField(node, 2, "output0");
+    bytesField(node, 4, "Reshape");
+
+    std::string graph;
+    bytesField(graph, 1, node);
+    bytesField(graph, 2, "fixed_batch");
+    bytesField(graph, 5, shape);
+    bytesField(graph, 11, tensorInfo("images", {kModelBatch, 3, kInputSide, kInputSide}));
+    bytesField(graph, 12, tensorInfo("output0", output_dims));
+
+    std::string opset;
+    intField(opset, 2, 13);
+
+    std::string model;
+    intField(model, 1, 7);  // ir_version
+    bytesField(model, 7, graph);
+    bytesField(model, 8, opset);
+    return model;
+}
+
+class FixedBatchModel : public ::testing::Test {
+protected:
+    void SetUp() override {
+        path_ = (std::filesystem::temp_directory_path() / "navign_vision_fixed_batch.onnx").string();
+        std::ofstream(path_, std::ios::binary) << fixedBatchModel();
+
+        detector_.setBackend(InferenceBackend::OnnxRuntime);
+        if (!detector_.loadModel(path_)) {
+            GTEST_SKIP() << "ONNX Runtime is not available";
+        }
+        ASSERT_EQ(detector_.maxBatchSize(), kModelBatch);
+    }
+
+    void TearDown() override { std::filesystem::remove(path_); }
+
+    std::string path_;
+    ObjectDetector detector_;
+    // Letterbox gray stays below the threshold, so nothing is detected
+    const cv::Mat image_ = cv::Mat::zeros(kInputSide, kInputSide, CV_8UC3);
+};
+
+} // namespace
+
+TEST_F(FixedBatchModel, DetectPadsSingleImage) {
+    EXPECT_TRUE(detector_.detect(image_, 0.99f, 0.45f).empty());
+}
+
+TEST_F(FixedBatchModel, DetectBatchPadsPartialChunks) {
+    EXPECT_EQ(detector_.detectBatch(std::vector<cv::Mat>{image_}, 0.99f, 0.45f).size(), 1u);
+    EXPECT_EQ(detector_.detectBatch(std::vector<cv::Mat>(3, image_), 0.99f, 0.45f).size(), 3u);
+}
+
+TEST_F(FixedBatchModel, SchedulerRunsSingleFrameBatch) {
+    // The latency budget runs out with one frame collected
+    InferenceScheduler scheduler(detector_, kModelBatch, 0us);
+    EXPECT_EQ(scheduler.maxBatch(), static_cast<size_t>(kModelBatch));
+
+    FairQueue<FramePtr> queue(4);
+    auto frame = std::make_shared<Frame>();
+    frame->image = image_;
+    queue.push(0, frame);
+
+    ASSERT_TRUE(scheduler.collect(queue, 10ms));
+    const auto& results = scheduler.run(0.99f, 0.45f);
+    ASSERT_EQ(results.size(), 1u);
+    EXPECT_EQ(results[0].frame, frame);
+    EXPECT_TRUE(results[0].objects.empty());
+}
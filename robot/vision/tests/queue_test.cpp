@@ -0,0 +1,115 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include "bounded_queue.hpp"
+#include "fair_queue.hpp"
+
+using namespace navign::robot::vision;
+using namespace std::chrono_literals;
+
+TEST(BoundedQueue, EvictsOldestWhenFull) {
+    BoundedQueue<int> queue(2);
+    EXPECT_TRUE(queue.push(1));
+    EXPECT_TRUE(queue.push(2));
+    EXPECT_TRUE(queue.push(3));
+
+    EXPECT_EQ(queue.size(), 2u);
+    EXPECT_EQ(queue.droppedCount(), 1u);
+    EXPECT_EQ(queue.pop(0ms), 2);
+    EXPECT_EQ(queue.pop(0ms), 3);
+    EXPECT_EQ(queue.pop(0ms), std::nullopt);
+}
+
+TEST(BoundedQueue, CloseWakesConsumerAndRejectsPush) {
+    BoundedQueue<int> queue(1);
+    std::thread closer([&] {
+        std::this_thread::sleep_for(20ms);
+        queue.close();
+    });
+    const auto start = std::chrono::steady_clock::now();
+    EXPECT_EQ(queue.pop(5s), std::nullopt);
+    EXPECT_LT(std::chrono::steady_clock::now() - start, 2s);
+    closer.join();
+
+    EXPECT_FALSE(queue.push(1));
+    queue.reset();
+    EXPECT_TRUE(queue.push(1));
+    EXPECT_EQ(queue.pop(0ms), 1);
+}
+
+TEST(BoundedQueue, DrainsAfterClose) {
+    BoundedQueue<int> queue(4);
+    queue.push(1);
+    queue.close();
+    EXPECT_EQ(queue.pop(0ms), 1);
+    EXPECT_EQ(queue.pop(0ms), std::nullopt);
+}
+
+TEST(FairQueue, EvictsOnlyFromTheFullLane) {
+    FairQueue<int> queue(2, 2);
+    for (int i = 0; i < 5; i++) {
+        queue.push(0, i);
+    }
+    queue.push(1, 100);
+
+    EXPECT_EQ(queue.size(), 3u);
+    EXPECT_EQ(queue.droppedCount(0), 3u);
+    EXPECT_EQ(queue.droppedCount(1), 0u);
+    EXPECT_EQ(queue.droppedCount(), 3u);
+    EXPECT_FALSE(queue.push(2, 0));
+}
+
+TEST(FairQueue, PopsLanesRoundRobin) {
+    FairQueue<int> queue(8, 3);
+    for (int i = 0; i < 4; i++) {
+        queue.push(0, i);
+    }
+    queue.push(1, 10);
+    queue.push(2, 20);
+    queue.push(2, 21);
+
+    std::vector<int> order;
+    while (auto item = queue.pop(0ms)) {
+        order.push_back(*item);
+    }
+    EXPECT_EQ(order, (std::vector<int>{0, 10, 20, 1, 21, 2, 3}));
+}
+
+TEST(FairQueue, PushWaitBlocksUntilRoom) {
+    FairQueue<int> queue(1, 1);
+    ASSERT_TRUE(queue.pushWait(0, 1, 0ms));
+    EXPECT_FALSE(queue.pushWait(0, 2, 10ms));
+    EXPECT_EQ(queue.droppedCount(), 0u);
+
+    std::atomic<bool> pushed{false};
+    std::thread producer([&] {
+        pushed = queue.pushWait(0, 2, 5s);
+    });
+    std::this_thread::sleep_for(20ms);
+    EXPECT_FALSE(pushed.load());
+    EXPECT_EQ(queue.pop(0ms), 1);
+    producer.join();
+
+    EXPECT_TRUE(pushed.load());
+    EXPECT_EQ(queue.pop(0ms), 2);
+}
+
+TEST(FairQueue, CloseReleasesBlockedProducer) {
+    FairQueue<int> queue(1, 1);
+    queue.push(0, 1);
+
+    std::atomic<bool> pushed{true};
+    std::thread producer([&] {
+        pushed = queue.pushWait(0, 2, 5s);
+    });
+    std::this_thread::sleep_for(20ms);
+    queue.close();
+    producer.join();
+
+    EXPECT_FALSE(pushed.load());
+    EXPECT_EQ(queue.pop(0ms), 1);
+    EXPECT_EQ(queue.pop(0ms), std::nullopt);
+}
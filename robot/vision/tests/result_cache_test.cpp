@@ -0,0 +1,124 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "result_cache.hpp"
+
+using namespace navign::robot::vision;
+
+TEST(LatestResult, EmptyUntilFirstPublish) {
+    LatestResult latest;
+    EXPECT_EQ(latest.load(), nullptr);
+    EXPECT_EQ(latest.sequence(), 0u);
+}
+
+TEST(LatestResult, PublishReplacesSnapshot) {
+    LatestResult latest;
+    const auto first = latest.publish(7, 1, "first");
+    const auto second = latest.publish(8, 2, "second");
+
+    EXPECT_EQ(first->sequence, 1u);
+    EXPECT_EQ(second->sequence, 2u);
+    EXPECT_EQ(latest.load(), second);
+    EXPECT_EQ(latest.sequence(), 2u);
+    EXPECT_EQ(latest.load()->frame_id, 8u);
+    EXPECT_EQ(latest.load()->camera_id, 2u);
+
+    // Readers keep old snapshots alive
+    EXPECT_EQ(first->bytes, "first");
+}
+
+TEST(LatestResult, ReadersSeeIncreasingSequences) {
+    LatestResult latest;
+    constexpr uint64_t kPublishes = 20000;
+    std::atomic<bool> done{false};
+    std::atomic<bool> ordered{true};
+
+    std::vector<std::thread> readers;
+    for (int i = 0; i < 3; i++) {
+        readers.emplace_back([&] {
+            uint64_t last = 0;
+            while (!done.load()) {
+                const auto snapshot = latest.load();
+                const uint64_t sequence = snapshot ? snapshot->sequence : 0;
+                if (sequence < last || (snapshot && snapshot->frame_id != sequence)) {
+                    ordered = false;
+                }
+                last = sequence;
+            }
+        });
+    }
+    for (uint64_t i = 1; i <= kPublishes; i++) {
+        latest.publish(i, 0, "x");
+    }
+    done = true;
+    for (auto& reader : readers) {
+        reader.join();
+    }
+
+    EXPECT_TRUE(ordered.load());
+    EXPECT_EQ(latest.sequence(), kPublishes);
+}
+
+TEST(ResultSnapshot, DerivedIsBuiltOncePerKey) {
+    ResultSnapshot snapshot;
+    int builds = 0;
+    const auto make = [&](std::string& out) {
+        builds++;
+        out = "encoded";
+    };
+
+    bool coalesced = true;
+    const auto first = snapshot.derived("filtered", make, &coalesced);
+    EXPECT_FALSE(coalesced);
+    const auto again = snapshot.derived("filtered", make, &coalesced);
+    EXPECT_TRUE(coalesced);
+
+    EXPECT_EQ(first, again);
+    EXPECT_EQ(*first, "encoded");
+    EXPECT_EQ(builds, 1);
+
+    snapshot.derived("other", make, &coalesced);
+    EXPECT_FALSE(coalesced);
+    EXPECT_EQ(builds, 2);
+}
+
+TEST(ResultSnapshot, DerivedPastCapacityIsUncached) {
+    ResultSnapshot snapshot;
+    int builds = 0;
+    const auto make = [&](std::string& out) {
+        builds++;
+        out = std::to_string(builds);
+    };
+
+    for (size_t i = 0; i < ResultSnapshot::kMaxDerived; i++) {
+        snapshot.derived("key" + std::to_string(i), make);
+    }
+    snapshot.derived("extra", make);
+    snapshot.derived("extra", make);
+    EXPECT_EQ(builds, static_cast<int>(ResultSnapshot::kMaxDerived) + 2);
+
+    snapshot.derived("key0", make);
+    EXPECT_EQ(builds, static_cast<int>(ResultSnapshot::kMaxDerived) + 2);
+}
+
+TEST(ResultSnapshot, ConcurrentDerivedCoalesces) {
+    ResultSnapshot snapshot;
+    std::atomic<int> builds{0};
+
+    std::vector<std::thread> readers;
+    for (int i = 0; i < 8; i++) {
+        readers.emplace_back([&] {
+            snapshot.derived("filtered", [&](std::string& out) {
+                builds++;
+                out = "encoded";
+            });
+        });
+    }
+    for (auto& reader : readers) {
+        reader.join();
+    }
+    EXPECT_EQ(builds.load(), 1);
+}
@@ -0,0 +1,164 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <vector>
+
+#include "yolo_postprocess.hpp"
+
+using namespace navign::robot::vision;
+
+namespace {
+
+constexpr int kClasses = 80;
+constexpr float kConfThreshold = 0.5f;
+
+struct Candidate {
+    cv::Rect2d box;
+    float score;
+    int class_id;
+};
+
+/**
+ * @brief Random native-layout head [1, 4 + C, N] with sparse confident anchors
+ */
+cv::Mat makeHead(int anchors) {
+    const int sizes[] = {1, 4 + kClasses, anchors};
+    cv::Mat head(3, sizes, CV_32F);
+    cv::RNG rng(1234);
+    float* data = head.ptr<float>();
+    for (int row = 0; row < 4 + kClasses; row++) {
+        for (int a = 0; a < anchors; a++) {
+            const float value = rng.uniform(0.0f, 1.0f);
+            data[row * anchors + a] = row < 4 ? 10.0f + 600.0f * value : std::pow(value, 8.0f);
+        }
+    }
+    // Ties between classes resolve to the lowest class
+    for (int a = 0; a < anchors; a += 97) {
+        data[(4 + 3) * anchors + a] = 0.9999f;
+        data[(4 + 11) * anchors + a] = 0.9999f;
+    }
+    return head;
+}
+
+/**
+ * @brief Scalar decode of a native-layout head, the reference for the SIMD passes
+ */
+std::vector<Candidate> referenceDecode(const cv::Mat& head, float threshold) {
+    const int anchors = head.size[2];
+    const float* data = head.ptr<float>();
+    std::vector<Candidate> candidates;
+    for (int a = 0; a < anchors; a++) {
+        float best = data[4 * anchors + a];
+        int best_class = 0;
+        for (int c = 1; c < kClasses; c++) {
+            const float score = data[(4 + c) * anchors + a];
+            if (score > best) {
+                best = score;
+                best_class = c;
+            }
+        }
+        if (best > threshold) {
+            const float cx = data[a];
+            const float cy = data[anchors + a];
+            const float w = data[2 * anchors + a];
+            const float h = data[3 * anchors + a];
+            candidates.push_back({cv::Rect2d(cx - w / 2.0f, cy - h / 2.0f, w, h), best, best_class});
+        }
+    }
+    return candidates;
+}
+
+void expectMatches(const YoloPostprocessor& postprocessor, const std::vector<Candidate>& expected) {
+    ASSERT_EQ(postprocessor.boxes().size(), expected.size());
+    for (size_t i = 0; i < expected.size(); i++) {
+        EXPECT_EQ(postprocessor.boxes()[i], expected[i].box) << "candidate " << i;
+        EXPECT_EQ(postprocessor.scores()[i], expected[i].score) << "candidate " << i;
+        EXPECT_EQ(postprocessor.classIds()[i], expected[i].class_id) << "candidate " << i;
+    }
+}
+
+} // namespace
+
+TEST(YoloPostprocess, DecodeMatchesScalar) {
+    // Not a multiple of the vector width, so the scalar tail runs too
+    const cv::Mat head = makeHead(8403);
+    const auto expected = referenceDecode(head, kConfThreshold);
+    ASSERT_FALSE(expected.empty());
+
+    YoloPostprocessor postprocessor;
+    EXPECT_EQ(postprocessor.decode(head, kConfThreshold), expected.size());
+    expectMatches(postprocessor, expected);
+}
+
+TEST(YoloPostprocess, DecodeTransposedLayout) {
+    const cv::Mat head = makeHead(1003);
+    const auto expected = referenceDecode(head, kConfThreshold);
+
+    // [1, N, 4 + C]
+    cv::Mat native(4 + kClasses, head.size[2], CV_32F, const_cast<float*>(head.ptr<float>()));
+    cv::Mat transposed;
+    cv::transpose(native, transposed);
+    const int sizes[] = {1, transposed.rows, transposed.cols};
+    const cv::Mat output(3, sizes, CV_32F, transposed.data);
+
+    YoloPostprocessor postprocessor;
+    EXPECT_EQ(postprocessor.decode(output, kConfThreshold), expected.size());
+    expectMatches(postprocessor, expected);
+}
+
+TEST(YoloPostprocess, TiesKeepLowestClass) {
+    const cv::Mat head = makeHead(200);
+    YoloPostprocessor postprocessor;
+    postprocessor.decode(head, 0.999f);
+
+    size_t ties = 0;
+    for (size_t i = 0; i < postprocessor.boxes().size(); i++) {
+        if (postprocessor.scores()[i] == 0.9999f) {
+            EXPECT_EQ(postprocessor.classIds()[i], 3);
+            ties++;
+        }
+    }
+    EXPECT_GT(ties, 0u);
+}
+
+TEST(YoloPostprocess, ClassAwareNmsKeepsOverlappingClasses) {
+    // Two identical boxes of different classes and a duplicate of the first
+    const int sizes[] = {1, 4 + kClasses, 3};
+    cv::Mat head(3, sizes, CV_32F, cv::Scalar(0.0f));
+    float* data = head.ptr<float>();
+    for (int a = 0; a < 3; a++) {
+        data[a] = 100.0f;
+        data[3 + a] = 100.0f;
+        data[6 + a] = 50.0f;
+        data[9 + a] = 50.0f;
+    }
+    data[(4 + 0) * 3 + 0] = 0.9f;
+    data[(4 + 0) * 3 + 1] = 0.8f;
+    data[(4 + 5) * 3 + 2] = 0.7f;
+
+    YoloPostprocessor postprocessor;
+    ASSERT_EQ(postprocessor.decode(head, kConfThreshold), 3u);
+    EXPECT_EQ(postprocessor.suppress(kConfThreshold, 0.45f, NmsMode::Agnostic).size(), 1u);
+    EXPECT_EQ(postprocessor.suppress(kConfThreshold, 0.45f, NmsMode::ClassAware).size(), 2u);
+    EXPECT_EQ(postprocessor.suppress(kConfThreshold, 0.45f, NmsMode::Batched).size(), 2u);
+}
+
+TEST(YoloPostprocess, BatchedNmsSeparatesClassesAtNegativeCoordinates) {
+    // A class 1 box past the left/top edge: offsets sized from [0, max]
+    // alone would shift it onto the class 0 box and suppress it
+    const int sizes[] = {1, 4 + kClasses, 2};
+    cv::Mat head(3, sizes, CV_32F, cv::Scalar(0.0f));
+    float* data = head.ptr<float>();
+    const float boxes[2][4] = {{25.0f, 25.0f, 50.0f, 50.0f}, {-20.0f, -20.0f, 50.0f, 50.0f}};  // cx, cy, w, h
+    for (int a = 0; a < 2; a++) {
+        for (int row = 0; row < 4; row++) {
+            data[row * 2 + a] = boxes[a][row];
+        }
+    }
+    data[(4 + 0) * 2 + 0] = 0.9f;
+    data[(4 + 1) * 2 + 1] = 0.8f;
+
+    YoloPostprocessor postprocessor;
+    ASSERT_EQ(postprocessor.decode(head, kConfThreshold), 2u);
+    EXPECT_EQ(postprocessor.suppress(kConfThreshold, 0.45f, NmsMode::Batched).size(), 2u);
+}